@@ -29,6 +29,11 @@ STATIC UINTN mFwCfgSelectorAddress;
 STATIC UINTN mFwCfgDataAddress;
 STATIC UINTN mFwCfgDmaAddress;
 
+//
+// The largest number of bytes moved by one fw_cfg DMA transfer
+//
+#define FW_CFG_DMA_MAX_CHUNK  SIZE_16MB
+
 /**
   Reads firmware configuration bytes into a buffer
 
@@ -282,8 +287,8 @@ MmioReadBytes (
 
 
 /**
-  Transfer an array of bytes, or skip a number of bytes, using the DMA
-  interface.
+  Transfer an array of bytes, or skip a number of bytes, using a single
+  transfer of the DMA interface.
 
   @param[in]     Size     Size in bytes to transfer or skip.
 
@@ -298,8 +303,8 @@ MmioReadBytes (
 **/
 STATIC
 VOID
-DmaTransferBytes (
-  IN     UINTN  Size,
+DmaTransferChunk (
+  IN     UINT32 Size,
   IN OUT VOID   *Buffer OPTIONAL,
   IN     UINT32 Control
   )
@@ -307,17 +312,8 @@ DmaTransferBytes (
   volatile FW_CFG_DMA_ACCESS Access;
   UINT32                     Status;
 
-  ASSERT (Control == FW_CFG_DMA_CTL_WRITE || Control == FW_CFG_DMA_CTL_READ ||
-    Control == FW_CFG_DMA_CTL_SKIP);
-
-  if (Size == 0) {
-    return;
-  }
-
-  ASSERT (Size <= MAX_UINT32);
-
   Access.Control = SwapBytes32 (Control);
-  Access.Length  = SwapBytes32 ((UINT32)Size);
+  Access.Length  = SwapBytes32 (Size);
   Access.Address = SwapBytes64 ((UINT64)(UINTN)Buffer);
 
   //
@@ -351,6 +347,45 @@ DmaTransferBytes (
 }
 
 
+/**
+  Transfer an array of bytes, or skip a number of bytes, using the DMA
+  interface, in chunks of at most FW_CFG_DMA_MAX_CHUNK bytes.
+
+  @param[in]     Size     Size in bytes to transfer or skip.
+
+  @param[in,out] Buffer   Buffer to read data into or write data from. Ignored,
+                          and may be NULL, if Size is zero, or Control is
+                          FW_CFG_DMA_CTL_SKIP.
+
+  @param[in]     Control  One of the following:
+                          FW_CFG_DMA_CTL_WRITE - write to fw_cfg from Buffer.
+                          FW_CFG_DMA_CTL_READ  - read from fw_cfg into Buffer.
+                          FW_CFG_DMA_CTL_SKIP  - skip bytes in fw_cfg.
+**/
+STATIC
+VOID
+DmaTransferBytes (
+  IN     UINTN  Size,
+  IN OUT VOID   *Buffer OPTIONAL,
+  IN     UINT32 Control
+  )
+{
+  UINT32 ChunkSize;
+
+  ASSERT (Control == FW_CFG_DMA_CTL_WRITE || Control == FW_CFG_DMA_CTL_READ ||
+    Control == FW_CFG_DMA_CTL_SKIP);
+
+  while (Size > 0) {
+    ChunkSize = (UINT32)MIN (Size, FW_CFG_DMA_MAX_CHUNK);
+    DmaTransferChunk (ChunkSize, Buffer, Control);
+    if (Control != FW_CFG_DMA_CTL_SKIP) {
+      Buffer = (UINT8 *)Buffer + ChunkSize;
+    }
+    Size -= ChunkSize;
+  }
+}
+
+
 /**
   Fast READ_BYTES_FUNCTION.
 **/
@@ -594,8 +594,9 @@ char *strlwr(char *s)
 
 //
 // Global data to store full file path. It is not required to be free.
+// Each thread has its own copy.
 //
-CHAR8 mCommonLibFullPath[MAX_LONG_FILE_PATH];
+THREAD_LOCAL CHAR8 mCommonLibFullPath[MAX_LONG_FILE_PATH];
 
 CHAR8 *
 LongFilePath (
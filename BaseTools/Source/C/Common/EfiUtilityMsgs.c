@@ -24,13 +24,13 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 // Declare module globals for keeping track of the the utility's
 // name and other settings.
 //
-STATIC STATUS mStatus                 = STATUS_SUCCESS;
+STATIC THREAD_LOCAL STATUS mStatus    = STATUS_SUCCESS;
 STATIC CHAR8  mUtilityName[50]        = { 0 };
 STATIC UINT64 mPrintLogLevel          = INFO_LOG_LEVEL;
 STATIC CHAR8  *mSourceFileName        = NULL;
 STATIC UINT32 mSourceFileLineNum      = 0;
-STATIC UINT32 mErrorCount             = 0;
-STATIC UINT32 mWarningCount           = 0;
+STATIC THREAD_LOCAL UINT32 mErrorCount   = 0;
+STATIC THREAD_LOCAL UINT32 mWarningCount = 0;
 STATIC UINT32 mMaxErrors              = 0;
 STATIC UINT32 mMaxWarnings            = 0;
 STATIC UINT32 mMaxWarningsPlusErrors  = 0;
@@ -642,6 +642,27 @@ Returns:
   return mStatus;
 }
 
+VOID
+ResetUtilityStatus (
+  VOID
+  )
+/*++
+
+Routine Description:
+  Reset the worst-case status of the calling thread to STATUS_SUCCESS, so that
+  GetUtilityStatus() returns the status of the next job run by the thread.
+
+Arguments:
+  None.
+
+Returns:
+  NA
+
+--*/
+{
+  mStatus = STATUS_SUCCESS;
+}
+
 VOID
 SetPrintLevel (
   UINT64  LogLevel
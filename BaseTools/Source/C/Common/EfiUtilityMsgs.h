@@ -39,6 +39,16 @@ typedef int STATUS;
 #define MAX_LINE_LEN               0x200
 #define MAXIMUM_INPUT_FILE_NUM     10
 
+//
+// Storage class of the globals which each thread of a utility running
+// several jobs at the same time must have its own copy of.
+//
+#ifdef __GNUC__
+#define THREAD_LOCAL  __thread
+#else
+#define THREAD_LOCAL  __declspec(thread)
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -52,6 +62,15 @@ GetUtilityStatus (
   VOID
   );
 
+//
+// The worst case is tracked for each thread. A thread running several jobs
+// one after the other calls ResetUtilityStatus() before each job.
+//
+VOID
+ResetUtilityStatus (
+  VOID
+  );
+
 //
 // If someone prints an error message and didn't specify a source file name,
 // then we print the utility name instead. However they must tell us the
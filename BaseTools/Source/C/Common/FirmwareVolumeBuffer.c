@@ -12,6 +12,8 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 **/
 
+#include <stdlib.h>
+
 #include "FirmwareVolumeBufferLib.h"
 #include "BinderFuncs.h"
 
@@ -1494,6 +1496,375 @@ Returns:
 }
 
 
+STATIC
+int
+FvBufCompareFileEntryName (
+  IN CONST VOID *Entry1,
+  IN CONST VOID *Entry2
+  )
+/*++
+
+Routine Description:
+
+  qsort callback ordering file index entries by file name.  Files with the
+  same name stay in the order they have in the FV.
+
+Arguments:
+
+  Entry1 - Address of the first FV_BUF_FILE_ENTRY pointer
+  Entry2 - Address of the second FV_BUF_FILE_ENTRY pointer
+
+Returns:
+
+  <0, 0 or >0 like memcmp
+
+--*/
+{
+  FV_BUF_FILE_ENTRY *File1;
+  FV_BUF_FILE_ENTRY *File2;
+  INTN              Result;
+
+  File1 = *(FV_BUF_FILE_ENTRY **) Entry1;
+  File2 = *(FV_BUF_FILE_ENTRY **) Entry2;
+  Result = CommonLibBinderCompareMem (
+             &File1->File->Name,
+             &File2->File->Name,
+             sizeof (EFI_GUID)
+             );
+  if (Result != 0) {
+    return (Result < 0) ? -1 : 1;
+  }
+  if (File1 == File2) {
+    return 0;
+  }
+  return (File1 < File2) ? -1 : 1;
+}
+
+
+EFI_STATUS
+FvBufCreateIndex (
+  IN VOID *Fv,
+  OUT FV_BUF_INDEX **Index
+  )
+/*++
+
+Routine Description:
+
+  Walks the Fv once and indexes its files and the sections of each file,
+  so that files can be found by name and sections by type without
+  scanning the Fv again.
+
+Arguments:
+
+  Fv - Address of the Fv in memory
+  Index - Output index, to be freed with FvBufFreeIndex
+
+Returns:
+
+  EFI_SUCCESS
+  EFI_INVALID_PARAMETER
+  EFI_OUT_OF_RESOURCES
+  EFI_VOLUME_CORRUPTED
+
+--*/
+{
+  EFI_STATUS                 Status;
+  FV_BUF_INDEX               *NewIndex;
+  UINTN                      Key;
+  UINTN                      SectionKey;
+  UINTN                      FileIndex;
+  UINTN                      MaxFileCount;
+  UINTN                      MaxSectionCount;
+  VOID                       *Buffer;
+  EFI_FFS_FILE_HEADER        *File;
+  VOID                       *SectionStart;
+  UINTN                      TotalSectionsSize;
+  EFI_COMMON_SECTION_HEADER  *Section;
+
+  if ((Fv == NULL) || (Index == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  NewIndex = CommonLibBinderAllocate (sizeof (FV_BUF_INDEX));
+  if (NewIndex == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  CommonLibBinderSetMem (NewIndex, sizeof (FV_BUF_INDEX), 0);
+  NewIndex->Fv = Fv;
+
+  MaxFileCount = 0;
+  MaxSectionCount = 0;
+  Key = 0;
+  while (TRUE) {
+    Status = FvBufFindNextFile (Fv, &Key, (VOID **)&File);
+    if (Status == EFI_NOT_FOUND) {
+      break;
+    } else if (EFI_ERROR (Status)) {
+      FvBufFreeIndex (NewIndex);
+      return Status;
+    }
+
+    //
+    // Grow the tables geometrically, so the FV is walked only once.
+    //
+    if (NewIndex->FileCount == MaxFileCount) {
+      MaxFileCount = (MaxFileCount == 0) ? 64 : MaxFileCount * 2;
+      Buffer = CommonLibBinderAllocate (MaxFileCount * sizeof (FV_BUF_FILE_ENTRY));
+      if (Buffer == NULL) {
+        FvBufFreeIndex (NewIndex);
+        return EFI_OUT_OF_RESOURCES;
+      }
+      if (NewIndex->Files != NULL) {
+        CommonLibBinderCopyMem (
+          Buffer,
+          NewIndex->Files,
+          NewIndex->FileCount * sizeof (FV_BUF_FILE_ENTRY)
+          );
+        CommonLibBinderFree (NewIndex->Files);
+      }
+      NewIndex->Files = Buffer;
+    }
+
+    NewIndex->Files[NewIndex->FileCount].File = File;
+    NewIndex->Files[NewIndex->FileCount].FirstSection = NewIndex->SectionCount;
+    NewIndex->Files[NewIndex->FileCount].SectionCount = 0;
+
+    //
+    // Raw and pad files have no sections
+    //
+    if ((File->Type != EFI_FV_FILETYPE_RAW) &&
+        (File->Type != EFI_FV_FILETYPE_FFS_PAD)) {
+      SectionStart = (VOID*)((UINTN)File + FvBufGetFfsHeaderSize (File));
+      TotalSectionsSize =
+        FvBufGetFfsFileSize (File) - FvBufGetFfsHeaderSize (File);
+      SectionKey = 0;
+      while (!EFI_ERROR (FvBufFindNextSection (
+                           SectionStart,
+                           TotalSectionsSize,
+                           &SectionKey,
+                           (VOID **)&Section
+                           ))) {
+        if (NewIndex->SectionCount == MaxSectionCount) {
+          MaxSectionCount = (MaxSectionCount == 0) ? 256 : MaxSectionCount * 2;
+          Buffer = CommonLibBinderAllocate (MaxSectionCount * sizeof (EFI_COMMON_SECTION_HEADER *));
+          if (Buffer == NULL) {
+            FvBufFreeIndex (NewIndex);
+            return EFI_OUT_OF_RESOURCES;
+          }
+          if (NewIndex->Sections != NULL) {
+            CommonLibBinderCopyMem (
+              Buffer,
+              NewIndex->Sections,
+              NewIndex->SectionCount * sizeof (EFI_COMMON_SECTION_HEADER *)
+              );
+            CommonLibBinderFree (NewIndex->Sections);
+          }
+          NewIndex->Sections = Buffer;
+        }
+        NewIndex->Sections[NewIndex->SectionCount++] = Section;
+        NewIndex->Files[NewIndex->FileCount].SectionCount++;
+      }
+    }
+
+    NewIndex->FileCount++;
+  }
+
+  if (NewIndex->FileCount != 0) {
+    NewIndex->NameOrder = CommonLibBinderAllocate (NewIndex->FileCount * sizeof (FV_BUF_FILE_ENTRY *));
+    if (NewIndex->NameOrder == NULL) {
+      FvBufFreeIndex (NewIndex);
+      return EFI_OUT_OF_RESOURCES;
+    }
+    for (FileIndex = 0; FileIndex < NewIndex->FileCount; FileIndex++) {
+      NewIndex->NameOrder[FileIndex] = &NewIndex->Files[FileIndex];
+    }
+    qsort (
+      NewIndex->NameOrder,
+      NewIndex->FileCount,
+      sizeof (FV_BUF_FILE_ENTRY *),
+      FvBufCompareFileEntryName
+      );
+  }
+
+  *Index = NewIndex;
+  return EFI_SUCCESS;
+}
+
+
+VOID
+FvBufFreeIndex (
+  IN FV_BUF_INDEX *Index
+  )
+/*++
+
+Routine Description:
+
+  Frees an index created by FvBufCreateIndex
+
+Arguments:
+
+  Index - The index to free
+
+Returns:
+
+  None
+
+--*/
+{
+  if (Index == NULL) {
+    return;
+  }
+
+  if (Index->Files != NULL) {
+    CommonLibBinderFree (Index->Files);
+  }
+  if (Index->NameOrder != NULL) {
+    CommonLibBinderFree (Index->NameOrder);
+  }
+  if (Index->Sections != NULL) {
+    CommonLibBinderFree (Index->Sections);
+  }
+  CommonLibBinderFree (Index);
+}
+
+
+EFI_STATUS
+FvBufIndexFindFileByName (
+  IN FV_BUF_INDEX *Index,
+  IN EFI_GUID *Name,
+  OUT VOID **File
+  )
+/*++
+
+Routine Description:
+
+  Searches the index of a Fv for a file by its name.  This gives the same
+  result as FvBufFindFileByName, without walking the Fv.
+
+Arguments:
+
+  Index - Index of the Fv, from FvBufCreateIndex
+  Name - Guid filename to search for in the firmware volume
+  File - Output file pointer
+    File == NULL - Only determine if the file exists, based on return
+                   value from the function call.
+    otherwise - *File will be update to the location of the file
+
+Returns:
+
+  EFI_SUCCESS
+  EFI_NOT_FOUND
+
+--*/
+{
+  UINTN  Low;
+  UINTN  High;
+  UINTN  Middle;
+  INTN   Result;
+
+  //
+  // Find the first entry whose name is not below Name.  Entries with the
+  // same name are in FV order, so this is the file FvBufFindFileByName
+  // would find.
+  //
+  Low = 0;
+  High = Index->FileCount;
+  while (Low < High) {
+    Middle = Low + (High - Low) / 2;
+    Result = CommonLibBinderCompareMem (
+               &Index->NameOrder[Middle]->File->Name,
+               Name,
+               sizeof (EFI_GUID)
+               );
+    if (Result < 0) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+
+  if ((Low == Index->FileCount) ||
+      !CommonLibBinderCompareGuid (Name, &Index->NameOrder[Low]->File->Name)) {
+    return EFI_NOT_FOUND;
+  }
+
+  if (File != NULL) {
+    *File = Index->NameOrder[Low]->File;
+  }
+  return EFI_SUCCESS;
+}
+
+
+EFI_STATUS
+FvBufIndexFindSectionByType (
+  IN FV_BUF_INDEX *Index,
+  IN VOID *FfsFile,
+  IN UINT8 Type,
+  OUT VOID **Section
+  )
+/*++
+
+Routine Description:
+
+  Searches the index of a Fv for a section of a file by its type.  This
+  gives the same result as FvBufFindSectionByType, without parsing the
+  sections of the file again.
+
+Arguments:
+
+  Index - Index of the Fv, from FvBufCreateIndex
+  FfsFile - Address of the FFS file in memory, inside the indexed Fv
+  Type - FFS FILE section type to search for
+  Section - Output section pointer
+    (Section == NULL) -> Only determine if the section exists, based on return
+                         value from the function call.
+    otherwise -> *Section will be update to the location of the file
+
+Returns:
+
+  EFI_SUCCESS
+  EFI_NOT_FOUND
+
+--*/
+{
+  UINTN              Low;
+  UINTN              High;
+  UINTN              Middle;
+  UINTN              SectionIndex;
+  FV_BUF_FILE_ENTRY  *Entry;
+
+  //
+  // Files are indexed in FV order, so their addresses are sorted.
+  //
+  Low = 0;
+  High = Index->FileCount;
+  while (Low < High) {
+    Middle = Low + (High - Low) / 2;
+    if ((UINTN)Index->Files[Middle].File < (UINTN)FfsFile) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+
+  if ((Low == Index->FileCount) || ((VOID*)Index->Files[Low].File != FfsFile)) {
+    return EFI_NOT_FOUND;
+  }
+
+  Entry = &Index->Files[Low];
+  for (SectionIndex = 0; SectionIndex < Entry->SectionCount; SectionIndex++) {
+    if (Index->Sections[Entry->FirstSection + SectionIndex]->Type == Type) {
+      if (Section != NULL) {
+        *Section = Index->Sections[Entry->FirstSection + SectionIndex];
+      }
+      return EFI_SUCCESS;
+    }
+  }
+
+  return EFI_NOT_FOUND;
+}
+
+
 EFI_STATUS
 FvBufShrinkWrap (
   IN VOID *Fv
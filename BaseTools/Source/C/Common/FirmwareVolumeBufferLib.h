@@ -19,6 +19,28 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include "Common/PiFirmwareFile.h"
 #include "Common/PiFirmwareVolume.h"
 
+//
+// Index of the files of a FV and of the sections of each file, built in one
+// pass over the FV by FvBufCreateIndex.  Files are kept in the order they are
+// found in the FV, and NameOrder holds them sorted by name for lookups.
+// Sections are the ones found directly in each file; encapsulation sections
+// are not expanded.
+//
+typedef struct {
+  EFI_FFS_FILE_HEADER         *File;
+  UINTN                       FirstSection;
+  UINTN                       SectionCount;
+} FV_BUF_FILE_ENTRY;
+
+typedef struct {
+  VOID                        *Fv;
+  UINTN                       FileCount;
+  FV_BUF_FILE_ENTRY           *Files;
+  FV_BUF_FILE_ENTRY           **NameOrder;
+  UINTN                       SectionCount;
+  EFI_COMMON_SECTION_HEADER   **Sections;
+} FV_BUF_INDEX;
+
 EFI_STATUS
 FvBufAddFile (
   IN OUT VOID *Fv,
@@ -64,6 +86,12 @@ FvBufCountSections (
   IN UINTN* Count
   );
 
+EFI_STATUS
+FvBufCreateIndex (
+  IN VOID *Fv,
+  OUT FV_BUF_INDEX **Index
+  );
+
 EFI_STATUS
 FvBufDuplicate (
   IN VOID *SourceFv,
@@ -127,6 +155,11 @@ FvBufFindSectionByType (
   OUT VOID **Section
   );
 
+VOID
+FvBufFreeIndex (
+  IN FV_BUF_INDEX *Index
+  );
+
 EFI_STATUS
 FvBufGetFileRawData (
   IN  VOID*     FfsFile,
@@ -140,6 +173,21 @@ FvBufGetSize (
   OUT UINTN *Size
   );
 
+EFI_STATUS
+FvBufIndexFindFileByName (
+  IN FV_BUF_INDEX *Index,
+  IN EFI_GUID *Name,
+  OUT VOID **File
+  );
+
+EFI_STATUS
+FvBufIndexFindSectionByType (
+  IN FV_BUF_INDEX *Index,
+  IN VOID *FfsFile,
+  IN UINT8 Type,
+  OUT VOID **Section
+  );
+
 EFI_STATUS
 FvBufPackageFreeformRawFile (
   IN EFI_GUID*  Filename,
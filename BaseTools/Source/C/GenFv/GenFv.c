@@ -135,6 +135,9 @@ Returns:
                         Its format is xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx\n");
   fprintf (stdout, "  --FvNameGuid Guid     Guid is used to specify Fv Name.\n\
                         Its format is xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx\n");
+  fprintf (stdout, "  --pack                Reorder the PEIM, driver and application FFS files\n\
+                        that are not in an apriori file, to save the pad\n\
+                        files added for data alignment.\n");
   fprintf (stdout, "  --capflag CapFlag     Capsule Reset Flag can be PersistAcrossReset,\n\
                         or PopulateSystemTable or InitiateReset or not set\n");
   fprintf (stdout, "  --capoemflag CapOEMFlag\n\
@@ -505,6 +508,13 @@ Returns:
       continue;
     }
 
+    if (stricmp (argv[0], "--pack") == 0) {
+      mFvDataInfo.PackFiles = TRUE;
+      argc --;
+      argv ++;
+      continue;
+    }
+
     if ((stricmp (argv[0], "-p") == 0) || (stricmp (argv[0], "--dump") == 0)) {
       DumpCapsule = TRUE;
       argc --;
@@ -51,6 +51,8 @@ EFI_GUID  mFileGuidArray [MAX_NUMBER_OF_FILES_IN_FV];
 EFI_GUID  mZeroGuid                           = {0x0, 0x0, 0x0, {0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0}};
 EFI_GUID  mDefaultCapsuleGuid                 = {0x3B6686BD, 0x0D76, 0x4030, { 0xB7, 0x0E, 0xB5, 0x51, 0x9E, 0x2F, 0xC5, 0xA0 }};
 EFI_GUID  mEfiFfsSectionAlignmentPaddingGuid  = EFI_FFS_SECTION_ALIGNMENT_PADDING_GUID;
+EFI_GUID  mPeiAprioriFileNameGuid             = PEI_APRIORI_FILE_NAME_GUID;
+EFI_GUID  mDxeAprioriFileNameGuid             = DXE_APRIORI_FILE_NAME_GUID;
 
 CHAR8      *mFvbAttributeName[] = {
   EFI_FVB2_READ_DISABLED_CAP_STRING,
@@ -166,6 +168,7 @@ UINT8                                   m64kRecoveryStartupApDataArray[SIZEOF_ST
 FV_INFO                     mFvDataInfo;
 CAP_INFO                    mCapDataInfo;
 BOOLEAN                     mIsLargeFfs = FALSE;
+STATIC UINT32               mFvPadSize = 0;
 
 EFI_PHYSICAL_ADDRESS mFvBaseAddress[0x10];
 UINT32               mFvBaseAddressNumber = 0;
@@ -2823,6 +2826,10 @@ Returns:
     fprintf (FvMapFile, EFI_FV_TAKEN_SIZE_STRING);
     fprintf (FvMapFile, " = 0x%x\n", (unsigned) mFvTakenSize);
   }
+  if (mFvPadSize != 0) {
+    fprintf (FvMapFile, EFI_FV_PAD_SIZE_STRING);
+    fprintf (FvMapFile, " = 0x%x\n", (unsigned) mFvPadSize);
+  }
   if (mFvTotalSize != 0 && mFvTakenSize != 0) {
     fprintf (FvMapFile, EFI_FV_SPACE_SIZE_STRING);
     fprintf (FvMapFile, " = 0x%x\n\n", (unsigned) (mFvTotalSize - mFvTakenSize));
@@ -2833,6 +2840,7 @@ Returns:
   //
   fprintf (FvReportFile, "%s = 0x%x\n", EFI_FV_TOTAL_SIZE_STRING, (unsigned) mFvTotalSize);
   fprintf (FvReportFile, "%s = 0x%x\n", EFI_FV_TAKEN_SIZE_STRING, (unsigned) mFvTakenSize);
+  fprintf (FvReportFile, "%s = 0x%x\n", EFI_FV_PAD_SIZE_STRING, (unsigned) mFvPadSize);
 
   //
   // Add PI FV extension header
@@ -3058,6 +3066,423 @@ Returns:
   }
 }
 
+STATIC
+UINTN
+GetFfsPadSize (
+  IN UINTN   Offset,
+  IN UINT32  FfsHeaderSize,
+  IN UINT32  FfsAlignment
+  )
+/*++
+Routine Description:
+  Get the size of the pad file that is added in front of a FFS file, so that
+  the file data is aligned. This is the size AddPadFile uses.
+
+Arguments:
+  Offset        - Offset of the FFS file in the FV.
+  FfsHeaderSize - Header size of the FFS file.
+  FfsAlignment  - Data alignment of the FFS file in bytes.
+
+Returns:
+  The size of the pad file, or 0 if no pad file is needed.
+--*/
+{
+  UINTN  NewOffset;
+
+  if (((Offset + FfsHeaderSize) % FfsAlignment) == 0) {
+    return 0;
+  }
+
+  //
+  // Only EFI_FFS_FILE_HEADER is needed for a pad section.
+  //
+  NewOffset = (Offset + FfsHeaderSize + sizeof (EFI_FFS_FILE_HEADER) + FfsAlignment - 1) & ~((UINTN) FfsAlignment - 1);
+  return NewOffset - FfsHeaderSize - Offset;
+}
+
+STATIC
+UINTN
+PlaceFfsFiles (
+  IN OUT FV_PACK_FILE  *PackFiles,
+  IN     UINTN         NumberOfFiles,
+  IN     UINTN         Offset,
+  IN     BOOLEAN       Reorder,
+  OUT    UINTN         *Order,
+  OUT    UINTN         *PadSize
+  )
+/*++
+Routine Description:
+  Lay out the FFS files of a FV, and return the order of the files and the
+  space taken by the pad files.
+
+  The files are placed in input order. If Reorder is TRUE, the pad file in
+  front of a file is replaced by movable files found later in the list, as
+  long as the file keeps its offset. The relative order of the files that are
+  not movable never changes.
+
+Arguments:
+  PackFiles     - The layout information of the files in input order.
+  NumberOfFiles - The number of files.
+  Offset        - Offset of the first file in the FV.
+  Reorder       - Whether movable files may fill the pad files.
+  Order         - Returns the indexes of the files in FV order.
+  PadSize       - Returns the total size of the pad files.
+
+Returns:
+  The offset of the end of the last file.
+--*/
+{
+  UINTN  Count;
+  UINTN  Index;
+  UINTN  Current;
+  UINTN  Best;
+  UINTN  BestEnd;
+  UINTN  End;
+  UINTN  Pad;
+
+  *PadSize = 0;
+  for (Index = 0; Index < NumberOfFiles; Index++) {
+    PackFiles[Index].Placed = FALSE;
+  }
+
+  Current = 0;
+  for (Count = 0; Count < NumberOfFiles;) {
+    //
+    // The first file in input order that is not placed yet
+    //
+    while (PackFiles[Current].Placed) {
+      Current++;
+    }
+    Pad = GetFfsPadSize (Offset, PackFiles[Current].HeaderSize, PackFiles[Current].Alignment);
+
+    while (Reorder && Pad != 0) {
+      //
+      // Find the largest movable file that needs no pad file itself and
+      // leaves the current file at the same offset.
+      //
+      Best    = NumberOfFiles;
+      BestEnd = 0;
+      for (Index = Current + 1; Index < NumberOfFiles; Index++) {
+        if (PackFiles[Index].Placed || !PackFiles[Index].Movable) {
+          continue;
+        }
+        if (GetFfsPadSize (Offset, PackFiles[Index].HeaderSize, PackFiles[Index].Alignment) != 0) {
+          continue;
+        }
+        End = (Offset + PackFiles[Index].Size + EFI_FFS_FILE_HEADER_ALIGNMENT - 1) & ~(EFI_FFS_FILE_HEADER_ALIGNMENT - 1);
+        if (End + GetFfsPadSize (End, PackFiles[Current].HeaderSize, PackFiles[Current].Alignment) != Offset + Pad) {
+          continue;
+        }
+        if (Best == NumberOfFiles || PackFiles[Index].Size > PackFiles[Best].Size) {
+          Best    = Index;
+          BestEnd = End;
+        }
+      }
+      if (Best == NumberOfFiles) {
+        break;
+      }
+
+      PackFiles[Best].Placed = TRUE;
+      Order[Count++] = Best;
+      Pad    = Offset + Pad - BestEnd;
+      Offset = BestEnd;
+    }
+
+    PackFiles[Current].Placed = TRUE;
+    Order[Count++] = Current;
+    *PadSize += Pad;
+    Offset = (Offset + Pad + PackFiles[Current].Size + EFI_FFS_FILE_HEADER_ALIGNMENT - 1) & ~(EFI_FFS_FILE_HEADER_ALIGNMENT - 1);
+  }
+
+  return Offset;
+}
+
+STATIC
+EFI_STATUS
+ReadAprioriFile (
+  IN     CHAR8     *FileName,
+  IN OUT EFI_GUID  **AprioriList,
+  IN OUT UINTN     *AprioriCount
+  )
+/*++
+Routine Description:
+  Append the file names listed in the raw sections of an apriori file to
+  AprioriList.
+
+Arguments:
+  FileName      - The apriori FFS file.
+  AprioriList   - The list of file names, reallocated to hold the new names.
+  AprioriCount  - The number of file names in AprioriList.
+
+Returns:
+  EFI_ABORTED           - The file could not be read.
+  EFI_OUT_OF_RESOURCES  - No memory for the list.
+  EFI_SUCCESS           - The file names were added.
+--*/
+{
+  FILE                      *fpin;
+  UINT8                     *FileBuffer;
+  UINTN                     FileSize;
+  UINTN                     FileLength;
+  UINTN                     Offset;
+  UINT32                    SectionLength;
+  UINT32                    SectionHeaderLength;
+  UINTN                     GuidCount;
+  EFI_GUID                  *NewList;
+  EFI_COMMON_SECTION_HEADER *Section;
+
+  fpin = fopen (LongFilePath (FileName), "rb");
+  if (fpin == NULL) {
+    Error (NULL, 0, 0001, "Error opening file", FileName);
+    return EFI_ABORTED;
+  }
+  FileSize = _filelength (fileno (fpin));
+  FileBuffer = malloc (FileSize);
+  if (FileBuffer == NULL) {
+    fclose (fpin);
+    Error (NULL, 0, 4001, "Resource", "memory cannot be allocated!");
+    return EFI_OUT_OF_RESOURCES;
+  }
+  if (fread (FileBuffer, 1, FileSize, fpin) != FileSize || FileSize < sizeof (EFI_FFS_FILE_HEADER)) {
+    fclose (fpin);
+    free (FileBuffer);
+    Error (NULL, 0, 0004, "Error reading file", FileName);
+    return EFI_ABORTED;
+  }
+  fclose (fpin);
+
+  FileLength = GetFfsFileLength ((EFI_FFS_FILE_HEADER *) FileBuffer);
+  if (FileLength > FileSize) {
+    FileLength = FileSize;
+  }
+
+  //
+  // Every raw section holds a list of file names.
+  //
+  Offset = GetFfsHeaderLength ((EFI_FFS_FILE_HEADER *) FileBuffer);
+  while (Offset + sizeof (EFI_COMMON_SECTION_HEADER) <= FileLength) {
+    Section             = (EFI_COMMON_SECTION_HEADER *) (FileBuffer + Offset);
+    SectionLength       = GetSectionFileLength (Section);
+    SectionHeaderLength = GetSectionHeaderLength (Section);
+    if (SectionLength < SectionHeaderLength || SectionLength > FileLength - Offset) {
+      break;
+    }
+    if (Section->Type == EFI_SECTION_RAW) {
+      GuidCount = (SectionLength - SectionHeaderLength) / sizeof (EFI_GUID);
+      NewList = realloc (*AprioriList, (*AprioriCount + GuidCount) * sizeof (EFI_GUID));
+      if (NewList == NULL && GuidCount != 0) {
+        free (FileBuffer);
+        Error (NULL, 0, 4001, "Resource", "memory cannot be allocated!");
+        return EFI_OUT_OF_RESOURCES;
+      }
+      if (NewList != NULL) {
+        *AprioriList = NewList;
+        memcpy (*AprioriList + *AprioriCount, (UINT8 *) Section + SectionHeaderLength, GuidCount * sizeof (EFI_GUID));
+        *AprioriCount += GuidCount;
+      }
+    }
+    //
+    // Sections are 4-byte aligned
+    //
+    Offset += (SectionLength + 3) & ~3;
+  }
+
+  free (FileBuffer);
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+PackFvFiles (
+  IN OUT FV_INFO  *FvInfoPtr,
+  IN     UINTN    FirstFileOffset
+  )
+/*++
+Routine Description:
+  Reorder the FFS files of a PI FV to reduce the pad files added for data
+  alignment.
+
+  Only PEIM, driver and application files may move, and only if they have no
+  FFS_ATTRIB_FIXED attribute and are not listed in an apriori file of the FV.
+  Such files are dispatched by their dependency expressions, so the set of
+  files that are dispatched, and the order of the apriori files and of all
+  other files, stay the same. The files are only reordered if this makes the
+  FV smaller.
+
+Arguments:
+  FvInfoPtr       - The pointer to FV_INFO structure. Its file list is reordered.
+  FirstFileOffset - Offset of the first FFS file in the FV.
+
+Returns:
+  EFI_ABORTED           - Ffs Image Error
+  EFI_OUT_OF_RESOURCES  - No memory to pack the files
+  EFI_SUCCESS           - The files are packed or kept in order
+--*/
+{
+  EFI_STATUS          Status;
+  FILE                *fpin;
+  UINTN               Index;
+  UINTN               Index1;
+  UINTN               NumberOfFiles;
+  UINTN               FfsFileSize;
+  UINT32              FfsAlignment;
+  EFI_FFS_FILE_HEADER FfsHeader;
+  FV_PACK_FILE        *PackFiles;
+  UINTN               *Order;
+  EFI_GUID            *AprioriList;
+  UINTN               AprioriCount;
+  UINTN               OriginalEnd;
+  UINTN               OriginalPadSize;
+  UINTN               PackedEnd;
+  UINTN               PackedPadSize;
+  UINTN               MovedCount;
+  CHAR8               *FvFiles;
+  UINT32              *SizeofFvFiles;
+
+  for (NumberOfFiles = 0; FvInfoPtr->FvFiles[NumberOfFiles][0] != 0; NumberOfFiles++) {
+  }
+  if (!FvInfoPtr->IsPiFvImage || NumberOfFiles < 2) {
+    return EFI_SUCCESS;
+  }
+
+  Status        = EFI_SUCCESS;
+  AprioriList   = NULL;
+  AprioriCount  = 0;
+  FvFiles       = NULL;
+  SizeofFvFiles = NULL;
+  PackFiles     = calloc (NumberOfFiles, sizeof (FV_PACK_FILE));
+  Order         = malloc (NumberOfFiles * sizeof (UINTN));
+  if (PackFiles == NULL || Order == NULL) {
+    Error (NULL, 0, 4001, "Resource", "memory cannot be allocated!");
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Finish;
+  }
+
+  for (Index = 0; Index < NumberOfFiles; Index++) {
+    fpin = fopen (LongFilePath (FvInfoPtr->FvFiles[Index]), "rb");
+    if (fpin == NULL) {
+      Error (NULL, 0, 0001, "Error opening file", FvInfoPtr->FvFiles[Index]);
+      Status = EFI_ABORTED;
+      goto Finish;
+    }
+    FfsFileSize = _filelength (fileno (fpin));
+    if (fread (&FfsHeader, sizeof (UINT8), sizeof (EFI_FFS_FILE_HEADER), fpin) != sizeof (EFI_FFS_FILE_HEADER)) {
+      fclose (fpin);
+      Error (NULL, 0, 0004, "Error reading file", FvInfoPtr->FvFiles[Index]);
+      Status = EFI_ABORTED;
+      goto Finish;
+    }
+    fclose (fpin);
+
+    memcpy (&PackFiles[Index].Name, &FfsHeader.Name, sizeof (EFI_GUID));
+    if (IsVtfFile (&FfsHeader)) {
+      //
+      // The VTF file is placed at the end of the FV, and takes no space here.
+      //
+      PackFiles[Index].HeaderSize = sizeof (EFI_FFS_FILE_HEADER);
+      PackFiles[Index].Alignment  = 1;
+      continue;
+    }
+
+    if (CompareGuid (&FfsHeader.Name, &mPeiAprioriFileNameGuid) == 0 ||
+        CompareGuid (&FfsHeader.Name, &mDxeAprioriFileNameGuid) == 0) {
+      Status = ReadAprioriFile (FvInfoPtr->FvFiles[Index], &AprioriList, &AprioriCount);
+      if (EFI_ERROR (Status)) {
+        goto Finish;
+      }
+    }
+
+    PackFiles[Index].Size = (UINT32) FfsFileSize;
+    if (FvInfoPtr->SizeofFvFiles[Index] > FfsFileSize) {
+      PackFiles[Index].Size = FvInfoPtr->SizeofFvFiles[Index];
+    }
+    if (FfsFileSize >= MAX_FFS_SIZE) {
+      PackFiles[Index].HeaderSize = sizeof (EFI_FFS_FILE_HEADER2);
+    } else {
+      PackFiles[Index].HeaderSize = sizeof (EFI_FFS_FILE_HEADER);
+    }
+    ReadFfsAlignment (&FfsHeader, &FfsAlignment);
+    PackFiles[Index].Alignment = 1 << FfsAlignment;
+
+    switch (FfsHeader.Type) {
+    case EFI_FV_FILETYPE_PEIM:
+    case EFI_FV_FILETYPE_DRIVER:
+    case EFI_FV_FILETYPE_COMBINED_PEIM_DRIVER:
+    case EFI_FV_FILETYPE_APPLICATION:
+    case EFI_FV_FILETYPE_SMM:
+    case EFI_FV_FILETYPE_COMBINED_SMM_DXE:
+    case EFI_FV_FILETYPE_MM_STANDALONE:
+      PackFiles[Index].Movable = (BOOLEAN) ((FfsHeader.Attributes & FFS_ATTRIB_FIXED) == 0);
+      break;
+    default:
+      PackFiles[Index].Movable = FALSE;
+      break;
+    }
+  }
+
+  //
+  // Files dispatched by an apriori file keep their place.
+  //
+  for (Index = 0; Index < NumberOfFiles; Index++) {
+    for (Index1 = 0; PackFiles[Index].Movable && Index1 < AprioriCount; Index1++) {
+      if (CompareGuid (&PackFiles[Index].Name, &AprioriList[Index1]) == 0) {
+        PackFiles[Index].Movable = FALSE;
+      }
+    }
+  }
+
+  OriginalEnd = PlaceFfsFiles (PackFiles, NumberOfFiles, FirstFileOffset, FALSE, Order, &OriginalPadSize);
+  PackedEnd   = PlaceFfsFiles (PackFiles, NumberOfFiles, FirstFileOffset, TRUE, Order, &PackedPadSize);
+  if (PackedEnd >= OriginalEnd) {
+    VerboseMsg ("the FFS file order is kept, %u bytes of pad files cannot be saved", (unsigned) OriginalPadSize);
+    goto Finish;
+  }
+
+  //
+  // Reorder the file list
+  //
+  FvFiles       = malloc (NumberOfFiles * MAX_LONG_FILE_PATH);
+  SizeofFvFiles = malloc (NumberOfFiles * sizeof (UINT32));
+  if (FvFiles == NULL || SizeofFvFiles == NULL) {
+    Error (NULL, 0, 4001, "Resource", "memory cannot be allocated!");
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Finish;
+  }
+  memcpy (FvFiles, FvInfoPtr->FvFiles, NumberOfFiles * MAX_LONG_FILE_PATH);
+  memcpy (SizeofFvFiles, FvInfoPtr->SizeofFvFiles, NumberOfFiles * sizeof (UINT32));
+  MovedCount = 0;
+  for (Index = 0; Index < NumberOfFiles; Index++) {
+    memcpy (FvInfoPtr->FvFiles[Index], FvFiles + Order[Index] * MAX_LONG_FILE_PATH, MAX_LONG_FILE_PATH);
+    FvInfoPtr->SizeofFvFiles[Index] = SizeofFvFiles[Order[Index]];
+    if (Order[Index] != Index) {
+      MovedCount++;
+    }
+  }
+  VerboseMsg (
+    "%u FFS files are reordered, the pad files shrink from %u to %u bytes",
+    (unsigned) MovedCount,
+    (unsigned) OriginalPadSize,
+    (unsigned) PackedPadSize
+    );
+
+Finish:
+  if (PackFiles != NULL) {
+    free (PackFiles);
+  }
+  if (Order != NULL) {
+    free (Order);
+  }
+  if (AprioriList != NULL) {
+    free (AprioriList);
+  }
+  if (FvFiles != NULL) {
+    free (FvFiles);
+  }
+  if (SizeofFvFiles != NULL) {
+    free (SizeofFvFiles);
+  }
+  return Status;
+}
+
 EFI_STATUS
 CalculateFvSize (
   FV_INFO *FvInfoPtr
@@ -3084,11 +3509,14 @@ Returns:
   UINT32              FfsHeaderSize;
   EFI_FFS_FILE_HEADER FfsHeader;
   UINTN               VtfFileSize;
+  UINTN               FfsPadSize;
+  EFI_STATUS          Status;
 
   FvExtendHeaderSize = 0;
   VtfFileSize = 0;
   fpin  = NULL;
   Index = 0;
+  mFvPadSize = 0;
 
   //
   // Compute size for easy access later
@@ -3133,6 +3561,16 @@ Returns:
     CurrentOffset = (CurrentOffset + 7) & (~7);
   }
 
+  //
+  // Reorder the FFS files to save pad files
+  //
+  if (FvInfoPtr->PackFiles) {
+    Status = PackFvFiles (FvInfoPtr, CurrentOffset);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
   //
   // Accumlate every FFS file size.
   //
@@ -3190,13 +3628,9 @@ Returns:
       //
       // Add Pad file
       //
-      if (((CurrentOffset + FfsHeaderSize) % FfsAlignment) != 0) {
-        //
-        // Only EFI_FFS_FILE_HEADER is needed for a pad section.
-        //
-        CurrentOffset = (CurrentOffset + FfsHeaderSize + sizeof(EFI_FFS_FILE_HEADER) + FfsAlignment - 1) & ~(FfsAlignment - 1);
-        CurrentOffset -= FfsHeaderSize;
-      }
+      FfsPadSize = GetFfsPadSize (CurrentOffset, FfsHeaderSize, FfsAlignment);
+      CurrentOffset += FfsPadSize;
+      mFvPadSize += (UINT32) FfsPadSize;
     }
 
     //
@@ -81,6 +81,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #define EFI_FV_TOTAL_SIZE_STRING    "EFI_FV_TOTAL_SIZE"
 #define EFI_FV_TAKEN_SIZE_STRING    "EFI_FV_TAKEN_SIZE"
 #define EFI_FV_SPACE_SIZE_STRING    "EFI_FV_SPACE_SIZE"
+#define EFI_FV_PAD_SIZE_STRING      "EFI_FV_PAD_SIZE"
 
 //
 // Attributes section
@@ -163,6 +164,15 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #define IA32_X64_VTF_SIGNATURE_OFFSET    0x14
 #define IA32_X64_VTF0_SIGNATURE SIGNATURE_32('V','T','F',0)
 
+//
+// Names of the PEI and DXE apriori files
+//
+#define PEI_APRIORI_FILE_NAME_GUID \
+  { 0x1b45cc0a, 0x156a, 0x428a, { 0xaf, 0x62, 0x49, 0x86, 0x4d, 0xa0, 0xe6, 0xe6 } }
+
+#define DXE_APRIORI_FILE_NAME_GUID \
+  { 0xfc510ee7, 0xffdc, 0x11d4, { 0xbd, 0x41, 0x00, 0x80, 0xc7, 0x3c, 0x88, 0x81 } }
+
 //
 // Defines to calculate the offset for PEI CORE entry points
 //
@@ -229,8 +239,21 @@ typedef struct {
   UINT32                  SizeofFvFiles[MAX_NUMBER_OF_FILES_IN_FV];
   BOOLEAN                 IsPiFvImage;
   INT8                    ForceRebase;
+  BOOLEAN                 PackFiles;
 } FV_INFO;
 
+//
+// Layout information of one FFS file, used to pack the files of a FV
+//
+typedef struct {
+  EFI_GUID                Name;
+  UINT32                  Size;
+  UINT32                  HeaderSize;
+  UINT32                  Alignment;
+  BOOLEAN                 Movable;
+  BOOLEAN                 Placed;
+} FV_PACK_FILE;
+
 typedef struct {
   EFI_GUID                CapGuid;
   UINT32                  HeaderSize;
@@ -343,6 +366,12 @@ CalculateFvSize (
   FV_INFO *FvInfoPtr
   );
 
+EFI_STATUS
+PackFvFiles (
+  IN OUT FV_INFO  *FvInfoPtr,
+  IN     UINTN    FirstFileOffset
+  );
+
 EFI_STATUS
 FfsRebase (
   IN OUT  FV_INFO               *FvInfo,
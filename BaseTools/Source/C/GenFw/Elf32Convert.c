@@ -86,17 +86,40 @@ typedef Elf32_Dyn Elf_Dyn;
 #define ELF_R_TYPE(r) ELF32_R_TYPE(r)
 #define ELF_R_SYM(r) ELF32_R_SYM(r)
 
+STATIC
+Elf_Shdr *
+GetShdrByIndex (
+  UINT32 Num
+  );
+
+STATIC
+Elf_Shdr *
+FindStrtabShdr (
+  VOID
+  );
+
+//
+// The conversion state below is per thread, and is initialized by
+// InitializeElf32 for each image.
+//
+
 //
 // Well known ELF structures.
 //
-STATIC Elf_Ehdr *mEhdr;
-STATIC Elf_Shdr *mShdrBase;
-STATIC Elf_Phdr *mPhdrBase;
+STATIC THREAD_LOCAL Elf_Ehdr *mEhdr;
+STATIC THREAD_LOCAL Elf_Shdr *mShdrBase;
+STATIC THREAD_LOCAL Elf_Phdr *mPhdrBase;
+
+//
+// Section name string table and symbol string table, looked up once per image.
+//
+STATIC THREAD_LOCAL CHAR8    *mShStrtab;
+STATIC THREAD_LOCAL Elf_Shdr *mStrtabShdr;
 
 //
 // Coff information
 //
-STATIC UINT32 mCoffAlignment = 0x20;
+STATIC THREAD_LOCAL UINT32 mCoffAlignment = 0x20;
 
 //
 // PE section alignment.
@@ -106,17 +129,17 @@ STATIC const UINT16 mCoffNbrSections = 4;
 //
 // ELF sections to offset in Coff file.
 //
-STATIC UINT32 *mCoffSectionsOffset = NULL;
+STATIC THREAD_LOCAL UINT32 *mCoffSectionsOffset = NULL;
 
 //
 // Offsets in COFF file
 //
-STATIC UINT32 mNtHdrOffset;
-STATIC UINT32 mTextOffset;
-STATIC UINT32 mDataOffset;
-STATIC UINT32 mHiiRsrcOffset;
-STATIC UINT32 mRelocOffset;
-STATIC UINT32 mDebugOffset;
+STATIC THREAD_LOCAL UINT32 mNtHdrOffset;
+STATIC THREAD_LOCAL UINT32 mTextOffset;
+STATIC THREAD_LOCAL UINT32 mDataOffset;
+STATIC THREAD_LOCAL UINT32 mHiiRsrcOffset;
+STATIC THREAD_LOCAL UINT32 mRelocOffset;
+STATIC THREAD_LOCAL UINT32 mDebugOffset;
 
 //
 // Initialization Function
@@ -162,6 +185,17 @@ InitializeElf32 (
   mShdrBase  = (Elf_Shdr *)((UINT8 *)mEhdr + mEhdr->e_shoff);
   mPhdrBase = (Elf_Phdr *)((UINT8 *)mEhdr + mEhdr->e_phoff);
 
+  //
+  // Reset the state left by the image converted before.
+  //
+  mCoffAlignment = 0x20;
+
+  //
+  // Look up the string tables once, rather than for each section or symbol name.
+  //
+  mShStrtab   = (CHAR8 *)mEhdr + GetShdrByIndex(mEhdr->e_shstrndx)->sh_offset;
+  mStrtabShdr = FindStrtabShdr ();
+
   //
   // Create COFF Section offset buffer and zero.
   //
@@ -197,7 +231,7 @@ GetShdrByIndex (
 {
   if (Num >= mEhdr->e_shnum) {
     Error (NULL, 0, 3000, "Invalid", "GetShdrByIndex: Index %u is too high.", Num);
-    exit(EXIT_FAILURE);
+    AbortElfConversion ();
   }
 
   return (Elf_Shdr*)((UINT8*)mShdrBase + Num * mEhdr->e_shentsize);
@@ -211,7 +245,7 @@ GetPhdrByIndex (
 {
   if (num >= mEhdr->e_phnum) {
     Error (NULL, 0, 3000, "Invalid", "GetPhdrByIndex: Index %u is too high.", num);
-    exit(EXIT_FAILURE);
+    AbortElfConversion ();
   }
 
   return (Elf_Phdr *)((UINT8*)mPhdrBase + num * mEhdr->e_phentsize);
@@ -253,9 +287,7 @@ IsHiiRsrcShdr (
   Elf_Shdr *Shdr
   )
 {
-  Elf_Shdr *Namedr = GetShdrByIndex(mEhdr->e_shstrndx);
-
-  return (BOOLEAN) (strcmp((CHAR8*)mEhdr + Namedr->sh_offset + Shdr->sh_name, ELF_HII_SECTION_NAME) == 0);
+  return (BOOLEAN) (strcmp(mShStrtab + Shdr->sh_name, ELF_HII_SECTION_NAME) == 0);
 }
 
 STATIC
@@ -276,9 +308,7 @@ IsStrtabShdr (
   Elf_Shdr *Shdr
   )
 {
-  Elf_Shdr *Namedr = GetShdrByIndex(mEhdr->e_shstrndx);
-
-  return (BOOLEAN) (strcmp((CHAR8*)mEhdr + Namedr->sh_offset + Shdr->sh_name, ELF_STRTAB_SECTION_NAME) == 0);
+  return (BOOLEAN) (strcmp(mShStrtab + Shdr->sh_name, ELF_STRTAB_SECTION_NAME) == 0);
 }
 
 STATIC
@@ -312,7 +342,7 @@ GetSymName (
     return NULL;
   }
 
-  StrtabShdr = FindStrtabShdr();
+  StrtabShdr = mStrtabShdr;
   if (StrtabShdr == NULL) {
     return NULL;
   }
@@ -761,7 +791,7 @@ WriteSections32 (
                  "For example, absolute and undefined symbols are not supported.",
                  mInImageName, SymName, Sym->st_value);
 
-          exit(EXIT_FAILURE);
+          AbortElfConversion ();
         }
         SymShdr = GetShdrByIndex(Sym->st_shndx);
 
@@ -878,7 +908,7 @@ WriteSections32 (
   return TRUE;
 }
 
-UINTN gMovwOffset = 0;
+THREAD_LOCAL UINTN gMovwOffset = 0;
 
 STATIC
 VOID
@@ -1179,6 +1209,7 @@ CleanUp32 (
 {
   if (mCoffSectionsOffset != NULL) {
     free (mCoffSectionsOffset);
+    mCoffSectionsOffset = NULL;
   }
 }
 
@@ -87,26 +87,55 @@ typedef Elf64_Dyn Elf_Dyn;
 #define ELF_R_TYPE(r) ELF64_R_TYPE(r)
 #define ELF_R_SYM(r) ELF64_R_SYM(r)
 
+STATIC
+Elf_Shdr *
+GetShdrByIndex (
+  UINT32 Num
+  );
+
+STATIC
+Elf_Shdr *
+FindStrtabShdr (
+  VOID
+  );
+
+//
+// The conversion state below is per thread, and is initialized by
+// InitializeElf64 for each image.
+//
+
 //
 // Well known ELF structures.
 //
-STATIC Elf_Ehdr *mEhdr;
-STATIC Elf_Shdr *mShdrBase;
-STATIC Elf_Phdr *mPhdrBase;
+STATIC THREAD_LOCAL Elf_Ehdr *mEhdr;
+STATIC THREAD_LOCAL Elf_Shdr *mShdrBase;
+STATIC THREAD_LOCAL Elf_Phdr *mPhdrBase;
+
+//
+// Section name string table and symbol string table, looked up once per image.
+//
+STATIC THREAD_LOCAL CHAR8    *mShStrtab;
+STATIC THREAD_LOCAL Elf_Shdr *mStrtabShdr;
 
 //
 // GOT information
 //
-STATIC Elf_Shdr *mGOTShdr = NULL;
-STATIC UINT32   mGOTShindex = 0;
-STATIC UINT32   *mGOTCoffEntries = NULL;
-STATIC UINT32   mGOTMaxCoffEntries = 0;
-STATIC UINT32   mGOTNumCoffEntries = 0;
+STATIC THREAD_LOCAL Elf_Shdr *mGOTShdr = NULL;
+STATIC THREAD_LOCAL UINT32   mGOTShindex = 0;
+STATIC THREAD_LOCAL UINT32   *mGOTCoffEntries = NULL;
+STATIC THREAD_LOCAL UINT32   mGOTMaxCoffEntries = 0;
+STATIC THREAD_LOCAL UINT32   mGOTNumCoffEntries = 0;
+
+//
+// Bitmap of the GOT bytes accumulated in mGOTCoffEntries, so that finding out
+// whether a GOT entry is new does not search the whole list.
+//
+STATIC THREAD_LOCAL UINT8    *mGOTCoffEntryMap = NULL;
 
 //
 // Coff information
 //
-STATIC UINT32 mCoffAlignment = 0x20;
+STATIC THREAD_LOCAL UINT32 mCoffAlignment = 0x20;
 
 //
 // PE section alignment.
@@ -116,17 +145,17 @@ STATIC const UINT16 mCoffNbrSections = 4;
 //
 // ELF sections to offset in Coff file.
 //
-STATIC UINT32 *mCoffSectionsOffset = NULL;
+STATIC THREAD_LOCAL UINT32 *mCoffSectionsOffset = NULL;
 
 //
 // Offsets in COFF file
 //
-STATIC UINT32 mNtHdrOffset;
-STATIC UINT32 mTextOffset;
-STATIC UINT32 mDataOffset;
-STATIC UINT32 mHiiRsrcOffset;
-STATIC UINT32 mRelocOffset;
-STATIC UINT32 mDebugOffset;
+STATIC THREAD_LOCAL UINT32 mNtHdrOffset;
+STATIC THREAD_LOCAL UINT32 mTextOffset;
+STATIC THREAD_LOCAL UINT32 mDataOffset;
+STATIC THREAD_LOCAL UINT32 mHiiRsrcOffset;
+STATIC THREAD_LOCAL UINT32 mRelocOffset;
+STATIC THREAD_LOCAL UINT32 mDebugOffset;
 
 //
 // Initialization Function
@@ -175,6 +204,24 @@ InitializeElf64 (
   mShdrBase  = (Elf_Shdr *)((UINT8 *)mEhdr + mEhdr->e_shoff);
   mPhdrBase = (Elf_Phdr *)((UINT8 *)mEhdr + mEhdr->e_phoff);
 
+  //
+  // Reset the state left by the image converted before.
+  //
+  mGOTShdr            = NULL;
+  mGOTShindex         = 0;
+  mGOTCoffEntries     = NULL;
+  mGOTMaxCoffEntries  = 0;
+  mGOTNumCoffEntries  = 0;
+  mGOTCoffEntryMap    = NULL;
+  mCoffAlignment      = 0x20;
+
+  //
+  // Look up the string tables once, rather than for each section or symbol name.
+  //
+  VerboseMsg ("Find String Tables");
+  mShStrtab   = (CHAR8 *)mEhdr + GetShdrByIndex(mEhdr->e_shstrndx)->sh_offset;
+  mStrtabShdr = FindStrtabShdr ();
+
   //
   // Create COFF Section offset buffer and zero.
   //
@@ -212,7 +259,7 @@ GetShdrByIndex (
 {
   if (Num >= mEhdr->e_shnum) {
     Error (NULL, 0, 3000, "Invalid", "GetShdrByIndex: Index %u is too high.", Num);
-    exit(EXIT_FAILURE);
+    AbortElfConversion ();
   }
 
   return (Elf_Shdr*)((UINT8*)mShdrBase + Num * mEhdr->e_shentsize);
@@ -254,9 +301,7 @@ IsHiiRsrcShdr (
   Elf_Shdr *Shdr
   )
 {
-  Elf_Shdr *Namedr = GetShdrByIndex(mEhdr->e_shstrndx);
-
-  return (BOOLEAN) (strcmp((CHAR8*)mEhdr + Namedr->sh_offset + Shdr->sh_name, ELF_HII_SECTION_NAME) == 0);
+  return (BOOLEAN) (strcmp(mShStrtab + Shdr->sh_name, ELF_HII_SECTION_NAME) == 0);
 }
 
 STATIC
@@ -277,9 +322,7 @@ IsStrtabShdr (
   Elf_Shdr *Shdr
   )
 {
-  Elf_Shdr *Namedr = GetShdrByIndex(mEhdr->e_shstrndx);
-
-  return (BOOLEAN) (strcmp((CHAR8*)mEhdr + Namedr->sh_offset + Shdr->sh_name, ELF_STRTAB_SECTION_NAME) == 0);
+  return (BOOLEAN) (strcmp(mShStrtab + Shdr->sh_name, ELF_STRTAB_SECTION_NAME) == 0);
 }
 
 STATIC
@@ -313,7 +356,7 @@ GetSymName (
     return NULL;
   }
 
-  StrtabShdr = FindStrtabShdr();
+  StrtabShdr = mStrtabShdr;
   if (StrtabShdr == NULL) {
     return NULL;
   }
@@ -351,7 +394,7 @@ FindElfGOTSectionFromGOTEntryElfRva (
       return;
     }
     Error (NULL, 0, 3000, "Unsupported", "FindElfGOTSectionFromGOTEntryElfRva: GOT entries found in multiple sections.");
-    exit(EXIT_FAILURE);
+    AbortElfConversion ();
   }
   for (i = 0; i < mEhdr->e_shnum; i++) {
     Elf_Shdr *shdr = GetShdrByIndex(i);
@@ -363,14 +406,15 @@ FindElfGOTSectionFromGOTEntryElfRva (
     }
   }
   Error (NULL, 0, 3000, "Invalid", "FindElfGOTSectionFromGOTEntryElfRva: ElfRva 0x%016LX for GOT entry not found in any section.", GOTEntryElfRva);
-  exit(EXIT_FAILURE);
+  AbortElfConversion ();
 }
 
 //
 // Stores locations of GOT entries in COFF image.
 //   Returns TRUE if GOT entry is new.
-//   Simple implementation as number of GOT
-//   entries is expected to be low.
+//   Entries inside the GOT section are looked up
+//   in a bitmap of the section, as a large module
+//   may have thousands of them.
 //
 
 STATIC
@@ -380,7 +424,28 @@ AccumulateCoffGOTEntries (
   )
 {
   UINT32 i;
-  if (mGOTCoffEntries != NULL) {
+  UINT32 GOTOffset;
+  UINT32 GOTSize;
+
+  GOTOffset = 0;
+  GOTSize   = 0;
+  if (mGOTShdr != NULL) {
+    GOTOffset = GOTCoffEntry - mCoffSectionsOffset[mGOTShindex];
+    GOTSize   = (UINT32) mGOTShdr->sh_size;
+  }
+  if (GOTOffset < GOTSize) {
+    if (mGOTCoffEntryMap == NULL) {
+      mGOTCoffEntryMap = (UINT8*)calloc((GOTSize + 7) / 8, 1);
+      if (mGOTCoffEntryMap == NULL) {
+        Error (NULL, 0, 4001, "Resource", "memory cannot be allocated!");
+      }
+      assert (mGOTCoffEntryMap != NULL);
+    }
+    if ((mGOTCoffEntryMap[GOTOffset / 8] & (1 << (GOTOffset % 8))) != 0) {
+      return FALSE;
+    }
+    mGOTCoffEntryMap[GOTOffset / 8] |= (UINT8) (1 << (GOTOffset % 8));
+  } else if (mGOTCoffEntries != NULL) {
     for (i = 0; i < mGOTNumCoffEntries; i++) {
       if (mGOTCoffEntries[i] == GOTCoffEntry) {
         return FALSE;
@@ -457,6 +522,10 @@ EmitGOTRelocations (
   mGOTCoffEntries = NULL;
   mGOTMaxCoffEntries = 0;
   mGOTNumCoffEntries = 0;
+  if (mGOTCoffEntryMap != NULL) {
+    free(mGOTCoffEntryMap);
+    mGOTCoffEntryMap = NULL;
+  }
 }
 
 //
@@ -910,7 +979,7 @@ WriteSections64 (
                  "For example, absolute and undefined symbols are not supported.",
                  mInImageName, SymName, Sym->st_value);
 
-          exit(EXIT_FAILURE);
+          AbortElfConversion ();
         }
         SymShdr = GetShdrByIndex(Sym->st_shndx);
 
@@ -1355,6 +1424,7 @@ CleanUp64 (
 {
   if (mCoffSectionsOffset != NULL) {
     free (mCoffSectionsOffset);
+    mCoffSectionsOffset = NULL;
   }
 }
 
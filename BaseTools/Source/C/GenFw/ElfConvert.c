@@ -25,6 +25,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <time.h>
 #include <ctype.h>
 #include <assert.h>
+#include <setjmp.h>
 
 #include <Common/UefiBaseTypes.h>
 #include <IndustryStandard/PeImage.h>
@@ -36,31 +37,49 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include "Elf32Convert.h"
 #include "Elf64Convert.h"
 
+//
+// The conversion state below is per thread, so that several images can be
+// converted at the same time.
+//
+
 //
 // Result Coff file in memory.
 //
-UINT8 *mCoffFile = NULL;
+THREAD_LOCAL UINT8 *mCoffFile = NULL;
+
+//
+// Allocated size of the Coff file. The bytes from mCoffOffset up to this size
+// are zero.
+//
+STATIC THREAD_LOCAL UINT32 mCoffFileSize;
 
 //
 // COFF relocation data
 //
-EFI_IMAGE_BASE_RELOCATION *mCoffBaseRel;
-UINT16                    *mCoffEntryRel;
+THREAD_LOCAL EFI_IMAGE_BASE_RELOCATION *mCoffBaseRel;
+THREAD_LOCAL UINT16                    *mCoffEntryRel;
 
 //
 // Current offset in coff file.
 //
-UINT32 mCoffOffset;
+THREAD_LOCAL UINT32 mCoffOffset;
 
 //
 // Offset in Coff file of headers and sections.
 //
-UINT32 mTableOffset;
+THREAD_LOCAL UINT32 mTableOffset;
 
 //
 //mFileBufferSize
 //
-UINT32 mFileBufferSize;
+THREAD_LOCAL UINT32 mFileBufferSize;
+
+//
+// Where ConvertElf resumes when the image is found to be invalid, and the
+// function freeing the resources of the ELF functions, once they have any.
+//
+STATIC THREAD_LOCAL jmp_buf mElfAbortJump;
+STATIC THREAD_LOCAL VOID    (*mElfCleanUp) ();
 
 //
 //*****************************************************************************
@@ -68,6 +87,18 @@ UINT32 mFileBufferSize;
 //*****************************************************************************
 //
 
+VOID
+AbortElfConversion (
+  VOID
+  )
+{
+  //
+  // Only the image of this thread is given up. The other threads of a batch
+  // go on converting theirs.
+  //
+  longjmp (mElfAbortJump, 1);
+}
+
 VOID
 CoffAddFixupEntry(
   UINT16 Val
@@ -85,6 +116,8 @@ CoffAddFixup(
   UINT8  Type
   )
 {
+  UINT32 NewSize;
+
   if (mCoffBaseRel == NULL
       || mCoffBaseRel->VirtualAddress != (Offset & ~0xfff)) {
     if (mCoffBaseRel != NULL) {
@@ -100,18 +133,30 @@ CoffAddFixup(
         CoffAddFixupEntry (0);
     }
 
-    mCoffFile = realloc (
-      mCoffFile,
-      mCoffOffset + sizeof(EFI_IMAGE_BASE_RELOCATION) + 2 * MAX_COFF_ALIGNMENT
-      );
-    if (mCoffFile == NULL) {
-      Error (NULL, 0, 4001, "Resource", "memory cannot be allocated!");
+    //
+    // Grow the Coff file geometrically, so that a large image is not copied
+    // and zeroed again for every 4 KB page holding relocations.
+    //
+    if (mCoffOffset + sizeof(EFI_IMAGE_BASE_RELOCATION) + 2 * MAX_COFF_ALIGNMENT > mCoffFileSize) {
+      NewSize = mCoffOffset + sizeof(EFI_IMAGE_BASE_RELOCATION) + 2 * MAX_COFF_ALIGNMENT;
+      if (NewSize < 2 * mCoffFileSize) {
+        NewSize = 2 * mCoffFileSize;
+      }
+      mCoffFile = realloc (mCoffFile, NewSize);
+      if (mCoffFile == NULL) {
+        Error (NULL, 0, 4001, "Resource", "memory cannot be allocated!");
+      }
+      assert (mCoffFile != NULL);
+      //
+      // The first time, the buffer is the one allocated by ScanSections, which
+      // ends at mCoffOffset.
+      //
+      if (mCoffFileSize < mCoffOffset) {
+        mCoffFileSize = mCoffOffset;
+      }
+      memset (mCoffFile + mCoffFileSize, 0, NewSize - mCoffFileSize);
+      mCoffFileSize = NewSize;
     }
-    assert (mCoffFile != NULL);
-    memset (
-      mCoffFile + mCoffOffset, 0,
-      sizeof(EFI_IMAGE_BASE_RELOCATION) + 2 * MAX_COFF_ALIGNMENT
-      );
 
     mCoffBaseRel = (EFI_IMAGE_BASE_RELOCATION*)(mCoffFile + mCoffOffset);
     mCoffBaseRel->VirtualAddress = Offset & ~0xfff;
@@ -178,7 +223,30 @@ ConvertElf (
   ELF_FUNCTION_TABLE              ElfFunctions;
   UINT8                           EiClass;
 
+  //
+  // A thread may convert several images one after the other, so reset the
+  // state left by the previous one.
+  //
+  mCoffFile       = NULL;
+  mCoffFileSize   = 0;
+  mCoffBaseRel    = NULL;
+  mCoffEntryRel   = NULL;
+  mCoffOffset     = 0;
+  mTableOffset    = 0;
   mFileBufferSize = *FileLength;
+  mElfCleanUp     = NULL;
+
+  if (setjmp (mElfAbortJump) != 0) {
+    if (mElfCleanUp != NULL) {
+      mElfCleanUp ();
+    }
+    if (mCoffFile != NULL) {
+      free (mCoffFile);
+      mCoffFile = NULL;
+    }
+    return FALSE;
+  }
+
   //
   // Determine ELF type and set function table pointer correctly.
   //
@@ -196,6 +264,7 @@ ConvertElf (
     Error (NULL, 0, 3000, "Unsupported", "ELF EI_CLASS not supported.");
     return FALSE;
   }
+  mElfCleanUp = ElfFunctions.CleanUp;
 
   //
   // Compute sections new address.
@@ -245,6 +314,7 @@ ConvertElf (
   //
   // Free resources used by ELF functions.
   //
+  mElfCleanUp = NULL;
   ElfFunctions.CleanUp ();
 
   return TRUE;
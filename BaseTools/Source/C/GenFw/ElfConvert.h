@@ -21,15 +21,15 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include "elf64.h"
 
 //
-// Externally defined variables
+// Externally defined variables. Each thread converting an image has its own copy.
 //
-extern UINT32 mCoffOffset;
-extern CHAR8  *mInImageName;
-extern UINT32 mImageTimeStamp;
-extern UINT8  *mCoffFile;
-extern UINT32 mTableOffset;
-extern UINT32 mOutImageType;
-extern UINT32 mFileBufferSize;
+extern THREAD_LOCAL UINT32 mCoffOffset;
+extern THREAD_LOCAL CHAR8  *mInImageName;
+extern THREAD_LOCAL UINT32 mImageTimeStamp;
+extern THREAD_LOCAL UINT8  *mCoffFile;
+extern THREAD_LOCAL UINT32 mTableOffset;
+extern THREAD_LOCAL UINT32 mOutImageType;
+extern THREAD_LOCAL UINT32 mFileBufferSize;
 
 //
 // Common EFI specific data.
@@ -64,6 +64,16 @@ typedef struct {
 //
 // Common functions
 //
+
+//
+// Give up converting the image after an error is reported. ConvertElf then
+// returns FALSE instead of the process exiting.
+//
+VOID
+AbortElfConversion (
+  VOID
+  );
+
 VOID
 CoffAddFixup (
   UINT32 Offset,
@@ -25,6 +25,10 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <string.h>
 #include <time.h>
 #include <ctype.h>
+#ifdef __GNUC__
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
 #include <Common/UefiBaseTypes.h>
 #include <IndustryStandard/PeImage.h>
@@ -86,13 +90,42 @@ static const char *gHiiPackageRCFileHeader[] = {
 };
 
 //
-// Module image information
+// One command of a batch, see --batch
 //
-CHAR8  *mInImageName;
-UINT32 mImageTimeStamp = 0;
-UINT32 mImageSize = 0;
-UINT32 mOutImageType = FW_DUMMY_IMAGE;
-BOOLEAN mIsConvertXip = FALSE;
+typedef struct {
+  int     Argc;
+  char    **Argv;
+  UINT32  LineNumber;
+  STATUS  Status;
+} GENFW_BATCH_JOB;
+
+typedef struct {
+  GENFW_BATCH_JOB  *Jobs;
+  UINT32           JobCount;
+  volatile long    NextJob;
+} GENFW_BATCH;
+
+#ifdef __GNUC__
+typedef pthread_t GENFW_THREAD;
+#else
+typedef HANDLE    GENFW_THREAD;
+#endif
+
+//
+// Module image information. The commands of a batch run in several threads,
+// so each thread has its own copy.
+//
+THREAD_LOCAL CHAR8  *mInImageName;
+THREAD_LOCAL UINT32 mImageTimeStamp = 0;
+THREAD_LOCAL UINT32 mImageSize = 0;
+THREAD_LOCAL UINT32 mOutImageType = FW_DUMMY_IMAGE;
+THREAD_LOCAL BOOLEAN mIsConvertXip = FALSE;
+
+//
+// Whether the commands run are the lines of a --batch list file. It is set
+// before the threads of the batch are created.
+//
+STATIC BOOLEAN mBatchMode = FALSE;
 
 
 STATIC
@@ -164,7 +197,8 @@ Returns:
   //
   // Summary usage
   //
-  fprintf (stdout, "\nUsage: %s [options] <input_file>\n\n", UTILITY_NAME);
+  fprintf (stdout, "\nUsage: %s [options] <input_file>\n", UTILITY_NAME);
+  fprintf (stdout, "       %s --batch ListFile [--threads Number] [-v | -q | -d level]\n\n", UTILITY_NAME);
 
   //
   // Copyright declaration
@@ -285,6 +319,19 @@ Returns:
                         except for -o or -r option. It is a action option.\n\
                         If it is combined with other action options, the later\n\
                         input action option will override the previous one.\n");
+  fprintf (stdout, "  --batch ListFile      Run the commands listed in ListFile in this process.\n\
+                        Each line of ListFile holds the options and input files\n\
+                        of one command. Arguments are separated by white space,\n\
+                        and can be enclosed in double quotes. Empty lines and\n\
+                        lines starting with # are ignored. The commands run in\n\
+                        parallel, and their output files are identical to the\n\
+                        ones of separate GenFw invocations. The log level\n\
+                        options given with --batch apply to all the commands,\n\
+                        and are not allowed in the lines of ListFile.\n\
+                        It can't be combined with other options except for\n\
+                        --threads, -v, -q, -d option.\n");
+  fprintf (stdout, "  --threads Number      Number of threads running the commands of --batch.\n\
+                        The default is the number of processors.\n");
   fprintf (stdout, "  -v, --verbose         Turn on verbose output with informational messages.\n");
   fprintf (stdout, "  -q, --quiet           Disable all messages except key message and fatal error\n");
   fprintf (stdout, "  -d, --debug level     Enable debug messages, at input debug level.\n");
@@ -1034,8 +1081,9 @@ Returns:
   return Status;
 }
 
+STATIC
 int
-main (
+RunCommand (
   int  argc,
   char *argv[]
   )
@@ -1043,7 +1091,8 @@ main (
 
 Routine Description:
 
-  Main function.
+  Run one GenFw command. It is called once from main, or for each command
+  of a batch. argv must be terminated by a NULL pointer.
 
 Arguments:
 
@@ -1051,7 +1100,7 @@ Arguments:
   argv - Array of pointers to command line parameter strings.
 
 Returns:
-  STATUS_SUCCESS - Utility exits successfully.
+  STATUS_SUCCESS - The command completes successfully.
   STATUS_ERROR   - Some error occurred during execution.
 
 --*/
@@ -1118,8 +1167,6 @@ Returns:
   time_t                           OutputFileTime;
   struct stat                      Stat_Buf;
 
-  SetUtilityName (UTILITY_NAME);
-
   //
   // Assign to fix compile warning
   //
@@ -1127,6 +1174,10 @@ Returns:
   InputFileNum      = 0;
   InputFileName     = NULL;
   mInImageName      = NULL;
+  mImageTimeStamp   = 0;
+  mImageSize        = 0;
+  mOutImageType     = FW_DUMMY_IMAGE;
+  mIsConvertXip     = FALSE;
   OutImageName      = NULL;
   ModuleType        = NULL;
   Type              = 0;
@@ -1367,6 +1418,18 @@ Returns:
       continue;
     }
 
+    //
+    // The log level is shared by all the threads of a batch, so it can only
+    // be set for the whole batch.
+    //
+    if (mBatchMode &&
+        ((stricmp (argv[0], "-v") == 0) || (stricmp (argv[0], "--verbose") == 0) ||
+         (stricmp (argv[0], "-q") == 0) || (stricmp (argv[0], "--quiet") == 0) ||
+         (stricmp (argv[0], "-d") == 0) || (stricmp (argv[0], "--debug") == 0))) {
+      Error (NULL, 0, 1002, "Conflicting option", "%s option cannot be used in the list file of --batch option.", argv[0]);
+      goto Finish;
+    }
+
     if ((stricmp (argv[0], "-v") == 0) || (stricmp (argv[0], "--verbose") == 0)) {
       SetPrintLevel (VERBOSE_LOG_LEVEL);
       VerboseMsg ("Verbose output Mode Set!");
@@ -2750,6 +2813,432 @@ Finish:
   return GetUtilityStatus ();
 }
 
+STATIC
+STATUS
+ReadBatchFile (
+  CHAR8        *FileName,
+  CHAR8        **Buffer,
+  GENFW_BATCH  *Batch
+  )
+/*++
+
+Routine Description:
+
+  Read the list file of a batch, and split each of its lines into the
+  arguments of a command.
+
+Arguments:
+
+  FileName - Name of the list file.
+  Buffer   - Receives the content of the list file, which the arguments point to.
+  Batch    - Receives the commands.
+
+Returns:
+  STATUS_SUCCESS - The list file is read.
+  STATUS_ERROR   - The list file can't be read, or memory can't be allocated.
+
+--*/
+{
+  FILE             *fpList;
+  UINT32           FileLength;
+  UINT32           LineCount;
+  UINT32           LineNumber;
+  UINT32           MaxArgc;
+  CHAR8            *Line;
+  CHAR8            *NextLine;
+  CHAR8            *Ptr;
+  GENFW_BATCH_JOB  *Job;
+
+  fpList = fopen (LongFilePath (FileName), "rb");
+  if (fpList == NULL) {
+    Error (NULL, 0, 0001, "Error opening file", FileName);
+    return STATUS_ERROR;
+  }
+  FileLength = _filelength (fileno (fpList));
+  *Buffer = (CHAR8 *) malloc (FileLength + 1);
+  if (*Buffer == NULL) {
+    Error (NULL, 0, 4001, "Resource", "memory cannot be allocated!");
+    fclose (fpList);
+    return STATUS_ERROR;
+  }
+  if (fread (*Buffer, 1, FileLength, fpList) != FileLength) {
+    Error (NULL, 0, 0004, "Error reading file", FileName);
+    fclose (fpList);
+    return STATUS_ERROR;
+  }
+  fclose (fpList);
+  (*Buffer)[FileLength] = '\0';
+
+  //
+  // Each line holds at most one command.
+  //
+  LineCount = 1;
+  for (Ptr = *Buffer; *Ptr != '\0'; Ptr++) {
+    if (*Ptr == '\n') {
+      LineCount++;
+    }
+  }
+  Batch->Jobs = (GENFW_BATCH_JOB *) calloc (LineCount, sizeof (GENFW_BATCH_JOB));
+  if (Batch->Jobs == NULL) {
+    Error (NULL, 0, 4001, "Resource", "memory cannot be allocated!");
+    return STATUS_ERROR;
+  }
+  Batch->JobCount = 0;
+  Batch->NextJob  = 0;
+
+  LineNumber = 0;
+  for (Line = *Buffer; Line != NULL; Line = NextLine) {
+    LineNumber++;
+    NextLine = strchr (Line, '\n');
+    if (NextLine != NULL) {
+      *NextLine = '\0';
+      NextLine++;
+    }
+    while (isspace ((UINT8) *Line)) {
+      Line++;
+    }
+    if ((*Line == '\0') || (*Line == '#')) {
+      continue;
+    }
+
+    //
+    // A line of N characters holds at most (N + 1) / 2 arguments. The
+    // argument list also holds the utility name and a NULL terminator.
+    //
+    MaxArgc = (UINT32) (strlen (Line) + 1) / 2;
+    Job = &Batch->Jobs[Batch->JobCount];
+    Job->Argv = (char **) malloc ((MaxArgc + 2) * sizeof (char *));
+    if (Job->Argv == NULL) {
+      Error (NULL, 0, 4001, "Resource", "memory cannot be allocated!");
+      return STATUS_ERROR;
+    }
+    Job->Argv[0]    = UTILITY_NAME;
+    Job->Argc       = 1;
+    Job->LineNumber = LineNumber;
+    Job->Status     = STATUS_SUCCESS;
+    Batch->JobCount++;
+
+    Ptr = Line;
+    while (*Ptr != '\0') {
+      if (*Ptr == '"') {
+        Ptr++;
+        Job->Argv[Job->Argc++] = Ptr;
+        while ((*Ptr != '\0') && (*Ptr != '"')) {
+          Ptr++;
+        }
+      } else {
+        Job->Argv[Job->Argc++] = Ptr;
+        while ((*Ptr != '\0') && !isspace ((UINT8) *Ptr)) {
+          Ptr++;
+        }
+      }
+      if (*Ptr != '\0') {
+        *Ptr = '\0';
+        Ptr++;
+      }
+      while (isspace ((UINT8) *Ptr)) {
+        Ptr++;
+      }
+    }
+    Job->Argv[Job->Argc] = NULL;
+  }
+
+  return STATUS_SUCCESS;
+}
+
+STATIC
+VOID
+RunBatchJobs (
+  GENFW_BATCH  *Batch
+  )
+/*++
+
+Routine Description:
+
+  Run the commands of a batch until all of them are taken. Each thread of the
+  batch takes the next command which is not run yet.
+
+Arguments:
+
+  Batch - The batch.
+
+Returns:
+
+  None
+
+--*/
+{
+  UINT32  Index;
+
+  while (TRUE) {
+#ifdef __GNUC__
+    Index = (UINT32) __sync_fetch_and_add (&Batch->NextJob, 1);
+#else
+    Index = (UINT32) InterlockedIncrement (&Batch->NextJob) - 1;
+#endif
+    if (Index >= Batch->JobCount) {
+      break;
+    }
+    ResetUtilityStatus ();
+    Batch->Jobs[Index].Status = RunCommand (Batch->Jobs[Index].Argc, Batch->Jobs[Index].Argv);
+  }
+}
+
+#ifdef __GNUC__
+STATIC
+VOID *
+BatchThread (
+  VOID  *Context
+  )
+#else
+STATIC
+DWORD
+WINAPI
+BatchThread (
+  LPVOID  Context
+  )
+#endif
+/*++
+
+Routine Description:
+
+  Entry point of the threads running the commands of a batch.
+
+Arguments:
+
+  Context - The batch.
+
+Returns:
+
+  0
+
+--*/
+{
+  RunBatchJobs ((GENFW_BATCH *) Context);
+  return 0;
+}
+
+STATIC
+int
+RunBatch (
+  int  argc,
+  char *argv[]
+  )
+/*++
+
+Routine Description:
+
+  Run the commands listed in the list file of the --batch option. The
+  commands are independent of each other, so they are run by a pool of threads.
+
+Arguments:
+
+  argc - Number of command line parameters.
+  argv - Array of pointers to command line parameter strings.
+
+Returns:
+  STATUS_SUCCESS - All the commands complete successfully.
+  STATUS_ERROR   - Some command fails, or some error occurred reading the list file.
+
+--*/
+{
+  CHAR8         *ListFileName;
+  CHAR8         *ListFileBuffer;
+  GENFW_BATCH   Batch;
+  GENFW_THREAD  *Threads;
+  UINT32        ThreadCount;
+  UINT32        CreatedCount;
+  UINT32        Index;
+  UINT64        Temp64;
+  STATUS        Status;
+#ifndef __GNUC__
+  SYSTEM_INFO   SystemInfo;
+#endif
+
+  ListFileName   = NULL;
+  ListFileBuffer = NULL;
+  ThreadCount    = 0;
+  Threads        = NULL;
+  memset (&Batch, 0, sizeof (Batch));
+
+  argc --;
+  argv ++;
+
+  while (argc > 0) {
+    if (stricmp (argv[0], "--batch") == 0) {
+      if (argv[1] == NULL || argv[1][0] == '-') {
+        Error (NULL, 0, 1003, "Invalid option value", "List file name is missing for --batch option");
+        goto Finish;
+      }
+      ListFileName = argv[1];
+      argc -= 2;
+      argv += 2;
+      continue;
+    }
+
+    if (stricmp (argv[0], "--threads") == 0) {
+      if ((argv[1] == NULL) || (AsciiStringToUint64 (argv[1], FALSE, &Temp64) != EFI_SUCCESS) || (Temp64 == 0)) {
+        Error (NULL, 0, 1003, "Invalid option value", "%s = %s", argv[0], argv[1]);
+        goto Finish;
+      }
+      ThreadCount = (UINT32) Temp64;
+      argc -= 2;
+      argv += 2;
+      continue;
+    }
+
+    if ((stricmp (argv[0], "-v") == 0) || (stricmp (argv[0], "--verbose") == 0)) {
+      SetPrintLevel (VERBOSE_LOG_LEVEL);
+      VerboseMsg ("Verbose output Mode Set!");
+      argc --;
+      argv ++;
+      continue;
+    }
+
+    if ((stricmp (argv[0], "-q") == 0) || (stricmp (argv[0], "--quiet") == 0)) {
+      SetPrintLevel (KEY_LOG_LEVEL);
+      KeyMsg ("Quiet output Mode Set!");
+      argc --;
+      argv ++;
+      continue;
+    }
+
+    if ((stricmp (argv[0], "-d") == 0) || (stricmp (argv[0], "--debug") == 0)) {
+      if ((argv[1] == NULL) || (AsciiStringToUint64 (argv[1], FALSE, &Temp64) != EFI_SUCCESS) || (Temp64 > 9)) {
+        Error (NULL, 0, 1003, "Invalid option value", "%s = %s", argv[0], argv[1]);
+        goto Finish;
+      }
+      SetPrintLevel (Temp64);
+      DebugMsg (NULL, 0, 9, "Debug Mode Set", "Debug Output Mode Level %s is set!", argv[1]);
+      argc -= 2;
+      argv += 2;
+      continue;
+    }
+
+    Error (NULL, 0, 1002, "Conflicting option", "%s option cannot be used with --batch option.", argv[0]);
+    goto Finish;
+  }
+
+  if (ReadBatchFile (ListFileName, &ListFileBuffer, &Batch) != STATUS_SUCCESS) {
+    goto Finish;
+  }
+  mBatchMode = TRUE;
+
+  if (ThreadCount == 0) {
+#ifdef __GNUC__
+    ThreadCount = (UINT32) sysconf (_SC_NPROCESSORS_ONLN);
+#else
+    GetSystemInfo (&SystemInfo);
+    ThreadCount = (UINT32) SystemInfo.dwNumberOfProcessors;
+#endif
+  }
+  if (ThreadCount > Batch.JobCount) {
+    ThreadCount = Batch.JobCount;
+  }
+  VerboseMsg ("Run %u commands of %s in %u threads.", (unsigned) Batch.JobCount, ListFileName, (unsigned) ThreadCount);
+
+  //
+  // The calling thread runs commands too. If fewer threads than requested
+  // can be created, the ones created run all the commands.
+  //
+  CreatedCount = 0;
+  if (ThreadCount > 1) {
+    Threads = (GENFW_THREAD *) malloc ((ThreadCount - 1) * sizeof (GENFW_THREAD));
+    if (Threads == NULL) {
+      Error (NULL, 0, 4001, "Resource", "memory cannot be allocated!");
+      goto Finish;
+    }
+    for (CreatedCount = 0; CreatedCount < ThreadCount - 1; CreatedCount++) {
+#ifdef __GNUC__
+      if (pthread_create (&Threads[CreatedCount], NULL, BatchThread, &Batch) != 0) {
+        break;
+      }
+#else
+      Threads[CreatedCount] = CreateThread (NULL, 0, BatchThread, &Batch, 0, NULL);
+      if (Threads[CreatedCount] == NULL) {
+        break;
+      }
+#endif
+    }
+  }
+
+  RunBatchJobs (&Batch);
+
+  for (Index = 0; Index < CreatedCount; Index++) {
+#ifdef __GNUC__
+    pthread_join (Threads[Index], NULL);
+#else
+    WaitForSingleObject (Threads[Index], INFINITE);
+    CloseHandle (Threads[Index]);
+#endif
+  }
+
+  //
+  // Report the commands which fail by their line in the list file.
+  //
+  for (Index = 0; Index < Batch.JobCount; Index++) {
+    if (Batch.Jobs[Index].Status != STATUS_SUCCESS) {
+      Error (ListFileName, Batch.Jobs[Index].LineNumber, 0, "GenFw command failed", NULL);
+    }
+  }
+
+Finish:
+  if (Threads != NULL) {
+    free (Threads);
+  }
+
+  if (Batch.Jobs != NULL) {
+    for (Index = 0; Index < Batch.JobCount; Index++) {
+      free (Batch.Jobs[Index].Argv);
+    }
+    free (Batch.Jobs);
+  }
+
+  if (ListFileBuffer != NULL) {
+    free (ListFileBuffer);
+  }
+
+  Status = GetUtilityStatus ();
+  VerboseMsg ("%s tool done with return code is 0x%x.", UTILITY_NAME, Status);
+
+  return Status;
+}
+
+int
+main (
+  int  argc,
+  char *argv[]
+  )
+/*++
+
+Routine Description:
+
+  Main function.
+
+Arguments:
+
+  argc - Number of command line parameters.
+  argv - Array of pointers to command line parameter strings.
+
+Returns:
+  STATUS_SUCCESS - Utility exits successfully.
+  STATUS_ERROR   - Some error occurred during execution.
+
+--*/
+{
+  int  Index;
+
+  SetUtilityName (UTILITY_NAME);
+
+  for (Index = 1; Index < argc; Index++) {
+    if (stricmp (argv[Index], "--batch") == 0) {
+      return RunBatch (argc, argv);
+    }
+  }
+
+  return RunCommand (argc, argv);
+}
+
 STATIC
 EFI_STATUS
 ZeroDebugData (
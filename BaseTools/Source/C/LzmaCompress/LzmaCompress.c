@@ -21,17 +21,33 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 #include "Sdk/C/Alloc.h"
 #include "Sdk/C/7zFile.h"
 #include "Sdk/C/7zVersion.h"
+#include "Sdk/C/CpuArch.h"
 #include "Sdk/C/LzmaDec.h"
 #include "Sdk/C/LzmaEnc.h"
 #include "Sdk/C/Bra.h"
+#include "Sdk/C/Threads.h"
 #include "CommonLib.h"
 
 #define LZMA_HEADER_SIZE (LZMA_PROPS_SIZE + 8)
 
+//
+// The multi-block format starts with a header of four little endian UInt32
+// values: signature, block size, block count and original size. It is
+// followed by the compressed size of each block as UInt32 and then by the
+// blocks, each of which is a complete LZMA stream with its own header. This
+// matches LZMA_MULTI_BLOCK_HEADER in MdeModulePkg/Include/Guid/LzmaDecompress.h.
+//
+#define LZMA_MULTI_BLOCK_SIGNATURE    0x424D5A4C  // "LZMB"
+#define LZMA_MULTI_BLOCK_HEADER_SIZE  16
+#define LZMA_MULTI_BLOCK_DEFAULT_SIZE (1 << 20)
+
 typedef enum {
   NoConverter,
   X86Converter,
@@ -45,10 +61,13 @@ const char *kDataErrorMessage = "Data error";
 
 static Bool mQuietMode = False;
 static CONVERTER_TYPE mConType = NoConverter;
+static Bool mMultiBlock = False;
+static UInt32 mBlockSize = LZMA_MULTI_BLOCK_DEFAULT_SIZE;
+static UInt32 mNumThreads = 0;
 
 #define UTILITY_NAME "LzmaCompress"
 #define UTILITY_MAJOR_VERSION 0
-#define UTILITY_MINOR_VERSION 2
+#define UTILITY_MINOR_VERSION 3
 #define INTEL_COPYRIGHT \
   "Copyright (c) 2009-2018, Intel Corporation. All rights reserved."
 void PrintHelp(char *buffer)
@@ -61,6 +80,13 @@ void PrintHelp(char *buffer)
              "  -d: decode file\n"
              "  -o FileName, --output FileName: specify the output filename\n"
              "  --f86: enable converter for x86 code\n"
+             "  --multi-block: split the data into blocks that are compressed\n"
+             "                 independently of each other\n"
+             "  --block-size Size: uncompressed size of each block of --multi-block,\n"
+             "                     1MB by default\n"
+             "  --threads Number: number of threads used to encode, one per processor\n"
+             "                    by default. The match finder of a single stream uses\n"
+             "                    at most two, --multi-block encodes blocks in parallel\n"
              "  -v, --verbose: increase output messages\n"
              "  -q, --quiet: reduce output messages\n"
              "  --debug [0-9]: set debug level\n"
@@ -93,6 +119,218 @@ void PrintVersion(char *buffer)
   sprintf (buffer, "%s Version %d.%d %s ", UTILITY_NAME, UTILITY_MAJOR_VERSION, UTILITY_MINOR_VERSION, __BUILD_VERSION);
 }
 
+static UInt32 GetNumberOfProcessors(void)
+{
+#ifdef _WIN32
+  SYSTEM_INFO systemInfo;
+  GetSystemInfo(&systemInfo);
+  return (UInt32)systemInfo.dwNumberOfProcessors;
+#else
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return (count > 0) ? (UInt32)count : 1;
+#endif
+}
+
+/*
+  Encodes inBuffer as one LZMA stream with its LZMA_HEADER_SIZE bytes header.
+  *outSize is the size of outBuffer on input and the size of the stream on output.
+*/
+static SRes EncodeBuffer(Byte *outBuffer, size_t *outSize, const Byte *inBuffer, size_t inSize, UInt32 numThreads)
+{
+  SRes res;
+  size_t outSizeProcessed = *outSize - LZMA_HEADER_SIZE;
+  size_t outPropsSize = LZMA_PROPS_SIZE;
+  CLzmaEncProps props;
+  int i;
+
+  LzmaEncProps_Init(&props);
+  if (numThreads != 0)
+    props.numThreads = (numThreads > 1) ? 2 : 1;
+  LzmaEncProps_Normalize(&props);
+
+  for (i = 0; i < 8; i++)
+    outBuffer[i + LZMA_PROPS_SIZE] = (Byte)((UInt64)inSize >> (8 * i));
+
+  res = LzmaEncode(outBuffer + LZMA_HEADER_SIZE, &outSizeProcessed,
+      inBuffer, inSize, &props, outBuffer, &outPropsSize, 0,
+      NULL, &g_Alloc, &g_Alloc);
+
+  if (res == SZ_OK)
+    *outSize = LZMA_HEADER_SIZE + outSizeProcessed;
+  return res;
+}
+
+typedef struct
+{
+  const Byte *inBuffer;
+  size_t inSize;
+  UInt32 blockCount;
+  Byte **blockBuffer;
+  size_t *blockSize;
+  UInt32 nextBlock;
+  SRes res;
+  CCriticalSection lock;
+} CMultiBlockEncoder;
+
+static THREAD_FUNC_RET_TYPE THREAD_FUNC_CALL_TYPE MultiBlockEncodeThread(void *param)
+{
+  CMultiBlockEncoder *p = (CMultiBlockEncoder *)param;
+
+  for (;;)
+  {
+    UInt32 block;
+    size_t offset;
+    size_t inSize;
+    size_t outSize;
+    SRes res;
+
+    CriticalSection_Enter(&p->lock);
+    block = p->nextBlock;
+    if (block < p->blockCount && p->res == SZ_OK)
+      p->nextBlock++;
+    else
+      block = p->blockCount;
+    CriticalSection_Leave(&p->lock);
+
+    if (block == p->blockCount)
+      break;
+
+    offset = (size_t)block * mBlockSize;
+    inSize = p->inSize - offset;
+    if (inSize > mBlockSize)
+      inSize = mBlockSize;
+
+    // we allocate 105% of block size + 64KB for each block, like for a single stream
+    outSize = inSize / 20 * 21 + (1 << 16);
+    p->blockBuffer[block] = (Byte *)MyAlloc(outSize);
+    if (p->blockBuffer[block] == 0) {
+      res = SZ_ERROR_MEM;
+    } else {
+      res = EncodeBuffer(p->blockBuffer[block], &outSize, p->inBuffer + offset, inSize, 1);
+      p->blockSize[block] = outSize;
+      if (res == SZ_OK && outSize > 0xFFFFFFFF)
+        res = SZ_ERROR_OUTPUT_EOF;
+    }
+
+    if (res != SZ_OK) {
+      CriticalSection_Enter(&p->lock);
+      if (p->res == SZ_OK)
+        p->res = res;
+      CriticalSection_Leave(&p->lock);
+    }
+  }
+
+  return 0;
+}
+
+/*
+  Encodes inBuffer in the multi-block format. The blocks are handed out to
+  worker threads one by one, and the calling thread encodes blocks as well.
+*/
+static SRes EncodeMultiBlock(ISeqOutStream *outStream, const Byte *inBuffer, size_t inSize)
+{
+  CMultiBlockEncoder encoder;
+  CThread *threads = 0;
+  UInt32 numThreads;
+  UInt32 i;
+  Byte header[LZMA_MULTI_BLOCK_HEADER_SIZE];
+  Byte *sizes = 0;
+  SRes res;
+
+  if ((UInt64)inSize > 0xFFFFFFFF)
+    return SZ_ERROR_PARAM;
+
+  memset(&encoder, 0, sizeof(encoder));
+  encoder.inBuffer = inBuffer;
+  encoder.inSize = inSize;
+  encoder.blockCount = (UInt32)(inSize / mBlockSize) + ((inSize % mBlockSize) != 0);
+
+  SetUi32(header, LZMA_MULTI_BLOCK_SIGNATURE);
+  SetUi32(header + 4, mBlockSize);
+  SetUi32(header + 8, encoder.blockCount);
+  SetUi32(header + 12, (UInt32)inSize);
+
+  //
+  // Empty input is encoded as a header without blocks.
+  //
+  if (encoder.blockCount == 0) {
+    if (outStream->Write(outStream, header, sizeof(header)) != sizeof(header))
+      return SZ_ERROR_WRITE;
+    return SZ_OK;
+  }
+
+  encoder.blockBuffer = (Byte **)MyAlloc(encoder.blockCount * sizeof(Byte *));
+  encoder.blockSize = (size_t *)MyAlloc(encoder.blockCount * sizeof(size_t));
+  sizes = (Byte *)MyAlloc(encoder.blockCount * 4);
+  if (encoder.blockBuffer == 0 || encoder.blockSize == 0 || sizes == 0) {
+    res = SZ_ERROR_MEM;
+    goto Done;
+  }
+  memset(encoder.blockBuffer, 0, encoder.blockCount * sizeof(Byte *));
+
+  if (CriticalSection_Init(&encoder.lock) != 0) {
+    res = SZ_ERROR_THREAD;
+    goto Done;
+  }
+
+  numThreads = (mNumThreads != 0) ? mNumThreads : GetNumberOfProcessors();
+  if (numThreads > encoder.blockCount)
+    numThreads = encoder.blockCount;
+  if (numThreads > 1) {
+    threads = (CThread *)MyAlloc((numThreads - 1) * sizeof(CThread));
+    if (threads == 0)
+      numThreads = 1;
+  }
+
+  //
+  // A thread that fails to start is not an error, the remaining threads
+  // simply encode more blocks.
+  //
+  for (i = 0; i + 1 < numThreads; i++) {
+    Thread_Construct(&threads[i]);
+    Thread_Create(&threads[i], MultiBlockEncodeThread, &encoder);
+  }
+  MultiBlockEncodeThread(&encoder);
+  for (i = 0; i + 1 < numThreads; i++) {
+    if (Thread_WasCreated(&threads[i])) {
+      Thread_Wait(&threads[i]);
+      Thread_Close(&threads[i]);
+    }
+  }
+  CriticalSection_Delete(&encoder.lock);
+
+  res = encoder.res;
+  if (res != SZ_OK)
+    goto Done;
+
+  for (i = 0; i < encoder.blockCount; i++)
+    SetUi32(sizes + 4 * i, (UInt32)encoder.blockSize[i]);
+
+  if (outStream->Write(outStream, header, sizeof(header)) != sizeof(header) ||
+      outStream->Write(outStream, sizes, encoder.blockCount * 4) != encoder.blockCount * 4) {
+    res = SZ_ERROR_WRITE;
+    goto Done;
+  }
+  for (i = 0; i < encoder.blockCount; i++) {
+    if (outStream->Write(outStream, encoder.blockBuffer[i], encoder.blockSize[i]) != encoder.blockSize[i]) {
+      res = SZ_ERROR_WRITE;
+      goto Done;
+    }
+  }
+
+Done:
+  if (encoder.blockBuffer != 0) {
+    for (i = 0; i < encoder.blockCount; i++)
+      MyFree(encoder.blockBuffer[i]);
+  }
+  MyFree(encoder.blockBuffer);
+  MyFree(encoder.blockSize);
+  MyFree(sizes);
+  MyFree(threads);
+
+  return res;
+}
+
 static SRes Encode(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 fileSize)
 {
   SRes res;
@@ -101,15 +339,13 @@ static SRes Encode(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 file
   Byte *outBuffer = 0;
   Byte *filteredStream = 0;
   size_t outSize;
-  CLzmaEncProps props;
-
-  LzmaEncProps_Init(&props);
-  LzmaEncProps_Normalize(&props);
 
   if (inSize != 0) {
     inBuffer = (Byte *)MyAlloc(inSize);
     if (inBuffer == 0)
       return SZ_ERROR_MEM;
+  } else if (mMultiBlock) {
+    return EncodeMultiBlock(outStream, inBuffer, inSize);
   } else {
     return SZ_ERROR_INPUT_EOF;
   }
@@ -119,6 +355,11 @@ static SRes Encode(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 file
     goto Done;
   }
 
+  if (mMultiBlock) {
+    res = EncodeMultiBlock(outStream, inBuffer, inSize);
+    goto Done;
+  }
+
   // we allocate 105% of original size + 64KB for output buffer
   outSize = (size_t)fileSize / 20 * 21 + (1 << 16);
   outBuffer = (Byte *)MyAlloc(outSize);
@@ -127,12 +368,6 @@ static SRes Encode(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 file
     goto Done;
   }
 
-  {
-    int i;
-    for (i = 0; i < 8; i++)
-      outBuffer[i + LZMA_PROPS_SIZE] = (Byte)(fileSize >> (8 * i));
-  }
-
   if (mConType != NoConverter)
   {
     filteredStream = (Byte *)MyAlloc(inSize);
@@ -151,28 +386,91 @@ static SRes Encode(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 file
     }
   }
 
-  {
-    size_t outSizeProcessed = outSize - LZMA_HEADER_SIZE;
-    size_t outPropsSize = LZMA_PROPS_SIZE;
+  res = EncodeBuffer(outBuffer, &outSize,
+      mConType != NoConverter ? filteredStream : inBuffer, inSize,
+      mNumThreads);
+  if (res != SZ_OK)
+    goto Done;
 
-    res = LzmaEncode(outBuffer + LZMA_HEADER_SIZE, &outSizeProcessed,
-        mConType != NoConverter ? filteredStream : inBuffer, inSize,
-        &props, outBuffer, &outPropsSize, 0,
-        NULL, &g_Alloc, &g_Alloc);
+  if (outStream->Write(outStream, outBuffer, outSize) != outSize)
+    res = SZ_ERROR_WRITE;
 
-    if (res != SZ_OK)
+Done:
+  MyFree(outBuffer);
+  MyFree(inBuffer);
+  MyFree(filteredStream);
+
+  return res;
+}
+
+/*
+  Decodes inBuffer in the multi-block format, checking that every block
+  decodes to the size the header gives for it.
+*/
+static SRes DecodeMultiBlock(ISeqOutStream *outStream, const Byte *inBuffer, size_t inSize)
+{
+  SRes res = SZ_OK;
+  Byte *outBuffer = 0;
+  UInt32 blockSize;
+  UInt32 blockCount;
+  UInt32 origSize;
+  UInt32 i;
+  size_t offset;
+  ELzmaStatus status;
+
+  if (inSize < LZMA_MULTI_BLOCK_HEADER_SIZE || GetUi32(inBuffer) != LZMA_MULTI_BLOCK_SIGNATURE)
+    return SZ_ERROR_DATA;
+
+  blockSize = GetUi32(inBuffer + 4);
+  blockCount = GetUi32(inBuffer + 8);
+  origSize = GetUi32(inBuffer + 12);
+  if (blockSize == 0 ||
+      blockCount != origSize / blockSize + ((origSize % blockSize) != 0) ||
+      (inSize - LZMA_MULTI_BLOCK_HEADER_SIZE) / 4 < blockCount)
+    return SZ_ERROR_DATA;
+
+  if (origSize == 0)
+    return SZ_OK;
+
+  outBuffer = (Byte *)MyAlloc(origSize);
+  if (outBuffer == 0)
+    return SZ_ERROR_MEM;
+
+  offset = LZMA_MULTI_BLOCK_HEADER_SIZE + (size_t)blockCount * 4;
+  for (i = 0; i < blockCount; i++) {
+    size_t compSize = GetUi32(inBuffer + LZMA_MULTI_BLOCK_HEADER_SIZE + 4 * i);
+    size_t expected = origSize - (size_t)i * blockSize;
+    size_t outSize;
+    size_t inSizePure;
+
+    if (expected > blockSize)
+      expected = blockSize;
+    if (compSize < LZMA_HEADER_SIZE || compSize > inSize - offset ||
+        GetUi32(inBuffer + offset + LZMA_PROPS_SIZE) != expected ||
+        GetUi32(inBuffer + offset + LZMA_PROPS_SIZE + 4) != 0) {
+      res = SZ_ERROR_DATA;
       goto Done;
+    }
 
-    outSize = LZMA_HEADER_SIZE + outSizeProcessed;
+    outSize = expected;
+    inSizePure = compSize - LZMA_HEADER_SIZE;
+    res = LzmaDecode(outBuffer + (size_t)i * blockSize, &outSize,
+        inBuffer + offset + LZMA_HEADER_SIZE, &inSizePure,
+        inBuffer + offset, LZMA_PROPS_SIZE, LZMA_FINISH_END, &status, &g_Alloc);
+    if (res != SZ_OK)
+      goto Done;
+    if (outSize != expected) {
+      res = SZ_ERROR_DATA;
+      goto Done;
+    }
+    offset += compSize;
   }
 
-  if (outStream->Write(outStream, outBuffer, outSize) != outSize)
+  if (outStream->Write(outStream, outBuffer, origSize) != origSize)
     res = SZ_ERROR_WRITE;
 
 Done:
   MyFree(outBuffer);
-  MyFree(inBuffer);
-  MyFree(filteredStream);
 
   return res;
 }
@@ -202,6 +500,11 @@ static SRes Decode(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 file
     goto Done;
   }
 
+  if (mMultiBlock) {
+    res = DecodeMultiBlock(outStream, inBuffer, inSize);
+    goto Done;
+  }
+
   for (i = 0; i < 8; i++)
     outSize64 += ((UInt64)inBuffer[LZMA_PROPS_SIZE + i]) << (i * 8);
 
@@ -271,6 +574,30 @@ int main2(int numArgs, const char *args[], char *rs)
       modeWasSet = True;
     } else if (strcmp(args[param], "--f86") == 0) {
       mConType = X86Converter;
+    } else if (strcmp(args[param], "--multi-block") == 0) {
+      mMultiBlock = True;
+    } else if (strcmp(args[param], "--block-size") == 0) {
+      char *end;
+      unsigned long value;
+      if (numArgs < (param + 2)) {
+        return PrintUserError(rs);
+      }
+      value = strtoul(args[++param], &end, 0);
+      if (*end != '\0' || value == 0 || value > 0x80000000) {
+        return PrintUserError(rs);
+      }
+      mBlockSize = (UInt32)value;
+    } else if (strcmp(args[param], "--threads") == 0) {
+      char *end;
+      unsigned long value;
+      if (numArgs < (param + 2)) {
+        return PrintUserError(rs);
+      }
+      value = strtoul(args[++param], &end, 0);
+      if (*end != '\0' || value == 0 || value > 256) {
+        return PrintUserError(rs);
+      }
+      mNumThreads = (UInt32)value;
     } else if (strcmp(args[param], "-o") == 0 ||
                strcmp(args[param], "--output") == 0) {
       if (numArgs < (param + 2)) {
@@ -319,6 +646,10 @@ int main2(int numArgs, const char *args[], char *rs)
     return PrintUserError(rs);
   }
 
+  if (mMultiBlock && mConType != NoConverter) {
+    return PrintError(rs, "--f86 can not be used with --multi-block");
+  }
+
   {
     size_t t4 = sizeof(UInt32);
     size_t t8 = sizeof(UInt64);
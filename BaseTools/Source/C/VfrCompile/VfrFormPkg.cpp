@@ -14,6 +14,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 **/
 
 #include "stdio.h"
+#include "stdlib.h"
 #include "assert.h"
 #include "VfrFormPkg.h"
 
@@ -110,6 +111,8 @@ CFormPkg::CFormPkg (
   mCurrBufferNode      = NULL;
   mReadBufferNode      = NULL;
   mReadBufferOffset    = 0;
+  mOffsetBufferNode    = NULL;
+  mOffsetBufferBase    = 0;
   PendingAssignList    = NULL;
 
   Node = new SBufferNode;
@@ -630,6 +633,7 @@ CFormPkg::InsertNodeBefore(
 
   NewNode->mNext = LastNode->mNext;
   LastNode->mNext = NewNode;
+  mOffsetBufferNode = NULL;
 
   return VFR_RETURN_SUCCESS;
 }
@@ -643,11 +647,23 @@ CFormPkg::GetBufAddrBaseOnOffset (
   UINT32      TotalBufLen;
   UINT32      CurrentBufLen;
 
-  TotalBufLen = 0;
+  //
+  // Nodes before the cached one are only resized or relinked by
+  // AdjustDynamicInsertOpcode, which drops the cache.
+  //
+  if (mOffsetBufferNode != NULL && Offset >= mOffsetBufferBase) {
+    TmpNode     = mOffsetBufferNode;
+    TotalBufLen = mOffsetBufferBase;
+  } else {
+    TmpNode     = mBufferNodeQueueHead;
+    TotalBufLen = 0;
+  }
 
-  for (TmpNode = mBufferNodeQueueHead; TmpNode != NULL; TmpNode = TmpNode->mNext) {
+  for (; TmpNode != NULL; TmpNode = TmpNode->mNext) {
     CurrentBufLen = TmpNode->mBufferFree - TmpNode->mBufferStart;
     if (Offset >= TotalBufLen && Offset < TotalBufLen + CurrentBufLen) {
+      mOffsetBufferNode = TmpNode;
+      mOffsetBufferBase = TotalBufLen;
       return TmpNode->mBufferStart + (Offset - TotalBufLen);
     }
 
@@ -673,6 +689,7 @@ CFormPkg::AdjustDynamicInsertOpcode (
   UINT32      NeedRestoreCodeLen;
 
   NewRestoreNodeEnd = NULL;
+  mOffsetBufferNode = NULL;
 
   InserPositionNode  = GetBinBufferNodeForAddr(InserPositionAddr);
   InsertOpcodeNode = GetBinBufferNodeForAddr(InsertOpcodeAddr);
@@ -1045,6 +1062,13 @@ CIfrRecordInfoDB::CIfrRecordInfoDB (
   for (UINT8 i = 0; i < EFI_HII_MAX_SUPPORT_DEFAULT_TYPE; i++) {
     mAllDefaultIdArray[i] = 0xffff;
   }
+  mRecordIdxTable       = NULL;
+  mRecordIdxTableCount  = 0;
+  mRecordIdxTableSize   = 0;
+  mRecordIdxTableValid  = TRUE;
+  mRecordLineTable      = NULL;
+  mRecordLineTableCount = 0;
+  mRecordLineTableValid = FALSE;
 }
 
 CIfrRecordInfoDB::~CIfrRecordInfoDB (
@@ -1058,6 +1082,35 @@ CIfrRecordInfoDB::~CIfrRecordInfoDB (
     mIfrRecordListHead = mIfrRecordListHead->mNext;
     delete pNode;
   }
+
+  ARRAY_SAFE_FREE (mRecordIdxTable);
+  ARRAY_SAFE_FREE (mRecordLineTable);
+}
+
+VOID
+CIfrRecordInfoDB::BuildRecordIdxTable (
+  VOID
+  )
+{
+  SIfrRecord *pNode;
+  UINT32     Count;
+
+  Count = 0;
+  for (pNode = mIfrRecordListHead; pNode != NULL; pNode = pNode->mNext) {
+    Count++;
+  }
+
+  if (Count > mRecordIdxTableSize) {
+    ARRAY_SAFE_FREE (mRecordIdxTable);
+    mRecordIdxTable     = new SIfrRecord *[Count];
+    mRecordIdxTableSize = Count;
+  }
+
+  mRecordIdxTableCount = 0;
+  for (pNode = mIfrRecordListHead; pNode != NULL; pNode = pNode->mNext) {
+    mRecordIdxTable[mRecordIdxTableCount++] = pNode;
+  }
+  mRecordIdxTableValid = TRUE;
 }
 
 SIfrRecord *
@@ -1065,19 +1118,22 @@ CIfrRecordInfoDB::GetRecordInfoFromIdx (
   IN UINT32 RecordIdx
   )
 {
-  UINT32     Idx;
-  SIfrRecord *pNode = NULL;
-
   if (RecordIdx == EFI_IFR_RECORDINFO_IDX_INVALUD) {
     return NULL;
   }
 
-  for (Idx = (EFI_IFR_RECORDINFO_IDX_START + 1), pNode = mIfrRecordListHead;
-       (Idx != RecordIdx) && (pNode != NULL);
-       Idx++, pNode = pNode->mNext)
-  ;
+  if (!mRecordIdxTableValid) {
+    BuildRecordIdxTable ();
+  }
 
-  return pNode;
+  //
+  // Record index starts from 1 at the list head.
+  //
+  if ((RecordIdx == EFI_IFR_RECORDINFO_IDX_START) || (RecordIdx > mRecordIdxTableCount)) {
+    return NULL;
+  }
+
+  return mRecordIdxTable[RecordIdx - 1];
 }
 
 UINT32
@@ -1107,6 +1163,22 @@ CIfrRecordInfoDB::IfrRecordRegister (
   }
   mRecordCount++;
 
+  if (mRecordIdxTableValid) {
+    if (mRecordIdxTableCount == mRecordIdxTableSize) {
+      SIfrRecord **NewTable;
+
+      NewTable = new SIfrRecord *[mRecordIdxTableSize * 2 + 1024];
+      if (mRecordIdxTable != NULL) {
+        memcpy (NewTable, mRecordIdxTable, mRecordIdxTableCount * sizeof (SIfrRecord *));
+        delete[] mRecordIdxTable;
+      }
+      mRecordIdxTable     = NewTable;
+      mRecordIdxTableSize = mRecordIdxTableSize * 2 + 1024;
+    }
+    mRecordIdxTable[mRecordIdxTableCount++] = pNew;
+  }
+  mRecordLineTableValid = FALSE;
+
   return mRecordCount;
 }
 
@@ -1141,6 +1213,7 @@ CIfrRecordInfoDB::IfrRecordInfoUpdate (
   pNode->mBinBufLen = BinBufLen;
   pNode->mIfrBinBuf = BinBuf;
 
+  mRecordLineTableValid = FALSE;
 }
 
 VOID
@@ -1185,6 +1258,71 @@ CIfrRecordInfoDB::IfrRecordOutput (
   return;
 }
 
+typedef struct {
+  SIfrRecord *Record;
+  UINT32     Position;
+} SIfrRecordLineEntry;
+
+static
+int
+CompareRecordLine (
+  IN CONST VOID *Entry1,
+  IN CONST VOID *Entry2
+  )
+{
+  CONST SIfrRecordLineEntry *Line1 = (CONST SIfrRecordLineEntry *) Entry1;
+  CONST SIfrRecordLineEntry *Line2 = (CONST SIfrRecordLineEntry *) Entry2;
+
+  if (Line1->Record->mLineNo != Line2->Record->mLineNo) {
+    return (Line1->Record->mLineNo < Line2->Record->mLineNo) ? -1 : 1;
+  }
+  //
+  // Records of the same line keep their order in the list.
+  //
+  return (Line1->Position < Line2->Position) ? -1 : (Line1->Position > Line2->Position);
+}
+
+VOID
+CIfrRecordInfoDB::BuildRecordLineTable (
+  VOID
+  )
+{
+  SIfrRecord          *pNode;
+  SIfrRecordLineEntry *Entries;
+  UINT32              Count;
+  UINT32              Index;
+
+  ARRAY_SAFE_FREE (mRecordLineTable);
+  mRecordLineTable      = NULL;
+  mRecordLineTableCount = 0;
+  mRecordLineTableValid = TRUE;
+
+  Count = 0;
+  for (pNode = mIfrRecordListHead; pNode != NULL; pNode = pNode->mNext) {
+    Count++;
+  }
+  if (Count == 0) {
+    return;
+  }
+
+  Entries = new SIfrRecordLineEntry[Count];
+  Count   = 0;
+  for (pNode = mIfrRecordListHead; pNode != NULL; pNode = pNode->mNext) {
+    Entries[Count].Record   = pNode;
+    Entries[Count].Position = Count;
+    Count++;
+  }
+  qsort (Entries, Count, sizeof (SIfrRecordLineEntry), CompareRecordLine);
+
+  mRecordLineTable = new SIfrRecord *[Count];
+  for (Index = 0; Index < Count; Index++) {
+    mRecordLineTable[Index] = Entries[Index].Record;
+  }
+  mRecordLineTableCount = Count;
+
+  delete[] Entries;
+}
+
 VOID
 CIfrRecordInfoDB::IfrRecordOutput (
   IN FILE   *File,
@@ -1194,6 +1332,9 @@ CIfrRecordInfoDB::IfrRecordOutput (
   SIfrRecord *pNode;
   UINT8      Index;
   UINT32     TotalSize;
+  UINT32     Low;
+  UINT32     High;
+  UINT32     Mid;
 
   if (mSwitch == FALSE) {
     return;
@@ -1203,6 +1344,39 @@ CIfrRecordInfoDB::IfrRecordOutput (
     return;
   }
 
+  if (LineNo != 0) {
+    //
+    // Called for every line of the VFR file, so look the line up in the
+    // records sorted by line number instead of walking all records.
+    //
+    if (!mRecordLineTableValid) {
+      BuildRecordLineTable ();
+    }
+
+    Low  = 0;
+    High = mRecordLineTableCount;
+    while (Low < High) {
+      Mid = Low + (High - Low) / 2;
+      if (mRecordLineTable[Mid]->mLineNo < LineNo) {
+        Low = Mid + 1;
+      } else {
+        High = Mid;
+      }
+    }
+
+    for (; (Low < mRecordLineTableCount) && (mRecordLineTable[Low]->mLineNo == LineNo); Low++) {
+      pNode = mRecordLineTable[Low];
+      fprintf (File, ">%08X: ", pNode->mOffset);
+      if (pNode->mIfrBinBuf != NULL) {
+        for (Index = 0; Index < pNode->mBinBufLen; Index++) {
+          fprintf (File, "%02X ", (UINT8)(pNode->mIfrBinBuf[Index]));
+        }
+      }
+      fprintf (File, "\n");
+    }
+    return;
+  }
+
   TotalSize = 0;
 
   for (pNode = mIfrRecordListHead; pNode != NULL; pNode = pNode->mNext) {
@@ -1362,6 +1536,9 @@ CIfrRecordInfoDB::IfrAdjustDynamicOpcodeInRecords (
     return FALSE;
   }
 
+  mRecordIdxTableValid  = FALSE;
+  mRecordLineTableValid = FALSE;
+
   //
   // Adjust the node. pPreNode save the Node before mIfrRecordListTail
   //
@@ -1642,6 +1819,9 @@ CIfrRecordInfoDB::IfrRecordAdjust (
     pNode = pNode->mNext;
   }
 
+  mRecordIdxTableValid  = FALSE;
+  mRecordLineTableValid = FALSE;
+
   //
   // Update Ifr Opcode Offset
   //
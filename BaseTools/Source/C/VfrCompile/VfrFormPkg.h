@@ -115,6 +115,14 @@ private:
   SBufferNode         *mReadBufferNode;
   UINT32              mReadBufferOffset;
 
+  //
+  // The node last found by GetBufAddrBaseOnOffset and the offset of its
+  // first byte, so that increasing offsets are found without walking from
+  // the head of the queue each time.
+  //
+  SBufferNode         *mOffsetBufferNode;
+  UINT32              mOffsetBufferBase;
+
   UINT32              mPkgLength;
 
   VOID                _WRITE_PKG_LINE (IN FILE *, IN UINT32 , IN CONST CHAR8 *, IN CHAR8 *, IN UINT32);
@@ -213,7 +221,25 @@ private:
   UINT8      mAllDefaultTypeCount;
   UINT16     mAllDefaultIdArray[EFI_HII_MAX_SUPPORT_DEFAULT_TYPE];
 
+  //
+  // The records in list order, so that a record index is found without
+  // walking the list. It is rebuilt after the list is reordered.
+  //
+  SIfrRecord **mRecordIdxTable;
+  UINT32     mRecordIdxTableCount;
+  UINT32     mRecordIdxTableSize;
+  BOOLEAN    mRecordIdxTableValid;
+
+  //
+  // The records sorted by line number, for the record list file.
+  //
+  SIfrRecord **mRecordLineTable;
+  UINT32     mRecordLineTableCount;
+  BOOLEAN    mRecordLineTableValid;
+
   SIfrRecord * GetRecordInfoFromIdx (IN UINT32);
+  VOID             BuildRecordIdxTable (VOID);
+  VOID             BuildRecordLineTable (VOID);
   BOOLEAN          CheckQuestionOpCode (IN UINT8);
   BOOLEAN          CheckIdOpCode (IN UINT8);
   EFI_QUESTION_ID  GetOpcodeQuestionId (IN EFI_IFR_OP_HEADER *);
@@ -20,6 +20,28 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include "VfrUtilityLib.h"
 #include "VfrFormPkg.h"
 
+/**
+  Get the hash table bucket of a symbol name.
+
+  @param  Name     The symbol name.
+
+  @return The bucket index, less than VFR_HASH_TABLE_SIZE.
+**/
+STATIC
+UINT32
+VfrHashName (
+  IN CONST CHAR8 *Name
+  )
+{
+  UINT32 Hash;
+
+  for (Hash = 0; *Name != '\0'; Name++) {
+    Hash = Hash * 31 + (UINT8) *Name;
+  }
+
+  return Hash % VFR_HASH_TABLE_SIZE;
+}
+
 VOID
 CVfrBinaryOutput::WriteLine (
   IN FILE         *pFile,
@@ -137,6 +159,7 @@ SConfigItem::SConfigItem (
   mGuid          = NULL;
   mId            = NULL;
   mInfoStrList = NULL;
+  mOffsetBitMap = NULL;
   mNext        = NULL;
 
   if (Name != NULL) {
@@ -172,6 +195,7 @@ SConfigItem::SConfigItem (
   mGuid        = NULL;
   mId          = NULL;
   mInfoStrList = NULL;
+  mOffsetBitMap = NULL;
   mNext        = NULL;
 
   if (Name != NULL) {
@@ -204,6 +228,7 @@ SConfigItem::~SConfigItem (
   ARRAY_SAFE_FREE (mName);
   ARRAY_SAFE_FREE (mGuid);
   ARRAY_SAFE_FREE (mId);
+  ARRAY_SAFE_FREE (mOffsetBitMap);
   while (mInfoStrList != NULL) {
     Info = mInfoStrList;
     mInfoStrList = mInfoStrList->mNext;
@@ -326,17 +351,25 @@ CVfrBufferConfig::Write (
       }
       mItemListPos = pItem;
     } else {
-      // tranverse the list to find out if there's already the value for the same offset
-      for (pInfo = mItemListPos->mInfoStrList; pInfo != NULL; pInfo = pInfo->mNext) {
-        if (pInfo->mOffset == Offset) {
-          return 0;
+      // check whether there's already the value for the same offset
+      if (mItemListPos->mOffsetBitMap == NULL) {
+        if ((mItemListPos->mOffsetBitMap = new UINT32[EFI_CONFIG_OFFSET_BITMAP_SIZE]) == NULL) {
+          return 2;
+        }
+        memset (mItemListPos->mOffsetBitMap, 0, EFI_CONFIG_OFFSET_BITMAP_SIZE * sizeof (UINT32));
+        for (pInfo = mItemListPos->mInfoStrList; pInfo != NULL; pInfo = pInfo->mNext) {
+          mItemListPos->mOffsetBitMap[pInfo->mOffset / EFI_BITS_PER_UINT32] |= 0x80000000 >> (pInfo->mOffset % EFI_BITS_PER_UINT32);
         }
       }
+      if ((mItemListPos->mOffsetBitMap[Offset / EFI_BITS_PER_UINT32] & (0x80000000 >> (Offset % EFI_BITS_PER_UINT32))) != 0) {
+        return 0;
+      }
       if((pInfo = new SConfigInfo (Type, Offset, Width, Value)) == NULL) {
         return 2;
       }
       pInfo->mNext = mItemListPos->mInfoStrList;
       mItemListPos->mInfoStrList = pInfo;
+      mItemListPos->mOffsetBitMap[Offset / EFI_BITS_PER_UINT32] |= 0x80000000 >> (Offset % EFI_BITS_PER_UINT32);
     }
     break;
 
@@ -574,8 +607,14 @@ CVfrVarDataTypeDB::RegisterNewType (
   IN SVfrDataType  *New
   )
 {
+  UINT32 Bucket;
+
   New->mNext               = mDataTypeList;
   mDataTypeList            = New;
+
+  Bucket                   = VfrHashName (New->mTypeName);
+  New->mHashNext           = mDataTypeHashTable[Bucket];
+  mDataTypeHashTable[Bucket] = New;
 }
 
 EFI_VFR_RETURN_CODE
@@ -952,6 +991,8 @@ CVfrVarDataTypeDB::CVfrVarDataTypeDB (
   VOID
   )
 {
+  UINT32 Index;
+
   mDataTypeList  = NULL;
   mNewDataType   = NULL;
   mCurrDataField = NULL;
@@ -960,6 +1001,10 @@ CVfrVarDataTypeDB::CVfrVarDataTypeDB (
   mFirstNewDataTypeName = NULL;
   mCurrDataType  = NULL;
 
+  for (Index = 0; Index < VFR_HASH_TABLE_SIZE; Index++) {
+    mDataTypeHashTable[Index] = NULL;
+  }
+
   InternalTypesListInit ();
 }
 
@@ -1082,7 +1127,7 @@ CVfrVarDataTypeDB::SetNewTypeName (
     return VFR_RETURN_INVALID_PARAMETER;
   }
 
-  for (pType = mDataTypeList; pType != NULL; pType = pType->mNext) {
+  for (pType = mDataTypeHashTable[VfrHashName (TypeName)]; pType != NULL; pType = pType->mHashNext) {
     if (strcmp(pType->mTypeName, TypeName) == 0) {
       return VFR_RETURN_REDEFINED;
     }
@@ -1318,7 +1363,7 @@ CVfrVarDataTypeDB::GetDataType (
 
   *DataType = NULL;
 
-  for (pDataType = mDataTypeList; pDataType != NULL; pDataType = pDataType->mNext) {
+  for (pDataType = mDataTypeHashTable[VfrHashName (TypeName)]; pDataType != NULL; pDataType = pDataType->mHashNext) {
     if (strcmp (TypeName, pDataType->mTypeName) == 0) {
       *DataType = pDataType;
       return VFR_RETURN_SUCCESS;
@@ -1374,7 +1419,7 @@ CVfrVarDataTypeDB::GetDataTypeSize (
 
   *Size = 0;
 
-  for (pDataType = mDataTypeList; pDataType != NULL; pDataType = pDataType->mNext) {
+  for (pDataType = mDataTypeHashTable[VfrHashName (TypeName)]; pDataType != NULL; pDataType = pDataType->mHashNext) {
     if (strcmp (TypeName, pDataType->mTypeName) == 0) {
       *Size = pDataType->mTotalSize;
       return VFR_RETURN_SUCCESS;
@@ -1481,7 +1526,7 @@ CVfrVarDataTypeDB::IsTypeNameDefined (
     return FALSE;
   }
 
-  for (pType = mDataTypeList; pType != NULL; pType = pType->mNext) {
+  for (pType = mDataTypeHashTable[VfrHashName (TypeName)]; pType != NULL; pType = pType->mHashNext) {
     if (strcmp (pType->mTypeName, TypeName) == 0) {
       return TRUE;
     }
@@ -1563,6 +1608,7 @@ SVfrVarStorageNode::SVfrVarStorageNode (
     mVarStoreName = NULL;
   }
   mNext                            = NULL;
+  mHashNext                        = NULL;
   mVarStoreId                      = VarStoreId;
   mVarStoreType                    = EFI_VFR_VARSTORE_EFI;
   mStorageInfo.mEfiVar.mEfiVarName = VarName;
@@ -1591,6 +1637,7 @@ SVfrVarStorageNode::SVfrVarStorageNode (
     mVarStoreName = NULL;
   }
   mNext                    = NULL;
+  mHashNext                = NULL;
   mVarStoreId              = VarStoreId;
   if (BitsVarstore) {
     mVarStoreType            = EFI_VFR_VARSTORE_BUFFER_BITS;
@@ -1614,6 +1661,7 @@ SVfrVarStorageNode::SVfrVarStorageNode (
     mVarStoreName = NULL;
   }
   mNext                              = NULL;
+  mHashNext                          = NULL;
   mVarStoreId                        = VarStoreId;
   mVarStoreType                      = EFI_VFR_VARSTORE_NAME;
   mStorageInfo.mNameSpace.mNameTable = new EFI_VARSTORE_ID[DEFAULT_NAME_TABLE_ITEMS];
@@ -1654,6 +1702,10 @@ CVfrDataStorage::CVfrDataStorage (
   mNewVarStorageNode       = NULL;
   mBufferFieldInfoListHead = NULL;
   mBufferFieldInfoListTail = NULL;
+
+  for (Index = 0; Index < VFR_HASH_TABLE_SIZE; Index++) {
+    mVarStoreHashTable[Index] = NULL;
+  }
 }
 
 CVfrDataStorage::~CVfrDataStorage (
@@ -1822,6 +1874,7 @@ CVfrDataStorage::DeclareNameVarStoreEnd (
   mNewVarStorageNode->mGuid = *Guid;
   mNewVarStorageNode->mNext = mNameVarStoreList;
   mNameVarStoreList         = mNewVarStorageNode;
+  RegisterVarStoreName (mNewVarStorageNode);
 
   mNewVarStorageNode        = NULL;
 
@@ -1859,6 +1912,7 @@ CVfrDataStorage::DeclareEfiVarStore (
 
   pNode->mNext       = mEfiVarStoreList;
   mEfiVarStoreList   = pNode;
+  RegisterVarStoreName (pNode);
 
   return VFR_RETURN_SUCCESS;
 }
@@ -1903,6 +1957,7 @@ CVfrDataStorage::DeclareBufferVarStore (
 
   pNew->mNext         = mBufferVarStoreList;
   mBufferVarStoreList = pNew;
+  RegisterVarStoreName (pNew);
 
   if (gCVfrBufferConfig.Register(StoreName, Guid) != 0) {
     return VFR_RETURN_FATAL_ERROR;
@@ -1998,6 +2053,30 @@ CVfrDataStorage::CheckGuidField (
   return FALSE;
 }
 
+/**
+  Add the varstore to the hash table of the varstore names.
+
+  The varstores are added to the head of their buckets the same way as to
+  the head of their lists, so a bucket keeps the order of each list.
+
+  @param  pNode    The varstore just added to its list.
+**/
+VOID
+CVfrDataStorage::RegisterVarStoreName (
+  IN SVfrVarStorageNode *pNode
+  )
+{
+  UINT32 Bucket;
+
+  if (pNode->mVarStoreName == NULL) {
+    return;
+  }
+
+  Bucket                     = VfrHashName (pNode->mVarStoreName);
+  pNode->mHashNext           = mVarStoreHashTable[Bucket];
+  mVarStoreHashTable[Bucket] = pNode;
+}
+
 /**
   Base on the input store name and guid to find the varstore id.
 
@@ -2020,32 +2099,33 @@ CVfrDataStorage::GetVarStoreId (
   EFI_VFR_RETURN_CODE   ReturnCode;
   SVfrVarStorageNode    *pNode;
   BOOLEAN               HasFoundOne = FALSE;
+  SVfrVarStorageNode    *pBucket;
+  UINT32                Pass;
+  EFI_VFR_VARSTORE_TYPE VarStoreType;
 
   mCurrVarStorageNode = NULL;
 
-  for (pNode = mBufferVarStoreList; pNode != NULL; pNode = pNode->mNext) {
-    if (strcmp (pNode->mVarStoreName, StoreName) == 0) {
-      if (CheckGuidField(pNode, StoreGuid, &HasFoundOne, &ReturnCode)) {
-        *VarStoreId = mCurrVarStorageNode->mVarStoreId;
-        return ReturnCode;
+  //
+  // Search the buffer, EFI and name/value varstores in turn, as they are
+  // kept in three lists.
+  //
+  pBucket = mVarStoreHashTable[VfrHashName (StoreName)];
+  for (Pass = 0; Pass < 3; Pass++) {
+    for (pNode = pBucket; pNode != NULL; pNode = pNode->mHashNext) {
+      VarStoreType = pNode->mVarStoreType;
+      if (VarStoreType == EFI_VFR_VARSTORE_BUFFER_BITS) {
+        VarStoreType = EFI_VFR_VARSTORE_BUFFER;
       }
-    }
-  }
-
-  for (pNode = mEfiVarStoreList; pNode != NULL; pNode = pNode->mNext) {
-    if (strcmp (pNode->mVarStoreName, StoreName) == 0) {
-      if (CheckGuidField(pNode, StoreGuid, &HasFoundOne, &ReturnCode)) {
-        *VarStoreId = mCurrVarStorageNode->mVarStoreId;
-        return ReturnCode;
+      if ((Pass == 0 && VarStoreType != EFI_VFR_VARSTORE_BUFFER) ||
+          (Pass == 1 && VarStoreType != EFI_VFR_VARSTORE_EFI) ||
+          (Pass == 2 && VarStoreType != EFI_VFR_VARSTORE_NAME)) {
+        continue;
       }
-    }
-  }
-
-  for (pNode = mNameVarStoreList; pNode != NULL; pNode = pNode->mNext) {
-    if (strcmp (pNode->mVarStoreName, StoreName) == 0) {
-      if (CheckGuidField(pNode, StoreGuid, &HasFoundOne, &ReturnCode)) {
-        *VarStoreId = mCurrVarStorageNode->mVarStoreId;
-        return ReturnCode;
+      if (strcmp (pNode->mVarStoreName, StoreName) == 0) {
+        if (CheckGuidField(pNode, StoreGuid, &HasFoundOne, &ReturnCode)) {
+          *VarStoreId = mCurrVarStorageNode->mVarStoreId;
+          return ReturnCode;
+        }
       }
     }
   }
@@ -2530,6 +2610,7 @@ SVfrRuleNode::SVfrRuleNode (
   }
 
   mNext       = NULL;
+  mHashNext   = NULL;
   mRuleId     = RuleId;
 }
 
@@ -2544,8 +2625,14 @@ SVfrRuleNode::~SVfrRuleNode (
 
 CVfrRulesDB::CVfrRulesDB ()
 {
+  UINT32 Index;
+
   mRuleList   = NULL;
   mFreeRuleId = EFI_VARSTORE_ID_START;
+
+  for (Index = 0; Index < VFR_HASH_TABLE_SIZE; Index++) {
+    mRuleHashTable[Index] = NULL;
+  }
 }
 
 CVfrRulesDB::~CVfrRulesDB ()
@@ -2565,6 +2652,7 @@ CVfrRulesDB::RegisterRule (
   )
 {
   SVfrRuleNode *pNew;
+  UINT32       Bucket;
 
   if (RuleName == NULL) {
     return ;
@@ -2578,6 +2666,10 @@ CVfrRulesDB::RegisterRule (
 
   pNew->mNext = mRuleList;
   mRuleList   = pNew;
+
+  Bucket                 = VfrHashName (RuleName);
+  pNew->mHashNext        = mRuleHashTable[Bucket];
+  mRuleHashTable[Bucket] = pNew;
 }
 
 UINT8
@@ -2591,7 +2683,7 @@ CVfrRulesDB::GetRuleId (
     return EFI_RULE_ID_INVALID;
   }
 
-  for (pNode = mRuleList; pNode != NULL; pNode = pNode->mNext) {
+  for (pNode = mRuleHashTable[VfrHashName (RuleName)]; pNode != NULL; pNode = pNode->mHashNext) {
     if (strcmp (pNode->mRuleName, RuleName) == 0) {
       return pNode->mRuleId;
     }
@@ -2754,6 +2846,10 @@ SVfrQuestionNode::SVfrQuestionNode (
   mBitMask    = BitMask;
   mNext       = NULL;
   mQtype      = QUESTION_NORMAL;
+  mNameNext   = NULL;
+  mVarIdNext  = NULL;
+  mIdNext     = NULL;
+  mSequence   = 0;
 
   if (Name == NULL) {
     mName = new CHAR8[strlen ("$DEFAULT") + 1];
@@ -2796,6 +2892,8 @@ CVfrQuestionDB::CVfrQuestionDB ()
   // Question ID 0 is reserved.
   mFreeQIdBitMap[0] = 0x80000000;
   mQuestionList     = NULL;
+
+  InitHashTable ();
 }
 
 CVfrQuestionDB::~CVfrQuestionDB ()
@@ -2833,6 +2931,85 @@ CVfrQuestionDB::ResetInit(
   // Question ID 0 is reserved.
   mFreeQIdBitMap[0] = 0x80000000;
   mQuestionList     = NULL;
+
+  InitHashTable ();
+}
+
+VOID
+CVfrQuestionDB::InitHashTable (
+  VOID
+  )
+{
+  UINT32 Index;
+
+  for (Index = 0; Index < VFR_HASH_TABLE_SIZE; Index++) {
+    mNameHashTable[Index]  = NULL;
+    mVarIdHashTable[Index] = NULL;
+    mIdHashTable[Index]    = NULL;
+  }
+  mQuestionSequence = 0;
+}
+
+VOID
+CVfrQuestionDB::AddQuestionIdHash (
+  IN SVfrQuestionNode *pNode
+  )
+{
+  UINT32 Bucket;
+
+  Bucket               = pNode->mQuestionId % VFR_HASH_TABLE_SIZE;
+  pNode->mIdNext       = mIdHashTable[Bucket];
+  mIdHashTable[Bucket] = pNode;
+}
+
+VOID
+CVfrQuestionDB::RemoveQuestionIdHash (
+  IN SVfrQuestionNode *pNode
+  )
+{
+  SVfrQuestionNode **pLink;
+
+  for (pLink = &mIdHashTable[pNode->mQuestionId % VFR_HASH_TABLE_SIZE]; *pLink != NULL; pLink = &(*pLink)->mIdNext) {
+    if (*pLink == pNode) {
+      *pLink = pNode->mIdNext;
+      pNode->mIdNext = NULL;
+      return;
+    }
+  }
+}
+
+/**
+  Add the question nodes just linked to the head of mQuestionList to the
+  hash tables.
+
+  The nodes are added from the last one, so that each bucket keeps the
+  order of mQuestionList.
+
+  @param  pNode    The question nodes in mQuestionList order.
+  @param  Count    The number of the question nodes.
+**/
+VOID
+CVfrQuestionDB::AddQuestionNodes (
+  IN SVfrQuestionNode **pNode,
+  IN UINT32           Count
+  )
+{
+  UINT32 Index;
+  UINT32 Bucket;
+
+  for (Index = Count; Index > 0; Index--) {
+    pNode[Index - 1]->mSequence = ++mQuestionSequence;
+
+    Bucket                          = VfrHashName (pNode[Index - 1]->mName);
+    pNode[Index - 1]->mNameNext     = mNameHashTable[Bucket];
+    mNameHashTable[Bucket]          = pNode[Index - 1];
+
+    Bucket                          = VfrHashName (pNode[Index - 1]->mVarIdStr);
+    pNode[Index - 1]->mVarIdNext    = mVarIdHashTable[Bucket];
+    mVarIdHashTable[Bucket]         = pNode[Index - 1];
+
+    AddQuestionIdHash (pNode[Index - 1]);
+  }
 }
 
 VOID
@@ -2880,6 +3057,7 @@ CVfrQuestionDB::RegisterQuestion (
 
   pNode->mNext       = mQuestionList;
   mQuestionList      = pNode;
+  AddQuestionNodes (&pNode, 1);
 
   gCFormPkg.DoPendingAssign (VarIdStr, (VOID *)&QuestionId, sizeof(EFI_QUESTION_ID));
 
@@ -2930,6 +3108,7 @@ CVfrQuestionDB::RegisterOldDateQuestion (
   pNode[1]->mNext       = pNode[2];
   pNode[2]->mNext       = mQuestionList;
   mQuestionList         = pNode[0];
+  AddQuestionNodes (pNode, 3);
 
   gCFormPkg.DoPendingAssign (YearVarId, (VOID *)&QuestionId, sizeof(EFI_QUESTION_ID));
   gCFormPkg.DoPendingAssign (MonthVarId, (VOID *)&QuestionId, sizeof(EFI_QUESTION_ID));
@@ -3037,6 +3216,7 @@ CVfrQuestionDB::RegisterNewDateQuestion (
   pNode[1]->mNext       = pNode[2];
   pNode[2]->mNext       = mQuestionList;
   mQuestionList         = pNode[0];
+  AddQuestionNodes (pNode, 3);
 
   for (Index = 0; Index < 3; Index++) {
     if (VarIdStr[Index] != NULL) {
@@ -3108,6 +3288,7 @@ CVfrQuestionDB::RegisterOldTimeQuestion (
   pNode[1]->mNext       = pNode[2];
   pNode[2]->mNext       = mQuestionList;
   mQuestionList         = pNode[0];
+  AddQuestionNodes (pNode, 3);
 
   gCFormPkg.DoPendingAssign (HourVarId, (VOID *)&QuestionId, sizeof(EFI_QUESTION_ID));
   gCFormPkg.DoPendingAssign (MinuteVarId, (VOID *)&QuestionId, sizeof(EFI_QUESTION_ID));
@@ -3215,6 +3396,7 @@ CVfrQuestionDB::RegisterNewTimeQuestion (
   pNode[1]->mNext       = pNode[2];
   pNode[2]->mNext       = mQuestionList;
   mQuestionList         = pNode[0];
+  AddQuestionNodes (pNode, 3);
 
   for (Index = 0; Index < 3; Index++) {
     if (VarIdStr[Index] != NULL) {
@@ -3341,6 +3523,7 @@ CVfrQuestionDB::RegisterRefQuestion (
   pNode[2]->mNext       = pNode[3];
   pNode[3]->mNext       = mQuestionList;
   mQuestionList         = pNode[0];
+  AddQuestionNodes (pNode, 4);
 
   gCFormPkg.DoPendingAssign (VarIdStr[0], (VOID *)&QuestionId, sizeof(EFI_QUESTION_ID));
   gCFormPkg.DoPendingAssign (VarIdStr[1], (VOID *)&QuestionId, sizeof(EFI_QUESTION_ID));
@@ -3368,6 +3551,7 @@ CVfrQuestionDB::UpdateQuestionId (
   )
 {
   SVfrQuestionNode *pNode = NULL;
+  SVfrQuestionNode *pTmp;
 
   if (QId == NewQId) {
     // don't update
@@ -3381,9 +3565,13 @@ CVfrQuestionDB::UpdateQuestionId (
     return VFR_RETURN_REDEFINED;
   }
 
-  for (pNode = mQuestionList; pNode != NULL; pNode = pNode->mNext) {
-    if (pNode->mQuestionId == QId) {
-      break;
+  //
+  // Update the first question of QId in mQuestionList, which is the one
+  // registered last.
+  //
+  for (pTmp = mIdHashTable[QId % VFR_HASH_TABLE_SIZE]; pTmp != NULL; pTmp = pTmp->mIdNext) {
+    if (pTmp->mQuestionId == QId && (pNode == NULL || pTmp->mSequence > pNode->mSequence)) {
+      pNode = pTmp;
     }
   }
 
@@ -3392,7 +3580,9 @@ CVfrQuestionDB::UpdateQuestionId (
   }
 
   MarkQuestionIdUnused (QId);
+  RemoveQuestionIdHash (pNode);
   pNode->mQuestionId = NewQId;
+  AddQuestionIdHash (pNode);
   MarkQuestionIdUsed (NewQId);
 
   gCFormPkg.DoPendingAssign (pNode->mVarIdStr, (VOID *)&NewQId, sizeof(EFI_QUESTION_ID));
@@ -3421,7 +3611,17 @@ CVfrQuestionDB::GetQuestionId (
     return ;
   }
 
-  for (pNode = mQuestionList; pNode != NULL; pNode = pNode->mNext) {
+  //
+  // The hash chains keep the order of mQuestionList, so the first match is
+  // still the question registered last.
+  //
+  if (VarIdStr != NULL) {
+    pNode = mVarIdHashTable[VfrHashName (VarIdStr)];
+  } else {
+    pNode = mNameHashTable[VfrHashName (Name)];
+  }
+
+  for (; pNode != NULL; pNode = (VarIdStr != NULL) ? pNode->mVarIdNext : pNode->mNameNext) {
     if (Name != NULL) {
       if (strcmp (pNode->mName, Name) != 0) {
         continue;
@@ -3456,7 +3656,7 @@ CVfrQuestionDB::FindQuestion (
     return VFR_RETURN_INVALID_PARAMETER;
   }
 
-  for (pNode = mQuestionList; pNode != NULL; pNode = pNode->mNext) {
+  for (pNode = mIdHashTable[QuestionId % VFR_HASH_TABLE_SIZE]; pNode != NULL; pNode = pNode->mIdNext) {
     if (pNode->mQuestionId == QuestionId) {
       return VFR_RETURN_SUCCESS;
     }
@@ -3476,7 +3676,7 @@ CVfrQuestionDB::FindQuestion (
     return VFR_RETURN_FATAL_ERROR;
   }
 
-  for (pNode = mQuestionList; pNode != NULL; pNode = pNode->mNext) {
+  for (pNode = mNameHashTable[VfrHashName (Name)]; pNode != NULL; pNode = pNode->mNameNext) {
     if (strcmp (pNode->mName, Name) == 0) {
       return VFR_RETURN_SUCCESS;
     }
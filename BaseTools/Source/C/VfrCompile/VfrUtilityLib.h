@@ -37,6 +37,11 @@ static EFI_GUID gEdkiiIfrBitVarGuid = EDKII_IFR_BIT_VARSTORE_GUID;
 #define BUFFER_SAFE_FREE(Buf)              do { if ((Buf) != NULL) { delete (Buf); } } while (0);
 #define ARRAY_SAFE_FREE(Buf)               do { if ((Buf) != NULL) { delete[] (Buf); } } while (0);
 
+//
+// Bucket number of the hash tables indexing the symbol lists by name or ID.
+//
+#define VFR_HASH_TABLE_SIZE                0x400
+
 
 class CVfrBinaryOutput {
 public:
@@ -63,11 +68,14 @@ private:
   SConfigInfo& operator= (IN CONST SConfigInfo&);  // Prevent assignment
 };
 
+#define EFI_CONFIG_OFFSET_BITMAP_SIZE      ((0xFFFF + 1) / EFI_BITS_PER_UINT32)
+
 struct SConfigItem {
   CHAR8         *mName;         // varstore name
   EFI_GUID      *mGuid;         // varstore guid, varstore name + guid deside one varstore
   CHAR8         *mId;           // default ID
   SConfigInfo   *mInfoStrList;  // list of Offset/Value in the varstore
+  UINT32        *mOffsetBitMap; // offsets in mInfoStrList, built on the first lookup
   SConfigItem   *mNext;
 
 public:
@@ -132,6 +140,7 @@ struct SVfrDataType {
   BOOLEAN                   mHasBitField;
   SVfrDataField             *mMembers;
   SVfrDataType              *mNext;
+  SVfrDataType              *mHashNext;
 };
 
 #define VFR_PACK_ASSIGN     0x01
@@ -191,6 +200,7 @@ public:
 
 private:
   SVfrDataType              *mDataTypeList;
+  SVfrDataType              *mDataTypeHashTable[VFR_HASH_TABLE_SIZE];
 
   SVfrDataType              *mNewDataType;
   SVfrDataType              *mCurrDataType;
@@ -257,6 +267,7 @@ struct SVfrVarStorageNode {
   EFI_VARSTORE_ID           mVarStoreId;
   BOOLEAN                   mAssignedFlag; //Create varstore opcode
   struct SVfrVarStorageNode *mNext;
+  struct SVfrVarStorageNode *mHashNext;
 
   EFI_VFR_VARSTORE_TYPE     mVarStoreType;
   union {
@@ -321,6 +332,7 @@ private:
   struct SVfrVarStorageNode *mBufferVarStoreList;
   struct SVfrVarStorageNode *mEfiVarStoreList;
   struct SVfrVarStorageNode *mNameVarStoreList;
+  struct SVfrVarStorageNode *mVarStoreHashTable[VFR_HASH_TABLE_SIZE];
 
   struct SVfrVarStorageNode *mCurrVarStorageNode;
   struct SVfrVarStorageNode *mNewVarStorageNode;
@@ -337,6 +349,7 @@ private:
                                   IN EFI_GUID *,
                                   IN BOOLEAN *,
                                   OUT EFI_VFR_RETURN_CODE *);
+  VOID            RegisterVarStoreName (IN SVfrVarStorageNode *);
 
 public:
   CVfrDataStorage ();
@@ -394,6 +407,16 @@ struct SVfrQuestionNode {
   SVfrQuestionNode          *mNext;
   EFI_QUESION_TYPE          mQtype;
 
+  //
+  // Hash chains by name, by variable ID string and by question ID. The
+  // sequence number gives the order of the node in mNext list, which the
+  // question ID chain does not keep after UpdateQuestionId.
+  //
+  SVfrQuestionNode          *mNameNext;
+  SVfrQuestionNode          *mVarIdNext;
+  SVfrQuestionNode          *mIdNext;
+  UINT32                    mSequence;
+
   SVfrQuestionNode (IN CHAR8 *, IN CHAR8 *, IN UINT32 BitMask = 0);
   ~SVfrQuestionNode ();
 
@@ -406,9 +429,17 @@ class CVfrQuestionDB {
 private:
   SVfrQuestionNode          *mQuestionList;
   UINT32                    mFreeQIdBitMap[EFI_FREE_QUESTION_ID_BITMAP_SIZE];
+  SVfrQuestionNode          *mNameHashTable[VFR_HASH_TABLE_SIZE];
+  SVfrQuestionNode          *mVarIdHashTable[VFR_HASH_TABLE_SIZE];
+  SVfrQuestionNode          *mIdHashTable[VFR_HASH_TABLE_SIZE];
+  UINT32                    mQuestionSequence;
 
 private:
   EFI_QUESTION_ID GetFreeQuestionId (VOID);
+  VOID            InitHashTable (VOID);
+  VOID            AddQuestionNodes (IN SVfrQuestionNode **, IN UINT32);
+  VOID            RemoveQuestionIdHash (IN SVfrQuestionNode *);
+  VOID            AddQuestionIdHash (IN SVfrQuestionNode *);
   BOOLEAN         ChekQuestionIdFree (IN EFI_QUESTION_ID);
   VOID            MarkQuestionIdUsed (IN EFI_QUESTION_ID);
   VOID            MarkQuestionIdUnused (IN EFI_QUESTION_ID);
@@ -483,6 +514,7 @@ struct SVfrRuleNode {
   UINT8                     mRuleId;
   CHAR8                     *mRuleName;
   SVfrRuleNode              *mNext;
+  SVfrRuleNode              *mHashNext;
 
   SVfrRuleNode(IN CHAR8 *, IN UINT8);
   ~SVfrRuleNode();
@@ -495,6 +527,7 @@ private:
 class CVfrRulesDB {
 private:
   SVfrRuleNode              *mRuleList;
+  SVfrRuleNode              *mRuleHashTable[VFR_HASH_TABLE_SIZE];
   UINT8                     mFreeRuleId;
 
 public:
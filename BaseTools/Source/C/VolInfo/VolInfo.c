@@ -19,8 +19,13 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <assert.h>
 #ifdef __GNUC__
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
 #else
 #include <direct.h>
+#include <windows.h>
 #endif
 
 #include <FvLib.h>
@@ -43,12 +48,19 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include "StringFuncs.h"
 #include "ParseInf.h"
 #include "PeCoffLib.h"
+#include "../LzmaCompress/Sdk/C/LzmaDec.h"
+#include "../LzmaCompress/Sdk/C/Bra.h"
+#include "../LzmaCompress/Sdk/C/CpuArch.h"
 
 //
 // Utility global variables
 //
 
 EFI_GUID  gEfiCrc32GuidedSectionExtractionProtocolGuid = EFI_CRC32_GUIDED_SECTION_EXTRACTION_PROTOCOL_GUID;
+EFI_GUID  gTianoCustomDecompressGuid = TIANO_CUSTOM_DECOMPRESS_GUID;
+EFI_GUID  gLzmaCustomDecompressGuid = LZMA_CUSTOM_DECOMPRESS_GUID;
+EFI_GUID  gLzmaF86CustomDecompressGuid = LZMAF86_CUSTOM_DECOMPRESS_GUID;
+EFI_GUID  gLzmaMultiBlockCustomDecompressGuid = LZMA_MULTI_BLOCK_CUSTOM_DECOMPRESS_GUID;
 
 #define UTILITY_MAJOR_VERSION      1
 #define UTILITY_MINOR_VERSION      0
@@ -59,6 +71,8 @@ EFI_GUID  gEfiCrc32GuidedSectionExtractionProtocolGuid = EFI_CRC32_GUIDED_SECTIO
 
 #define MAX_BASENAME_LEN  60  // not good to hardcode, but let's be reasonable
 
+#define JSON_MAX_DEPTH    128
+
 //
 // Structure to keep a list of guid-to-basenames
 //
@@ -80,6 +94,26 @@ CHAR8* mUtilityFilename = NULL;
 BOOLEAN EnableHash = FALSE;
 CHAR8 *OpenSslPath = NULL;
 
+//
+// Only this file of the top level FV is dumped, if --file is given
+//
+STATIC EFI_GUID mDumpFileNameBuffer;
+STATIC EFI_GUID *mDumpFileName = NULL;
+
+//
+// JSON dump of the FV, written along with the text output if --json is given
+//
+STATIC FILE     *mJsonFile = NULL;
+STATIC UINTN    mJsonDepth = 0;
+STATIC BOOLEAN  mJsonEmpty[JSON_MAX_DEPTH];
+STATIC CHAR8    mJsonClose[JSON_MAX_DEPTH];
+
+//
+// Time spent indexing FVs and decoding sections, in microseconds
+//
+STATIC UINT64   mIndexTime = 0;
+STATIC UINT64   mDecodeTime = 0;
+
 EFI_STATUS
 ParseGuidBaseNameFile (
   CHAR8    *FileName
@@ -110,7 +144,8 @@ DumpDepexSection (
 STATIC
 EFI_STATUS
 ReadHeader (
-  IN FILE       *InputFile,
+  IN UINT8      *Image,
+  IN UINTN      ImageSize,
   OUT UINT32    *FvSize,
   OUT BOOLEAN   *ErasePolarity
   );
@@ -120,7 +155,8 @@ EFI_STATUS
 PrintFileInfo (
   EFI_FIRMWARE_VOLUME_HEADER  *FvImage,
   EFI_FFS_FILE_HEADER         *FileHeader,
-  BOOLEAN                     ErasePolarity
+  BOOLEAN                     ErasePolarity,
+  FV_BUF_INDEX                *Index
   );
 
 static
@@ -136,6 +172,73 @@ LoadGuidedSectionToolsTxt (
   IN CHAR8* FirmwareVolumeFilename
   );
 
+STATIC
+EFI_STATUS
+MapInputFile (
+  IN  CHAR8    *FileName,
+  OUT UINT8    **Image,
+  OUT UINTN    *ImageSize,
+  OUT BOOLEAN  *Mapped
+  );
+
+STATIC
+VOID
+UnmapInputFile (
+  IN UINT8    *Image,
+  IN UINTN    ImageSize,
+  IN BOOLEAN  Mapped
+  );
+
+STATIC
+UINT64
+GetTimeInMicroseconds (
+  VOID
+  );
+
+STATIC
+VOID
+JsonBegin (
+  IN CHAR8  *Name,
+  IN CHAR8  Open
+  );
+
+STATIC
+VOID
+JsonEnd (
+  VOID
+  );
+
+STATIC
+VOID
+JsonString (
+  IN CHAR8  *Name,
+  IN CHAR8  *Value
+  );
+
+STATIC
+VOID
+JsonNumber (
+  IN CHAR8   *Name,
+  IN UINT64  Value
+  );
+
+STATIC
+VOID
+JsonGuid (
+  IN CHAR8     *Name,
+  IN EFI_GUID  *Guid
+  );
+
+STATIC
+EFI_STATUS
+ExtractGuidedSection (
+  IN  EFI_GUID  *SectionGuid,
+  IN  UINT8     *Data,
+  IN  UINT32    DataLength,
+  OUT UINT8     **Output,
+  OUT UINT32    *OutputLength
+  );
+
 EFI_STATUS
 CombinePath (
   IN  CHAR8* DefaultPath,
@@ -229,8 +332,10 @@ Returns:
 
 --*/
 {
-  FILE                        *InputFile;
-  int                         BytesRead;
+  UINT8                       *InputImage;
+  UINTN                       InputSize;
+  UINTN                       AvailableSize;
+  BOOLEAN                     Mapped;
   EFI_FIRMWARE_VOLUME_HEADER  *FvImage;
   UINT32                      FvSize;
   EFI_STATUS                  Status;
@@ -239,6 +344,10 @@ Returns:
   UINT64                      LogLevel;
   CHAR8                       *OpenSslEnv;
   CHAR8                       *OpenSslCommand;
+  CHAR8                       *JsonFileName;
+  UINT64                      StartTime;
+  UINT64                      MapTime;
+  UINT64                      ParseTime;
 
   SetUtilityName (UTILITY_NAME);
   //
@@ -260,6 +369,7 @@ Returns:
   argv++;
   LogLevel = 0;
   Offset = 0;
+  JsonFileName = NULL;
 
   //
   // Look for help options
@@ -350,6 +460,28 @@ Returns:
       continue;
     }
 
+    if (stricmp (argv[0], "--json") == 0) {
+      if (argc < 2) {
+        Error (NULL, 0, 1003, "Invalid option value", "Missing file name for %s", argv[0]);
+        return GetUtilityStatus ();
+      }
+      JsonFileName = argv[1];
+      argc -= 2;
+      argv += 2;
+      continue;
+    }
+
+    if (stricmp (argv[0], "--file") == 0) {
+      if ((argc < 2) || (StringToGuid (argv[1], &mDumpFileNameBuffer) != EFI_SUCCESS)) {
+        Error (NULL, 0, 1003, "Invalid option value", "%s requires a file GUID", argv[0]);
+        return GetUtilityStatus ();
+      }
+      mDumpFileName = &mDumpFileNameBuffer;
+      argc -= 2;
+      argv += 2;
+      continue;
+    }
+
     if ((stricmp (argv[0], "-v") == 0) || (stricmp (argv[0], "--verbose") == 0)) {
       SetPrintLevel (VERBOSE_LOG_LEVEL);
       argc --;
@@ -387,62 +519,85 @@ Returns:
   }
 
   //
-  // Open the file containing the FV
+  // Map the file containing the FV, which is then parsed in place
   //
   if (mUtilityFilename == NULL) {
     Error (NULL, 0, 1001, "Missing option", "Input files are not specified");
     return GetUtilityStatus ();
   }
-  InputFile = fopen (LongFilePath (mUtilityFilename), "rb");
-  if (InputFile == NULL) {
+  StartTime = GetTimeInMicroseconds ();
+  Status = MapInputFile (mUtilityFilename, &InputImage, &InputSize, &Mapped);
+  if (EFI_ERROR (Status)) {
     Error (NULL, 0, 0001, "Error opening the input file", mUtilityFilename);
     return GetUtilityStatus ();
   }
+  MapTime = GetTimeInMicroseconds () - StartTime;
   //
   // Skip over pad bytes if specified. This is used if they prepend 0xff
   // data to the FV image binary.
   //
-  if (Offset != 0) {
-    fseek (InputFile, Offset, SEEK_SET);
+  AvailableSize = 0;
+  if ((Offset >= 0) && ((UINTN) Offset <= InputSize)) {
+    AvailableSize = InputSize - Offset;
   }
+  FvImage = (EFI_FIRMWARE_VOLUME_HEADER *) (InputImage + (InputSize - AvailableSize));
   //
   // Determine size of FV
   //
-  Status = ReadHeader (InputFile, &FvSize, &ErasePolarity);
+  Status = ReadHeader ((UINT8 *) FvImage, AvailableSize, &FvSize, &ErasePolarity);
   if (EFI_ERROR (Status)) {
     Error (NULL, 0, 0003, "error parsing FV image", "%s Header is invalid", mUtilityFilename);
-    fclose (InputFile);
+    UnmapInputFile (InputImage, InputSize, Mapped);
     return GetUtilityStatus ();
   }
-  //
-  // Allocate a buffer for the FV image
-  //
-  FvImage = malloc (FvSize);
-  if (FvImage == NULL) {
-    Error (NULL, 0, 4001, "Resource: Memory can't be allocated", NULL);
-    fclose (InputFile);
-    return GetUtilityStatus ();
-  }
-  //
-  // Seek to the start of the image, then read the entire FV to the buffer
-  //
-  fseek (InputFile, Offset, SEEK_SET);
-  BytesRead = fread (FvImage, 1, FvSize, InputFile);
-  fclose (InputFile);
-  if ((unsigned int) BytesRead != FvSize) {
+  if (FvSize > AvailableSize) {
     Error (NULL, 0, 0004, "error reading FvImage from", mUtilityFilename);
-    free (FvImage);
+    UnmapInputFile (InputImage, InputSize, Mapped);
     return GetUtilityStatus ();
   }
 
+  if (JsonFileName != NULL) {
+    mJsonFile = fopen (LongFilePath (JsonFileName), "w");
+    if (mJsonFile == NULL) {
+      Error (NULL, 0, 0001, "Error opening file", JsonFileName);
+      UnmapInputFile (InputImage, InputSize, Mapped);
+      return GetUtilityStatus ();
+    }
+    JsonBegin (NULL, '{');
+    JsonString ("Image", mUtilityFilename);
+    JsonNumber ("Offset", InputSize - AvailableSize);
+    JsonBegin ("FirmwareVolume", '{');
+  }
+
   LoadGuidedSectionToolsTxt (mUtilityFilename);
 
+  ParseTime = GetTimeInMicroseconds ();
   PrintFvInfo (FvImage, FALSE);
+  ParseTime = GetTimeInMicroseconds () - ParseTime;
+
+  if (mJsonFile != NULL) {
+    //
+    // Close what a parse error left open, then add the timing and the status
+    //
+    while (mJsonDepth > 1) {
+      JsonEnd ();
+    }
+    JsonBegin ("Timing", '{');
+    JsonNumber ("MapMicroseconds", MapTime);
+    JsonNumber ("IndexMicroseconds", mIndexTime);
+    JsonNumber ("DecodeMicroseconds", mDecodeTime);
+    JsonNumber ("ParseMicroseconds", ParseTime);
+    JsonNumber ("TotalMicroseconds", GetTimeInMicroseconds () - StartTime);
+    JsonEnd ();
+    JsonNumber ("Status", GetUtilityStatus ());
+    JsonEnd ();
+    fclose (mJsonFile);
+  }
 
   //
   // Clean up
   //
-  free (FvImage);
+  UnmapInputFile (InputImage, InputSize, Mapped);
   FreeGuidBaseNameList ();
   return GetUtilityStatus ();
 }
@@ -476,7 +631,10 @@ Returns:
   BOOLEAN                     ErasePolarity;
   UINTN                       FvSize;
   EFI_FFS_FILE_HEADER         *CurrentFile;
-  UINTN                       Key;
+  EFI_FFS_FILE_HEADER         *DumpFile;
+  FV_BUF_INDEX                *Index;
+  UINTN                       FileIndex;
+  UINT64                      StartTime;
 
   Status = FvBufGetSize (Fv, &FvSize);
 
@@ -486,43 +644,70 @@ Returns:
       TRUE : FALSE;
 
   //
-  // Get the first file
+  // Index the files and their sections in one pass over the FV
   //
-  Key = 0;
-  Status = FvBufFindNextFile (Fv, &Key, (VOID **) &CurrentFile);
+  StartTime = GetTimeInMicroseconds ();
+  Status = FvBufCreateIndex (Fv, &Index);
+  mIndexTime += GetTimeInMicroseconds () - StartTime;
   if (EFI_ERROR (Status)) {
+    Error (NULL, 0, 0003, "error parsing FV image", "cannot index the files in the FV image");
+    return GetUtilityStatus ();
+  }
+  if (Index->FileCount == 0) {
+    FvBufFreeIndex (Index);
     Error (NULL, 0, 0003, "error parsing FV image", "cannot find the first file in the FV image");
     return GetUtilityStatus ();
   }
+
+  //
+  // Only the file given by --file is displayed from the top level FV
+  //
+  DumpFile = NULL;
+  if (!IsChildFv && (mDumpFileName != NULL)) {
+    Status = FvBufIndexFindFileByName (Index, mDumpFileName, (VOID **) &DumpFile);
+    if (EFI_ERROR (Status)) {
+      FvBufFreeIndex (Index);
+      Error (NULL, 0, 0003, "error parsing FV image", "cannot find the file given by --file in the FV image");
+      return GetUtilityStatus ();
+    }
+  }
+
+  JsonNumber ("Size", FvSize);
+  JsonNumber ("Attributes", ((EFI_FIRMWARE_VOLUME_HEADER*)Fv)->Attributes);
+  JsonGuid ("FileSystemGuid", &((EFI_FIRMWARE_VOLUME_HEADER*)Fv)->FileSystemGuid);
+  JsonBegin ("Files", '[');
+
   //
   // Display information about files found
   //
-  while (CurrentFile != NULL) {
+  for (FileIndex = 0; FileIndex < Index->FileCount; FileIndex++) {
+    CurrentFile = Index->Files[FileIndex].File;
+
     //
     // Increment the number of files counter
     //
     NumberOfFiles++;
 
+    if ((DumpFile != NULL) && (CurrentFile != DumpFile)) {
+      continue;
+    }
+
     //
     // Display info about this file
     //
-    Status = PrintFileInfo (Fv, CurrentFile, ErasePolarity);
+    JsonBegin (NULL, '{');
+    Status = PrintFileInfo (Fv, CurrentFile, ErasePolarity, Index);
     if (EFI_ERROR (Status)) {
+      FvBufFreeIndex (Index);
       Error (NULL, 0, 0003, "error parsing FV image", "failed to parse a file in the FV");
       return GetUtilityStatus ();
     }
-    //
-    // Get the next file
-    //
-    Status = FvBufFindNextFile (Fv, &Key, (VOID **) &CurrentFile);
-    if (Status == EFI_NOT_FOUND) {
-      CurrentFile = NULL;
-    } else if (EFI_ERROR (Status)) {
-      Error (NULL, 0, 0003, "error parsing FV image", "cannot find the next file in the FV image");
-      return GetUtilityStatus ();
-    }
+    JsonEnd ();
   }
 
+  JsonEnd ();
+  FvBufFreeIndex (Index);
+
   if (IsChildFv) {
     printf ("There are a total of %d files in the child FV\n", (int) NumberOfFiles);
   } else {
@@ -727,7 +912,8 @@ Returns:
 STATIC
 EFI_STATUS
 ReadHeader (
-  IN FILE       *InputFile,
+  IN UINT8      *Image,
+  IN UINTN      ImageSize,
   OUT UINT32    *FvSize,
   OUT BOOLEAN   *ErasePolarity
   )
@@ -740,7 +926,8 @@ Routine Description:
 
 Arguments:
 
-  InputFile       The file that contains the FV image.
+  Image           The FV image, in memory.
+  ImageSize       The size of the memory holding the FV image.
   FvSize          The size of the FV.
   ErasePolarity   The FV erase polarity.
 
@@ -763,14 +950,18 @@ Returns:
   //
   // Check input parameters
   //
-  if (InputFile == NULL || FvSize == NULL || ErasePolarity == NULL) {
+  if (Image == NULL || FvSize == NULL || ErasePolarity == NULL) {
     Error (__FILE__, __LINE__, 0, "application error", "invalid parameter to function");
     return EFI_INVALID_PARAMETER;
   }
   //
   // Read the header
   //
-  fread (&VolumeHeader, sizeof (EFI_FIRMWARE_VOLUME_HEADER) - sizeof (EFI_FV_BLOCK_MAP_ENTRY), 1, InputFile);
+  if (ImageSize < sizeof (EFI_FIRMWARE_VOLUME_HEADER) - sizeof (EFI_FV_BLOCK_MAP_ENTRY)) {
+    printf ("ERROR: Image is too small for a FV header!\n");
+    return EFI_ABORTED;
+  }
+  memcpy (&VolumeHeader, Image, sizeof (EFI_FIRMWARE_VOLUME_HEADER) - sizeof (EFI_FV_BLOCK_MAP_ENTRY));
   BytesRead     = sizeof (EFI_FIRMWARE_VOLUME_HEADER) - sizeof (EFI_FV_BLOCK_MAP_ENTRY);
   Signature[0]  = VolumeHeader.Signature;
   Signature[1]  = 0;
@@ -1059,7 +1250,11 @@ Returns:
   printf ("Revision:              0x%04X\n", VolumeHeader.Revision);
 
   do {
-    fread (&BlockMap, sizeof (EFI_FV_BLOCK_MAP_ENTRY), 1, InputFile);
+    if (ImageSize - BytesRead < sizeof (EFI_FV_BLOCK_MAP_ENTRY)) {
+      printf ("ERROR: Block Maps run past the end of the image!\n");
+      return EFI_ABORTED;
+    }
+    memcpy (&BlockMap, Image + BytesRead, sizeof (EFI_FV_BLOCK_MAP_ENTRY));
     BytesRead += sizeof (EFI_FV_BLOCK_MAP_ENTRY);
 
     if (BlockMap.NumBlocks != 0) {
@@ -1084,9 +1279,6 @@ Returns:
 
   *FvSize = Size;
 
-  //
-  // rewind (InputFile);
-  //
   return EFI_SUCCESS;
 }
 
@@ -1095,7 +1287,8 @@ EFI_STATUS
 PrintFileInfo (
   EFI_FIRMWARE_VOLUME_HEADER  *FvImage,
   EFI_FFS_FILE_HEADER         *FileHeader,
-  BOOLEAN                     ErasePolarity
+  BOOLEAN                     ErasePolarity,
+  FV_BUF_INDEX                *Index
   )
 /*++
 
@@ -1108,6 +1301,7 @@ Arguments:
   FvImage       - GC_TODO: add argument description
   FileHeader    - GC_TODO: add argument description
   ErasePolarity - GC_TODO: add argument description
+  Index         - Index of the files and sections of FvImage
 
 Returns:
 
@@ -1123,6 +1317,8 @@ Returns:
   EFI_STATUS          Status;
   UINT8               GuidBuffer[PRINTED_GUID_BUFFER_SIZE];
   UINT32              HeaderSize;
+  EFI_USER_INTERFACE_SECTION *UiSection;
+  CHAR8               *UiName;
 #if (PI_SPECIFICATION_VERSION < 0x00010000)
   UINT16              *Tail;
 #endif
@@ -1160,6 +1356,13 @@ Returns:
   printf ("File Attributes:  0x%02X\n", FileHeader->Attributes);
   printf ("File State:       0x%02X\n", FileHeader->State);
 
+  JsonGuid ("Name", &FileHeader->Name);
+  JsonNumber ("Offset", (UINTN) FileHeader - (UINTN) FvImage);
+  JsonNumber ("Size", FileLength);
+  JsonNumber ("Attributes", FileHeader->Attributes);
+  JsonNumber ("State", FileHeader->State);
+  JsonNumber ("Type", FileHeader->Type);
+
   //
   // Print file state
   //
@@ -1322,6 +1525,21 @@ Returns:
     break;
   }
 
+  //
+  // The JSON dump gives the name of the file from its UI section
+  //
+  if ((mJsonFile != NULL) &&
+      !EFI_ERROR (FvBufIndexFindSectionByType (Index, FileHeader, EFI_SECTION_USER_INTERFACE, (VOID **) &UiSection))) {
+    UiName = (CHAR8 *) malloc (UnicodeStrLen (UiSection->FileNameString) + 1);
+    if (UiName == NULL) {
+      Error (NULL, 0, 4001, "Resource", "memory cannot be allocated!");
+      return EFI_OUT_OF_RESOURCES;
+    }
+    Unicode2AsciiString (UiSection->FileNameString, UiName);
+    JsonString ("UiName", UiName);
+    free (UiName);
+  }
+
   switch (FileHeader->Type) {
 
   case EFI_FV_FILETYPE_ALL:
@@ -1333,6 +1551,7 @@ Returns:
     //
     // All other files have sections
     //
+    JsonBegin ("Sections", '[');
     Status = ParseSection (
               (UINT8 *) ((UINTN) FileHeader + HeaderSize),
               FvBufGetFfsFileSize (FileHeader) - HeaderSize
@@ -1343,6 +1562,7 @@ Returns:
       //
       return EFI_ABORTED;
     }
+    JsonEnd ();
     break;
   }
 
@@ -1681,6 +1901,7 @@ Returns:
   CHAR8               *ToolInputFileName;
   CHAR8               *ToolOutputFileName;
   CHAR8               *UIFileName;
+  UINT64              DecodeTime;
 
   ParsedLength = 0;
   ToolInputFileName = NULL;
@@ -1709,11 +1930,14 @@ Returns:
     SectionHeaderLen = GetSectionHeaderLength((EFI_COMMON_SECTION_HEADER *)Ptr);
 
     SectionName = SectionNameToStr (Type);
+    JsonBegin (NULL, '{');
     if (SectionName != NULL) {
       printf ("------------------------------------------------------------\n");
       printf ("  Type:  %s\n  Size:  0x%08X\n", SectionName, (unsigned) SectionLength);
+      JsonString ("Type", SectionName);
       free (SectionName);
     }
+    JsonNumber ("Size", SectionLength);
 
     switch (Type) {
     case EFI_SECTION_RAW:
@@ -1796,15 +2020,18 @@ Returns:
       }
       Unicode2AsciiString (((EFI_USER_INTERFACE_SECTION *) Ptr)->FileNameString, UIFileName);
       printf ("  String: %s\n", UIFileName);
+      JsonString ("String", UIFileName);
       free (UIFileName);
       break;
 
     case EFI_SECTION_FIRMWARE_VOLUME_IMAGE:
+      JsonBegin ("FirmwareVolume", '{');
       Status = PrintFvInfo (Ptr + SectionHeaderLen, TRUE);
       if (EFI_ERROR (Status)) {
         Error (NULL, 0, 0003, "printing of FV section contents failed", NULL);
         return EFI_SECTION_ERROR;
       }
+      JsonEnd ();
       break;
 
     case EFI_SECTION_COMPATIBILITY16:
@@ -1823,6 +2050,7 @@ Returns:
     case EFI_SECTION_VERSION:
       printf ("  Build Number:  0x%02X\n", *(UINT16 *)(Ptr + SectionHeaderLen));
       printf ("  Version Strg:  %s\n", (char*) (Ptr + SectionHeaderLen + sizeof (UINT16)));
+      JsonNumber ("BuildNumber", *(UINT16 *)(Ptr + SectionHeaderLen));
       break;
 
     case EFI_SECTION_COMPRESSION:
@@ -1838,9 +2066,11 @@ Returns:
       }
       CompressedLength    = SectionLength - RealHdrLen;
       printf ("  Uncompressed Length:  0x%08X\n", (unsigned) UncompressedLength);
+      JsonNumber ("UncompressedLength", UncompressedLength);
 
       if (CompressionType == EFI_NOT_COMPRESSED) {
         printf ("  Compression Type:  EFI_NOT_COMPRESSED\n");
+        JsonString ("CompressionType", "EFI_NOT_COMPRESSED");
         if (CompressedLength != UncompressedLength) {
           Error (
             NULL,
@@ -1857,8 +2087,10 @@ Returns:
         GetInfoFunction     = EfiGetInfo;
         DecompressFunction  = EfiDecompress;
         printf ("  Compression Type:  EFI_STANDARD_COMPRESSION\n");
+        JsonString ("CompressionType", "EFI_STANDARD_COMPRESSION");
 
         CompressedBuffer  = Ptr + RealHdrLen;
+        DecodeTime        = GetTimeInMicroseconds ();
 
         Status            = GetInfoFunction (CompressedBuffer, CompressedLength, &DstSize, &ScratchSize);
         if (EFI_ERROR (Status)) {
@@ -1896,11 +2128,15 @@ Returns:
           free (UncompressedBuffer);
           return EFI_SECTION_ERROR;
         }
+        DecodeTime   = GetTimeInMicroseconds () - DecodeTime;
+        mDecodeTime += DecodeTime;
+        JsonNumber ("DecodeMicroseconds", DecodeTime);
       } else {
         Error (NULL, 0, 0003, "unrecognized compression type", "type 0x%X", CompressionType);
         return EFI_SECTION_ERROR;
       }
 
+      JsonBegin ("Sections", '[');
       Status = ParseSection (UncompressedBuffer, UncompressedLength);
 
       if (CompressionType == EFI_STANDARD_COMPRESSION) {
@@ -1914,6 +2150,7 @@ Returns:
         Error (NULL, 0, 0003, "failed to parse section", NULL);
         return EFI_SECTION_ERROR;
       }
+      JsonEnd ();
       break;
 
     case EFI_SECTION_GUID_DEFINED:
@@ -1931,14 +2168,58 @@ Returns:
       printf ("\n");
       printf ("  DataOffset:             0x%04X\n", (unsigned) DataOffset);
       printf ("  Attributes:             0x%04X\n", (unsigned) Attributes);
+      JsonGuid ("SectionDefinitionGuid", EfiGuid);
+      JsonNumber ("DataOffset", DataOffset);
+      JsonNumber ("Attributes", Attributes);
 
-      ExtractionTool =
-        LookupGuidedSectionToolPath (
-          mParsedGuidedSectionTools,
-          EfiGuid
-          );
+      if (DataOffset > SectionLength) {
+        Error (NULL, 0, 0003, "Error parsing section", "DataOffset of the GUIDed section is beyond the end of the section");
+        return EFI_SECTION_ERROR;
+      }
+
+      //
+      // The sections compressed by the tools of BaseTools are decoded in
+      // process; the tool GuidedSectionTools.txt gives is run for the others.
+      //
+      DecodeTime = GetTimeInMicroseconds ();
+      Status = ExtractGuidedSection (
+                 EfiGuid,
+                 Ptr + DataOffset,
+                 SectionLength - DataOffset,
+                 &ToolOutputBuffer,
+                 &ToolOutputLength
+                 );
+      ExtractionTool = NULL;
+      if (Status == EFI_UNSUPPORTED) {
+        ExtractionTool =
+          LookupGuidedSectionToolPath (
+            mParsedGuidedSectionTools,
+            EfiGuid
+            );
+      }
 
-      if (ExtractionTool != NULL) {
+      if (Status != EFI_UNSUPPORTED) {
+        if (EFI_ERROR (Status)) {
+          Error (NULL, 0, 0003, "decompress failed", "GUIDed section cannot be decoded");
+          return EFI_SECTION_ERROR;
+        }
+        DecodeTime   = GetTimeInMicroseconds () - DecodeTime;
+        mDecodeTime += DecodeTime;
+        JsonString ("Decoder", "internal");
+        JsonNumber ("DecodeMicroseconds", DecodeTime);
+
+        JsonBegin ("Sections", '[');
+        Status = ParseSection (
+                  ToolOutputBuffer,
+                  ToolOutputLength
+                  );
+        free (ToolOutputBuffer);
+        if (EFI_ERROR (Status)) {
+          Error (NULL, 0, 0003, "parse of decoded GUIDED section failed", NULL);
+          return EFI_SECTION_ERROR;
+        }
+        JsonEnd ();
+      } else if (ExtractionTool != NULL) {
        #ifndef __GNUC__
         ToolInputFile = CloneString (tmpnam (NULL));
         ToolOutputFile = CloneString (tmpnam (NULL));
@@ -1998,8 +2279,8 @@ Returns:
         Status =
           PutFileImage (
             ToolInputFile,
-            (CHAR8*) SectionBuffer + DataOffset,
-            BufferLength - DataOffset
+            (CHAR8*) Ptr + DataOffset,
+            SectionLength - DataOffset
             );
 
         system (SystemCommand);
@@ -2019,15 +2300,22 @@ Returns:
           Error (NULL, 0, 0004, "unable to read decoded GUIDED section", NULL);
           return EFI_SECTION_ERROR;
         }
+        DecodeTime   = GetTimeInMicroseconds () - DecodeTime;
+        mDecodeTime += DecodeTime;
+        JsonString ("Decoder", "external");
+        JsonNumber ("DecodeMicroseconds", DecodeTime);
 
+        JsonBegin ("Sections", '[');
         Status = ParseSection (
                   ToolOutputBuffer,
                   ToolOutputLength
                   );
+        free (ToolOutputBuffer);
         if (EFI_ERROR (Status)) {
           Error (NULL, 0, 0003, "parse of decoded GUIDED section failed", NULL);
           return EFI_SECTION_ERROR;
         }
+        JsonEnd ();
 
       //
       // Check for CRC32 sections which we can handle internally if needed.
@@ -2040,14 +2328,16 @@ Returns:
         //
         // CRC32 guided section
         //
+        JsonBegin ("Sections", '[');
         Status = ParseSection (
-                  SectionBuffer + DataOffset,
-                  BufferLength - DataOffset
+                  Ptr + DataOffset,
+                  SectionLength - DataOffset
                   );
         if (EFI_ERROR (Status)) {
           Error (NULL, 0, 0003, "parse of CRC32 GUIDED section failed", NULL);
           return EFI_SECTION_ERROR;
         }
+        JsonEnd ();
       } else {
         //
         // We don't know how to parse it now.
@@ -2066,6 +2356,8 @@ Returns:
       return EFI_SECTION_ERROR;
     }
 
+    JsonEnd ();
+
     ParsedLength += SectionLength;
     //
     // We make then next section begin on a 4-byte boundary
@@ -2364,6 +2656,658 @@ LoadGuidedSectionToolsTxt (
   }
 }
 
+STATIC
+EFI_STATUS
+MapInputFile (
+  IN  CHAR8    *FileName,
+  OUT UINT8    **Image,
+  OUT UINTN    *ImageSize,
+  OUT BOOLEAN  *Mapped
+  )
+/*++
+
+Routine Description:
+
+  Maps the input file in memory, so that the FV is parsed in place.  The
+  mapping is private: changes made to the image, like the rebase done for
+  --hash, are not written back to the file.  If the file cannot be mapped,
+  it is read to a buffer instead.
+
+Arguments:
+
+  FileName    - Name of the input file
+  Image       - Start of the file in memory
+  ImageSize   - Size of the file
+  Mapped      - TRUE if the file is mapped, FALSE if it was read to a buffer
+
+Returns:
+
+  EFI_SUCCESS             The file is in memory.
+  EFI_ABORTED             The file cannot be opened or read.
+  EFI_OUT_OF_RESOURCES    Memory allocation failed.
+
+--*/
+{
+  FILE    *InputFile;
+  UINTN   FileSize;
+#ifdef __GNUC__
+  int          Fd;
+  struct stat  FileStat;
+  VOID         *Mapping;
+
+  Fd = open (LongFilePath (FileName), O_RDONLY);
+  if (Fd < 0) {
+    return EFI_ABORTED;
+  }
+  if ((fstat (Fd, &FileStat) == 0) && S_ISREG (FileStat.st_mode) && (FileStat.st_size > 0)) {
+    Mapping = mmap (NULL, (size_t) FileStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, Fd, 0);
+    if (Mapping != MAP_FAILED) {
+      close (Fd);
+      *Image     = Mapping;
+      *ImageSize = (UINTN) FileStat.st_size;
+      *Mapped    = TRUE;
+      return EFI_SUCCESS;
+    }
+  }
+  close (Fd);
+#else
+  HANDLE         FileHandle;
+  HANDLE         MappingHandle;
+  LARGE_INTEGER  Size;
+  VOID           *Mapping;
+
+  FileHandle = CreateFileA (
+                 LongFilePath (FileName),
+                 GENERIC_READ,
+                 FILE_SHARE_READ,
+                 NULL,
+                 OPEN_EXISTING,
+                 FILE_ATTRIBUTE_NORMAL,
+                 NULL
+                 );
+  if (FileHandle == INVALID_HANDLE_VALUE) {
+    return EFI_ABORTED;
+  }
+  Mapping = NULL;
+  if (GetFileSizeEx (FileHandle, &Size) && (Size.QuadPart > 0)) {
+    MappingHandle = CreateFileMappingA (FileHandle, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (MappingHandle != NULL) {
+      //
+      // The view stays valid once the handles are closed.
+      //
+      Mapping = MapViewOfFile (MappingHandle, FILE_MAP_COPY, 0, 0, 0);
+      CloseHandle (MappingHandle);
+    }
+  }
+  CloseHandle (FileHandle);
+  if (Mapping != NULL) {
+    *Image     = Mapping;
+    *ImageSize = (UINTN) Size.QuadPart;
+    *Mapped    = TRUE;
+    return EFI_SUCCESS;
+  }
+#endif
+
+  //
+  // The file cannot be mapped, read it instead
+  //
+  InputFile = fopen (LongFilePath (FileName), "rb");
+  if (InputFile == NULL) {
+    return EFI_ABORTED;
+  }
+  fseek (InputFile, 0, SEEK_END);
+  FileSize = ftell (InputFile);
+  fseek (InputFile, 0, SEEK_SET);
+
+  *Image = malloc (FileSize + 1);
+  if (*Image == NULL) {
+    fclose (InputFile);
+    return EFI_OUT_OF_RESOURCES;
+  }
+  if (fread (*Image, 1, FileSize, InputFile) != FileSize) {
+    free (*Image);
+    fclose (InputFile);
+    return EFI_ABORTED;
+  }
+  fclose (InputFile);
+
+  *ImageSize = FileSize;
+  *Mapped    = FALSE;
+  return EFI_SUCCESS;
+}
+
+STATIC
+VOID
+UnmapInputFile (
+  IN UINT8    *Image,
+  IN UINTN    ImageSize,
+  IN BOOLEAN  Mapped
+  )
+/*++
+
+Routine Description:
+
+  Releases the input file mapped or read by MapInputFile.
+
+Arguments:
+
+  Image       - Start of the file in memory
+  ImageSize   - Size of the file
+  Mapped      - TRUE if the file is mapped, FALSE if it was read to a buffer
+
+Returns:
+
+  None
+
+--*/
+{
+  if (!Mapped) {
+    free (Image);
+    return;
+  }
+#ifdef __GNUC__
+  munmap (Image, ImageSize);
+#else
+  UnmapViewOfFile (Image);
+#endif
+}
+
+STATIC
+UINT64
+GetTimeInMicroseconds (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Reads the wall clock time, for the timing of the JSON dump.
+
+Arguments:
+
+  None
+
+Returns:
+
+  Time in microseconds from an arbitrary start point
+
+--*/
+{
+#ifdef __GNUC__
+  struct timeval  Time;
+
+  gettimeofday (&Time, NULL);
+  return (UINT64) Time.tv_sec * 1000000 + (UINT64) Time.tv_usec;
+#else
+  LARGE_INTEGER   Counter;
+  LARGE_INTEGER   Frequency;
+
+  QueryPerformanceFrequency (&Frequency);
+  QueryPerformanceCounter (&Counter);
+  return (UINT64) (Counter.QuadPart / Frequency.QuadPart) * 1000000 +
+         (UINT64) (Counter.QuadPart % Frequency.QuadPart) * 1000000 / Frequency.QuadPart;
+#endif
+}
+
+STATIC
+VOID
+JsonWriteString (
+  IN CHAR8  *String
+  )
+/*++
+
+Routine Description:
+
+  Writes a quoted and escaped string to the JSON dump.
+
+Arguments:
+
+  String  - The string to write
+
+Returns:
+
+  None
+
+--*/
+{
+  fputc ('"', mJsonFile);
+  for (; *String != '\0'; String++) {
+    if ((*String == '"') || (*String == '\\')) {
+      fprintf (mJsonFile, "\\%c", *String);
+    } else if ((UINT8) *String < 0x20) {
+      fprintf (mJsonFile, "\\u%04x", (UINT8) *String);
+    } else {
+      fputc (*String, mJsonFile);
+    }
+  }
+  fputc ('"', mJsonFile);
+}
+
+STATIC
+VOID
+JsonWriteName (
+  IN CHAR8  *Name
+  )
+/*++
+
+Routine Description:
+
+  Starts a new value of the current JSON object or array: writes the
+  separator from the previous value, the indentation and the name.
+
+Arguments:
+
+  Name    - Name of the value in an object, NULL in an array
+
+Returns:
+
+  None
+
+--*/
+{
+  UINTN  Level;
+
+  if (mJsonDepth > 0) {
+    Level = MIN (mJsonDepth, JSON_MAX_DEPTH) - 1;
+    if (!mJsonEmpty[Level]) {
+      fputc (',', mJsonFile);
+    }
+    mJsonEmpty[Level] = FALSE;
+    fprintf (mJsonFile, "\n%*s", (int) (mJsonDepth * 2), "");
+  }
+  if (Name != NULL) {
+    JsonWriteString (Name);
+    fputs (": ", mJsonFile);
+  }
+}
+
+STATIC
+VOID
+JsonBegin (
+  IN CHAR8  *Name,
+  IN CHAR8  Open
+  )
+/*++
+
+Routine Description:
+
+  Opens a JSON object or array in the JSON dump, if there is one.
+
+Arguments:
+
+  Name    - Name of the new object or array, NULL in an array
+  Open    - '{' for an object, '[' for an array
+
+Returns:
+
+  None
+
+--*/
+{
+  UINTN  Level;
+
+  if (mJsonFile == NULL) {
+    return;
+  }
+  JsonWriteName (Name);
+  fputc (Open, mJsonFile);
+  mJsonDepth++;
+  Level = MIN (mJsonDepth, JSON_MAX_DEPTH) - 1;
+  mJsonEmpty[Level] = TRUE;
+  mJsonClose[Level] = (CHAR8) ((Open == '{') ? '}' : ']');
+}
+
+STATIC
+VOID
+JsonEnd (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Closes the innermost JSON object or array of the JSON dump.
+
+Arguments:
+
+  None
+
+Returns:
+
+  None
+
+--*/
+{
+  UINTN  Level;
+
+  if ((mJsonFile == NULL) || (mJsonDepth == 0)) {
+    return;
+  }
+  Level = MIN (mJsonDepth, JSON_MAX_DEPTH) - 1;
+  mJsonDepth--;
+  if (!mJsonEmpty[Level]) {
+    fprintf (mJsonFile, "\n%*s", (int) (mJsonDepth * 2), "");
+  }
+  fputc (mJsonClose[Level], mJsonFile);
+  if (mJsonDepth == 0) {
+    fputc ('\n', mJsonFile);
+  }
+}
+
+STATIC
+VOID
+JsonString (
+  IN CHAR8  *Name,
+  IN CHAR8  *Value
+  )
+/*++
+
+Routine Description:
+
+  Adds a string to the JSON dump, if there is one.
+
+Arguments:
+
+  Name    - Name of the value, NULL in an array
+  Value   - The string
+
+Returns:
+
+  None
+
+--*/
+{
+  if (mJsonFile == NULL) {
+    return;
+  }
+  JsonWriteName (Name);
+  JsonWriteString (Value);
+}
+
+STATIC
+VOID
+JsonNumber (
+  IN CHAR8   *Name,
+  IN UINT64  Value
+  )
+/*++
+
+Routine Description:
+
+  Adds a number to the JSON dump, if there is one.
+
+Arguments:
+
+  Name    - Name of the value, NULL in an array
+  Value   - The number
+
+Returns:
+
+  None
+
+--*/
+{
+  if (mJsonFile == NULL) {
+    return;
+  }
+  JsonWriteName (Name);
+  fprintf (mJsonFile, "%llu", (unsigned long long) Value);
+}
+
+STATIC
+VOID
+JsonGuid (
+  IN CHAR8     *Name,
+  IN EFI_GUID  *Guid
+  )
+/*++
+
+Routine Description:
+
+  Adds a GUID, in registry format, to the JSON dump, if there is one.
+
+Arguments:
+
+  Name    - Name of the value, NULL in an array
+  Guid    - The GUID
+
+Returns:
+
+  None
+
+--*/
+{
+  UINT8  GuidBuffer[PRINTED_GUID_BUFFER_SIZE];
+
+  if (mJsonFile == NULL) {
+    return;
+  }
+  PrintGuidToBuffer (Guid, GuidBuffer, sizeof (GuidBuffer), TRUE);
+  JsonString (Name, (CHAR8 *) GuidBuffer);
+}
+
+STATIC
+VOID *
+LzmaAlloc (
+  ISzAllocPtr  Allocator,
+  size_t       Size
+  )
+{
+  return malloc (Size);
+}
+
+STATIC
+VOID
+LzmaFree (
+  ISzAllocPtr  Allocator,
+  VOID         *Address
+  )
+{
+  free (Address);
+}
+
+STATIC CONST ISzAlloc mLzmaAllocator = { LzmaAlloc, LzmaFree };
+
+STATIC
+EFI_STATUS
+LzmaDecompressData (
+  IN  UINT8   *Source,
+  IN  UINT32  SourceSize,
+  OUT UINT8   *Destination,
+  IN  UINT32  DestinationSize
+  )
+/*++
+
+Routine Description:
+
+  Decodes one LZMA stream, as written by LzmaCompress: the LZMA properties
+  and the 64-bit decoded size, followed by the compressed data.
+
+Arguments:
+
+  Source          - The LZMA stream
+  SourceSize      - Size of the LZMA stream
+  Destination     - Buffer receiving the decoded data
+  DestinationSize - Size the stream must decode to
+
+Returns:
+
+  EFI_SUCCESS             The stream is decoded.
+  EFI_VOLUME_CORRUPTED    The stream is not valid, or does not decode to
+                          DestinationSize bytes.
+
+--*/
+{
+  SizeT        OutSize;
+  SizeT        InSize;
+  ELzmaStatus  LzmaStatus;
+
+  if ((SourceSize < LZMA_PROPS_SIZE + 8) ||
+      (GetUi32 (Source + LZMA_PROPS_SIZE) != DestinationSize) ||
+      (GetUi32 (Source + LZMA_PROPS_SIZE + 4) != 0)) {
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  OutSize = DestinationSize;
+  InSize  = SourceSize - (LZMA_PROPS_SIZE + 8);
+  if (LzmaDecode (
+        Destination,
+        &OutSize,
+        Source + LZMA_PROPS_SIZE + 8,
+        &InSize,
+        Source,
+        LZMA_PROPS_SIZE,
+        LZMA_FINISH_END,
+        &LzmaStatus,
+        &mLzmaAllocator
+        ) != SZ_OK) {
+    return EFI_VOLUME_CORRUPTED;
+  }
+  if (OutSize != DestinationSize) {
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+ExtractGuidedSection (
+  IN  EFI_GUID  *SectionGuid,
+  IN  UINT8     *Data,
+  IN  UINT32    DataLength,
+  OUT UINT8     **Output,
+  OUT UINT32    *OutputLength
+  )
+/*++
+
+Routine Description:
+
+  Decodes the data of a GUIDed section in process, for the sections
+  compressed by TianoCompress and LzmaCompress.  This gives the same
+  output as running the tool GuidedSectionTools.txt gives for the GUID,
+  without writing the section to a file and starting a process.
+
+Arguments:
+
+  SectionGuid   - SectionDefinitionGuid of the GUIDed section
+  Data          - Data of the section, after its header
+  DataLength    - Length of Data
+  Output        - Decoded data, to be freed by the caller
+  OutputLength  - Length of the decoded data
+
+Returns:
+
+  EFI_SUCCESS             The section is decoded.
+  EFI_UNSUPPORTED         The section GUID is not decoded in process.
+  EFI_VOLUME_CORRUPTED    The section data is not valid.
+  EFI_OUT_OF_RESOURCES    Memory allocation failed.
+
+--*/
+{
+  EFI_STATUS  Status;
+  UINT8       *Buffer;
+  UINT8       *ScratchBuffer;
+  UINT32      DstSize;
+  UINT32      ScratchSize;
+  UINT32      BlockSize;
+  UINT32      BlockCount;
+  UINT32      BlockIndex;
+  UINT32      BlockLength;
+  UINT32      CompressedLength;
+  UINT32      Offset;
+  UINT32      X86State;
+
+  if (CompareGuid (SectionGuid, &gTianoCustomDecompressGuid) == 0) {
+    Status = TianoGetInfo (Data, DataLength, &DstSize, &ScratchSize);
+    if (EFI_ERROR (Status)) {
+      return EFI_VOLUME_CORRUPTED;
+    }
+    //
+    // One more byte, so that an empty section is not a NULL buffer
+    //
+    Buffer        = malloc (DstSize + 1);
+    ScratchBuffer = malloc (ScratchSize);
+    if ((Buffer == NULL) || (ScratchBuffer == NULL)) {
+      free (Buffer);
+      free (ScratchBuffer);
+      return EFI_OUT_OF_RESOURCES;
+    }
+    Status = TianoDecompress (Data, DataLength, Buffer, DstSize, ScratchBuffer, ScratchSize);
+    free (ScratchBuffer);
+    if (EFI_ERROR (Status)) {
+      free (Buffer);
+      return EFI_VOLUME_CORRUPTED;
+    }
+  } else if ((CompareGuid (SectionGuid, &gLzmaCustomDecompressGuid) == 0) ||
+             (CompareGuid (SectionGuid, &gLzmaF86CustomDecompressGuid) == 0)) {
+    if (DataLength < LZMA_PROPS_SIZE + 8) {
+      return EFI_VOLUME_CORRUPTED;
+    }
+    DstSize = GetUi32 (Data + LZMA_PROPS_SIZE);
+    Buffer  = malloc (DstSize + 1);
+    if (Buffer == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+    Status = LzmaDecompressData (Data, DataLength, Buffer, DstSize);
+    if (EFI_ERROR (Status)) {
+      free (Buffer);
+      return Status;
+    }
+    if (CompareGuid (SectionGuid, &gLzmaF86CustomDecompressGuid) == 0) {
+      x86_Convert_Init (X86State);
+      x86_Convert (Buffer, DstSize, 0, &X86State, 0);
+    }
+  } else if (CompareGuid (SectionGuid, &gLzmaMultiBlockCustomDecompressGuid) == 0) {
+    //
+    // Header, compressed size of each block, then the blocks, each of which
+    // is an LZMA stream decoding to BlockSize bytes but the last one.
+    //
+    if ((DataLength < LZMA_MULTI_BLOCK_HEADER_SIZE) ||
+        (GetUi32 (Data) != LZMA_MULTI_BLOCK_SIGNATURE)) {
+      return EFI_VOLUME_CORRUPTED;
+    }
+    BlockSize  = GetUi32 (Data + 4);
+    BlockCount = GetUi32 (Data + 8);
+    DstSize    = GetUi32 (Data + 12);
+    if ((BlockSize == 0) ||
+        (BlockCount != DstSize / BlockSize + ((DstSize % BlockSize) != 0 ? 1 : 0)) ||
+        ((DataLength - LZMA_MULTI_BLOCK_HEADER_SIZE) / 4 < BlockCount)) {
+      return EFI_VOLUME_CORRUPTED;
+    }
+    Buffer = malloc (DstSize + 1);
+    if (Buffer == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+    Offset = LZMA_MULTI_BLOCK_HEADER_SIZE + BlockCount * 4;
+    for (BlockIndex = 0; BlockIndex < BlockCount; BlockIndex++) {
+      CompressedLength = GetUi32 (Data + LZMA_MULTI_BLOCK_HEADER_SIZE + 4 * BlockIndex);
+      BlockLength      = MIN (BlockSize, DstSize - BlockIndex * BlockSize);
+      if (CompressedLength > DataLength - Offset) {
+        free (Buffer);
+        return EFI_VOLUME_CORRUPTED;
+      }
+      Status = LzmaDecompressData (
+                 Data + Offset,
+                 CompressedLength,
+                 Buffer + BlockIndex * BlockSize,
+                 BlockLength
+                 );
+      if (EFI_ERROR (Status)) {
+        free (Buffer);
+        return Status;
+      }
+      Offset += CompressedLength;
+    }
+  } else {
+    return EFI_UNSUPPORTED;
+  }
+
+  *Output       = Buffer;
+  *OutputLength = DstSize;
+  return EFI_SUCCESS;
+}
+
 
 void
 Usage (
@@ -2420,6 +3364,11 @@ Returns:
             processing an FV\n");
   fprintf (stdout, "  --hash\n\
             Generate HASH value of the entire PE image\n");
+  fprintf (stdout, "  --file FILE_GUID\n\
+            Only display the file with this name from the FV\n");
+  fprintf (stdout, "  --json JSON_FILENAME\n\
+            Also write the FV contents, with the time taken to map,\n\
+            index, decode and parse them, to a JSON file\n");
   fprintf (stdout, "  --sfo\n\
             Reserved for future use\n");
 }
@@ -34,4 +34,23 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #define OPENSSL_COMMAND_FORMAT_STRING       "%s sha1 -out %s %s"
 #define EXTRACT_COMMAND_FORMAT_STRING       "%s -d -o %s %s"
 
+//
+// GUIDed sections which are decoded in process instead of by the tool
+// GuidedSectionTools.txt gives for them
+//
+#define TIANO_CUSTOM_DECOMPRESS_GUID  \
+  { 0xA31280AD, 0x481E, 0x41B6, { 0x95, 0xE8, 0x12, 0x7F, 0x4C, 0x98, 0x47, 0x79 } }
+
+#define LZMA_CUSTOM_DECOMPRESS_GUID  \
+  { 0xEE4E5898, 0x3914, 0x4259, { 0x9D, 0x6E, 0xDC, 0x7B, 0xD7, 0x94, 0x03, 0xCF } }
+
+#define LZMAF86_CUSTOM_DECOMPRESS_GUID  \
+  { 0xD42AE6BD, 0x1352, 0x4BFB, { 0x90, 0x9A, 0xCA, 0x72, 0xA6, 0xEA, 0xE8, 0x89 } }
+
+#define LZMA_MULTI_BLOCK_CUSTOM_DECOMPRESS_GUID  \
+  { 0xE50A0786, 0xF995, 0x4C52, { 0xB7, 0x72, 0xD5, 0x06, 0xB8, 0x62, 0x7A, 0x16 } }
+
+#define LZMA_MULTI_BLOCK_SIGNATURE    SIGNATURE_32 ('L', 'Z', 'M', 'B')
+#define LZMA_MULTI_BLOCK_HEADER_SIZE  16
+
 #endif
@@ -1550,6 +1550,10 @@ class TopLevelMakefile(BuildFile):
             ExtraOption += " --genfds-multi-thread"
         if GlobalData.gIgnoreSource:
             ExtraOption += " --ignore-sources"
+        if GlobalData.gCompressCache:
+            ExtraOption += ' --compress-cache "%s"' % GlobalData.gCompressCache
+            if GlobalData.gCompressCacheSize:
+                ExtraOption += " --compress-cache-size %d" % GlobalData.gCompressCacheSize
 
         for pcd in GlobalData.BuildOptionPcd:
             if pcd[2]:
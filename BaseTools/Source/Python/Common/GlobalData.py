@@ -120,4 +120,6 @@ gPlatformHash = None
 gPackageHash = {}
 gModuleHash = {}
 gEnableGenfdsMultiThread = False
+gCompressCache = None
+gCompressCacheSize = None
 gSikpAutoGenCache = set()
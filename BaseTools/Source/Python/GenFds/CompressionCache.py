@@ -0,0 +1,233 @@
+## @file
+# Content-addressed cache of the compressed sections generated by GenFds
+#
+#  Copyright (c) 2018, Intel Corporation. All rights reserved.<BR>
+#
+#  This program and the accompanying materials
+#  are licensed and made available under the terms and conditions of the BSD License
+#  which accompanies this distribution.  The full text of the license may be found at
+#  http://opensource.org/licenses/bsd-license.php
+#
+#  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+#
+
+##
+# Import Modules
+#
+from __future__ import print_function
+from __future__ import absolute_import
+
+import Common.LongFilePathOs as os
+import hashlib
+import re
+import shutil
+import tempfile
+
+from Common import EdkLogger
+from Common.LongFilePathSupport import OpenLongFilePath as open
+
+## GUIDs of the GUIDed section tools which only compress their input
+#
+#  The output of these tools depends on nothing but the tool, its options and
+#  the input content, so it can be taken from the cache.
+#
+COMPRESSION_GUID_LIST = (
+    'A31280AD-481E-41B6-95E8-127F4C984779',     # TianoCompress
+    'EE4E5898-3914-4259-9D6E-DC7BD79403CF',     # LzmaCompress
+    'D42AE6BD-1352-4BFB-909A-CA72A6EAE889',     # LzmaF86Compress
+    'E50A0786-F995-4C52-B772-D506B8627A16',     # LzmaCompress multi-block
+    '3D532050-5CDA-4FD0-879E-0F7F630D5AFB',     # BrotliCompress
+    )
+
+## Content-addressed cache of compressed sections
+#
+#   A cache entry is named by the MD5 of the tool, its options and the content
+#   of its input files, so identical input is compressed only once, whatever
+#   platform or output directory it is built for. The directory can be shared
+#   by several workspaces. Entries are evicted in least recently used order
+#   when the cache grows larger than its size limit.
+#
+class CompressionCache(object):
+    CacheDir = None
+    MaxSize = 1024 * 1024 * 1024
+    HitCount = 0
+    MissCount = 0
+    StoreCount = 0
+    ToolHashDict = {}
+
+    ## Enable the cache
+    #
+    #   @param  CacheDir        Directory holding the cache entries
+    #   @param  MaxSize         Size limit of the cache in MB
+    #
+    @staticmethod
+    def SetCache(CacheDir, MaxSize=None):
+        if not os.path.isdir(CacheDir):
+            try:
+                os.makedirs(CacheDir)
+            except OSError:
+                EdkLogger.warn("GenFds", "Failed to create compression cache directory", ExtraData=CacheDir)
+                return
+        CompressionCache.CacheDir = CacheDir
+        if MaxSize is not None:
+            CompressionCache.MaxSize = MaxSize * 1024 * 1024
+
+    ## Get the cache key of an output
+    #
+    #   @param  Tool            Name or path of the tool generating the output
+    #   @param  Options         Option list of the tool, without input and output file names
+    #   @param  Input           Path list of input files
+    #
+    #   @retval string          The key, or None if the cache is not enabled
+    #
+    @staticmethod
+    def GetKey(Tool, Options, Input):
+        if not CompressionCache.CacheDir:
+            return None
+        m = hashlib.md5(os.path.basename(Tool))
+        m.update(CompressionCache._GetToolHash(Tool))
+        m.update(' '.join(Options))
+        for F in Input:
+            if not os.path.isfile(F):
+                return None
+            with open(F, 'rb') as Fd:
+                m.update(hashlib.md5(Fd.read()).hexdigest())
+        return m.hexdigest()
+
+    ## Hash the tool found in PATH, so that a rebuilt tool does not hit the entries of the old one
+    #
+    #   A tool in BinWrappers/PosixLike is a script running the real tool, so
+    #   the script and the tools it runs are hashed together.
+    #
+    @staticmethod
+    def _GetToolHash(Tool):
+        if Tool not in CompressionCache.ToolHashDict:
+            # a wrapper running itself must not recurse forever
+            CompressionCache.ToolHashDict[Tool] = ''
+            ToolHash = ''
+            ToolFile = CompressionCache._FindTool(Tool)
+            if ToolFile:
+                with open(ToolFile, 'rb') as Fd:
+                    Content = Fd.read()
+                ToolHash = hashlib.md5(Content).hexdigest()
+                if Content.startswith('#!'):
+                    for WrappedTool in CompressionCache._GetWrappedToolList(ToolFile, Content):
+                        ToolHash += CompressionCache._GetToolHash(WrappedTool)
+            CompressionCache.ToolHashDict[Tool] = ToolHash
+        return CompressionCache.ToolHashDict[Tool]
+
+    ## Find the file of a tool given by its path or by its name in PATH
+    #
+    @staticmethod
+    def _FindTool(Tool):
+        if os.path.isfile(Tool):
+            return Tool
+        for Dir in os.environ.get('PATH', '').split(os.pathsep):
+            for Ext in ('', '.exe', '.bat'):
+                if os.path.isfile(os.path.join(Dir, Tool + Ext)):
+                    return os.path.join(Dir, Tool + Ext)
+        return None
+
+    ## Get the tools run by a wrapper script
+    #
+    #   The wrapper of a C tool runs the binary of the same name from the
+    #   places below. Others, like LzmaF86Compress, run another tool by name.
+    #
+    @staticmethod
+    def _GetWrappedToolList(ToolFile, Content):
+        ToolList = []
+        Name = os.path.basename(ToolFile)
+        DirList = []
+        if 'WORKSPACE' in os.environ:
+            DirList.append(os.path.join(os.environ['WORKSPACE'], 'Conf', 'BaseToolsCBinaries'))
+        if 'EDK_TOOLS_PATH' in os.environ:
+            DirList.append(os.path.join(os.environ['EDK_TOOLS_PATH'], 'Source', 'C', 'bin'))
+        DirList.append(os.path.join(os.path.dirname(ToolFile), '..', '..', 'Source', 'C', 'bin'))
+        for Dir in DirList:
+            if os.path.isfile(os.path.join(Dir, Name)):
+                ToolList.append(os.path.join(Dir, Name))
+                break
+        ToolList.extend(re.findall(r'^\s*exec\s+([\w.-]+)\s', Content, re.MULTILINE))
+        return ToolList
+
+    @staticmethod
+    def _GetEntry(Key):
+        return os.path.join(CompressionCache.CacheDir, Key[:2], Key)
+
+    ## Copy the cached output to Output
+    #
+    #   @param  Key             The key from GetKey
+    #   @param  Output          Path of the output file
+    #
+    #   @retval True            The output was taken from the cache
+    #   @retval False           The output is not in the cache
+    #
+    @staticmethod
+    def Restore(Key, Output):
+        Entry = CompressionCache._GetEntry(Key)
+        try:
+            shutil.copyfile(Entry, Output)
+            # the time stamp of an entry is the time it was last used
+            os.utime(Entry, None)
+        except (IOError, OSError):
+            CompressionCache.MissCount += 1
+            return False
+        CompressionCache.HitCount += 1
+        return True
+
+    ## Save Output in the cache
+    #
+    #   The entry is written to a temporary file and then renamed, so that
+    #   GenFds running for other workspaces never see a partial entry.
+    #
+    #   @param  Key             The key from GetKey
+    #   @param  Output          Path of the output file
+    #
+    @staticmethod
+    def Store(Key, Output):
+        Entry = CompressionCache._GetEntry(Key)
+        try:
+            if not os.path.isdir(os.path.dirname(Entry)):
+                os.makedirs(os.path.dirname(Entry))
+            with open(Output, 'rb') as Src:
+                with tempfile.NamedTemporaryFile(dir=os.path.dirname(Entry), delete=False) as Dst:
+                    shutil.copyfileobj(Src, Dst)
+                    TempFile = Dst.name
+            # the entries are shared, not private like a temporary file
+            os.chmod(TempFile, 0o644)
+            if os.path.exists(Entry):
+                os.remove(Entry)
+            os.rename(TempFile, Entry)
+        except (IOError, OSError):
+            EdkLogger.debug(EdkLogger.DEBUG_5, "Failed to save %s in the compression cache" % Output)
+            return
+        CompressionCache.StoreCount += 1
+
+    ## Remove the least recently used entries until the cache is within its size limit
+    #
+    @staticmethod
+    def Evict():
+        if not CompressionCache.CacheDir or not CompressionCache.StoreCount:
+            return
+        EntryList = []
+        TotalSize = 0
+        for Root, Dirs, Files in os.walk(CompressionCache.CacheDir):
+            for File in Files:
+                Entry = os.path.join(Root, File)
+                try:
+                    Stat = os.stat(Entry)
+                except OSError:
+                    continue
+                EntryList.append((Stat.st_mtime, Stat.st_size, Entry))
+                TotalSize += Stat.st_size
+        if TotalSize <= CompressionCache.MaxSize:
+            return
+        for _, Size, Entry in sorted(EntryList):
+            try:
+                os.remove(Entry)
+            except OSError:
+                continue
+            TotalSize -= Size
+            if TotalSize <= CompressionCache.MaxSize:
+                break
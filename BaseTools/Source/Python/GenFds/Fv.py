@@ -18,6 +18,7 @@
 from __future__ import absolute_import
 import Common.LongFilePathOs as os
 import subprocess
+import time
 from io import BytesIO
 from struct import *
 from . import FfsFileStatement
@@ -100,6 +101,9 @@ class FV (object):
         if not Flag:
             GenFdsGlobalVariable.InfLogger( "\nGenerating %s FV" %self.UiFvName)
         GenFdsGlobalVariable.LargeFileInFvFlags.append(False)
+        FvStartTime = time.time()
+        GeneratedCount = GenFdsGlobalVariable.GeneratedOutputCount
+        ReusedCount = GenFdsGlobalVariable.ReusedOutputCount
         FFSGuid = None
 
         if self.FvBaseAddress is not None:
@@ -232,6 +236,12 @@ class FV (object):
                     FvFileObj.close()
                     GenFdsGlobalVariable.ImageBinDict[self.UiFvName.upper() + 'fv'] = FvOutputFile
                     GenFdsGlobalVariable.LargeFileInFvFlags.pop()
+                    GenFdsGlobalVariable.FvReportList.append((
+                                            self.UiFvName,
+                                            GenFdsGlobalVariable.GeneratedOutputCount - GeneratedCount,
+                                            GenFdsGlobalVariable.ReusedOutputCount - ReusedCount,
+                                            time.time() - FvStartTime
+                                            ))
                 else:
                     GenFdsGlobalVariable.ErrorLogger("Invalid FV file %s." % self.UiFvName)
             else:
@@ -40,6 +40,7 @@ from Workspace.WorkspaceDatabase import WorkspaceDatabase
 
 from .FdfParser import FdfParser, Warning
 from .GenFdsGlobalVariable import GenFdsGlobalVariable
+from .CompressionCache import CompressionCache
 from .FfsFileStatement import FileStatement
 
 ## Version and Copyright
@@ -188,6 +189,14 @@ def main():
         #Set global flag for build mode
         GlobalData.gIgnoreSource = Options.IgnoreSources
 
+        if Options.CompressCache:
+            CompressCache = os.path.normpath(Options.CompressCache)
+            if not os.path.isabs(CompressCache):
+                CompressCache = mws.join(GenFdsGlobalVariable.WorkSpaceDir, CompressCache)
+            if Options.CompressCacheSize is not None and Options.CompressCacheSize <= 0:
+                EdkLogger.error("GenFds", OPTION_VALUE_INVALID, ExtraData="Invalid value of option --compress-cache-size.")
+            CompressionCache.SetCache(CompressCache, Options.CompressCacheSize)
+
         if Options.Macros:
             for Pair in Options.Macros:
                 if Pair.startswith('"'):
@@ -326,6 +335,8 @@ def main():
 
         """Call GenFds"""
         GenFds.GenFd('', FdfParserObj, BuildWorkSpace, ArchList)
+        GenFdsGlobalVariable.DumpOutputHash()
+        CompressionCache.Evict()
 
         """Generate GUID cross reference file"""
         GenFds.GenerateGuidXRefFile(BuildWorkSpace, ArchList, FdfParserObj)
@@ -333,6 +344,12 @@ def main():
         """Display FV space info."""
         GenFds.DisplayFvSpaceInfo(FdfParserObj)
 
+        """Display FV generation info."""
+        GenFds.DisplayFvGenerationInfo()
+
+        """Display compression cache info."""
+        GenFds.DisplayCompressionCacheInfo()
+
     except Warning as X:
         EdkLogger.error(X.ToolName, FORMAT_INVALID, File=X.FileName, Line=X.LineNumber, ExtraData=X.Message, RaiseError=False)
         ReturnCode = FORMAT_INVALID
@@ -397,6 +414,8 @@ def myOptionParser():
     Parser.add_option("--ignore-sources", action="store_true", dest="IgnoreSources", default=False, help="Focus to a binary build and ignore all source files")
     Parser.add_option("--pcd", action="append", dest="OptionPcd", help="Set PCD value by command line. Format: \"PcdName=Value\" ")
     Parser.add_option("--genfds-multi-thread", action="store_true", dest="GenfdsMultiThread", default=False, help="Enable GenFds multi thread to generate ffs file.")
+    Parser.add_option("--compress-cache", action="store", type="string", dest="CompressCache", help="Reuse the compressed sections saved in the specified directory and save new ones there.")
+    Parser.add_option("--compress-cache-size", action="store", type="int", dest="CompressCacheSize", help="Specify the size limit of the compression cache in MB. Default is 1024.")
 
     Options, _ = Parser.parse_args()
     return Options
@@ -424,6 +443,7 @@ class GenFds(object):
     @staticmethod
     def GenFd (OutputDir, FdfParserObject, WorkSpace, ArchList):
         GenFdsGlobalVariable.SetDir ('', FdfParserObject, WorkSpace, ArchList)
+        GenFdsGlobalVariable.RestoreOutputHash()
 
         GenFdsGlobalVariable.VerboseLogger(" Generate all Fd images and their required FV and Capsule images!")
         if GenFds.OnlyGenerateThisCap is not None and GenFds.OnlyGenerateThisCap.upper() in GenFdsGlobalVariable.FdfParser.Profile.CapsuleDict:
@@ -567,6 +587,35 @@ class GenFds(object):
 
             GenFdsGlobalVariable.InfLogger(Name + ' ' + '[' + Percentage + '%Full] ' + str(TotalSizeValue) + ' total, ' + str(UsedSizeValue) + ' used, ' + str(FreeSizeValue) + ' free')
 
+    ## DisplayFvGenerationInfo()
+    #
+    #   Show how many of the sections, FFS files and FV images of each FV were
+    #   generated and how many were reused from the previous GenFds. The count
+    #   of an FV includes the FVs nested in it.
+    #
+    @staticmethod
+    def DisplayFvGenerationInfo():
+        if not GenFdsGlobalVariable.FvReportList:
+            return
+        GenFdsGlobalVariable.InfLogger('\nFV Generation Information')
+        for Name, Generated, Reused, Seconds in GenFdsGlobalVariable.FvReportList:
+            GenFdsGlobalVariable.InfLogger('%s [%s] %d generated, %d reused, %.2f seconds' %
+                                           (Name, 'rebuilt' if Generated else 'unchanged', Generated, Reused, Seconds))
+
+    ## DisplayCompressionCacheInfo()
+    #
+    #   Show how many compressed sections were taken from the compression cache
+    #   and how many had to be compressed again.
+    #
+    @staticmethod
+    def DisplayCompressionCacheInfo():
+        if not CompressionCache.CacheDir:
+            return
+        GenFdsGlobalVariable.InfLogger('\nCompression Cache Information')
+        GenFdsGlobalVariable.InfLogger('%d hits, %d misses, %d saved in %s' %
+                                       (CompressionCache.HitCount, CompressionCache.MissCount,
+                                        CompressionCache.StoreCount, CompressionCache.CacheDir))
+
     ## PreprocessImage()
     #
     #   @param  BuildDb         Database from build meta data files
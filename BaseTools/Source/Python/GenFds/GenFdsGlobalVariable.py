@@ -19,6 +19,7 @@ from __future__ import print_function
 from __future__ import absolute_import
 
 import Common.LongFilePathOs as os
+import hashlib
 from sys import stdout
 from subprocess import PIPE,Popen
 from struct import Struct
@@ -26,7 +27,7 @@ from array import array
 
 from Common.BuildToolError import COMMAND_FAILURE,GENFDS_ERROR
 from Common import EdkLogger
-from Common.Misc import SaveFileOnChange
+from Common.Misc import SaveFileOnChange, DataDump, DataRestore
 
 from Common.TargetTxtClassObject import TargetTxtClassObject
 from Common.ToolDefClassObject import ToolDefClassObject, ToolDefDict
@@ -35,6 +36,7 @@ import Common.DataType as DataType
 from Common.Misc import PathClass
 from Common.LongFilePathSupport import OpenLongFilePath as open
 from Common.MultipleWorkspace import MultipleWorkspace as mws
+from .CompressionCache import CompressionCache
 
 ## Global variables
 #
@@ -96,6 +98,21 @@ class GenFdsGlobalVariable:
     # FvName, FdName, CapName in FDF, Image file name
     ImageBinDict = {}
 
+    #
+    # The hash of the command and of the input files each tool output was
+    # generated from, and the hash of the output itself. It is kept in the FV
+    # directory, so that an output whose inputs were touched but not changed
+    # is not generated again by the next GenFds.
+    #
+    OutputHashDict = {}
+    # File path: (size, time stamp, hash), hashes computed in this GenFds
+    FileHashDict = {}
+    # Count of outputs generated and reused, used for the FV generation report
+    GeneratedOutputCount = 0
+    ReusedOutputCount = 0
+    # (FvName, generated outputs, reused outputs, time) of every FV generated
+    FvReportList = []
+
     ## LoadBuildRule
     #
     @staticmethod
@@ -418,12 +435,15 @@ class GenFdsGlobalVariable:
     #
     #   @param  Output          Path of output file
     #   @param  Input           Path list of input files
+    #   @param  Cmd             The command generating Output from Input
     #
-    #   @retval True            if Output doesn't exist, or any Input is newer
-    #   @retval False           if all Input is older than Output
+    #   @retval True            if Output doesn't exist, or any Input is newer and
+    #                           the command or the content of any Input changed
+    #   @retval False           if all Input is older than Output, or Output was
+    #                           generated by the same command from the same content
     #
     @staticmethod
-    def NeedsUpdate(Output, Input):
+    def NeedsUpdate(Output, Input, Cmd=None):
         if not os.path.exists(Output):
             return True
         # always update "Output" if no "Input" given
@@ -432,8 +452,7 @@ class GenFdsGlobalVariable:
 
         # if fdf file is changed after the 'Output" is generated, update the 'Output'
         OutputTime = os.path.getmtime(Output)
-        if GenFdsGlobalVariable.FdfFileTimeStamp > OutputTime:
-            return True
+        IsNewer = GenFdsGlobalVariable.FdfFileTimeStamp > OutputTime
 
         for F in Input:
             # always update "Output" if any "Input" doesn't exist
@@ -441,9 +460,98 @@ class GenFdsGlobalVariable:
                 return True
             # always update "Output" if any "Input" is newer than "Output"
             if os.path.getmtime(F) > OutputTime:
+                IsNewer = True
+
+        if IsNewer:
+            if Cmd is None or Output not in GenFdsGlobalVariable.OutputHashDict:
+                return True
+            #
+            # Output is kept with its old time stamp, the files generated from
+            # it are then not checked again.
+            #
+            if GenFdsGlobalVariable.OutputHashDict[Output] != (GenFdsGlobalVariable.GetInputHash(Input, Cmd),
+                                                               GenFdsGlobalVariable.GetFileHash(Output)):
                 return True
+        GenFdsGlobalVariable.ReusedOutputCount += 1
         return False
 
+    ## GetFileHash
+    #
+    #   @param  File            Path of the file
+    #
+    #   @retval string          MD5 of the file content
+    #
+    @staticmethod
+    def GetFileHash(File):
+        Stat = os.stat(File)
+        Key = (Stat.st_size, Stat.st_mtime)
+        if File not in GenFdsGlobalVariable.FileHashDict or GenFdsGlobalVariable.FileHashDict[File][0] != Key:
+            with open(File, 'rb') as Fd:
+                GenFdsGlobalVariable.FileHashDict[File] = (Key, hashlib.md5(Fd.read()).hexdigest())
+        return GenFdsGlobalVariable.FileHashDict[File][1]
+
+    ## GetInputHash
+    #
+    #   @param  Input           Path list of input files
+    #   @param  Cmd             The command generating the output from Input
+    #
+    #   @retval string          MD5 of the command, the input paths and their content
+    #
+    @staticmethod
+    def GetInputHash(Input, Cmd):
+        m = hashlib.md5(' '.join(Cmd))
+        for F in Input:
+            m.update(F)
+            m.update(GenFdsGlobalVariable.GetFileHash(F))
+        return m.hexdigest()
+
+    ## GenerateOutput
+    #
+    #   Call the tool generating Output and record the hash of Output and of
+    #   what it was generated from. If CacheKey is given, Output is taken from
+    #   the compression cache instead when it is there, and saved in the cache
+    #   otherwise.
+    #
+    #   @param  Output          Path of the output file
+    #   @param  Input           Path list of input files
+    #   @param  Cmd             The command generating Output from Input
+    #   @param  ErrorMess       Error message if the tool fails
+    #   @param  ReturnValue     The return value of the tool, see CallExternalTool
+    #   @param  CacheKey        The compression cache key of Output, see CompressionCache.GetKey
+    #
+    @staticmethod
+    def GenerateOutput(Output, Input, Cmd, ErrorMess, ReturnValue=[], CacheKey=None):
+        InputHash = GenFdsGlobalVariable.GetInputHash(Input, Cmd)
+        if CacheKey and CompressionCache.Restore(CacheKey, Output):
+            if ReturnValue != []:
+                ReturnValue[0] = 0
+        else:
+            GenFdsGlobalVariable.CallExternalTool(Cmd, ErrorMess, ReturnValue)
+            if ReturnValue != [] and ReturnValue[0] != 0:
+                return
+            if CacheKey and os.path.exists(Output):
+                CompressionCache.Store(CacheKey, Output)
+        GenFdsGlobalVariable.GeneratedOutputCount += 1
+        if os.path.exists(Output):
+            GenFdsGlobalVariable.OutputHashDict[Output] = (InputHash, GenFdsGlobalVariable.GetFileHash(Output))
+
+    ## Restore the hash of the outputs generated by the previous GenFds
+    #
+    @staticmethod
+    def RestoreOutputHash():
+        OutputHashFile = os.path.join(GenFdsGlobalVariable.FvDir, 'GenFdsOutputHash')
+        if os.path.isfile(OutputHashFile):
+            GenFdsGlobalVariable.OutputHashDict = DataRestore(OutputHashFile)
+            if GenFdsGlobalVariable.OutputHashDict is None:
+                GenFdsGlobalVariable.OutputHashDict = {}
+
+    ## Save the hash of the outputs for the next GenFds
+    #
+    @staticmethod
+    def DumpOutputHash():
+        if GenFdsGlobalVariable.FvDir:
+            DataDump(GenFdsGlobalVariable.OutputHashDict, os.path.join(GenFdsGlobalVariable.FvDir, 'GenFdsOutputHash'))
+
     @staticmethod
     def GenerateSection(Output, Input, Type=None, CompressionType=None, Guid=None,
                         GuidHdrLen=None, GuidAttr=[], Ui=None, Ver=None, InputAlign=[], BuildNumber=None, DummyFile=None, IsMakefile=False):
@@ -495,10 +603,11 @@ class GenFdsGlobalVariable:
                 if ' '.join(Cmd).strip() not in GenFdsGlobalVariable.SecCmdList:
                     GenFdsGlobalVariable.SecCmdList.append(' '.join(Cmd).strip())
             else:
-                if not GenFdsGlobalVariable.NeedsUpdate(Output, list(Input) + [CommandFile]):
+                if not GenFdsGlobalVariable.NeedsUpdate(Output, list(Input) + [CommandFile], Cmd):
                     return
-                GenFdsGlobalVariable.CallExternalTool(Cmd, "Failed to generate section")
+                GenFdsGlobalVariable.GenerateOutput(Output, list(Input) + [CommandFile], Cmd, "Failed to generate section")
         else:
+            Options = Cmd[1:]
             Cmd += ("-o", Output)
             Cmd += Input
 
@@ -506,9 +615,15 @@ class GenFdsGlobalVariable:
             if IsMakefile:
                 if ' '.join(Cmd).strip() not in GenFdsGlobalVariable.SecCmdList:
                     GenFdsGlobalVariable.SecCmdList.append(' '.join(Cmd).strip())
-            elif GenFdsGlobalVariable.NeedsUpdate(Output, list(Input) + [CommandFile]):
-                GenFdsGlobalVariable.DebugLogger(EdkLogger.DEBUG_5, "%s needs update because of newer %s" % (Output, Input))
-                GenFdsGlobalVariable.CallExternalTool(Cmd, "Failed to generate section")
+            else:
+                if GenFdsGlobalVariable.NeedsUpdate(Output, list(Input) + [CommandFile], Cmd):
+                    GenFdsGlobalVariable.DebugLogger(EdkLogger.DEBUG_5, "%s needs update because of newer %s" % (Output, Input))
+                    CacheKey = None
+                    if CompressionType:
+                        CacheKey = CompressionCache.GetKey(Cmd[0], Options, Input)
+                    GenFdsGlobalVariable.GenerateOutput(Output, list(Input) + [CommandFile], Cmd, "Failed to generate section",
+                                                        CacheKey=CacheKey)
+                # a reused large section also needs the FFS3 file system
                 if (os.path.getsize(Output) >= GenFdsGlobalVariable.LARGE_FILE_SIZE and
                     GenFdsGlobalVariable.LargeFileInFvFlags):
                     GenFdsGlobalVariable.LargeFileInFvFlags[-1] = True
@@ -559,17 +674,13 @@ class GenFdsGlobalVariable:
             GenFdsGlobalVariable.SecCmdList = []
             GenFdsGlobalVariable.CopyList = []
         else:
-            if not GenFdsGlobalVariable.NeedsUpdate(Output, list(Input) + [CommandFile]):
+            if not GenFdsGlobalVariable.NeedsUpdate(Output, list(Input) + [CommandFile], Cmd):
                 return
-            GenFdsGlobalVariable.CallExternalTool(Cmd, "Failed to generate FFS")
+            GenFdsGlobalVariable.GenerateOutput(Output, list(Input) + [CommandFile], Cmd, "Failed to generate FFS")
 
     @staticmethod
     def GenerateFirmwareVolume(Output, Input, BaseAddress=None, ForceRebase=None, Capsule=False, Dump=False,
                                AddressFile=None, MapFile=None, FfsList=[], FileSystemGuid=None):
-        if not GenFdsGlobalVariable.NeedsUpdate(Output, Input+FfsList):
-            return
-        GenFdsGlobalVariable.DebugLogger(EdkLogger.DEBUG_5, "%s needs update because of newer %s" % (Output, Input))
-
         Cmd = ["GenFv"]
         if BaseAddress:
             Cmd += ("-r", BaseAddress)
@@ -593,16 +704,24 @@ class GenFdsGlobalVariable:
         for I in Input:
             Cmd += ("-i", I)
 
-        GenFdsGlobalVariable.CallExternalTool(Cmd, "Failed to generate FV")
+        #
+        # GenFv adds the base address of child FVs to the address file. Check
+        # the FV address file it was copied from instead.
+        #
+        InputList = Input + FfsList
+        if AddressFile:
+            InputList.append(GenFdsGlobalVariable.FvAddressFileName)
+        if not GenFdsGlobalVariable.NeedsUpdate(Output, InputList, Cmd):
+            return False
+        GenFdsGlobalVariable.DebugLogger(EdkLogger.DEBUG_5, "%s needs update because of newer %s" % (Output, Input))
+
+        GenFdsGlobalVariable.GenerateOutput(Output, InputList, Cmd, "Failed to generate FV")
+        return True
 
     @staticmethod
     def GenerateFirmwareImage(Output, Input, Type="efi", SubType=None, Zero=False,
                               Strip=False, Replace=False, TimeStamp=None, Join=False,
                               Align=None, Padding=None, Convert=False, IsMakefile=False):
-        if not GenFdsGlobalVariable.NeedsUpdate(Output, Input) and not IsMakefile:
-            return
-        GenFdsGlobalVariable.DebugLogger(EdkLogger.DEBUG_5, "%s needs update because of newer %s" % (Output, Input))
-
         Cmd = ["GenFw"]
         if Type.lower() == "te":
             Cmd.append("-t")
@@ -629,8 +748,9 @@ class GenFdsGlobalVariable:
         if IsMakefile:
             if " ".join(Cmd).strip() not in GenFdsGlobalVariable.SecCmdList:
                 GenFdsGlobalVariable.SecCmdList.append(" ".join(Cmd).strip())
-        else:
-            GenFdsGlobalVariable.CallExternalTool(Cmd, "Failed to generate firmware image")
+        elif GenFdsGlobalVariable.NeedsUpdate(Output, Input, Cmd):
+            GenFdsGlobalVariable.DebugLogger(EdkLogger.DEBUG_5, "%s needs update because of newer %s" % (Output, Input))
+            GenFdsGlobalVariable.GenerateOutput(Output, Input, Cmd, "Failed to generate firmware image")
 
     @staticmethod
     def GenerateOptionRom(Output, EfiInput, BinaryInput, Compress=False, ClassCode=None,
@@ -654,11 +774,6 @@ class GenFdsGlobalVariable:
                 Cmd.append(BinFile)
                 InputList.append (BinFile)
 
-        # Check List
-        if not GenFdsGlobalVariable.NeedsUpdate(Output, InputList) and not IsMakefile:
-            return
-        GenFdsGlobalVariable.DebugLogger(EdkLogger.DEBUG_5, "%s needs update because of newer %s" % (Output, InputList))
-
         if ClassCode:
             Cmd += ("-l", ClassCode)
         if Revision:
@@ -672,15 +787,12 @@ class GenFdsGlobalVariable:
         if IsMakefile:
             if " ".join(Cmd).strip() not in GenFdsGlobalVariable.SecCmdList:
                 GenFdsGlobalVariable.SecCmdList.append(" ".join(Cmd).strip())
-        else:
-            GenFdsGlobalVariable.CallExternalTool(Cmd, "Failed to generate option rom")
+        elif GenFdsGlobalVariable.NeedsUpdate(Output, InputList, Cmd):
+            GenFdsGlobalVariable.DebugLogger(EdkLogger.DEBUG_5, "%s needs update because of newer %s" % (Output, InputList))
+            GenFdsGlobalVariable.GenerateOutput(Output, InputList, Cmd, "Failed to generate option rom")
 
     @staticmethod
-    def GuidTool(Output, Input, ToolPath, Options='', returnValue=[], IsMakefile=False):
-        if not GenFdsGlobalVariable.NeedsUpdate(Output, Input) and not IsMakefile:
-            return
-        GenFdsGlobalVariable.DebugLogger(EdkLogger.DEBUG_5, "%s needs update because of newer %s" % (Output, Input))
-
+    def GuidTool(Output, Input, ToolPath, Options='', returnValue=[], IsMakefile=False, Cache=False):
         Cmd = [ToolPath, ]
         Cmd += Options.split(' ')
         Cmd += ("-o", Output)
@@ -688,8 +800,12 @@ class GenFdsGlobalVariable:
         if IsMakefile:
             if " ".join(Cmd).strip() not in GenFdsGlobalVariable.SecCmdList:
                 GenFdsGlobalVariable.SecCmdList.append(" ".join(Cmd).strip())
-        else:
-            GenFdsGlobalVariable.CallExternalTool(Cmd, "Failed to call " + ToolPath, returnValue)
+        elif GenFdsGlobalVariable.NeedsUpdate(Output, Input, Cmd):
+            GenFdsGlobalVariable.DebugLogger(EdkLogger.DEBUG_5, "%s needs update because of newer %s" % (Output, Input))
+            CacheKey = None
+            if Cache:
+                CacheKey = CompressionCache.GetKey(ToolPath, Options.split(' '), Input)
+            GenFdsGlobalVariable.GenerateOutput(Output, Input, Cmd, "Failed to call " + ToolPath, returnValue, CacheKey)
 
     @staticmethod
     def CallExternalTool (cmd, errorMess, returnValue=[]):
@@ -23,6 +23,7 @@ from .Ffs import SectionSuffix
 import Common.LongFilePathOs as os
 from .GenFdsGlobalVariable import GenFdsGlobalVariable
 from .GenFdsGlobalVariable import FindExtendTool
+from .CompressionCache import COMPRESSION_GUID_LIST
 from CommonDataClass.FdfClass import GuidSectionClassObject
 from Common import ToolDefClassObject
 import sys
@@ -175,6 +176,8 @@ class GuidSection(GuidSectionClassObject) :
             CmdOption = '-e'
             if ExternalOption is not None:
                 CmdOption = CmdOption + ' ' + ExternalOption
+            # the output of a compression tool can be taken from the compression cache
+            Cache = self.NameGuid.upper() in COMPRESSION_GUID_LIST
             if not GenFdsGlobalVariable.EnableGenfdsMultiThread:
                 if self.ProcessRequired not in ("TRUE", "1") and self.IncludeFvSection and not FvAddrIsSet and self.FvParentAddr is not None:
                     #FirstCall is only set for the encapsulated flash FV image without process required attribute.
@@ -185,7 +188,7 @@ class GuidSection(GuidSectionClassObject) :
                 ReturnValue = [1]
                 if FirstCall:
                     #first try to call the guided tool with -z option and CmdOption for the no process required guided tool.
-                    GenFdsGlobalVariable.GuidTool(TempFile, [DummyFile], ExternalTool, '-z' + ' ' + CmdOption, ReturnValue)
+                    GenFdsGlobalVariable.GuidTool(TempFile, [DummyFile], ExternalTool, '-z' + ' ' + CmdOption, ReturnValue, Cache=Cache)
 
                 #
                 # when no call or first call failed, ReturnValue are not 1.
@@ -194,7 +197,7 @@ class GuidSection(GuidSectionClassObject) :
                 if ReturnValue[0] != 0:
                     FirstCall = False
                     ReturnValue[0] = 0
-                    GenFdsGlobalVariable.GuidTool(TempFile, [DummyFile], ExternalTool, CmdOption)
+                    GenFdsGlobalVariable.GuidTool(TempFile, [DummyFile], ExternalTool, CmdOption, Cache=Cache)
                 #
                 # There is external tool which does not follow standard rule which return nonzero if tool fails
                 # The output file has to be checked
@@ -233,7 +236,7 @@ class GuidSection(GuidSectionClassObject) :
 
                 if FirstCall and 'PROCESSING_REQUIRED' in Attribute:
                     # Guided data by -z option on first call is the process required data. Call the guided tool with the real option.
-                    GenFdsGlobalVariable.GuidTool(TempFile, [DummyFile], ExternalTool, CmdOption)
+                    GenFdsGlobalVariable.GuidTool(TempFile, [DummyFile], ExternalTool, CmdOption, Cache=Cache)
 
                 #
                 # Call Gensection Add Section Header
@@ -30,6 +30,24 @@ from Workspace.DecBuildData import DecBuildData
 from Workspace.DscBuildData import DscBuildData
 from Workspace.InfBuildData import InfBuildData
 
+## Cursor of the database
+#
+#   The tables keep the cursor they are created with. The cursor of another
+# connection can be put behind it, which the tables then use without knowing.
+#
+# @param Cursor             The sqlite3 cursor to use
+#
+class WorkspaceCursor(object):
+    def __init__(self, Cursor):
+        self.Cursor = Cursor
+
+    def __getattr__(self, Name):
+        return getattr(self.Cursor, Name)
+
+    # special methods are looked up on the class, not through __getattr__
+    def __iter__(self):
+        return iter(self.Cursor)
+
 ## Database
 #
 #   This class defined the build database for all modules, packages and platform.
@@ -164,17 +182,10 @@ class WorkspaceDatabase(object):
             if self._CheckWhetherDbNeedRenew(RenewDb, DbPath):
                 os.remove(DbPath)
 
-        # create db with optimized parameters
-        self.Conn = sqlite3.connect(DbPath, isolation_level='DEFERRED')
-        self.Conn.execute("PRAGMA synchronous=OFF")
-        self.Conn.execute("PRAGMA temp_store=MEMORY")
-        self.Conn.execute("PRAGMA count_changes=OFF")
-        self.Conn.execute("PRAGMA cache_size=8192")
-        #self.Conn.execute("PRAGMA page_size=8192")
-
-        # to avoid non-ascii character conversion issue
-        self.Conn.text_factory = str
-        self.Cur = self.Conn.cursor()
+        self.DbPath = DbPath
+        self._InheritedConn = None
+        self.Conn = self._Connect(DbPath)
+        self.Cur = WorkspaceCursor(self.Conn.cursor())
 
         # create table for internal uses
         self.TblDataModel = TableDataModel(self.Cur)
@@ -265,6 +276,38 @@ determine whether database file is out of date!\n")
     def __del__(self):
         self.Close()
 
+    ## Create db with optimized parameters
+    #
+    # @param DbPath             Path of database file
+    #
+    # @retval Conn              The sqlite3 connection
+    #
+    def _Connect(self, DbPath):
+        Conn = sqlite3.connect(DbPath, isolation_level='DEFERRED')
+        Conn.execute("PRAGMA synchronous=OFF")
+        Conn.execute("PRAGMA temp_store=MEMORY")
+        Conn.execute("PRAGMA count_changes=OFF")
+        Conn.execute("PRAGMA cache_size=8192")
+        #Conn.execute("PRAGMA page_size=8192")
+
+        # to avoid non-ascii character conversion issue
+        Conn.text_factory = str
+        return Conn
+
+    ## Open a connection of its own in a forked process
+    #
+    # A SQLite connection must not be carried across fork(). The inherited one
+    # is neither used nor closed by this process, which would release the locks
+    # of the database file held by the parent. A database in memory is a copy
+    # of its own in this process and is kept.
+    #
+    def Reconnect(self):
+        if self.DbPath == ':memory:' or self._InheritedConn is not None:
+            return
+        self._InheritedConn = self.Conn
+        self.Conn = self._Connect(self.DbPath)
+        self.Cur.Cursor = self.Conn.cursor()
+
     ## Close entire database
     #
     # Commit all first
@@ -28,6 +28,7 @@ import traceback
 import encodings.ascii
 import itertools
 import multiprocessing
+import signal
 
 from struct import *
 from threading import *
@@ -71,6 +72,14 @@ gToolsDefinition = "tools_def.txt"
 TemporaryTablePattern = re.compile(r'^_\d+_\d+_[a-fA-F0-9]+$')
 TmpTableDict = {}
 
+## The ModuleAutoGen objects and FFS commands of the AutoGen worker processes
+#
+# It is filled before the processes are forked, so that they inherit it along
+# with the workspace data it refers to. The tasks sent to the processes are
+# indexes into it.
+#
+gAutoGenTaskList = []
+
 ## Check environment PATH variable to make sure the specified tool is found
 #
 #   If the tool is found in the PATH, then True is returned
@@ -329,6 +338,44 @@ def LaunchCommand(Command, WorkingDir):
         EdkLogger.error("build", COMMAND_FAILURE, ExtraData="%s [%s]" % (Command, WorkingDir))
     return "%dms" % (int(round((time.time() - BeginTime) * 1000)))
 
+## Initialize an AutoGen worker process
+#
+# Ctrl-C is left to the build process, which terminates the workers. The
+# database connection of the build process is not used after the fork.
+#
+# @param  Db        The WorkspaceDatabase object of the build process
+#
+def InitAutoGenWorker(Db):
+    signal.signal(signal.SIGINT, signal.SIG_IGN)
+    Db.Reconnect()
+
+## Generate the AutoGen code files and makefile of a module in a worker process
+#
+# The files of the libraries the module depends on are not generated. They are
+# tasks of their own.
+#
+# @param  Index     The index of the module in gAutoGenTaskList
+#
+# @retval tuple     The index, the error code, the IsCodeFileCreated and
+#                   DepexGenerated states of the module, and the time spent
+#                   generating the code files and the makefile
+#
+def CreateAutoGenFiles(Index):
+    Ma, GenFfsList = gAutoGenTaskList[Index]
+    GlobalData.gGlobalDefines['ARCH'] = Ma.Arch
+    try:
+        GenCStart = time.time()
+        Ma.CreateCodeFile(False)
+        GenMakeStart = time.time()
+        Ma.CreateMakeFile(False, GenFfsList)
+    except FatalError as X:
+        return Index, X.args[0], False, False, 0, 0
+    except:
+        EdkLogger.error("build", CODE_ERROR, "Unknown fatal error when processing [%s]" % Ma.MetaFile,
+                        ExtraData=traceback.format_exc(), RaiseError=False)
+        return Index, CODE_ERROR, False, False, 0, 0
+    return Index, 0, Ma.IsCodeFileCreated, Ma.DepexGenerated, GenMakeStart - GenCStart, time.time() - GenMakeStart
+
 ## The smallest unit that can be built in multi-thread build mode
 #
 # This is the base class of build unit. The "Obj" parameter must provide
@@ -775,6 +822,10 @@ class Build():
         self.AutoGenTime    = 0
         self.MakeTime       = 0
         self.GenFdsTime     = 0
+        self.GenCTime       = 0
+        self.GenMakeTime    = 0
+        self.AutoGenPool    = None
+        self.AutoGenTaskIndex = {}
         GlobalData.BuildOptionPcd     = BuildOptions.OptionPcd if BuildOptions.OptionPcd else []
         #Set global flag for build mode
         GlobalData.gIgnoreSource = BuildOptions.IgnoreSources
@@ -782,6 +833,8 @@ class Build():
         GlobalData.gBinCacheDest   = BuildOptions.BinCacheDest
         GlobalData.gBinCacheSource = BuildOptions.BinCacheSource
         GlobalData.gEnableGenfdsMultiThread = BuildOptions.GenfdsMultiThread
+        GlobalData.gCompressCache = BuildOptions.CompressCache
+        GlobalData.gCompressCacheSize = BuildOptions.CompressCacheSize
 
         if GlobalData.gBinCacheDest and not GlobalData.gUseHashCache:
             EdkLogger.error("build", OPTION_NOT_SUPPORTED, ExtraData="--binary-destination must be used together with --hash.")
@@ -810,6 +863,18 @@ class Build():
             if GlobalData.gBinCacheDest is not None:
                 EdkLogger.error("build", OPTION_VALUE_INVALID, ExtraData="Invalid value of option --binary-destination.")
 
+        if GlobalData.gCompressCache:
+            CompressCache = os.path.normpath(GlobalData.gCompressCache)
+            if not os.path.isabs(CompressCache):
+                CompressCache = mws.join(self.WorkspaceDir, CompressCache)
+            GlobalData.gCompressCache = CompressCache
+        else:
+            if GlobalData.gCompressCache is not None:
+                EdkLogger.error("build", OPTION_VALUE_INVALID, ExtraData="Invalid value of option --compress-cache.")
+
+        if GlobalData.gCompressCacheSize is not None and GlobalData.gCompressCacheSize <= 0:
+            EdkLogger.error("build", OPTION_VALUE_INVALID, ExtraData="Invalid value of option --compress-cache-size.")
+
         if self.ConfDirectory:
             # Get alternate Conf location, if it is absolute, then just use the absolute directory name
             ConfDirectoryPath = os.path.normpath(self.ConfDirectory)
@@ -1235,14 +1300,18 @@ class Build():
             # for target which must generate AutoGen code and makefile
             if not self.SkipAutoGen or Target == 'genc':
                 self.Progress.Start("Generating code")
+                GenCStart = time.time()
                 AutoGenObject.CreateCodeFile(CreateDepsCodeFile)
+                self.GenCTime += time.time() - GenCStart
                 self.Progress.Stop("done!")
             if Target == "genc":
                 return True
 
             if not self.SkipAutoGen or Target == 'genmake':
                 self.Progress.Start("Generating makefile")
+                GenMakeStart = time.time()
                 AutoGenObject.CreateMakeFile(CreateDepsMakeFile, FfsCommand)
+                self.GenMakeTime += time.time() - GenMakeStart
                 self.Progress.Stop("done!")
             if Target == "genmake":
                 return True
@@ -1354,14 +1423,18 @@ class Build():
             # for target which must generate AutoGen code and makefile
             if not self.SkipAutoGen or Target == 'genc':
                 self.Progress.Start("Generating code")
+                GenCStart = time.time()
                 AutoGenObject.CreateCodeFile(CreateDepsCodeFile)
+                self.GenCTime += time.time() - GenCStart
                 self.Progress.Stop("done!")
             if Target == "genc":
                 return True
 
             if not self.SkipAutoGen or Target == 'genmake':
                 self.Progress.Start("Generating makefile")
+                GenMakeStart = time.time()
                 AutoGenObject.CreateMakeFile(CreateDepsMakeFile)
+                self.GenMakeTime += time.time() - GenMakeStart
                 #AutoGenObject.CreateAsBuiltInf()
                 self.Progress.Stop("done!")
             if Target == "genmake":
@@ -1865,17 +1938,21 @@ class Build():
                                 # for target which must generate AutoGen code and makefile
                                 if not self.SkipAutoGen or self.Target == 'genc':
                                     self.Progress.Start("Generating code")
+                                    GenCStart = time.time()
                                     Ma.CreateCodeFile(True)
+                                    self.GenCTime += time.time() - GenCStart
                                     self.Progress.Stop("done!")
                                 if self.Target == "genc":
                                     return True
                                 if not self.SkipAutoGen or self.Target == 'genmake':
                                     self.Progress.Start("Generating makefile")
+                                    GenMakeStart = time.time()
                                     if CmdListDict and self.Fdf and (Module.File, Arch) in CmdListDict:
                                         Ma.CreateMakeFile(True, CmdListDict[Module.File, Arch])
                                         del CmdListDict[Module.File, Arch]
                                     else:
                                         Ma.CreateMakeFile(True)
+                                    self.GenMakeTime += time.time() - GenMakeStart
                                     self.Progress.Stop("done!")
                                 if self.Target == "genmake":
                                     return True
@@ -2011,6 +2088,8 @@ class Build():
                 if GlobalData.gEnableGenfdsMultiThread and self.Fdf:
                     CmdListDict = self._GenFfsCmd()
 
+                self._StartAutoGenWorkers(Wa, BuildTarget, ToolChain, CmdListDict)
+
                 # multi-thread exit flag
                 ExitFlag = threading.Event()
                 ExitFlag.clear()
@@ -2021,17 +2100,8 @@ class Build():
                     Pa = PlatformAutoGen(Wa, self.PlatformFile, BuildTarget, ToolChain, Arch)
                     if Pa is None:
                         continue
-                    ModuleList = []
-                    for Inf in Pa.Platform.Modules:
-                        ModuleList.append(Inf)
-                    # Add the INF only list in FDF
-                    if GlobalData.gFdfParser is not None:
-                        for InfName in GlobalData.gFdfParser.Profile.InfList:
-                            Inf = PathClass(NormPath(InfName), self.WorkspaceDir, Arch)
-                            if Inf in Pa.Platform.Modules:
-                                continue
-                            ModuleList.append(Inf)
-                    for Module in ModuleList:
+                    AutoGenList = []
+                    for Module in self._GetModuleList(Pa):
                         # Get ModuleAutoGen object to generate C code file and makefile
                         Ma = ModuleAutoGen(Wa, Module, BuildTarget, ToolChain, Arch, self.PlatformFile)
 
@@ -2041,23 +2111,15 @@ class Build():
                             self.HashSkipModules.append(Ma)
                             continue
 
-                        # Not to auto-gen for targets 'clean', 'cleanlib', 'cleanall', 'run', 'fds'
-                        if self.Target not in ['clean', 'cleanlib', 'cleanall', 'run', 'fds']:
-                            # for target which must generate AutoGen code and makefile
-                            if not self.SkipAutoGen or self.Target == 'genc':
-                                Ma.CreateCodeFile(True)
-                            if self.Target == "genc":
-                                continue
-
-                            if not self.SkipAutoGen or self.Target == 'genmake':
-                                if CmdListDict and self.Fdf and (Module.File, Arch) in CmdListDict:
-                                    Ma.CreateMakeFile(True, CmdListDict[Module.File, Arch])
-                                    del CmdListDict[Module.File, Arch]
-                                else:
-                                    Ma.CreateMakeFile(True)
-                            if self.Target == "genmake":
-                                continue
+                        # Only the 'all' target gets here, which must generate AutoGen code and makefile
+                        if not self.SkipAutoGen:
+                            GenFfsList = []
+                            if CmdListDict and self.Fdf and (Module.File, Arch) in CmdListDict:
+                                GenFfsList = CmdListDict[Module.File, Arch]
+                                del CmdListDict[Module.File, Arch]
+                            AutoGenList.append((Ma, GenFfsList))
                         self.BuildModules.append(Ma)
+                    self._CreateAutoGenFiles(AutoGenList)
                     self.Progress.Stop("done!")
                     self.AutoGenTime += int(round((time.time() - AutoGenStart)))
                     MakeStart = time.time()
@@ -2082,6 +2144,7 @@ class Build():
                         EdkLogger.error("build", BUILD_ERROR, "Failed to build module", ExtraData=GlobalData.gBuildingModule)
                     self.MakeTime += int(round((time.time() - MakeStart)))
 
+                self._StopAutoGenWorkers()
                 MakeContiue = time.time()
                 #
                 # Save temp tables to a TmpTableDict.
@@ -2148,6 +2211,128 @@ class Build():
                     #
                     self._SaveMapFile(MapBuffer, Wa)
 
+    ## Get the modules of a platform to be built
+    #
+    #   @param  Pa      The PlatformAutoGen object of the platform
+    #
+    #   @retval list    The modules in the DSC file followed by the INF only
+    #                   list in the FDF file
+    #
+    def _GetModuleList(self, Pa):
+        ModuleList = []
+        for Inf in Pa.Platform.Modules:
+            ModuleList.append(Inf)
+        # Add the INF only list in FDF
+        if GlobalData.gFdfParser is not None:
+            for InfName in GlobalData.gFdfParser.Profile.InfList:
+                Inf = PathClass(NormPath(InfName), self.WorkspaceDir, Pa.Arch)
+                if Inf in Pa.Platform.Modules:
+                    continue
+                ModuleList.append(Inf)
+        return ModuleList
+
+    ## Start the processes generating the AutoGen files of a workspace
+    #
+    #   The processes are forked after the ModuleAutoGen objects of all modules
+    #   and libraries have been created, so they share the workspace data and
+    #   never parse a meta-file, which would write to the database. Python can
+    #   not fork on Windows, where the files are generated by the build process.
+    #
+    #   @param  Wa              The WorkspaceAutoGen object
+    #   @param  BuildTarget     The build target
+    #   @param  ToolChain       The tool chain
+    #   @param  CmdListDict     The FFS commands of the modules, or None
+    #
+    def _StartAutoGenWorkers(self, Wa, BuildTarget, ToolChain, CmdListDict):
+        if self.ThreadNumber < 2 or self.SkipAutoGen or sys.platform == "win32":
+            return
+
+        del gAutoGenTaskList[:]
+        self.AutoGenTaskIndex = {}
+        for Arch in Wa.ArchList:
+            GlobalData.gGlobalDefines['ARCH'] = Arch
+            Pa = PlatformAutoGen(Wa, self.PlatformFile, BuildTarget, ToolChain, Arch)
+            if Pa is None:
+                continue
+            for Module in self._GetModuleList(Pa):
+                Ma = ModuleAutoGen(Wa, Module, BuildTarget, ToolChain, Arch, self.PlatformFile)
+                if Ma is None:
+                    continue
+                GenFfsList = []
+                if CmdListDict and self.Fdf and (Module.File, Arch) in CmdListDict:
+                    GenFfsList = CmdListDict[Module.File, Arch]
+                for Obj, ObjFfsList in [(Ma, GenFfsList)] + [(La, []) for La in Ma.LibraryAutoGenList]:
+                    if (Obj.MetaFile, Arch) not in self.AutoGenTaskIndex:
+                        self.AutoGenTaskIndex[Obj.MetaFile, Arch] = len(gAutoGenTaskList)
+                        gAutoGenTaskList.append((Obj, ObjFfsList))
+
+        #
+        # Neither an open transaction of the database nor a thread printing the
+        # progress may be inherited by the processes.
+        #
+        self.Db.Conn.commit()
+        self.Progress.Stop("done!")
+        self.AutoGenPool = multiprocessing.Pool(self.ThreadNumber, InitAutoGenWorker, (self.Db,))
+        self.Progress.Start("Generating code and makefiles")
+
+    ## Stop the processes generating the AutoGen files
+    #
+    #   @param  Abort   Whether to stop them without waiting for their tasks
+    #
+    def _StopAutoGenWorkers(self, Abort=False):
+        if self.AutoGenPool is None:
+            return
+        if Abort:
+            self.AutoGenPool.terminate()
+        else:
+            self.AutoGenPool.close()
+        self.AutoGenPool.join()
+        self.AutoGenPool = None
+
+    ## Generate the AutoGen code files and makefiles of modules and their libraries
+    #
+    #   Without AutoGen worker processes, the modules are generated one after
+    #   another. Otherwise the libraries are generated first, each by a single
+    #   process, and then the modules without their libraries, so that no two
+    #   processes write the same file. Every file is generated from the same
+    #   data either way, so the output does not depend on the number of
+    #   processes or on the order they finish their tasks in.
+    #
+    #   @param  AutoGenList     List of (ModuleAutoGen object, FFS command list)
+    #
+    def _CreateAutoGenFiles(self, AutoGenList):
+        if self.AutoGenPool is None:
+            for Ma, GenFfsList in AutoGenList:
+                GenCStart = time.time()
+                Ma.CreateCodeFile(True)
+                GenMakeStart = time.time()
+                Ma.CreateMakeFile(True, GenFfsList)
+                self.GenCTime += GenMakeStart - GenCStart
+                self.GenMakeTime += time.time() - GenMakeStart
+            return
+
+        LibraryList = []
+        for Ma, GenFfsList in AutoGenList:
+            if not Ma.IsLibrary:
+                for La in Ma.LibraryAutoGenList:
+                    if La not in LibraryList:
+                        LibraryList.append(La)
+        ModuleList = [Ma for Ma, GenFfsList in AutoGenList if Ma not in LibraryList]
+
+        for MaList in [LibraryList, ModuleList]:
+            TaskList = [self.AutoGenTaskIndex[Ma.MetaFile, Ma.Arch] for Ma in MaList]
+            # wait with a timeout, as Ctrl-C is ignored by a wait without one
+            ResultList = self.AutoGenPool.map_async(CreateAutoGenFiles, TaskList, 1).get(0x7FFFFFFF)
+            for Index, ErrorCode, IsCodeFileCreated, DepexGenerated, GenCTime, GenMakeTime in ResultList:
+                if ErrorCode:
+                    self._StopAutoGenWorkers(True)
+                    raise FatalError(ErrorCode)
+                Ma = gAutoGenTaskList[Index][0]
+                Ma.IsCodeFileCreated = IsCodeFileCreated
+                Ma.DepexGenerated = DepexGenerated
+                self.GenCTime += GenCTime
+                self.GenMakeTime += GenMakeTime
+
     ## Generate GuidedSectionTools.txt in the FV directories.
     #
     def CreateGuidedSectionToolsFile(self):
@@ -2247,6 +2432,7 @@ class Build():
         EdkLogger.SetLevel(EdkLogger.ERROR)
         #self.DumpBuildData()
         Utils.Progressor.Abort()
+        self._StopAutoGenWorkers(True)
         if self.SpawnMode == True:
             BuildTask.Abort()
         EdkLogger.SetLevel(OldLogLevel)
@@ -2375,6 +2561,8 @@ def MyOptionParser():
     Parser.add_option("--binary-destination", action="store", type="string", dest="BinCacheDest", help="Generate a cache of binary files in the specified directory.")
     Parser.add_option("--binary-source", action="store", type="string", dest="BinCacheSource", help="Consume a cache of binary files from the specified directory.")
     Parser.add_option("--genfds-multi-thread", action="store_true", dest="GenfdsMultiThread", default=False, help="Enable GenFds multi thread to generate ffs file.")
+    Parser.add_option("--compress-cache", action="store", type="string", dest="CompressCache", help="Reuse the compressed sections saved in the specified directory and save new ones there.")
+    Parser.add_option("--compress-cache-size", action="store", type="int", dest="CompressCacheSize", help="Specify the size limit of the compression cache in MB. Default is 1024.")
     (Opt, Args) = Parser.parse_args()
     return (Opt, Args)
 
@@ -2571,6 +2759,17 @@ def Main():
     EdkLogger.SetLevel(EdkLogger.QUIET)
     EdkLogger.quiet("\n- %s -" % Conclusion)
     EdkLogger.quiet(time.strftime("Build end time: %H:%M:%S, %b.%d %Y", time.localtime()))
+    if MyBuild is not None and not BuildError:
+        #
+        # The code files and makefiles are generated during AutoGen, in all
+        # AutoGen worker processes together in multi-thread build mode, so
+        # their time is summed over the processes.
+        #
+        EdkLogger.quiet("Build phase time:")
+        for Phase, PhaseTime in [("AutoGen", MyBuild.AutoGenTime), ("  Code files", MyBuild.GenCTime),
+                                 ("  Makefiles", MyBuild.GenMakeTime), ("Make", MyBuild.MakeTime),
+                                 ("GenFds", MyBuild.GenFdsTime)]:
+            EdkLogger.quiet("  %-14s: %s" % (Phase, LogBuildTime(int(round(PhaseTime))) or "00:00:00"))
     EdkLogger.quiet("Build total time: %s\n" % BuildDurationStr)
     return ReturnCode
 
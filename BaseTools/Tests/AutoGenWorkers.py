@@ -0,0 +1,131 @@
+## @file
+#  Unit tests for the AutoGen worker processes of build
+#
+#  Copyright (c) 2018, Intel Corporation. All rights reserved.<BR>
+#
+#  This program and the accompanying materials
+#  are licensed and made available under the terms and conditions of the BSD License
+#  which accompanies this distribution.  The full text of the license may be found at
+#  http://opensource.org/licenses/bsd-license.php
+#
+#  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+#
+
+##
+# Import Modules
+#
+import os
+import shutil
+import sys
+import unittest
+
+import TestTools
+
+#
+# A platform of one application. Its libraries are AutoGen tasks of their own.
+#
+PLATFORM_DSC = '''
+[Defines]
+  PLATFORM_NAME                  = AutoGenWorkers
+  PLATFORM_GUID                  = 2E6E3B38-4B0E-4C4F-9D55-1C7A0C1B8F21
+  PLATFORM_VERSION               = 0.1
+  DSC_SPECIFICATION              = 0x00010005
+  OUTPUT_DIRECTORY               = Build/AutoGenWorkers
+  SUPPORTED_ARCHITECTURES        = IA32|X64
+  BUILD_TARGETS                  = DEBUG
+  SKUID_IDENTIFIER               = DEFAULT
+
+[LibraryClasses]
+  UefiApplicationEntryPoint|MdePkg/Library/UefiApplicationEntryPoint/UefiApplicationEntryPoint.inf
+  UefiLib|MdePkg/Library/UefiLib/UefiLib.inf
+  PcdLib|MdePkg/Library/BasePcdLibNull/BasePcdLibNull.inf
+  DebugLib|MdePkg/Library/BaseDebugLibNull/BaseDebugLibNull.inf
+  BaseLib|MdePkg/Library/BaseLib/BaseLib.inf
+  BaseMemoryLib|MdePkg/Library/BaseMemoryLib/BaseMemoryLib.inf
+  PrintLib|MdePkg/Library/BasePrintLib/BasePrintLib.inf
+  MemoryAllocationLib|MdePkg/Library/UefiMemoryAllocationLib/UefiMemoryAllocationLib.inf
+  DevicePathLib|MdePkg/Library/UefiDevicePathLib/UefiDevicePathLib.inf
+  UefiBootServicesTableLib|MdePkg/Library/UefiBootServicesTableLib/UefiBootServicesTableLib.inf
+  UefiRuntimeServicesTableLib|MdePkg/Library/UefiRuntimeServicesTableLib/UefiRuntimeServicesTableLib.inf
+
+[Components]
+  MdeModulePkg/Application/HelloWorld/HelloWorld.inf
+'''
+
+@unittest.skipIf(sys.platform == 'win32', 'The make of GCC5 is replaced by a shell script')
+class Tests(TestTools.BaseToolsTest):
+
+    def setUp(self):
+        TestTools.BaseToolsTest.setUp(self)
+        self.savedEnviron = os.environ.copy()
+
+    def tearDown(self):
+        os.environ.clear()
+        os.environ.update(self.savedEnviron)
+        TestTools.BaseToolsTest.tearDown(self)
+
+    ## Build the platform with make replaced by a script doing nothing
+    #
+    #   No compiler is run, but the AutoGen files of all the modules are
+    #   generated, by the worker processes if ThreadNumber is more than 1.
+    #
+    def BuildPlatform(self, ThreadNumber):
+        ConfDir = self.GetTmpFilePath('Conf')
+        os.mkdir(ConfDir)
+        for Template, Txt in (('tools_def.template', 'tools_def.txt'),
+                              ('build_rule.template', 'build_rule.txt'),
+                              ('target.template', 'target.txt')):
+            shutil.copyfile(os.path.join(TestTools.BaseToolsDir, 'Conf', Template), os.path.join(ConfDir, Txt))
+        BinDir = self.GetTmpFilePath('bin')
+        os.mkdir(BinDir)
+        self.WriteTmpFile(os.path.join('bin', 'make'), '#!/bin/sh\nexit 0\n')
+        os.chmod(os.path.join(BinDir, 'make'), 0o755)
+        os.mkdir(self.GetTmpFilePath('AutoGenWorkers'))
+        self.WriteTmpFile(os.path.join('AutoGenWorkers', 'AutoGenWorkers.dsc'), PLATFORM_DSC)
+
+        os.environ['WORKSPACE'] = self.testDir
+        os.environ['PACKAGES_PATH'] = os.path.realpath(os.path.join(TestTools.BaseToolsDir, '..'))
+        os.environ['EDK_TOOLS_PATH'] = TestTools.BaseToolsDir
+        os.environ['CONF_PATH'] = ConfDir
+        # the make of GCC5 is DEF(GCC_HOST_PREFIX)make
+        os.environ['GCC_HOST_BIN'] = BinDir + os.sep
+
+        return self.RunTool(
+            '-p', 'AutoGenWorkers/AutoGenWorkers.dsc',
+            '-a', 'IA32', '-a', 'X64', '-t', 'GCC5', '-b', 'DEBUG',
+            '-n', str(ThreadNumber),
+            toolName='build', logFile='build.log'
+            )
+
+    def CheckAutoGenFiles(self):
+        for Arch in ('IA32', 'X64'):
+            ArchDir = self.GetTmpFilePath(os.path.join('Build', 'AutoGenWorkers', 'DEBUG_GCC5', Arch))
+            for Module in (os.path.join('MdeModulePkg', 'Application', 'HelloWorld', 'HelloWorld'),
+                           os.path.join('MdePkg', 'Library', 'UefiLib', 'UefiLib'),
+                           os.path.join('MdePkg', 'Library', 'BaseLib', 'BaseLib')):
+                ModuleDir = os.path.join(ArchDir, Module)
+                self.assertTrue(os.path.exists(os.path.join(ModuleDir, 'DEBUG', 'AutoGen.h')), ModuleDir)
+                self.assertTrue(os.path.exists(os.path.join(ModuleDir, 'GNUmakefile')), ModuleDir)
+
+    def testAutoGenWorkers(self):
+        Result = self.RunBuildAndCheck(4)
+        self.assertEqual(Result, 0)
+
+    def testSingleProcess(self):
+        Result = self.RunBuildAndCheck(1)
+        self.assertEqual(Result, 0)
+
+    def RunBuildAndCheck(self, ThreadNumber):
+        Result = self.BuildPlatform(ThreadNumber)
+        if Result != 0:
+            self.DisplayFile('build.log')
+            return Result
+        self.CheckAutoGenFiles()
+        return Result
+
+TheTestSuite = TestTools.MakeTheTestSuite(locals())
+
+if __name__ == '__main__':
+    allTests = TheTestSuite()
+    unittest.TextTestRunner().run(allTests)
@@ -19,9 +19,17 @@ import os
 import sys
 import unittest
 
+import GenCrc32
+import GenFv
+import LzmaCompress
 import TianoCompress
+import VfrCompile
 modules = (
+    GenCrc32,
+    GenFv,
+    LzmaCompress,
     TianoCompress,
+    VfrCompile,
     )
 
 
@@ -0,0 +1,80 @@
+## @file
+# Unit tests for GenCrc32 utility
+#
+#  Copyright (c) 2018, Intel Corporation. All rights reserved.<BR>
+#
+#  This program and the accompanying materials
+#  are licensed and made available under the terms and conditions of the BSD License
+#  which accompanies this distribution.  The full text of the license may be found at
+#  http://opensource.org/licenses/bsd-license.php
+#
+#  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+#
+
+##
+# Import Modules
+#
+from __future__ import print_function
+import struct
+import unittest
+import zlib
+
+import TestTools
+
+class Tests(TestTools.BaseToolsTest):
+
+    def setUp(self):
+        TestTools.BaseToolsTest.setUp(self)
+        self.toolName = 'GenCrc32'
+
+    def testHelp(self):
+        result = self.RunTool('--help', logFile='help')
+        #self.DisplayFile('help')
+        self.assertTrue(result == 0)
+
+    def crcTestCycle(self, data):
+        self.WriteTmpFile('input', data)
+        result = self.RunTool(
+            '-e',
+            '-o', self.GetTmpFilePath('output1'),
+            self.GetTmpFilePath('input')
+            )
+        self.assertTrue(result == 0)
+        f = self.OpenTmpFile('output1', 'rb')
+        encoded = f.read()
+        f.close()
+        crc = struct.unpack('<I', encoded[:4])[0]
+        expected = zlib.crc32(data) & 0xffffffff
+        if crc != expected:
+            print()
+            print('CRC32 0x%08x of %d bytes does not match 0x%08x' % (crc, len(data), expected))
+        self.assertTrue(crc == expected)
+        self.assertTrue(encoded[4:] == data)
+        result = self.RunTool(
+            '-d',
+            '-o', self.GetTmpFilePath('output2'),
+            self.GetTmpFilePath('output1')
+            )
+        self.assertTrue(result == 0)
+        self.assertTrue(self.ReadTmpFile('output2') == data)
+
+    def testShortDataCycles(self):
+        #
+        # Cover every length around the 8-byte steps of the slicing-by-8 loop.
+        #
+        for length in range(1, 25):
+            self.crcTestCycle(self.GetRandomString(length))
+            self.CleanUpTmpDir()
+
+    def testRandomDataCycles(self):
+        for i in range(8):
+            data = self.GetRandomString(1024, 65536)
+            self.crcTestCycle(data)
+            self.CleanUpTmpDir()
+
+TheTestSuite = TestTools.MakeTheTestSuite(locals())
+
+if __name__ == '__main__':
+    allTests = TheTestSuite()
+    unittest.TextTestRunner().run(allTests)
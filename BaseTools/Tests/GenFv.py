@@ -0,0 +1,176 @@
+## @file
+# Unit tests for the FFS file packing of the GenFv utility
+#
+#  Copyright (c) 2018, Intel Corporation. All rights reserved.<BR>
+#
+#  This program and the accompanying materials
+#  are licensed and made available under the terms and conditions of the BSD License
+#  which accompanies this distribution.  The full text of the license may be found at
+#  http://opensource.org/licenses/bsd-license.php
+#
+#  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+#
+
+##
+# Import Modules
+#
+import random
+import re
+import struct
+import unittest
+import uuid
+
+import TestTools
+
+DXE_APRIORI_GUID = 'FC510EE7-FFDC-11D4-BD41-0080C73C8881'
+FILETYPE_RAW = 0x01
+FILETYPE_DRIVER = 0x07
+FILETYPE_FFS_PAD = 0xF0
+FFS_ATTRIB_FIXED = 0x04
+DATA_ALIGNMENT_LIST = (1, 16, 128, 512, 1024, 4 * 1024, 32 * 1024, 64 * 1024)
+
+class Tests(TestTools.BaseToolsTest):
+
+    def setUp(self):
+        TestTools.BaseToolsTest.setUp(self)
+        self.toolName = 'GenFv'
+
+    def genFfs(self, name, fileType, data, *options):
+        #
+        # Drivers need a PE32 section, GenFv does not rebase it without a base address.
+        #
+        sectionType = 'EFI_SECTION_RAW'
+        if fileType == 'EFI_FV_FILETYPE_DRIVER':
+            sectionType = 'EFI_SECTION_PE32'
+        self.WriteTmpFile(name + '.raw', data)
+        result = self.RunTool(
+            '-s', sectionType,
+            '-o', self.GetTmpFilePath(name + '.sec'),
+            self.GetTmpFilePath(name + '.raw'),
+            toolName='GenSec'
+            )
+        self.assertTrue(result == 0)
+        result = self.RunTool(
+            '-t', fileType,
+            '-g', name,
+            '-o', self.GetTmpFilePath(name + '.ffs'),
+            '-i', self.GetTmpFilePath(name + '.sec'),
+            *options,
+            toolName='GenFfs'
+            )
+        self.assertTrue(result == 0)
+        return self.GetTmpFilePath(name + '.ffs')
+
+    ##
+    # Generate an apriori file, drivers of random sizes with some of them
+    # aligned, a fixed driver and a raw file.
+    #
+    def genFfsFiles(self):
+        rand = random.Random(0x5eed)
+        names = [str(uuid.UUID(int=rand.getrandbits(128))).upper() for index in range(40)]
+        apriori = names[3:6]
+        ffsFiles = [
+            self.genFfs(DXE_APRIORI_GUID, 'EFI_FV_FILETYPE_FREEFORM', ''.join(uuid.UUID(name).bytes_le for name in apriori))
+            ]
+        for index, name in enumerate(names):
+            options = []
+            if index % 7 == 2:
+                options = ['-a', '4K']
+            elif index % 7 == 5:
+                options = ['-a', '1K']
+            if index == 20:
+                options.append('-x')
+            data = ''.join(chr(rand.randint(0, 255)) for byte in range(rand.randint(64, 3000)))
+            if index == 30:
+                ffsFiles.append(self.genFfs(name, 'EFI_FV_FILETYPE_RAW', data, *options))
+            else:
+                ffsFiles.append(self.genFfs(name, 'EFI_FV_FILETYPE_DRIVER', data, *options))
+        return ffsFiles, apriori
+
+    def genFv(self, fvName, ffsFiles, *options):
+        args = ['-b', '0x1000', '-o', self.GetTmpFilePath(fvName)]
+        for ffsFile in ffsFiles:
+            args += ['-f', ffsFile]
+        result = self.RunTool(*(args + list(options)), logFile='log')
+        if result != 0:
+            self.DisplayFile('log')
+        self.assertTrue(result == 0)
+        return self.OpenTmpFile(fvName, 'rb').read()
+
+    ##
+    # Return the files of a FV as (Name, Type, Attributes, Offset, Data),
+    # and the total size of its pad files.
+    #
+    def parseFv(self, fv):
+        fvLength, = struct.unpack_from('<Q', fv, 32)
+        headerLength, = struct.unpack_from('<H', fv, 48)
+        files = []
+        padSize = 0
+        offset = headerLength
+        while offset + 24 <= fvLength and fv[offset:offset + 24] != '\xff' * 24:
+            name = str(uuid.UUID(bytes_le=fv[offset:offset + 16])).upper()
+            fileType, attributes = struct.unpack_from('<BB', fv, offset + 18)
+            size = struct.unpack_from('<I', fv, offset + 20)[0] & 0xFFFFFF
+            if fileType == FILETYPE_FFS_PAD:
+                padSize += size
+            else:
+                files.append((name, fileType, attributes, offset, fv[offset + 24:offset + size]))
+            offset = (offset + size + 7) & ~7
+        return files, padSize
+
+    def readMapValue(self, mapName, key):
+        match = re.search(key + r' = (0x[0-9a-fA-F]+)', self.ReadTmpFile(mapName))
+        if match is None:
+            return 0
+        return int(match.group(1), 16)
+
+    def testPackedFvLoadsSameDrivers(self):
+        ffsFiles, apriori = self.genFfsFiles()
+        original, originalPadSize = self.parseFv(self.genFv('Original.fv', ffsFiles))
+        packed, packedPadSize = self.parseFv(self.genFv('Packed.fv', ffsFiles, '--pack'))
+
+        #
+        # The same files are in the FV, with the same content.
+        #
+        self.assertTrue(len(original) == len(ffsFiles))
+        self.assertTrue(sorted((f[0], f[1], f[4]) for f in original) == sorted((f[0], f[1], f[4]) for f in packed))
+
+        #
+        # The data of every file is aligned.
+        #
+        for name, fileType, attributes, offset, data in packed:
+            self.assertTrue((offset + 24) % DATA_ALIGNMENT_LIST[(attributes >> 3) & 7] == 0)
+
+        #
+        # The apriori file, the files it lists, fixed and raw files keep
+        # their order, and only the other drivers moved.
+        #
+        def IsPinned(f):
+            return f[0] == DXE_APRIORI_GUID or f[0] in apriori or f[1] != FILETYPE_DRIVER or (f[2] & FFS_ATTRIB_FIXED)
+        self.assertTrue([f[0] for f in original if IsPinned(f)] == [f[0] for f in packed if IsPinned(f)])
+        self.assertTrue([f[0] for f in original] != [f[0] for f in packed])
+
+        #
+        # Less space is taken by pad files, and the map files report it.
+        #
+        self.assertTrue(packedPadSize < originalPadSize)
+        self.assertTrue(self.readMapValue('Original.fv.map', 'EFI_FV_PAD_SIZE') == originalPadSize)
+        self.assertTrue(self.readMapValue('Packed.fv.map', 'EFI_FV_PAD_SIZE') == packedPadSize)
+        self.assertTrue(self.readMapValue('Packed.fv.map', 'EFI_FV_TAKEN_SIZE') < self.readMapValue('Original.fv.map', 'EFI_FV_TAKEN_SIZE'))
+
+    def testPackWithoutPadFiles(self):
+        #
+        # Without aligned files there is nothing to pack, and the order is kept.
+        #
+        ffsFiles = [self.genFfs(str(uuid.UUID(int=index + 1)).upper(), 'EFI_FV_FILETYPE_DRIVER', 'x' * (100 * index + 10)) for index in range(8)]
+        original, originalPadSize = self.parseFv(self.genFv('Original.fv', ffsFiles))
+        packed, packedPadSize = self.parseFv(self.genFv('Packed.fv', ffsFiles, '--pack'))
+        self.assertTrue(original == packed)
+        self.assertTrue(packedPadSize == 0)
+
+TheTestSuite = TestTools.MakeTheTestSuite(locals())
+
+if __name__ == '__main__':
+    allTests = TheTestSuite()
+    unittest.TextTestRunner().run(allTests)
@@ -0,0 +1,80 @@
+## @file
+# Unit tests for LzmaCompress utility
+#
+#  Copyright (c) 2008, Intel Corporation. All rights reserved.<BR>
+#
+#  This program and the accompanying materials
+#  are licensed and made available under the terms and conditions of the BSD License
+#  which accompanies this distribution.  The full text of the license may be found at
+#  http://opensource.org/licenses/bsd-license.php
+#
+#  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+#
+
+
+##
+# Import Modules
+#
+from __future__ import print_function
+import unittest
+
+import TestTools
+
+class Tests(TestTools.BaseToolsTest):
+
+    def setUp(self):
+        TestTools.BaseToolsTest.setUp(self)
+        self.toolName = 'LzmaCompress'
+
+    def compressionTestCycle(self, data, *options):
+        self.WriteTmpFile('input', data)
+        result = self.RunTool(
+            '-e',
+            '-o', self.GetTmpFilePath('output1'),
+            self.GetTmpFilePath('input'),
+            *options
+            )
+        self.assertTrue(result == 0)
+        result = self.RunTool(
+            '-d',
+            '-o', self.GetTmpFilePath('output2'),
+            self.GetTmpFilePath('output1'),
+            *options
+            )
+        self.assertTrue(result == 0)
+        start = self.ReadTmpFile('input')
+        finish = self.ReadTmpFile('output2')
+        startEqualsFinish = start == finish
+        if not startEqualsFinish:
+            print()
+            print('Original data did not match decompress(compress(data))')
+            self.DisplayBinaryData('original data', start)
+            self.DisplayBinaryData('after compression', self.ReadTmpFile('output1'))
+            self.DisplayBinaryData('after decomression', finish)
+        self.assertTrue(startEqualsFinish)
+
+    def testRandomDataCycles(self):
+        for i in range(4):
+            data = self.GetRandomString(1024, 2048)
+            self.compressionTestCycle(data)
+            self.CleanUpTmpDir()
+
+    def testMultiBlockCycles(self):
+        for i in range(4):
+            data = self.GetRandomString(1024, 2048)
+            self.compressionTestCycle(data, '--multi-block', '--block-size', '512')
+            self.CleanUpTmpDir()
+
+    def testMultiBlockEmptyInput(self):
+        #
+        # An empty section is encoded as a header without blocks.
+        #
+        self.compressionTestCycle('', '--multi-block')
+        self.assertTrue(len(self.ReadTmpFile('output1')) == 16)
+
+TheTestSuite = TestTools.MakeTheTestSuite(locals())
+
+if __name__ == '__main__':
+    allTests = TheTestSuite()
+    unittest.TextTestRunner().run(allTests)
@@ -26,6 +26,8 @@ def TheTestSuite():
     suites.append(CheckPythonSyntax.TheTestSuite())
     import CheckUnicodeSourceFiles
     suites.append(CheckUnicodeSourceFiles.TheTestSuite())
+    import AutoGenWorkers
+    suites.append(AutoGenWorkers.TheTestSuite())
     return unittest.TestSuite(suites)
 
 if __name__ == '__main__':
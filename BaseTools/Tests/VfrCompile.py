@@ -0,0 +1,123 @@
+## @file
+# Unit tests and compile-time benchmark for VfrCompile utility
+#
+#  Copyright (c) 2018, Intel Corporation. All rights reserved.<BR>
+#
+#  This program and the accompanying materials
+#  are licensed and made available under the terms and conditions of the BSD License
+#  which accompanies this distribution.  The full text of the license may be found at
+#  http://opensource.org/licenses/bsd-license.php
+#
+#  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+#
+
+##
+# Import Modules
+#
+from __future__ import print_function
+import time
+import unittest
+
+import TestTools
+
+FORM_NUMBER = 16
+RULE_NUMBER = 8
+TYPE_NUMBER = 64
+
+##
+# Generate a setup VFR with QuestionNumber groups of checkbox, numeric,
+# oneof and goto questions, spread over several forms, with extra data
+# types, varstores and rules to fill the symbol tables.
+#
+def GenerateVfr(QuestionNumber):
+    Lines = []
+    Lines.append('typedef struct {')
+    Lines.append('  UINT8  Check[%d];' % QuestionNumber)
+    Lines.append('  UINT16 Num[%d];' % QuestionNumber)
+    Lines.append('  UINT8  Sel[%d];' % QuestionNumber)
+    Lines.append('} BENCH_DATA;')
+    for Type in range(TYPE_NUMBER):
+        Lines.append('typedef struct { UINT32 A%d; UINT8 B%d[4]; } BENCH_TYPE_%d;' % (Type, Type, Type))
+    Lines.append('formset')
+    Lines.append('  guid = {0x12345678, 0x1234, 0x1234, {0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0}},')
+    Lines.append('  title = STRING_TOKEN(0x0002),')
+    Lines.append('  help = STRING_TOKEN(0x0003),')
+    Lines.append('  varstore BENCH_DATA, varid = 0x1000, name = BenchData, guid = {0x12345678, 0x1234, 0x1234, {0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf1}};')
+    for Type in range(TYPE_NUMBER):
+        Lines.append('  varstore BENCH_TYPE_%d, name = BenchType%d, guid = {0x12345678, 0x1234, 0x1234, {0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0x%02x}};' % (Type, Type, Type + 2))
+    PerForm = (QuestionNumber + FORM_NUMBER - 1) // FORM_NUMBER
+    for Form in range(FORM_NUMBER):
+        Lines.append('  form formid = %d, title = STRING_TOKEN(0x0002);' % (Form + 1))
+        for Rule in range(RULE_NUMBER):
+            Lines.append('    rule R%d_%d, ideqval BenchData.Check[%d] == 1 endrule;' % (Form, Rule, min(Form * PerForm, QuestionNumber - 1)))
+        for Index in range(Form * PerForm, min(QuestionNumber, (Form + 1) * PerForm)):
+            QuestionId = 0x1000 + 4 * Index
+            Lines.append('    checkbox varid = BenchData.Check[%d], questionid = 0x%x, prompt = STRING_TOKEN(0x0004), help = STRING_TOKEN(0x0004), endcheckbox;' % (Index, QuestionId))
+            Lines.append('    suppressif ideqval BenchData.Check[%d] == 0;' % Index)
+            Lines.append('    numeric varid = BenchData.Num[%d], questionid = 0x%x, prompt = STRING_TOKEN(0x0004), help = STRING_TOKEN(0x0004), minimum = 0, maximum = 1000, step = 1, default = 5,' % (Index, QuestionId + 1))
+            Lines.append('      inconsistentif prompt = STRING_TOKEN(0x0004), ideqval BenchData.Num[%d] == 999 endif;' % Index)
+            Lines.append('    endnumeric;')
+            Lines.append('    endif;')
+            Lines.append('    oneof varid = BenchData.Sel[%d], questionid = 0x%x, prompt = STRING_TOKEN(0x0004), help = STRING_TOKEN(0x0004),' % (Index, QuestionId + 2))
+            Lines.append('      option text = STRING_TOKEN(0x0005), value = 0, flags = DEFAULT;')
+            Lines.append('      option text = STRING_TOKEN(0x0006), value = 1, flags = 0;')
+            Lines.append('    endoneof;')
+            Lines.append('    grayoutif ideqid BenchData.Check[%d] == BenchData.Sel[%d];' % (Index, Index))
+            Lines.append('    goto %d, questionid = 0x%x, prompt = STRING_TOKEN(0x0004), help = STRING_TOKEN(0x0004);' % ((Form + 1) % FORM_NUMBER + 1, QuestionId + 3))
+            Lines.append('    endif;')
+        Lines.append('  endform;')
+    Lines.append('endformset;')
+    return '\n'.join(Lines) + '\n'
+
+class Tests(TestTools.BaseToolsTest):
+
+    def setUp(self):
+        TestTools.BaseToolsTest.setUp(self)
+        self.toolName = 'VfrCompile'
+
+    def compileVfr(self, questionNumber):
+        self.WriteTmpFile('Bench.vfr', GenerateVfr(questionNumber))
+        start = time.time()
+        result = self.RunTool(
+            '-n', '-l', '-b',
+            '-o', self.testDir,
+            self.GetTmpFilePath('Bench.vfr'),
+            logFile='log'
+            )
+        elapsed = time.time() - start
+        if result != 0:
+            self.DisplayFile('log')
+        self.assertTrue(result == 0)
+        return elapsed
+
+    def testRecordList(self):
+        #
+        # Every question of the VFR has its opcodes listed after its line.
+        #
+        self.compileVfr(32)
+        listing = self.ReadTmpFile('Bench.lst').splitlines()
+        questions = 0
+        for index, line in enumerate(listing):
+            if line.lstrip().startswith(('checkbox', 'numeric', 'oneof', 'goto')):
+                questions += 1
+                self.assertTrue(listing[index + 1].startswith('>'))
+        self.assertTrue(questions == 32 * 4)
+        self.assertTrue('Total Size of all record is' in ''.join(listing))
+
+    def testLargeVfrCompileTime(self):
+        #
+        # The symbol tables and the record list file scale with the number
+        # of questions, so report the compile time of a large setup VFR.
+        #
+        print()
+        for questionNumber in (500, 2000, 4000):
+            elapsed = self.compileVfr(questionNumber)
+            print('VfrCompile: %d questions compiled in %.2f seconds' % (questionNumber * 4, elapsed))
+            self.CleanUpTmpDir()
+
+TheTestSuite = TestTools.MakeTheTestSuite(locals())
+
+if __name__ == '__main__':
+    allTests = TheTestSuite()
+    unittest.TextTestRunner().run(allTests)
@@ -0,0 +1,468 @@
+/** @file
+  Crypto micro-benchmark application.
+
+  Measures the throughput of the digest, HMAC and cipher services of
+  BaseCryptLib, so that OpensslLib builds with different configurations or
+  tool chains can be compared on the target processor.
+
+  Copyright (c) 2018, Intel Corporation. All rights reserved.<BR>
+  This program and the accompanying materials
+  are licensed and made available under the terms and conditions of the BSD License
+  which accompanies this distribution.  The full text of the license may be found at
+  http://opensource.org/licenses/bsd-license.php
+
+  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/TimerLib.h>
+#include <Library/UefiLib.h>
+#include <Library/UefiApplicationEntryPoint.h>
+#include <Library/BaseCryptLib.h>
+
+//
+// Size of the buffer processed by one call, a multiple of the AES block size.
+//
+#define CRYPT_BENCH_BUFFER_SIZE   SIZE_64KB
+
+//
+// Minimum time spent measuring each primitive, in nanoseconds.
+//
+#define CRYPT_BENCH_MIN_TIME      1000000000ULL
+
+/**
+  Process a buffer once with the primitive under test.
+
+  @param[in]  Context   The context of the primitive.
+  @param[in]  Data      The buffer to process.
+  @param[in]  DataSize  The size of Data in bytes.
+  @param[out] Output    The output buffer, at least DataSize bytes.
+
+  @retval TRUE   The buffer was processed.
+  @retval FALSE  The primitive failed.
+
+**/
+typedef
+BOOLEAN
+(*CRYPT_BENCH_RUN) (
+  IN  VOID         *Context,
+  IN  CONST UINT8  *Data,
+  IN  UINTN        DataSize,
+  OUT UINT8        *Output
+  );
+
+/**
+  Create and initialize the context of the primitive under test.
+
+  @return The context, or NULL on failure.
+
+**/
+typedef
+VOID *
+(*CRYPT_BENCH_NEW) (
+  VOID
+  );
+
+typedef struct {
+  CHAR16           *Name;
+  CRYPT_BENCH_NEW  New;
+  CRYPT_BENCH_RUN  Run;
+} CRYPT_BENCH;
+
+GLOBAL_REMOVE_IF_UNREFERENCED CONST UINT8 mBenchKey[32] = {
+  0x60, 0x3d, 0xeb, 0x10, 0x15, 0xca, 0x71, 0xbe, 0x2b, 0x73, 0xae, 0xf0, 0x85, 0x7d, 0x77, 0x81,
+  0x1f, 0x35, 0x2c, 0x07, 0x3b, 0x61, 0x08, 0xd7, 0x2d, 0x98, 0x10, 0xa3, 0x09, 0x14, 0xdf, 0xf4
+};
+
+GLOBAL_REMOVE_IF_UNREFERENCED CONST UINT8 mBenchIvec[16] = {
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+
+/**
+  Allocate a SHA-1 context.
+
+  @return The SHA-1 context, or NULL on failure.
+
+**/
+VOID *
+NewSha1 (
+  VOID
+  )
+{
+  return AllocatePool (Sha1GetContextSize ());
+}
+
+/**
+  Compute the SHA-1 digest of a buffer, see CRYPT_BENCH_RUN.
+
+**/
+BOOLEAN
+RunSha1 (
+  IN  VOID         *Context,
+  IN  CONST UINT8  *Data,
+  IN  UINTN        DataSize,
+  OUT UINT8        *Output
+  )
+{
+  return Sha1Init (Context) &&
+         Sha1Update (Context, Data, DataSize) &&
+         Sha1Final (Context, Output);
+}
+
+/**
+  Allocate a SHA-256 context.
+
+  @return The SHA-256 context, or NULL on failure.
+
+**/
+VOID *
+NewSha256 (
+  VOID
+  )
+{
+  return AllocatePool (Sha256GetContextSize ());
+}
+
+/**
+  Compute the SHA-256 digest of a buffer, see CRYPT_BENCH_RUN.
+
+**/
+BOOLEAN
+RunSha256 (
+  IN  VOID         *Context,
+  IN  CONST UINT8  *Data,
+  IN  UINTN        DataSize,
+  OUT UINT8        *Output
+  )
+{
+  return Sha256Init (Context) &&
+         Sha256Update (Context, Data, DataSize) &&
+         Sha256Final (Context, Output);
+}
+
+/**
+  Allocate a SHA-384 context.
+
+  @return The SHA-384 context, or NULL on failure.
+
+**/
+VOID *
+NewSha384 (
+  VOID
+  )
+{
+  return AllocatePool (Sha384GetContextSize ());
+}
+
+/**
+  Compute the SHA-384 digest of a buffer, see CRYPT_BENCH_RUN.
+
+**/
+BOOLEAN
+RunSha384 (
+  IN  VOID         *Context,
+  IN  CONST UINT8  *Data,
+  IN  UINTN        DataSize,
+  OUT UINT8        *Output
+  )
+{
+  return Sha384Init (Context) &&
+         Sha384Update (Context, Data, DataSize) &&
+         Sha384Final (Context, Output);
+}
+
+/**
+  Allocate a SHA-512 context.
+
+  @return The SHA-512 context, or NULL on failure.
+
+**/
+VOID *
+NewSha512 (
+  VOID
+  )
+{
+  return AllocatePool (Sha512GetContextSize ());
+}
+
+/**
+  Compute the SHA-512 digest of a buffer, see CRYPT_BENCH_RUN.
+
+**/
+BOOLEAN
+RunSha512 (
+  IN  VOID         *Context,
+  IN  CONST UINT8  *Data,
+  IN  UINTN        DataSize,
+  OUT UINT8        *Output
+  )
+{
+  return Sha512Init (Context) &&
+         Sha512Update (Context, Data, DataSize) &&
+         Sha512Final (Context, Output);
+}
+
+/**
+  Allocate a HMAC-SHA256 context.
+
+  @return The HMAC-SHA256 context, or NULL on failure.
+
+**/
+VOID *
+NewHmacSha256 (
+  VOID
+  )
+{
+  return AllocatePool (HmacSha256GetContextSize ());
+}
+
+/**
+  Compute the HMAC-SHA256 of a buffer with a fixed key, see CRYPT_BENCH_RUN.
+
+**/
+BOOLEAN
+RunHmacSha256 (
+  IN  VOID         *Context,
+  IN  CONST UINT8  *Data,
+  IN  UINTN        DataSize,
+  OUT UINT8        *Output
+  )
+{
+  return HmacSha256Init (Context, mBenchKey, sizeof (mBenchKey)) &&
+         HmacSha256Update (Context, Data, DataSize) &&
+         HmacSha256Final (Context, Output);
+}
+
+/**
+  Create an AES context for the given key length.
+
+  @param[in]  KeyLength  The key length in bits.
+
+  @return The AES context, or NULL on failure.
+
+**/
+VOID *
+NewAes (
+  IN UINTN  KeyLength
+  )
+{
+  VOID  *Context;
+
+  Context = AllocatePool (AesGetContextSize ());
+  if (Context != NULL && !AesInit (Context, mBenchKey, KeyLength)) {
+    FreePool (Context);
+    Context = NULL;
+  }
+  return Context;
+}
+
+/**
+  Create an AES-128 context.
+
+  @return The AES-128 context, or NULL on failure.
+
+**/
+VOID *
+NewAes128 (
+  VOID
+  )
+{
+  return NewAes (128);
+}
+
+/**
+  Create an AES-256 context.
+
+  @return The AES-256 context, or NULL on failure.
+
+**/
+VOID *
+NewAes256 (
+  VOID
+  )
+{
+  return NewAes (256);
+}
+
+/**
+  Encrypt a buffer with AES-CBC, see CRYPT_BENCH_RUN.
+
+**/
+BOOLEAN
+RunAesCbcEncrypt (
+  IN  VOID         *Context,
+  IN  CONST UINT8  *Data,
+  IN  UINTN        DataSize,
+  OUT UINT8        *Output
+  )
+{
+  return AesCbcEncrypt (Context, Data, DataSize, mBenchIvec, Output);
+}
+
+/**
+  Decrypt a buffer with AES-CBC, see CRYPT_BENCH_RUN.
+
+**/
+BOOLEAN
+RunAesCbcDecrypt (
+  IN  VOID         *Context,
+  IN  CONST UINT8  *Data,
+  IN  UINTN        DataSize,
+  OUT UINT8        *Output
+  )
+{
+  return AesCbcDecrypt (Context, Data, DataSize, mBenchIvec, Output);
+}
+
+GLOBAL_REMOVE_IF_UNREFERENCED CONST CRYPT_BENCH mCryptBench[] = {
+  { L"SHA-1",               NewSha1,       RunSha1          },
+  { L"SHA-256",             NewSha256,     RunSha256        },
+  { L"SHA-384",             NewSha384,     RunSha384        },
+  { L"SHA-512",             NewSha512,     RunSha512        },
+  { L"HMAC-SHA256",         NewHmacSha256, RunHmacSha256    },
+  { L"AES-128-CBC encrypt", NewAes128,     RunAesCbcEncrypt },
+  { L"AES-128-CBC decrypt", NewAes128,     RunAesCbcDecrypt },
+  { L"AES-256-CBC encrypt", NewAes256,     RunAesCbcEncrypt },
+  { L"AES-256-CBC decrypt", NewAes256,     RunAesCbcDecrypt }
+};
+
+/**
+  Return the time elapsed between two performance counter values.
+
+  @param[in]  Start  The performance counter value at the start.
+  @param[in]  End    The performance counter value at the end.
+
+  @return The elapsed time in nanoseconds.
+
+**/
+UINT64
+GetElapsedTime (
+  IN UINT64  Start,
+  IN UINT64  End
+  )
+{
+  UINT64  CounterStart;
+  UINT64  CounterEnd;
+  UINT64  Ticks;
+
+  GetPerformanceCounterProperties (&CounterStart, &CounterEnd);
+  if (CounterEnd < CounterStart) {
+    //
+    // Counter counts down, swap the roles of Start and End.
+    //
+    Ticks = (Start >= End) ? (Start - End) : (Start + (CounterStart - End) + 1 - CounterEnd);
+  } else {
+    Ticks = (End >= Start) ? (End - Start) : (End + (CounterEnd - Start) + 1 - CounterStart);
+  }
+  return GetTimeInNanoSecond (Ticks);
+}
+
+/**
+  Measure and print the throughput of one primitive.
+
+  @param[in]  Bench   The primitive to measure.
+  @param[in]  Data    The input buffer of CRYPT_BENCH_BUFFER_SIZE bytes.
+  @param[out] Output  The output buffer of CRYPT_BENCH_BUFFER_SIZE bytes.
+
+**/
+VOID
+RunCryptBench (
+  IN  CONST CRYPT_BENCH  *Bench,
+  IN  CONST UINT8        *Data,
+  OUT UINT8              *Output
+  )
+{
+  VOID    *Context;
+  UINT64  Start;
+  UINT64  Elapsed;
+  UINT64  Bytes;
+  UINT64  KBytesPerSecond;
+
+  Context = Bench->New ();
+  if (Context == NULL) {
+    Print (L"%-20s  unsupported\n", Bench->Name);
+    return;
+  }
+
+  Bytes   = 0;
+  Elapsed = 0;
+  Start   = GetPerformanceCounter ();
+  do {
+    if (!Bench->Run (Context, Data, CRYPT_BENCH_BUFFER_SIZE, Output)) {
+      Print (L"%-20s  failed\n", Bench->Name);
+      FreePool (Context);
+      return;
+    }
+    Bytes  += CRYPT_BENCH_BUFFER_SIZE;
+    Elapsed = GetElapsedTime (Start, GetPerformanceCounter ());
+  } while (Elapsed < CRYPT_BENCH_MIN_TIME);
+
+  FreePool (Context);
+
+  KBytesPerSecond = DivU64x64Remainder (MultU64x32 (Bytes, 1000000), Elapsed, NULL);
+  Print (
+    L"%-20s  %6Lu.%02Lu MB/s\n",
+    Bench->Name,
+    DivU64x32 (KBytesPerSecond, 1000),
+    DivU64x32 (ModU64x32 (KBytesPerSecond, 1000), 10)
+    );
+}
+
+/**
+  The user Entry Point for Application. The user code starts with this function
+  as the real entry point for the application.
+
+  @param[in] ImageHandle    The firmware allocated handle for the EFI image.
+  @param[in] SystemTable    A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS             The entry point is executed successfully.
+  @retval EFI_UNSUPPORTED         No performance counter is available.
+  @retval EFI_OUT_OF_RESOURCES    The buffers could not be allocated.
+
+**/
+EFI_STATUS
+EFIAPI
+UefiMain (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  UINT8   *Data;
+  UINT8   *Output;
+  UINTN   Index;
+
+  if (GetPerformanceCounterProperties (NULL, NULL) == 0) {
+    Print (L"CryptBench: no performance counter is available.\n");
+    return EFI_UNSUPPORTED;
+  }
+
+  Data   = AllocatePool (CRYPT_BENCH_BUFFER_SIZE);
+  Output = AllocatePool (CRYPT_BENCH_BUFFER_SIZE);
+  if (Data == NULL || Output == NULL) {
+    if (Data != NULL) {
+      FreePool (Data);
+    }
+    if (Output != NULL) {
+      FreePool (Output);
+    }
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  for (Index = 0; Index < CRYPT_BENCH_BUFFER_SIZE; Index++) {
+    Data[Index] = (UINT8) Index;
+  }
+
+  Print (L"CryptBench: %u byte buffers\n", CRYPT_BENCH_BUFFER_SIZE);
+  for (Index = 0; Index < ARRAY_SIZE (mCryptBench); Index++) {
+    RunCryptBench (&mCryptBench[Index], Data, Output);
+  }
+
+  FreePool (Data);
+  FreePool (Output);
+  return EFI_SUCCESS;
+}
@@ -18,6 +18,7 @@
 #define TRUNCATE_TO_PAGES(a)  ((a) >> EFI_PAGE_SHIFT)
 
 LIST_ENTRY  mSmmMemoryMap = INITIALIZE_LIST_HEAD_VARIABLE (mSmmMemoryMap);
+LIST_ENTRY  mSmmFreePageClass[FREE_PAGE_CLASS_COUNT];
 
 //
 // For GetMemoryMap()
@@ -453,6 +454,60 @@ GetSmmMemoryMapEntryCount (
 
 
 
+/**
+  Internal Function. Add a free page node to the list of its size class, which
+  is kept in descending address order.
+
+  @param  Pages                  The free page node.
+
+**/
+VOID
+InternalInsertFreePageClass (
+  IN FREE_PAGE_LIST  *Pages
+  )
+{
+  LIST_ENTRY  *ClassList;
+  LIST_ENTRY  *Link;
+
+  ASSERT (Pages->NumberOfPages > 0);
+  ClassList = &mSmmFreePageClass[HighBitSet64 (Pages->NumberOfPages)];
+  for (Link = ClassList->ForwardLink; Link != ClassList; Link = Link->ForwardLink) {
+    if ((UINTN)BASE_CR (Link, FREE_PAGE_LIST, ClassLink) < (UINTN)Pages) {
+      break;
+    }
+  }
+  //
+  // Insert the node before the first lower one.
+  //
+  InsertTailList (Link, &Pages->ClassLink);
+}
+
+/**
+  Internal Function. Set the number of pages of a free page node, moving it to
+  the list of its new size class.
+
+  @param  Pages                  The free page node.
+  @param  NumberOfPages          The new number of pages of the node.
+
+**/
+VOID
+InternalResizeFreePageNode (
+  IN OUT FREE_PAGE_LIST  *Pages,
+  IN     UINTN           NumberOfPages
+  )
+{
+  if (HighBitSet64 (NumberOfPages) == HighBitSet64 (Pages->NumberOfPages)) {
+    //
+    // The address of the node does not change, nor does its place in its class.
+    //
+    Pages->NumberOfPages = NumberOfPages;
+    return;
+  }
+  RemoveEntryList (&Pages->ClassLink);
+  Pages->NumberOfPages = NumberOfPages;
+  InternalInsertFreePageClass (Pages);
+}
+
 /**
   Internal Function. Allocate n pages from given free page node.
 
@@ -484,12 +539,14 @@ InternalAllocPagesOnOneNode (
     Node = (FREE_PAGE_LIST*)((UINTN)Pages + EFI_PAGES_TO_SIZE (Top));
     Node->NumberOfPages = Pages->NumberOfPages - Top;
     InsertHeadList (&Pages->Link, &Node->Link);
+    InternalInsertFreePageClass (Node);
   }
 
   if (Bottom > 0) {
-    Pages->NumberOfPages = Bottom;
+    InternalResizeFreePageNode (Pages, Bottom);
   } else {
     RemoveEntryList (&Pages->Link);
+    RemoveEntryList (&Pages->ClassLink);
   }
 
   return (UINTN)Pages + EFI_PAGES_TO_SIZE (Bottom);
@@ -514,6 +571,39 @@ InternalAllocMaxAddress (
 {
   LIST_ENTRY      *Node;
   FREE_PAGE_LIST  *Pages;
+  FREE_PAGE_LIST  *Highest;
+  UINTN           Class;
+
+  if (MaxAddress == (UINTN)-1 && NumberOfPages > 0) {
+    //
+    // Without an address limit, pick the node the walk below would pick, the
+    // highest one big enough: the highest fitting node of the class of
+    // NumberOfPages, or the highest node of a class above, as any of them fits.
+    //
+    Highest = NULL;
+    Class   = (UINTN)HighBitSet64 (NumberOfPages);
+    for (Node = mSmmFreePageClass[Class].ForwardLink;
+         Node != &mSmmFreePageClass[Class];
+         Node = Node->ForwardLink) {
+      Pages = BASE_CR (Node, FREE_PAGE_LIST, ClassLink);
+      if (Pages->NumberOfPages >= NumberOfPages) {
+        Highest = Pages;
+        break;
+      }
+    }
+    for (Class++; Class < FREE_PAGE_CLASS_COUNT; Class++) {
+      if (!IsListEmpty (&mSmmFreePageClass[Class])) {
+        Pages = BASE_CR (GetFirstNode (&mSmmFreePageClass[Class]), FREE_PAGE_LIST, ClassLink);
+        if (Highest == NULL || (UINTN)Pages > (UINTN)Highest) {
+          Highest = Pages;
+        }
+      }
+    }
+    if (Highest == NULL) {
+      return (UINTN)(-1);
+    }
+    return InternalAllocPagesOnOneNode (Highest, NumberOfPages, MaxAddress);
+  }
 
   for (Node = FreePageList->BackLink; Node != FreePageList; Node = Node->BackLink) {
     Pages = BASE_CR (Node, FREE_PAGE_LIST, Link);
@@ -756,8 +846,9 @@ InternalMergeNodes (
     TRUNCATE_TO_PAGES ((UINTN)Next - (UINTN)First) >= First->NumberOfPages);
 
   if (TRUNCATE_TO_PAGES ((UINTN)Next - (UINTN)First) == First->NumberOfPages) {
-    First->NumberOfPages += Next->NumberOfPages;
+    InternalResizeFreePageNode (First, First->NumberOfPages + Next->NumberOfPages);
     RemoveEntryList (&Next->Link);
+    RemoveEntryList (&Next->ClassLink);
     Next = First;
   }
   return Next;
@@ -814,6 +905,7 @@ SmmInternalFreePagesEx (
   Pages = (FREE_PAGE_LIST*)(UINTN)Memory;
   Pages->NumberOfPages = NumberOfPages;
   InsertTailList (Node, &Pages->Link);
+  InternalInsertFreePageClass (Pages);
 
   if (Pages->Link.BackLink != &mSmmMemoryMap) {
     Pages = InternalMergeNodes (
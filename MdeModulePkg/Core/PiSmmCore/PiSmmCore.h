@@ -1226,9 +1226,19 @@ extern EFI_LOADED_IMAGE_PROTOCOL  *mSmmCoreLoadedImage;
 typedef struct {
   LIST_ENTRY  Link;
   UINTN       NumberOfPages;
+  LIST_ENTRY  ClassLink;
 } FREE_PAGE_LIST;
 
+//
+// Free page nodes are also kept on segregated lists by size class, class N
+// holding the nodes of 2^N up to 2^(N+1) - 1 pages in descending address
+// order, so that AllocateAnyPages finds the highest fitting node without
+// walking the address ordered free list.
+//
+#define FREE_PAGE_CLASS_COUNT  64
+
 extern LIST_ENTRY  mSmmMemoryMap;
+extern LIST_ENTRY  mSmmFreePageClass[FREE_PAGE_CLASS_COUNT];
 
 //
 // Pool management
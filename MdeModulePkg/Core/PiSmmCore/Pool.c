@@ -72,6 +72,13 @@ SmmInitializeMemoryServices (
     }
   }
 
+  //
+  // Initialize free page size class lists
+  //
+  for (Index = 0; Index < ARRAY_SIZE (mSmmFreePageClass); Index++) {
+    InitializeListHead (&mSmmFreePageClass[Index]);
+  }
+
   Status = EfiGetSystemConfigurationTable (
             &gLoadFixedAddressConfigurationTableGuid,
            (VOID **) &LMFAConfigurationTable
@@ -0,0 +1,27 @@
+/** @file
+  GUID for an event group that is signaled when a variable of the image security
+  database (db, dbx or dbt) has been successfully written.
+
+  The DXE drivers which cache the image security database use it to know when
+  the cache has to be read again.
+
+  Copyright (c) 2018, Intel Corporation. All rights reserved.<BR>
+  This program and the accompanying materials
+  are licensed and made available under the terms and conditions of the BSD License
+  which accompanies this distribution.  The full text of the license may be found at
+  http://opensource.org/licenses/bsd-license.php
+
+  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#ifndef __IMAGE_SECURITY_DATABASE_CHANGED_GUID_H__
+#define __IMAGE_SECURITY_DATABASE_CHANGED_GUID_H__
+
+#define EDKII_IMAGE_SECURITY_DATABASE_CHANGED_GUID \
+    { 0xcc3d84a9, 0xcb20, 0x4b7b, { 0x8f, 0x7b, 0x60, 0x64, 0x3b, 0xa9, 0xd9, 0x86 }}
+
+extern EFI_GUID gEdkiiImageSecurityDatabaseChangedGuid;
+
+#endif
@@ -29,7 +29,32 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #define LZMAF86_CUSTOM_DECOMPRESS_GUID  \
   { 0xD42AE6BD, 0x1352, 0x4bfb, { 0x90, 0x9A, 0xCA, 0x72, 0xA6, 0xEA, 0xE8, 0x89 } }
 
+///
+/// The Global ID used to identify a section of an FFS file of type
+/// EFI_SECTION_GUID_DEFINED, whose contents have been split into blocks that
+/// are compressed using LZMA independently of each other.
+///
+#define LZMA_MULTI_BLOCK_CUSTOM_DECOMPRESS_GUID  \
+  { 0xE50A0786, 0xF995, 0x4C52, { 0xB7, 0x72, 0xD5, 0x06, 0xB8, 0x62, 0x7A, 0x16 } }
+
+#define LZMA_MULTI_BLOCK_SIGNATURE  SIGNATURE_32 ('L', 'Z', 'M', 'B')
+
+///
+/// The data of a section with LZMA_MULTI_BLOCK_CUSTOM_DECOMPRESS_GUID starts
+/// with this header. It is followed by a UINT32 array holding the compressed
+/// size of each block, and then by the blocks themselves. Every block is a
+/// complete LZMA stream that decompresses to BlockSize bytes, except the last
+/// one which holds the remainder of OriginalSize.
+///
+typedef struct {
+  UINT32  Signature;
+  UINT32  BlockSize;
+  UINT32  BlockCount;
+  UINT32  OriginalSize;
+} LZMA_MULTI_BLOCK_HEADER;
+
 extern GUID gLzmaCustomDecompressGuid;
 extern GUID gLzmaF86CustomDecompressGuid;
+extern GUID gLzmaMultiBlockCustomDecompressGuid;
 
 #endif
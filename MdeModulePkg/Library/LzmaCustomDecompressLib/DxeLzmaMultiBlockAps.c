@@ -0,0 +1,74 @@
+/** @file
+  Run the decompression of LZMA multi-block buffers on the APs in DXE.
+
+  Copyright (c) 2018, Intel Corporation. All rights reserved.<BR>
+  This program and the accompanying materials
+  are licensed and made available under the terms and conditions of the BSD License
+  which accompanies this distribution.  The full text of the license may be found at
+  http://opensource.org/licenses/bsd-license.php
+
+  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#include <PiDxe.h>
+
+#include "LzmaDecompressLibInternal.h"
+#include <Protocol/MpService.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+
+/**
+  Decompresses blocks on the APs.
+
+  The APs take blocks from Context until none is left. The blocks that are
+  still left when this function returns are decompressed by the caller. This
+  function returns without doing anything when there is no AP to help.
+
+  @param  Context  The state of the decompression.
+**/
+VOID
+LzmaMultiBlockStartupAllAps (
+  IN OUT LZMA_MULTI_BLOCK_CONTEXT  *Context
+  )
+{
+  EFI_STATUS                Status;
+  EFI_MP_SERVICES_PROTOCOL  *MpServices;
+  UINTN                     NumberOfProcessors;
+  UINTN                     NumberOfEnabledProcessors;
+  UINTN                     Pages;
+
+  Status = gBS->LocateProtocol (&gEfiMpServiceProtocolGuid, NULL, (VOID **) &MpServices);
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+
+  Status = MpServices->GetNumberOfProcessors (
+                         MpServices,
+                         &NumberOfProcessors,
+                         &NumberOfEnabledProcessors
+                         );
+  if (EFI_ERROR (Status) || NumberOfEnabledProcessors < 2) {
+    return;
+  }
+
+  Context->ApScratchCount = (UINT32) MIN (NumberOfEnabledProcessors - 1, Context->BlockCount);
+  Pages = EFI_SIZE_TO_PAGES ((UINTN) Context->ApScratchCount * SCRATCH_BUFFER_REQUEST_SIZE);
+  Context->ApScratch = AllocatePages (Pages);
+  if (Context->ApScratch == NULL) {
+    return;
+  }
+
+  MpServices->StartupAllAPs (
+                MpServices,
+                LzmaMultiBlockApProcedure,
+                FALSE,
+                NULL,
+                0,
+                Context,
+                NULL
+                );
+
+  FreePages (Context->ApScratch, Pages);
+}
@@ -17,8 +17,6 @@
 #include "Sdk/C/7zVersion.h"
 #include "Sdk/C/LzmaDec.h"
 
-#define SCRATCH_BUFFER_REQUEST_SIZE SIZE_64KB
-
 typedef struct
 {
   ISzAlloc Functions;
@@ -75,8 +73,6 @@ SzFree (
   //
 }
 
-#define LZMA_HEADER_SIZE (LZMA_PROPS_SIZE + 8)
-
 /**
   Get the size of the uncompressed buffer by parsing EncodeData header.
 
@@ -22,6 +22,44 @@
 #include <Library/ExtractGuidedSectionLib.h>
 #include <Guid/LzmaDecompress.h>
 
+#define SCRATCH_BUFFER_REQUEST_SIZE SIZE_64KB
+
+#define LZMA_HEADER_SIZE (LZMA_PROPS_SIZE + 8)
+
+///
+/// The state shared by the processors that decompress the blocks of one
+/// LZMA multi-block buffer in parallel.
+///
+typedef struct {
+  CONST VOID       *Source;
+  VOID             *Destination;
+  UINT32           BlockCount;
+  ///
+  /// The index of the next block to decompress.
+  ///
+  volatile UINT32  NextBlock;
+  ///
+  /// SCRATCH_BUFFER_REQUEST_SIZE bytes of scratch buffer for each AP, and the
+  /// index of the next one that is not taken by an AP yet.
+  ///
+  UINT8            *ApScratch;
+  UINT32           ApScratchCount;
+  volatile UINT32  NextApScratch;
+  volatile BOOLEAN Failed;
+} LZMA_MULTI_BLOCK_CONTEXT;
+
+/**
+  Get the size of the uncompressed buffer by parsing EncodeData header.
+
+  @param EncodedData  Pointer to the compressed data.
+
+  @return The size of the uncompressed buffer.
+**/
+UINT64
+GetDecodedSizeOfBuf(
+  UINT8 *EncodedData
+  );
+
 /**
   Given a Lzma compressed source buffer, this function retrieves the size of
   the uncompressed buffer and the size of the scratch buffer required
@@ -92,5 +130,132 @@ LzmaUefiDecompress (
   IN OUT VOID    *Scratch
   );
 
+/**
+  Given a source buffer in the LZMA multi-block format, this function retrieves
+  the size of the uncompressed buffer and the size of the scratch buffer required
+  to decompress the source buffer.
+
+  The header, the compressed block size array and the LZMA header of every block
+  are checked to be consistent with each other and to lie within the source buffer.
+
+  @param  Source          The source buffer containing the compressed data.
+  @param  SourceSize      The size, in bytes, of the source buffer.
+  @param  DestinationSize A pointer to the size, in bytes, of the uncompressed buffer
+                          that will be generated when the compressed buffer specified
+                          by Source and SourceSize is decompressed.
+  @param  ScratchSize     A pointer to the size, in bytes, of the scratch buffer that
+                          is required to decompress the compressed buffer specified
+                          by Source and SourceSize.
+
+  @retval  RETURN_SUCCESS           The size of the uncompressed data was returned
+                                    in DestinationSize and the size of the scratch
+                                    buffer was returned in ScratchSize.
+  @retval  RETURN_INVALID_PARAMETER The source buffer is not in the LZMA multi-block format.
+
+**/
+RETURN_STATUS
+EFIAPI
+LzmaMultiBlockUefiDecompressGetInfo (
+  IN  CONST VOID  *Source,
+  IN  UINT32      SourceSize,
+  OUT UINT32      *DestinationSize,
+  OUT UINT32      *ScratchSize
+  );
+
+/**
+  Decompresses a source buffer in the LZMA multi-block format.
+
+  The blocks are decompressed one after the other into consecutive parts of
+  Destination, reusing the same scratch buffer.
+
+  @param  Source      The source buffer containing the compressed data.
+  @param  SourceSize  The size of source buffer.
+  @param  Destination The destination buffer to store the decompressed data
+  @param  Scratch     A temporary scratch buffer that is used to perform the decompression.
+
+  @retval  RETURN_SUCCESS Decompression completed successfully, and
+                          the uncompressed buffer is returned in Destination.
+  @retval  RETURN_INVALID_PARAMETER
+                          The source buffer specified by Source is corrupted
+                          (not in a valid compressed format).
+**/
+RETURN_STATUS
+EFIAPI
+LzmaMultiBlockUefiDecompress (
+  IN CONST VOID  *Source,
+  IN UINTN       SourceSize,
+  IN OUT VOID    *Destination,
+  IN OUT VOID    *Scratch
+  );
+
+/**
+  Decompresses one block of a source buffer in the LZMA multi-block format.
+
+  The source buffer must have been checked by LzmaMultiBlockUefiDecompress().
+  Blocks may be decompressed in any order and at the same time on different
+  processors, as long as each one uses its own scratch buffer.
+
+  @param  Source      The source buffer containing the compressed data.
+  @param  Index       The index of the block to decompress.
+  @param  Destination The destination buffer of the whole decompressed data.
+  @param  Scratch     A scratch buffer of SCRATCH_BUFFER_REQUEST_SIZE bytes.
+
+  @retval  RETURN_SUCCESS            The block was decompressed.
+  @retval  RETURN_INVALID_PARAMETER  The block is corrupted.
+**/
+RETURN_STATUS
+LzmaMultiBlockDecodeBlock (
+  IN CONST VOID  *Source,
+  IN UINT32      Index,
+  IN OUT VOID    *Destination,
+  IN OUT VOID    *Scratch
+  );
+
+/**
+  Decompresses all blocks of a source buffer in the LZMA multi-block format.
+
+  Each library instance provides its own implementation, which decompresses
+  the blocks either one after the other or on several processors.
+
+  @param  Source      The source buffer containing the compressed data, which
+                      has been checked by LzmaMultiBlockUefiDecompress().
+  @param  Destination The destination buffer to store the decompressed data.
+  @param  Scratch     A scratch buffer of SCRATCH_BUFFER_REQUEST_SIZE bytes.
+
+  @retval  RETURN_SUCCESS            All blocks were decompressed.
+  @retval  RETURN_INVALID_PARAMETER  At least one block is corrupted.
+**/
+RETURN_STATUS
+LzmaMultiBlockDecodeBlocks (
+  IN CONST VOID  *Source,
+  IN OUT VOID    *Destination,
+  IN OUT VOID    *Scratch
+  );
+
+/**
+  Decompresses blocks on the APs.
+
+  The APs take blocks from Context until none is left. The blocks that are
+  still left when this function returns are decompressed by the caller. This
+  function returns without doing anything when there is no AP to help.
+
+  @param  Context  The state of the decompression.
+**/
+VOID
+LzmaMultiBlockStartupAllAps (
+  IN OUT LZMA_MULTI_BLOCK_CONTEXT  *Context
+  );
+
+/**
+  Decompresses blocks on an AP until none is left.
+
+  @param  Buffer  The LZMA_MULTI_BLOCK_CONTEXT of the decompression.
+**/
+VOID
+EFIAPI
+LzmaMultiBlockApProcedure (
+  IN OUT VOID  *Buffer
+  );
+
 #endif
 
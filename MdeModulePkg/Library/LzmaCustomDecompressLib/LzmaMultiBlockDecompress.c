@@ -0,0 +1,190 @@
+/** @file
+  LZMA multi-block decompress interfaces
+
+  Copyright (c) 2018, Intel Corporation. All rights reserved.<BR>
+  This program and the accompanying materials
+  are licensed and made available under the terms and conditions of the BSD License
+  which accompanies this distribution.  The full text of the license may be found at
+  http://opensource.org/licenses/bsd-license.php
+
+  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#include "LzmaDecompressLibInternal.h"
+#include "Sdk/C/7zTypes.h"
+#include "Sdk/C/LzmaDec.h"
+
+/**
+  Check that a source buffer in the LZMA multi-block format is consistent.
+
+  @param  Source      The source buffer containing the compressed data.
+  @param  SourceSize  The size of source buffer.
+
+  @retval TRUE   All the blocks lie within the source buffer and their LZMA
+                 headers match the sizes given by the multi-block header.
+  @retval FALSE  The source buffer is not in the LZMA multi-block format.
+**/
+STATIC
+BOOLEAN
+IsValidMultiBlockBuffer (
+  IN CONST VOID  *Source,
+  IN UINTN       SourceSize
+  )
+{
+  CONST LZMA_MULTI_BLOCK_HEADER  *Header;
+  CONST UINT32                   *CompressedSize;
+  UINTN                          Offset;
+  UINT32                         Index;
+  UINT32                         BlockCount;
+
+  Header = (CONST LZMA_MULTI_BLOCK_HEADER *) Source;
+  if (SourceSize < sizeof (LZMA_MULTI_BLOCK_HEADER) ||
+      Header->Signature != LZMA_MULTI_BLOCK_SIGNATURE ||
+      Header->BlockSize == 0) {
+    return FALSE;
+  }
+
+  BlockCount = Header->OriginalSize / Header->BlockSize;
+  if (Header->OriginalSize % Header->BlockSize != 0) {
+    BlockCount++;
+  }
+  if (Header->BlockCount != BlockCount ||
+      (SourceSize - sizeof (LZMA_MULTI_BLOCK_HEADER)) / sizeof (UINT32) < BlockCount) {
+    return FALSE;
+  }
+
+  CompressedSize = (CONST UINT32 *) (Header + 1);
+  Offset         = sizeof (LZMA_MULTI_BLOCK_HEADER) + BlockCount * sizeof (UINT32);
+  for (Index = 0; Index < BlockCount; Index++) {
+    if (CompressedSize[Index] < LZMA_HEADER_SIZE ||
+        CompressedSize[Index] > SourceSize - Offset) {
+      return FALSE;
+    }
+    if (GetDecodedSizeOfBuf ((UINT8 *) Source + Offset) !=
+        MIN (Header->BlockSize, Header->OriginalSize - Index * Header->BlockSize)) {
+      return FALSE;
+    }
+    Offset += CompressedSize[Index];
+  }
+
+  return TRUE;
+}
+
+/**
+  Given a source buffer in the LZMA multi-block format, this function retrieves
+  the size of the uncompressed buffer and the size of the scratch buffer required
+  to decompress the source buffer.
+
+  The header, the compressed block size array and the LZMA header of every block
+  are checked to be consistent with each other and to lie within the source buffer.
+
+  @param  Source          The source buffer containing the compressed data.
+  @param  SourceSize      The size, in bytes, of the source buffer.
+  @param  DestinationSize A pointer to the size, in bytes, of the uncompressed buffer
+                          that will be generated when the compressed buffer specified
+                          by Source and SourceSize is decompressed.
+  @param  ScratchSize     A pointer to the size, in bytes, of the scratch buffer that
+                          is required to decompress the compressed buffer specified
+                          by Source and SourceSize.
+
+  @retval  RETURN_SUCCESS           The size of the uncompressed data was returned
+                                    in DestinationSize and the size of the scratch
+                                    buffer was returned in ScratchSize.
+  @retval  RETURN_INVALID_PARAMETER The source buffer is not in the LZMA multi-block format.
+
+**/
+RETURN_STATUS
+EFIAPI
+LzmaMultiBlockUefiDecompressGetInfo (
+  IN  CONST VOID  *Source,
+  IN  UINT32      SourceSize,
+  OUT UINT32      *DestinationSize,
+  OUT UINT32      *ScratchSize
+  )
+{
+  if (!IsValidMultiBlockBuffer (Source, SourceSize)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  *DestinationSize = ((CONST LZMA_MULTI_BLOCK_HEADER *) Source)->OriginalSize;
+  *ScratchSize     = SCRATCH_BUFFER_REQUEST_SIZE;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Decompresses a source buffer in the LZMA multi-block format.
+
+  The blocks are decompressed into consecutive parts of Destination by
+  LzmaMultiBlockDecodeBlocks(), which may use other processors to do so.
+
+  @param  Source      The source buffer containing the compressed data.
+  @param  SourceSize  The size of source buffer.
+  @param  Destination The destination buffer to store the decompressed data
+  @param  Scratch     A temporary scratch buffer that is used to perform the decompression.
+
+  @retval  RETURN_SUCCESS Decompression completed successfully, and
+                          the uncompressed buffer is returned in Destination.
+  @retval  RETURN_INVALID_PARAMETER
+                          The source buffer specified by Source is corrupted
+                          (not in a valid compressed format).
+**/
+RETURN_STATUS
+EFIAPI
+LzmaMultiBlockUefiDecompress (
+  IN CONST VOID  *Source,
+  IN UINTN       SourceSize,
+  IN OUT VOID    *Destination,
+  IN OUT VOID    *Scratch
+  )
+{
+  if (!IsValidMultiBlockBuffer (Source, SourceSize)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  return LzmaMultiBlockDecodeBlocks (Source, Destination, Scratch);
+}
+
+/**
+  Decompresses one block of a source buffer in the LZMA multi-block format.
+
+  The source buffer must have been checked by LzmaMultiBlockUefiDecompress().
+  Blocks may be decompressed in any order and at the same time on different
+  processors, as long as each one uses its own scratch buffer.
+
+  @param  Source      The source buffer containing the compressed data.
+  @param  Index       The index of the block to decompress.
+  @param  Destination The destination buffer of the whole decompressed data.
+  @param  Scratch     A scratch buffer of SCRATCH_BUFFER_REQUEST_SIZE bytes.
+
+  @retval  RETURN_SUCCESS            The block was decompressed.
+  @retval  RETURN_INVALID_PARAMETER  The block is corrupted.
+**/
+RETURN_STATUS
+LzmaMultiBlockDecodeBlock (
+  IN CONST VOID  *Source,
+  IN UINT32      Index,
+  IN OUT VOID    *Destination,
+  IN OUT VOID    *Scratch
+  )
+{
+  CONST LZMA_MULTI_BLOCK_HEADER  *Header;
+  CONST UINT32                   *CompressedSize;
+  UINTN                          Offset;
+  UINT32                         Block;
+
+  Header         = (CONST LZMA_MULTI_BLOCK_HEADER *) Source;
+  CompressedSize = (CONST UINT32 *) (Header + 1);
+  Offset         = sizeof (LZMA_MULTI_BLOCK_HEADER) + Header->BlockCount * sizeof (UINT32);
+  for (Block = 0; Block < Index; Block++) {
+    Offset += CompressedSize[Block];
+  }
+
+  return LzmaUefiDecompress (
+           (UINT8 *) Source + Offset,
+           CompressedSize[Index],
+           (UINT8 *) Destination + (UINTN) Index * Header->BlockSize,
+           Scratch
+           );
+}
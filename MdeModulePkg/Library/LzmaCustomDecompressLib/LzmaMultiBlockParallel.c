@@ -0,0 +1,114 @@
+/** @file
+  Decompress the blocks of an LZMA multi-block buffer on all processors.
+
+  Copyright (c) 2018, Intel Corporation. All rights reserved.<BR>
+  This program and the accompanying materials
+  are licensed and made available under the terms and conditions of the BSD License
+  which accompanies this distribution.  The full text of the license may be found at
+  http://opensource.org/licenses/bsd-license.php
+
+  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#include "LzmaDecompressLibInternal.h"
+#include <Library/PerformanceLib.h>
+#include <Library/SynchronizationLib.h>
+
+/**
+  Decompresses blocks taken from Context until none is left.
+
+  @param  Context  The state of the decompression.
+  @param  Scratch  A scratch buffer of SCRATCH_BUFFER_REQUEST_SIZE bytes.
+**/
+STATIC
+VOID
+DecodeRemainingBlocks (
+  IN OUT LZMA_MULTI_BLOCK_CONTEXT  *Context,
+  IN OUT VOID                      *Scratch
+  )
+{
+  UINT32  Index;
+
+  for (;;) {
+    Index = InterlockedIncrement (&Context->NextBlock) - 1;
+    if (Index >= Context->BlockCount) {
+      break;
+    }
+    if (RETURN_ERROR (LzmaMultiBlockDecodeBlock (Context->Source, Index, Context->Destination, Scratch))) {
+      Context->Failed = TRUE;
+    }
+  }
+}
+
+/**
+  Decompresses blocks on an AP until none is left.
+
+  @param  Buffer  The LZMA_MULTI_BLOCK_CONTEXT of the decompression.
+**/
+VOID
+EFIAPI
+LzmaMultiBlockApProcedure (
+  IN OUT VOID  *Buffer
+  )
+{
+  LZMA_MULTI_BLOCK_CONTEXT  *Context;
+  UINT32                    Index;
+
+  Context = (LZMA_MULTI_BLOCK_CONTEXT *) Buffer;
+
+  //
+  // Every AP needs a scratch buffer of its own. The APs that come too late to
+  // get one have nothing to do anyway, as there are no more APs with scratch
+  // buffers than blocks.
+  //
+  Index = InterlockedIncrement (&Context->NextApScratch) - 1;
+  if (Index >= Context->ApScratchCount) {
+    return;
+  }
+
+  DecodeRemainingBlocks (Context, Context->ApScratch + (UINTN) Index * SCRATCH_BUFFER_REQUEST_SIZE);
+}
+
+/**
+  Decompresses all blocks of a source buffer in the LZMA multi-block format.
+
+  The APs decompress blocks in parallel when MP services are available.
+  The BSP decompresses the blocks that are left afterwards, which are all of
+  them when there is no AP to help. The time spent is logged as a performance
+  measurement.
+
+  @param  Source      The source buffer containing the compressed data, which
+                      has been checked by LzmaMultiBlockUefiDecompress().
+  @param  Destination The destination buffer to store the decompressed data.
+  @param  Scratch     A scratch buffer of SCRATCH_BUFFER_REQUEST_SIZE bytes.
+
+  @retval  RETURN_SUCCESS            All blocks were decompressed.
+  @retval  RETURN_INVALID_PARAMETER  At least one block is corrupted.
+**/
+RETURN_STATUS
+LzmaMultiBlockDecodeBlocks (
+  IN CONST VOID  *Source,
+  IN OUT VOID    *Destination,
+  IN OUT VOID    *Scratch
+  )
+{
+  LZMA_MULTI_BLOCK_CONTEXT  Context;
+
+  PERF_INMODULE_BEGIN ("LzmaMultiBlock");
+
+  ZeroMem (&Context, sizeof (Context));
+  Context.Source      = Source;
+  Context.Destination = Destination;
+  Context.BlockCount  = ((CONST LZMA_MULTI_BLOCK_HEADER *) Source)->BlockCount;
+
+  if (Context.BlockCount > 1) {
+    LzmaMultiBlockStartupAllAps (&Context);
+  }
+  DecodeRemainingBlocks (&Context, Scratch);
+
+  PERF_INMODULE_END ("LzmaMultiBlock");
+
+  return Context.Failed ? RETURN_INVALID_PARAMETER : RETURN_SUCCESS;
+}
@@ -0,0 +1,48 @@
+/** @file
+  Decompress the blocks of an LZMA multi-block buffer one after the other.
+
+  Copyright (c) 2018, Intel Corporation. All rights reserved.<BR>
+  This program and the accompanying materials
+  are licensed and made available under the terms and conditions of the BSD License
+  which accompanies this distribution.  The full text of the license may be found at
+  http://opensource.org/licenses/bsd-license.php
+
+  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#include "LzmaDecompressLibInternal.h"
+
+/**
+  Decompresses all blocks of a source buffer in the LZMA multi-block format.
+
+  The blocks are decompressed one after the other on the calling processor.
+
+  @param  Source      The source buffer containing the compressed data, which
+                      has been checked by LzmaMultiBlockUefiDecompress().
+  @param  Destination The destination buffer to store the decompressed data.
+  @param  Scratch     A scratch buffer of SCRATCH_BUFFER_REQUEST_SIZE bytes.
+
+  @retval  RETURN_SUCCESS            All blocks were decompressed.
+  @retval  RETURN_INVALID_PARAMETER  At least one block is corrupted.
+**/
+RETURN_STATUS
+LzmaMultiBlockDecodeBlocks (
+  IN CONST VOID  *Source,
+  IN OUT VOID    *Destination,
+  IN OUT VOID    *Scratch
+  )
+{
+  UINT32         Index;
+  RETURN_STATUS  Status;
+
+  for (Index = 0; Index < ((CONST LZMA_MULTI_BLOCK_HEADER *) Source)->BlockCount; Index++) {
+    Status = LzmaMultiBlockDecodeBlock (Source, Index, Destination, Scratch);
+    if (RETURN_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  return RETURN_SUCCESS;
+}
@@ -14,22 +14,158 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 #include "InternalBm.h"
 
+//
+// Number of the slowest controllers listed by the connect time report.
+//
+#define BM_CONNECT_REPORT_COUNT  10
+
+typedef struct {
+  EFI_HANDLE  Controller;
+  UINT64      Time;         // in nanoseconds
+} BM_CONNECT_TIME;
+
+/**
+  Read the timer of the processor.
+
+  @param  Cpu           The CPU architectural protocol, or NULL.
+  @param  TimerPeriod   Return the period of the timer in femtoseconds.
+
+  @return The timer value, or 0 when no timer is available.
+**/
+UINT64
+BmGetTimerValue (
+  IN  EFI_CPU_ARCH_PROTOCOL  *Cpu,
+  OUT UINT64                 *TimerPeriod
+  )
+{
+  EFI_STATUS  Status;
+  UINT64      TimerValue;
+
+  *TimerPeriod = 0;
+  if (Cpu == NULL) {
+    return 0;
+  }
+  Status = Cpu->GetTimerValue (Cpu, 0, &TimerValue, TimerPeriod);
+  if (EFI_ERROR (Status)) {
+    *TimerPeriod = 0;
+    return 0;
+  }
+  return TimerValue;
+}
+
+/**
+  Record the time spent connecting a controller, keeping the slowest
+  controllers sorted by time in the report.
+
+  @param  Report        The connect time report of BM_CONNECT_REPORT_COUNT entries.
+  @param  Controller    The controller handle.
+  @param  Time          The time spent connecting Controller, in nanoseconds.
+**/
+VOID
+BmRecordConnectTime (
+  IN OUT BM_CONNECT_TIME  *Report,
+  IN     EFI_HANDLE       Controller,
+  IN     UINT64           Time
+  )
+{
+  UINTN            Index;
+  BM_CONNECT_TIME  Entry;
+
+  //
+  // Accumulate the time of a controller connected again by a later pass,
+  // otherwise replace the fastest entry.
+  //
+  for (Index = 0; Index < BM_CONNECT_REPORT_COUNT - 1; Index++) {
+    if (Report[Index].Controller == Controller) {
+      break;
+    }
+  }
+  if (Report[Index].Controller == Controller) {
+    Time += Report[Index].Time;
+  } else if (Time <= Report[Index].Time) {
+    return;
+  }
+  Report[Index].Controller = Controller;
+  Report[Index].Time       = Time;
+
+  //
+  // Move the updated entry up to keep the report sorted.
+  //
+  for (; Index > 0 && Report[Index - 1].Time < Report[Index].Time; Index--) {
+    CopyMem (&Entry, &Report[Index - 1], sizeof (Entry));
+    CopyMem (&Report[Index - 1], &Report[Index], sizeof (Entry));
+    CopyMem (&Report[Index], &Entry, sizeof (Entry));
+  }
+}
+
+/**
+  Print the controllers which took the most time to connect.
+
+  @param  Report        The connect time report of BM_CONNECT_REPORT_COUNT entries.
+  @param  TotalTime     The time spent connecting all the controllers, in nanoseconds.
+**/
+VOID
+BmPrintConnectTimeReport (
+  IN BM_CONNECT_TIME  *Report,
+  IN UINT64           TotalTime
+  )
+{
+  UINTN            Index;
+  CHAR16           *DevicePathStr;
+
+  DEBUG ((
+    DEBUG_INFO, "[Bds] Connected all controllers in %Ld us, slowest controllers:\n",
+    DivU64x32 (TotalTime, 1000)
+    ));
+  for (Index = 0; Index < BM_CONNECT_REPORT_COUNT && Report[Index].Controller != NULL; Index++) {
+    DevicePathStr = ConvertDevicePathToText (DevicePathFromHandle (Report[Index].Controller), FALSE, FALSE);
+    DEBUG ((
+      DEBUG_INFO, "[Bds]   %10Ld us  %s\n",
+      DivU64x32 (Report[Index].Time, 1000),
+      (DevicePathStr != NULL) ? DevicePathStr : L"<no device path>"
+      ));
+    if (DevicePathStr != NULL) {
+      FreePool (DevicePathStr);
+    }
+  }
+}
+
 /**
   Connect all the drivers to all the controllers.
 
   This function makes sure all the current system drivers manage the correspoinding
   controllers if have. And at the same time, makes sure all the system controllers
   have driver to manage it if have.
+
+  When DEBUG_INFO messages are enabled and the processor timer is available, the
+  time spent connecting each controller is measured and the slowest controllers
+  are reported.
 **/
 VOID
 BmConnectAllDriversToAllControllers (
   VOID
   )
 {
-  EFI_STATUS  Status;
-  UINTN       HandleCount;
-  EFI_HANDLE  *HandleBuffer;
-  UINTN       Index;
+  EFI_STATUS             Status;
+  UINTN                  HandleCount;
+  EFI_HANDLE             *HandleBuffer;
+  UINTN                  Index;
+  EFI_CPU_ARCH_PROTOCOL  *Cpu;
+  UINT64                 TimerPeriod;
+  UINT64                 Start;
+  UINT64                 Time;
+  UINT64                 TotalTime;
+  BM_CONNECT_TIME        Report[BM_CONNECT_REPORT_COUNT];
+
+  Cpu       = NULL;
+  TotalTime = 0;
+  ZeroMem (Report, sizeof (Report));
+  if (DebugPrintLevelEnabled (DEBUG_INFO)) {
+    Status = gBS->LocateProtocol (&gEfiCpuArchProtocolGuid, NULL, (VOID **) &Cpu);
+    if (EFI_ERROR (Status)) {
+      Cpu = NULL;
+    }
+  }
 
   do {
     //
@@ -44,7 +180,16 @@ BmConnectAllDriversToAllControllers (
            );
 
     for (Index = 0; Index < HandleCount; Index++) {
+      Start = BmGetTimerValue (Cpu, &TimerPeriod);
       gBS->ConnectController (HandleBuffer[Index], NULL, NULL, TRUE);
+      if (TimerPeriod != 0) {
+        Time = DivU64x32 (
+                 MultU64x64 (BmGetTimerValue (Cpu, &TimerPeriod) - Start, TimerPeriod),
+                 1000000
+                 );
+        TotalTime += Time;
+        BmRecordConnectTime (Report, HandleBuffer[Index], Time);
+      }
     }
 
     if (HandleBuffer != NULL) {
@@ -60,6 +205,10 @@ BmConnectAllDriversToAllControllers (
     Status = gDS->Dispatch ();
 
   } while (!EFI_ERROR (Status));
+
+  if (TotalTime != 0) {
+    BmPrintConnectTimeReport (Report, TotalTime);
+  }
 }
 
 /**
@@ -2662,6 +2662,7 @@ UiDisplayMenu (
   UI_EVENT_TYPE                   EventType;
   BOOLEAN                         SkipHighLight;
   EFI_HII_VALUE                   *StatementValue;
+  BOOLEAN                         FormPainted;
 
   EventType           = UIEventNone;
   Status              = EFI_SUCCESS;
@@ -2685,6 +2686,7 @@ UiDisplayMenu (
   DownArrow           = FALSE;
   SkipValue           = 0;
   SkipHighLight       = FALSE;
+  FormPainted         = FALSE;
 
   NextMenuOption      = NULL;
   SavedMenuOption     = NULL;
@@ -2717,6 +2719,11 @@ UiDisplayMenu (
   while (TRUE) {
     switch (ControlFlag) {
     case CfInitialization:
+      //
+      // Measure the time from entering the form until it is painted and
+      // ready for user input.
+      //
+      PERF_INMODULE_BEGIN ("PaintForm");
       if ((gOldFormEntry.HiiHandle != FormData->HiiHandle) ||
           (!CompareGuid (&gOldFormEntry.FormSetGuid, &FormData->FormSetGuid))) {
         //
@@ -3148,6 +3155,10 @@ UiDisplayMenu (
       break;
 
     case CfPrepareToReadKey:
+      if (!FormPainted) {
+        FormPainted = TRUE;
+        PERF_INMODULE_END ("PaintForm");
+      }
       ControlFlag = CfReadKey;
       ScreenOperation = UiNoOperation;
       break;
@@ -24,6 +24,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Library/MemoryAllocationLib.h>
 #include <Library/PrintLib.h>
 #include <Library/CustomizedDisplayLib.h>
+#include <Library/PerformanceLib.h>
 
 #include <Protocol/FormBrowserEx2.h>
 #include <Protocol/SimpleTextIn.h>
@@ -1407,6 +1407,12 @@ InsertStringPackage (
     return Status;
   }
 
+  //
+  // Index the string ids. Without the index, FindStringBlock() still works by
+  // parsing the string blocks, so a failure here is not fatal.
+  //
+  BuildStringIndex (StringPackage);
+
   //
   // Insert to String package array
   //
@@ -1506,6 +1512,7 @@ AdjustStringPackage (
       StringPackage->StringPkgHdr->Header.Length += Skip2BlockSize;
       PackageList->PackageListHdr.PackageLength += Skip2BlockSize;
       StringPackage->MaxStringId = MaxStringId;
+      BuildStringIndex (StringPackage);
     }
   }
 
@@ -1644,6 +1651,7 @@ RemoveStringPackages (
     PackageList->PackageListHdr.PackageLength -= Package->StringPkgHdr->Header.Length;
     FreePool (Package->StringBlock);
     FreePool (Package->StringPkgHdr);
+    FreeStringIndex (Package);
     //
     // Delete font information
     //
@@ -1768,6 +1776,12 @@ InsertFontPackage (
     goto Error;
   }
 
+  //
+  // Index the glyphs. Without the index, FindGlyphBlock() still works by
+  // parsing the glyph blocks, so a failure here is not fatal.
+  //
+  BuildGlyphIndex (FontPackage);
+
   //
   // This font package describes an unique EFI_FONT_INFO. Backup it in global
   // font info list.
@@ -1807,6 +1821,9 @@ Error:
     if (FontPackage->GlyphBlock != NULL) {
       FreePool (FontPackage->GlyphBlock);
     }
+    if (FontPackage->GlyphIndex != NULL) {
+      FreePool (FontPackage->GlyphIndex);
+    }
     FreePool (FontPackage);
   }
   if (GlobalFont != NULL) {
@@ -1955,6 +1972,9 @@ RemoveFontPackages (
     if (Package->GlyphBlock != NULL) {
       FreePool (Package->GlyphBlock);
     }
+    if (Package->GlyphIndex != NULL) {
+      FreePool (Package->GlyphIndex);
+    }
     FreePool (Package->FontPkgHdr);
     //
     // Delete default character cell information
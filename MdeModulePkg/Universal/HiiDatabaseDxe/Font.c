@@ -638,6 +638,90 @@ WriteOutputParam (
 }
 
 
+/**
+  Find a glyph in the glyph index of a font package.
+
+  This is a internal function.
+
+  @param  FontPackage             Hii font package instance with a glyph index.
+  @param  CharValue               Unicode character value, which identifies a glyph
+                                  block.
+  @param  GlyphBuffer             Output the corresponding bitmap data of the found
+                                  block. It is the caller's responsibility to free
+                                  this buffer.
+  @param  Cell                    Output cell information of the encoded bitmap.
+  @param  GlyphBufferLen          If not NULL, output the length of GlyphBuffer.
+
+  @retval EFI_SUCCESS             The bitmap data is retrieved successfully.
+  @retval EFI_NOT_FOUND           The specified CharValue does not exist in current
+                                  database.
+  @retval EFI_OUT_OF_RESOURCES    The system is out of resources to accomplish the
+                                  task.
+
+**/
+EFI_STATUS
+LookupGlyphIndex (
+  IN  HII_FONT_PACKAGE_INSTANCE      *FontPackage,
+  IN  CHAR16                         CharValue,
+  OUT UINT8                          **GlyphBuffer, OPTIONAL
+  OUT EFI_HII_GLYPH_INFO             *Cell, OPTIONAL
+  OUT UINTN                          *GlyphBufferLen OPTIONAL
+  )
+{
+  HII_GLYPH_INDEX_ENTRY               *Entry;
+  UINTN                               Low;
+  UINTN                               High;
+  UINTN                               Middle;
+  UINTN                               Redirect;
+  UINTN                               BufferLen;
+
+  //
+  // Each EFI_HII_GIBT_DUPLICATE run redirects the lookup once, so more
+  // redirections than runs mean the duplicates refer to each other.
+  //
+  for (Redirect = 0; Redirect <= FontPackage->GlyphIndexCount; Redirect++) {
+    //
+    // Find the last run starting at or below CharValue.
+    //
+    Low  = 0;
+    High = FontPackage->GlyphIndexCount;
+    while (Low < High) {
+      Middle = (Low + High) / 2;
+      if (FontPackage->GlyphIndex[Middle].CharValue <= CharValue) {
+        Low = Middle + 1;
+      } else {
+        High = Middle;
+      }
+    }
+    if (Low == 0) {
+      return EFI_NOT_FOUND;
+    }
+
+    Entry = &FontPackage->GlyphIndex[Low - 1];
+    if ((UINTN) CharValue >= (UINTN) Entry->CharValue + Entry->Count) {
+      return EFI_NOT_FOUND;
+    }
+
+    if (Entry->Duplicate != 0) {
+      CharValue = Entry->Duplicate;
+      continue;
+    }
+
+    BufferLen = BITMAP_LEN_1_BIT (Entry->Cell.Width, Entry->Cell.Height);
+    return WriteOutputParam (
+             FontPackage->GlyphBlock + Entry->Offset + (CharValue - Entry->CharValue) * BufferLen,
+             BufferLen,
+             &Entry->Cell,
+             GlyphBuffer,
+             Cell,
+             GlyphBufferLen
+             );
+  }
+
+  return EFI_NOT_FOUND;
+}
+
+
 /**
   Parse all glyph blocks to find a glyph block specified by CharValue.
   If CharValue = (CHAR16) (-1), collect all default character cell information
@@ -686,6 +770,10 @@ FindGlyphBlock (
   BaseLine  = 0;
   MinOffsetY = 0;
 
+  if (CharValue != (CHAR16) (-1) && FontPackage->GlyphIndex != NULL) {
+    return LookupGlyphIndex (FontPackage, CharValue, GlyphBuffer, Cell, GlyphBufferLen);
+  }
+
   if (CharValue == (CHAR16) (-1)) {
     //
     // Collect the cell information specified in font package fixed header.
@@ -924,6 +1012,157 @@ FindGlyphBlock (
 }
 
 
+/**
+  Build the glyph index of a font package, so that FindGlyphBlock() locates
+  a glyph without parsing the glyph blocks in front of it. The default cells
+  of the package must have been collected by FindGlyphBlock() with
+  CharValue = (CHAR16) (-1) before.
+
+  @param  FontPackage             Hii font package instance.
+
+  @retval EFI_SUCCESS             The index is built.
+  @retval EFI_OUT_OF_RESOURCES    The system is out of resources to accomplish the
+                                  task. The font package has no index.
+  @retval EFI_NOT_FOUND           The glyph blocks cannot be indexed. The font
+                                  package has no index.
+
+**/
+EFI_STATUS
+BuildGlyphIndex (
+  IN OUT HII_FONT_PACKAGE_INSTANCE  *FontPackage
+  )
+{
+  EFI_STATUS                          Status;
+  HII_GLYPH_INDEX_ENTRY               *GlyphIndex;
+  HII_GLYPH_INDEX_ENTRY               Entry;
+  UINTN                               Count;
+  UINTN                               Pass;
+  UINT8                               *BlockPtr;
+  UINT16                              CharCurrent;
+  UINT16                              Length16;
+  UINT32                              Length32;
+  UINTN                               BufferLen;
+
+  ASSERT (FontPackage != NULL);
+  ASSERT (FontPackage->Signature == HII_FONT_PACKAGE_SIGNATURE);
+
+  //
+  // The first pass counts the runs of glyphs, the second one records them.
+  //
+  GlyphIndex = NULL;
+  Count      = 0;
+  for (Pass = 0; Pass < 2; Pass++) {
+    if (Pass == 1) {
+      if (Count == 0) {
+        return EFI_SUCCESS;
+      }
+      GlyphIndex = AllocateZeroPool (Count * sizeof (HII_GLYPH_INDEX_ENTRY));
+      if (GlyphIndex == NULL) {
+        return EFI_OUT_OF_RESOURCES;
+      }
+    }
+
+    Count       = 0;
+    CharCurrent = 1;
+    BlockPtr    = FontPackage->GlyphBlock;
+    while (*BlockPtr != EFI_HII_GIBT_END) {
+      ZeroMem (&Entry, sizeof (Entry));
+      Entry.CharValue = CharCurrent;
+
+      switch (*BlockPtr) {
+      case EFI_HII_GIBT_DEFAULTS:
+        BlockPtr += sizeof (EFI_HII_GIBT_DEFAULTS_BLOCK);
+        break;
+
+      case EFI_HII_GIBT_DUPLICATE:
+        Entry.Count = 1;
+        CopyMem (&Entry.Duplicate, BlockPtr + sizeof (EFI_HII_GLYPH_BLOCK), sizeof (CHAR16));
+        BlockPtr += sizeof (EFI_HII_GIBT_DUPLICATE_BLOCK);
+        break;
+
+      case EFI_HII_GIBT_EXT1:
+        BlockPtr += *(BlockPtr + sizeof (EFI_HII_GLYPH_BLOCK) + sizeof (UINT8));
+        break;
+      case EFI_HII_GIBT_EXT2:
+        CopyMem (&Length16, BlockPtr + sizeof (EFI_HII_GLYPH_BLOCK) + sizeof (UINT8), sizeof (UINT16));
+        BlockPtr += Length16;
+        break;
+      case EFI_HII_GIBT_EXT4:
+        CopyMem (&Length32, BlockPtr + sizeof (EFI_HII_GLYPH_BLOCK) + sizeof (UINT8), sizeof (UINT32));
+        BlockPtr += Length32;
+        break;
+
+      case EFI_HII_GIBT_GLYPH:
+        CopyMem (&Entry.Cell, BlockPtr + sizeof (EFI_HII_GLYPH_BLOCK), sizeof (EFI_HII_GLYPH_INFO));
+        Entry.Count  = 1;
+        BlockPtr    += sizeof (EFI_HII_GIBT_GLYPH_BLOCK) - sizeof (UINT8);
+        Entry.Offset = (UINT32) (BlockPtr - FontPackage->GlyphBlock);
+        BlockPtr    += BITMAP_LEN_1_BIT (Entry.Cell.Width, Entry.Cell.Height);
+        break;
+
+      case EFI_HII_GIBT_GLYPHS:
+        CopyMem (&Entry.Cell, BlockPtr + sizeof (EFI_HII_GLYPH_BLOCK), sizeof (EFI_HII_GLYPH_INFO));
+        CopyMem (&Entry.Count, BlockPtr + sizeof (EFI_HII_GLYPH_BLOCK) + sizeof (EFI_HII_GLYPH_INFO), sizeof (UINT16));
+        BlockPtr    += sizeof (EFI_HII_GLYPH_BLOCK) + sizeof (EFI_HII_GLYPH_INFO) + sizeof (UINT16);
+        Entry.Offset = (UINT32) (BlockPtr - FontPackage->GlyphBlock);
+        BlockPtr    += Entry.Count * BITMAP_LEN_1_BIT (Entry.Cell.Width, Entry.Cell.Height);
+        break;
+
+      case EFI_HII_GIBT_GLYPH_DEFAULT:
+      case EFI_HII_GIBT_GLYPHS_DEFAULT:
+        Status = GetCell (CharCurrent, &FontPackage->GlyphInfoList, &Entry.Cell);
+        if (EFI_ERROR (Status)) {
+          goto Error;
+        }
+        BufferLen = BITMAP_LEN_1_BIT (Entry.Cell.Width, Entry.Cell.Height);
+        if (*BlockPtr == EFI_HII_GIBT_GLYPH_DEFAULT) {
+          Entry.Count = 1;
+          BlockPtr   += sizeof (EFI_HII_GLYPH_BLOCK);
+        } else {
+          CopyMem (&Entry.Count, BlockPtr + sizeof (EFI_HII_GLYPH_BLOCK), sizeof (UINT16));
+          BlockPtr   += sizeof (EFI_HII_GIBT_GLYPHS_DEFAULT_BLOCK) - sizeof (UINT8);
+        }
+        Entry.Offset = (UINT32) (BlockPtr - FontPackage->GlyphBlock);
+        BlockPtr    += Entry.Count * BufferLen;
+        break;
+
+      case EFI_HII_GIBT_SKIP1:
+        CharCurrent = (UINT16) (CharCurrent + (UINT16) (*(BlockPtr + sizeof (EFI_HII_GLYPH_BLOCK))));
+        BlockPtr   += sizeof (EFI_HII_GIBT_SKIP1_BLOCK);
+        break;
+      case EFI_HII_GIBT_SKIP2:
+        CopyMem (&Length16, BlockPtr + sizeof (EFI_HII_GLYPH_BLOCK), sizeof (UINT16));
+        CharCurrent = (UINT16) (CharCurrent + Length16);
+        BlockPtr   += sizeof (EFI_HII_GIBT_SKIP2_BLOCK);
+        break;
+
+      default:
+        Status = EFI_NOT_FOUND;
+        goto Error;
+      }
+
+      if (Entry.Count != 0) {
+        if (GlyphIndex != NULL) {
+          CopyMem (&GlyphIndex[Count], &Entry, sizeof (Entry));
+        }
+        CharCurrent = (UINT16) (CharCurrent + Entry.Count);
+        Count++;
+      }
+    }
+  }
+
+  FontPackage->GlyphIndex      = GlyphIndex;
+  FontPackage->GlyphIndexCount = Count;
+  return EFI_SUCCESS;
+
+Error:
+  if (GlyphIndex != NULL) {
+    FreePool (GlyphIndex);
+  }
+  return Status;
+}
+
+
 /**
   Copy a Font Name to a new created EFI_FONT_INFO structure.
 
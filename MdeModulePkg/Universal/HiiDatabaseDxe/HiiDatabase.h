@@ -157,6 +157,16 @@ typedef struct {
 //
 // String Package definitions
 //
+//
+// Location of the text of one string, relative to the string blocks of its
+// string package. TextOffset is 0 for string ids which are not present in a
+// string block, e.g. those covered by EFI_HII_SIBT_SKIP1/SKIP2 blocks.
+//
+typedef struct {
+  UINT32                                BlockOffset;
+  UINT32                                TextOffset;
+} HII_STRING_INDEX_ENTRY;
+
 #define HII_STRING_PACKAGE_SIGNATURE    SIGNATURE_32 ('h','i','s','p')
 typedef struct _HII_STRING_PACKAGE_INSTANCE {
   UINTN                                 Signature;
@@ -166,6 +176,8 @@ typedef struct _HII_STRING_PACKAGE_INSTANCE {
   LIST_ENTRY                            FontInfoList;  // local font info list
   UINT8                                 FontId;
   EFI_STRING_ID                         MaxStringId;   // record StringId
+  HII_STRING_INDEX_ENTRY                *StringIndex;  // indexed by StringId - 1, NULL if not built
+  EFI_STRING_ID                         StringIndexCount;
 } HII_STRING_PACKAGE_INSTANCE;
 
 //
@@ -192,6 +204,20 @@ typedef struct _HII_SIMPLE_FONT_PACKAGE_INSTANCE {
 //
 // Font Package definitions
 //
+//
+// A run of consecutive characters whose glyphs share one cell and are stored
+// back to back in the glyph blocks of a font package. A run for a
+// EFI_HII_GIBT_DUPLICATE block covers one character, and Duplicate holds the
+// character whose glyph it reuses.
+//
+typedef struct {
+  CHAR16                                CharValue;
+  UINT16                                Count;
+  UINT32                                Offset;     // offset of the bitmap of CharValue
+  CHAR16                                Duplicate;
+  EFI_HII_GLYPH_INFO                    Cell;
+} HII_GLYPH_INDEX_ENTRY;
+
 #define HII_FONT_PACKAGE_SIGNATURE      SIGNATURE_32 ('h','i','f','p')
 typedef struct _HII_FONT_PACKAGE_INSTANCE {
   UINTN                                 Signature;
@@ -201,6 +227,8 @@ typedef struct _HII_FONT_PACKAGE_INSTANCE {
   UINT8                                 *GlyphBlock;
   LIST_ENTRY                            FontEntry;
   LIST_ENTRY                            GlyphInfoList;
+  HII_GLYPH_INDEX_ENTRY                 *GlyphIndex; // sorted by CharValue, NULL if not built
+  UINTN                                 GlyphIndexCount;
 } HII_FONT_PACKAGE_INSTANCE;
 
 #define HII_GLYPH_INFO_SIGNATURE        SIGNATURE_32 ('h','g','i','s')
@@ -545,6 +573,38 @@ FindStringBlock (
   OUT EFI_STRING_ID                   *StartStringId OPTIONAL
   );
 
+/**
+  Build the string id index of a string package, so that FindStringBlock()
+  locates a string without parsing the string blocks in front of it.
+  Any index built before is freed first.
+
+  @param  StringPackage           Hii string package instance.
+
+  @retval EFI_SUCCESS             The index is built.
+  @retval EFI_OUT_OF_RESOURCES    The system is out of resources to accomplish the
+                                  task. The string package has no index.
+  @retval EFI_NOT_FOUND           The string blocks cannot be indexed. The string
+                                  package has no index.
+
+**/
+EFI_STATUS
+BuildStringIndex (
+  IN OUT HII_STRING_PACKAGE_INSTANCE  *StringPackage
+  );
+
+/**
+  Free the string id index of a string package. This must be done whenever
+  the string blocks of the package are changed; the index is then rebuilt
+  by the next FindStringBlock().
+
+  @param  StringPackage           Hii string package instance.
+
+**/
+VOID
+FreeStringIndex (
+  IN OUT HII_STRING_PACKAGE_INSTANCE  *StringPackage
+  );
+
 
 /**
   Parse all glyph blocks to find a glyph block specified by CharValue.
@@ -576,6 +636,26 @@ FindGlyphBlock (
   OUT UINTN                          *GlyphBufferLen OPTIONAL
   );
 
+/**
+  Build the glyph index of a font package, so that FindGlyphBlock() locates
+  a glyph without parsing the glyph blocks in front of it. The default cells
+  of the package must have been collected by FindGlyphBlock() with
+  CharValue = (CHAR16) (-1) before.
+
+  @param  FontPackage             Hii font package instance.
+
+  @retval EFI_SUCCESS             The index is built.
+  @retval EFI_OUT_OF_RESOURCES    The system is out of resources to accomplish the
+                                  task. The font package has no index.
+  @retval EFI_NOT_FOUND           The glyph blocks cannot be indexed. The font
+                                  package has no index.
+
+**/
+EFI_STATUS
+BuildGlyphIndex (
+  IN OUT HII_FONT_PACKAGE_INSTANCE  *FontPackage
+  );
+
 /**
   This function exports Form packages to a buffer.
   This is a internal function.
@@ -233,6 +233,206 @@ GetStringFontInfo (
 }
 
 
+/**
+  Build the string id index of a string package, so that FindStringBlock()
+  locates a string without parsing the string blocks in front of it.
+  Any index built before is freed first.
+
+  @param  StringPackage           Hii string package instance.
+
+  @retval EFI_SUCCESS             The index is built.
+  @retval EFI_OUT_OF_RESOURCES    The system is out of resources to accomplish the
+                                  task. The string package has no index.
+  @retval EFI_NOT_FOUND           The string blocks cannot be indexed. The string
+                                  package has no index.
+
+**/
+EFI_STATUS
+BuildStringIndex (
+  IN OUT HII_STRING_PACKAGE_INSTANCE  *StringPackage
+  )
+{
+  HII_STRING_INDEX_ENTRY               *StringIndex;
+  UINT8                                *BlockHdr;
+  UINT8                                *StringTextPtr;
+  EFI_STRING_ID                        CurrentStringId;
+  EFI_STRING_ID                        DuplicateId;
+  UINTN                                Offset;
+  UINTN                                BlockSize;
+  UINTN                                StringSize;
+  UINT16                               StringCount;
+  UINT16                               SkipCount;
+  UINTN                                Index;
+  UINT8                                Length8;
+  UINT32                               Length32;
+  EFI_HII_SIBT_EXT2_BLOCK              Ext2;
+
+  ASSERT (StringPackage != NULL);
+  ASSERT (StringPackage->Signature == HII_STRING_PACKAGE_SIGNATURE);
+
+  FreeStringIndex (StringPackage);
+  if (StringPackage->MaxStringId == 0) {
+    return EFI_SUCCESS;
+  }
+
+  StringIndex = AllocateZeroPool (StringPackage->MaxStringId * sizeof (HII_STRING_INDEX_ENTRY));
+  if (StringIndex == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // Walk the string blocks once, the same way as FindStringBlock(), and record
+  // where the text of each string id starts. StringCount is the number of
+  // strings held by the current block, and the text of the first one is at
+  // StringTextPtr.
+  //
+  CurrentStringId = 1;
+  BlockHdr        = StringPackage->StringBlock;
+  while (*BlockHdr != EFI_HII_SIBT_END) {
+    StringCount   = 0;
+    StringTextPtr = NULL;
+    BlockSize     = 0;
+
+    switch (*BlockHdr) {
+    case EFI_HII_SIBT_STRING_SCSU:
+    case EFI_HII_SIBT_STRING_SCSU_FONT:
+      if (*BlockHdr == EFI_HII_SIBT_STRING_SCSU) {
+        Offset = sizeof (EFI_HII_STRING_BLOCK);
+      } else {
+        Offset = sizeof (EFI_HII_SIBT_STRING_SCSU_FONT_BLOCK) - sizeof (UINT8);
+      }
+      StringCount   = 1;
+      StringTextPtr = BlockHdr + Offset;
+      break;
+
+    case EFI_HII_SIBT_STRINGS_SCSU:
+      CopyMem (&StringCount, BlockHdr + sizeof (EFI_HII_STRING_BLOCK), sizeof (UINT16));
+      StringTextPtr = BlockHdr + sizeof (EFI_HII_SIBT_STRINGS_SCSU_BLOCK) - sizeof (UINT8);
+      break;
+
+    case EFI_HII_SIBT_STRINGS_SCSU_FONT:
+      CopyMem (&StringCount, BlockHdr + sizeof (EFI_HII_STRING_BLOCK) + sizeof (UINT8), sizeof (UINT16));
+      StringTextPtr = BlockHdr + sizeof (EFI_HII_SIBT_STRINGS_SCSU_FONT_BLOCK) - sizeof (UINT8);
+      break;
+
+    case EFI_HII_SIBT_STRING_UCS2:
+      StringCount   = 1;
+      StringTextPtr = BlockHdr + sizeof (EFI_HII_STRING_BLOCK);
+      break;
+
+    case EFI_HII_SIBT_STRING_UCS2_FONT:
+      StringCount   = 1;
+      StringTextPtr = BlockHdr + sizeof (EFI_HII_SIBT_STRING_UCS2_FONT_BLOCK) - sizeof (CHAR16);
+      break;
+
+    case EFI_HII_SIBT_STRINGS_UCS2:
+      CopyMem (&StringCount, BlockHdr + sizeof (EFI_HII_STRING_BLOCK), sizeof (UINT16));
+      StringTextPtr = BlockHdr + sizeof (EFI_HII_SIBT_STRINGS_UCS2_BLOCK) - sizeof (CHAR16);
+      break;
+
+    case EFI_HII_SIBT_STRINGS_UCS2_FONT:
+      CopyMem (&StringCount, BlockHdr + sizeof (EFI_HII_STRING_BLOCK) + sizeof (UINT8), sizeof (UINT16));
+      StringTextPtr = BlockHdr + sizeof (EFI_HII_SIBT_STRINGS_UCS2_FONT_BLOCK) - sizeof (CHAR16);
+      break;
+
+    case EFI_HII_SIBT_DUPLICATE:
+      //
+      // A duplicate string id shares the text of the string id it refers to.
+      //
+      CopyMem (&DuplicateId, BlockHdr + sizeof (EFI_HII_STRING_BLOCK), sizeof (EFI_STRING_ID));
+      if (CurrentStringId <= StringPackage->MaxStringId &&
+          DuplicateId != 0 && DuplicateId < CurrentStringId) {
+        CopyMem (&StringIndex[CurrentStringId - 1], &StringIndex[DuplicateId - 1], sizeof (HII_STRING_INDEX_ENTRY));
+      }
+      CurrentStringId++;
+      BlockSize = sizeof (EFI_HII_SIBT_DUPLICATE_BLOCK);
+      break;
+
+    case EFI_HII_SIBT_SKIP1:
+      SkipCount       = (UINT16) (*(BlockHdr + sizeof (EFI_HII_STRING_BLOCK)));
+      CurrentStringId = (UINT16) (CurrentStringId + SkipCount);
+      BlockSize       = sizeof (EFI_HII_SIBT_SKIP1_BLOCK);
+      break;
+
+    case EFI_HII_SIBT_SKIP2:
+      CopyMem (&SkipCount, BlockHdr + sizeof (EFI_HII_STRING_BLOCK), sizeof (UINT16));
+      CurrentStringId = (UINT16) (CurrentStringId + SkipCount);
+      BlockSize       = sizeof (EFI_HII_SIBT_SKIP2_BLOCK);
+      break;
+
+    case EFI_HII_SIBT_EXT1:
+      CopyMem (&Length8, BlockHdr + sizeof (EFI_HII_STRING_BLOCK) + sizeof (UINT8), sizeof (UINT8));
+      BlockSize = Length8;
+      break;
+
+    case EFI_HII_SIBT_EXT2:
+      CopyMem (&Ext2, BlockHdr, sizeof (EFI_HII_SIBT_EXT2_BLOCK));
+      BlockSize = Ext2.Length;
+      break;
+
+    case EFI_HII_SIBT_EXT4:
+      CopyMem (&Length32, BlockHdr + sizeof (EFI_HII_STRING_BLOCK) + sizeof (UINT8), sizeof (UINT32));
+      BlockSize = Length32;
+      break;
+
+    default:
+      break;
+    }
+
+    for (Index = 0; Index < StringCount; Index++) {
+      if (CurrentStringId <= StringPackage->MaxStringId) {
+        StringIndex[CurrentStringId - 1].BlockOffset = (UINT32) (BlockHdr - StringPackage->StringBlock);
+        StringIndex[CurrentStringId - 1].TextOffset  = (UINT32) (StringTextPtr - BlockHdr);
+      }
+      if (*BlockHdr == EFI_HII_SIBT_STRING_SCSU || *BlockHdr == EFI_HII_SIBT_STRING_SCSU_FONT ||
+          *BlockHdr == EFI_HII_SIBT_STRINGS_SCSU || *BlockHdr == EFI_HII_SIBT_STRINGS_SCSU_FONT) {
+        StringSize = AsciiStrSize ((CHAR8 *) StringTextPtr);
+      } else {
+        GetUnicodeStringTextOrSize (NULL, StringTextPtr, &StringSize);
+      }
+      StringTextPtr += StringSize;
+      CurrentStringId++;
+    }
+    if (StringTextPtr != NULL) {
+      BlockSize = StringTextPtr - BlockHdr;
+    }
+
+    if (BlockSize == 0) {
+      //
+      // Unknown block type, the blocks behind it cannot be located.
+      //
+      FreePool (StringIndex);
+      return EFI_NOT_FOUND;
+    }
+    BlockHdr += BlockSize;
+  }
+
+  StringPackage->StringIndex      = StringIndex;
+  StringPackage->StringIndexCount = StringPackage->MaxStringId;
+  return EFI_SUCCESS;
+}
+
+/**
+  Free the string id index of a string package. This must be done whenever
+  the string blocks of the package are changed; the index is then rebuilt
+  by the next FindStringBlock().
+
+  @param  StringPackage           Hii string package instance.
+
+**/
+VOID
+FreeStringIndex (
+  IN OUT HII_STRING_PACKAGE_INSTANCE  *StringPackage
+  )
+{
+  if (StringPackage->StringIndex != NULL) {
+    FreePool (StringPackage->StringIndex);
+    StringPackage->StringIndex      = NULL;
+    StringPackage->StringIndexCount = 0;
+  }
+}
+
+
 /**
   Parse all string blocks to find a String block specified by StringId.
   If StringId = (EFI_STRING_ID) (-1), find out all EFI_HII_SIBT_FONT blocks
@@ -303,6 +503,23 @@ FindStringBlock (
     if (StringId > StringPackage->MaxStringId) {
       return EFI_NOT_FOUND;
     }
+
+    //
+    // Use the string id index when the string is present in a string block.
+    // String ids in skip blocks still need the full parse below, which also
+    // reports the skip block to the caller.
+    //
+    if (StringPackage->StringIndex == NULL) {
+      BuildStringIndex (StringPackage);
+    }
+    if (StringPackage->StringIndex != NULL &&
+        StringId <= StringPackage->StringIndexCount &&
+        StringPackage->StringIndex[StringId - 1].TextOffset != 0) {
+      *StringBlockAddr  = StringPackage->StringBlock + StringPackage->StringIndex[StringId - 1].BlockOffset;
+      *BlockType        = **StringBlockAddr;
+      *StringTextOffset = StringPackage->StringIndex[StringId - 1].TextOffset;
+      return EFI_SUCCESS;
+    }
   } else {
     ASSERT (Private != NULL && Private->Signature == HII_DATABASE_PRIVATE_DATA_SIGNATURE);
     if (StringId == 0 && LastStringId != NULL) {
@@ -847,6 +1064,7 @@ InsertLackStringBlock (
   }
   FreePool (StringPackage->StringBlock);
   StringPackage->StringBlock = StringBlock;
+  FreeStringIndex (StringPackage);
   StringPackage->StringPkgHdr->Header.Length += NewBlockSize - OldBlockSize;
 
   return EFI_SUCCESS;
@@ -1014,6 +1232,7 @@ SetStringWorker (
 
     FreePool (StringPackage->StringBlock);
     StringPackage->StringBlock = Block;
+    FreeStringIndex (StringPackage);
     StringPackage->StringPkgHdr->Header.Length += (UINT32) (BlockSize - OldBlockSize);
     break;
 
@@ -1047,6 +1266,7 @@ SetStringWorker (
 
     FreePool (StringPackage->StringBlock);
     StringPackage->StringBlock = Block;
+    FreeStringIndex (StringPackage);
     StringPackage->StringPkgHdr->Header.Length += (UINT32) (BlockSize - OldBlockSize);
     break;
 
@@ -1098,6 +1318,7 @@ SetStringWorker (
 
   FreePool (StringPackage->StringBlock);
   StringPackage->StringBlock = Block;
+  FreeStringIndex (StringPackage);
   StringPackage->StringPkgHdr->Header.Length += Ext2.Length;
 
   return EFI_SUCCESS;
@@ -1283,6 +1504,7 @@ HiiNewString (
       *BlockPtr = EFI_HII_SIBT_END;
       FreePool (StringPackage->StringBlock);
       StringPackage->StringBlock = StringBlock;
+      FreeStringIndex (StringPackage);
       StringPackage->StringPkgHdr->Header.Length += Ucs2BlockSize;
       PackageListNode->PackageListHdr.PackageLength += Ucs2BlockSize;
     }
@@ -1414,6 +1636,7 @@ HiiNewString (
     *BlockPtr = EFI_HII_SIBT_END;
     FreePool (StringPackage->StringBlock);
     StringPackage->StringBlock = StringBlock;
+    FreeStringIndex (StringPackage);
     StringPackage->StringPkgHdr->Header.Length += Ucs2BlockSize;
     PackageListNode->PackageListHdr.PackageLength += Ucs2BlockSize;
 
@@ -1456,6 +1679,7 @@ HiiNewString (
       *BlockPtr = EFI_HII_SIBT_END;
       FreePool (StringPackage->StringBlock);
       StringPackage->StringBlock = StringBlock;
+      FreeStringIndex (StringPackage);
       StringPackage->StringPkgHdr->Header.Length += Ucs2FontBlockSize;
       PackageListNode->PackageListHdr.PackageLength += Ucs2FontBlockSize;
 
@@ -1517,6 +1741,7 @@ HiiNewString (
       *BlockPtr = EFI_HII_SIBT_END;
       FreePool (StringPackage->StringBlock);
       StringPackage->StringBlock = StringBlock;
+      FreeStringIndex (StringPackage);
       StringPackage->StringPkgHdr->Header.Length += FontBlockSize + Ucs2FontBlockSize;
       PackageListNode->PackageListHdr.PackageLength += FontBlockSize + Ucs2FontBlockSize;
 
@@ -122,16 +122,28 @@ RuntimeServiceSetVariable (
   IN VOID          *Data
   )
 {
-  return EmuSetVariable (
-          VariableName,
-          VendorGuid,
-          Attributes,
-          DataSize,
-          Data,
-          &mVariableModuleGlobal->VariableGlobal[Physical],
-          &mVariableModuleGlobal->VolatileLastVariableOffset,
-          &mVariableModuleGlobal->NonVolatileLastVariableOffset
-          );
+  EFI_STATUS       Status;
+
+  Status = EmuSetVariable (
+             VariableName,
+             VendorGuid,
+             Attributes,
+             DataSize,
+             Data,
+             &mVariableModuleGlobal->VariableGlobal[Physical],
+             &mVariableModuleGlobal->VolatileLastVariableOffset,
+             &mVariableModuleGlobal->NonVolatileLastVariableOffset
+             );
+
+  //
+  // Let the drivers which cache db/dbx/dbt know that they have to read it again.
+  //
+  if (!EFI_ERROR (Status) && !EfiAtRuntime () &&
+      CompareGuid (VendorGuid, &gEfiImageSecurityDatabaseGuid)) {
+    EfiEventGroupSignal (&gEdkiiImageSecurityDatabaseChangedGuid);
+  }
+
+  return Status;
 }
 
 /**
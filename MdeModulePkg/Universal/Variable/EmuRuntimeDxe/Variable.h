@@ -34,6 +34,8 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Library/HobLib.h>
 #include <Guid/VariableFormat.h>
 #include <Guid/GlobalVariable.h>
+#include <Guid/ImageAuthentication.h>
+#include <Guid/ImageSecurityDatabaseChanged.h>
 
 #include <Guid/EventGroup.h>
 
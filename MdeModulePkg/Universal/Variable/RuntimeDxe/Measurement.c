@@ -14,10 +14,12 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 #include <PiDxe.h>
 #include <Guid/ImageAuthentication.h>
+#include <Guid/ImageSecurityDatabaseChanged.h>
 #include <IndustryStandard/UefiTcgPlatform.h>
 
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
+#include <Library/UefiLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
@@ -228,6 +230,13 @@ SecureBootHook (
   UINTN                             VariableDataSize;
   VOID                              *VariableData;
 
+  //
+  // Let the drivers which cache db/dbx/dbt know that they have to read it again.
+  //
+  if (CompareGuid (VendorGuid, &gEfiImageSecurityDatabaseGuid)) {
+    EfiEventGroupSignal (&gEdkiiImageSecurityDatabaseChangedGuid);
+  }
+
   if (!IsSecureBootPolicyVariable (VariableName, VendorGuid)) {
     return ;
   }
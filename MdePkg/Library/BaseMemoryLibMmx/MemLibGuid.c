@@ -9,6 +9,7 @@
     BaseMemoryLibRepStr
     BaseMemoryLibOptDxe
     BaseMemoryLibOptPei
+    BaseMemoryLibAvx2
     PeiMemoryLib
     UefiMemoryLib
 
@@ -8,6 +8,7 @@
     BaseMemoryLibRepStr
     BaseMemoryLibOptDxe
     BaseMemoryLibOptPei
+    BaseMemoryLibAvx2
     PeiMemoryLib
     UefiMemoryLib
 
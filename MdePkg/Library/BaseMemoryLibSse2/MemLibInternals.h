@@ -8,6 +8,7 @@
     BaseMemoryLibRepStr
     BaseMemoryLibOptDxe
     BaseMemoryLibOptPei
+    BaseMemoryLibAvx2
 
   Copyright (c) 2006 - 2016, Intel Corporation. All rights reserved.<BR>
   This program and the accompanying materials
@@ -37,34 +37,51 @@ FillBuf (
   IN  UINT16        NumOfBits
   )
 {
+  UINT8   *Src;
+  UINT32  Index;
+
   //
-  // Left shift NumOfBits of bits in advance
+  // Left shift NumOfBits of bits in advance. Shifting a 32-bit value by 32
+  // is undefined in C, so a full refill clears mBitBuf explicitly.
   //
-  Sd->mBitBuf = (UINT32) LShiftU64 (((UINT64)Sd->mBitBuf), NumOfBits);
+  if (NumOfBits < BITBUFSIZ) {
+    Sd->mBitBuf <<= NumOfBits;
+  } else {
+    Sd->mBitBuf = 0;
+  }
 
   //
-  // Copy data needed in bytes into mSbuBitBuf
+  // Copy data needed in 32-bit words into mSubBitBuf. The bits of mSubBitBuf
+  // that have already been consumed are either shifted out or land on the
+  // same bits of mBitBuf, so OR-ing the whole of mSubBitBuf is harmless.
   //
   while (NumOfBits > Sd->mBitCount) {
     NumOfBits = (UINT16) (NumOfBits - Sd->mBitCount);
-    Sd->mBitBuf |= (UINT32) LShiftU64 (((UINT64)Sd->mSubBitBuf), NumOfBits);
+    if (NumOfBits < BITBUFSIZ) {
+      Sd->mBitBuf |= Sd->mSubBitBuf << NumOfBits;
+    }
 
-    if (Sd->mCompSize > 0) {
+    Src = Sd->mSrcBase + Sd->mInBuf;
+    if (Sd->mCompSize >= sizeof (UINT32)) {
       //
-      // Get 1 byte into SubBitBuf
+      // Get 4 bytes into SubBitBuf, most significant byte first
       //
-      Sd->mCompSize--;
-      Sd->mSubBitBuf  = Sd->mSrcBase[Sd->mInBuf++];
-      Sd->mBitCount   = 8;
-
+      Sd->mSubBitBuf  = ((UINT32) Src[0] << 24) | ((UINT32) Src[1] << 16) |
+                        ((UINT32) Src[2] << 8)  | Src[3];
+      Sd->mInBuf     += sizeof (UINT32);
+      Sd->mCompSize  -= sizeof (UINT32);
     } else {
       //
-      // No more bits from the source, just pad zero bit.
+      // Get the remaining bytes and pad zero bits when the source runs out.
       //
       Sd->mSubBitBuf  = 0;
-      Sd->mBitCount   = 8;
-
+      for (Index = 0; Index < Sd->mCompSize; Index++) {
+        Sd->mSubBitBuf |= (UINT32) Src[Index] << (24 - 8 * Index);
+      }
+      Sd->mInBuf     += Sd->mCompSize;
+      Sd->mCompSize   = 0;
     }
+    Sd->mBitCount = BITBUFSIZ;
   }
 
   //
@@ -75,7 +92,9 @@ FillBuf (
   //
   // Copy NumOfBits of bits from mSubBitBuf into mBitBuf
   //
-  Sd->mBitBuf |= Sd->mSubBitBuf >> Sd->mBitCount;
+  if (Sd->mBitCount < BITBUFSIZ) {
+    Sd->mBitBuf |= Sd->mSubBitBuf >> Sd->mBitCount;
+  }
 }
 
 /**
@@ -624,6 +643,24 @@ Decode (
       //
       DataIdx     = Sd->mOutBuf - DecodeP (Sd) - 1;
 
+      //
+      // When the whole string lies within the data already decoded and fits
+      // into the destination buffer, copy it without checking every byte.
+      // A string overlapping its own source repeats the last bytes, so it
+      // must be copied forward byte by byte.
+      //
+      if ((DataIdx < Sd->mOutBuf) && (BytesRemain <= Sd->mOrigSize - Sd->mOutBuf)) {
+        if (Sd->mOutBuf - DataIdx >= BytesRemain) {
+          CopyMem (&Sd->mDstBase[Sd->mOutBuf], &Sd->mDstBase[DataIdx], BytesRemain);
+          Sd->mOutBuf += BytesRemain;
+        } else {
+          while (BytesRemain-- > 0) {
+            Sd->mDstBase[Sd->mOutBuf++] = Sd->mDstBase[DataIdx++];
+          }
+        }
+        continue;
+      }
+
       //
       // Write BytesRemain of bytes into mDstBase
       //
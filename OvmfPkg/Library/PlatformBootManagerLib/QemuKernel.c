@@ -13,6 +13,8 @@
 
 #include <Uefi.h>
 
+#include <Protocol/Cpu.h>
+
 #include <Library/BaseLib.h>
 #include <Library/DebugLib.h>
 #include <Library/LoadLinuxLib.h>
@@ -23,6 +25,58 @@
 #include <Library/UefiLib.h>
 
 
+/**
+  Select a fw_cfg item and read its contents into Buffer. When DEBUG_INFO
+  messages are enabled, log the number of bytes read and the time it took, so
+  that slow direct kernel boots can be attributed to the fw_cfg transfers.
+
+  @param[in]  Name    Name of the item, for the log.
+  @param[in]  Item    The fw_cfg item to read.
+  @param[in]  Size    Number of bytes to read.
+  @param[out] Buffer  Receives the item's contents.
+**/
+STATIC
+VOID
+QemuKernelReadItem (
+  IN  CONST CHAR8           *Name,
+  IN  FIRMWARE_CONFIG_ITEM  Item,
+  IN  UINTN                 Size,
+  OUT VOID                  *Buffer
+  )
+{
+  EFI_STATUS            Status;
+  EFI_CPU_ARCH_PROTOCOL *Cpu;
+  UINT64                Start;
+  UINT64                End;
+  UINT64                TimerPeriod;
+
+  Cpu = NULL;
+  if (DebugPrintLevelEnabled (DEBUG_INFO)) {
+    Status = gBS->LocateProtocol (&gEfiCpuArchProtocolGuid, NULL,
+                    (VOID **)&Cpu);
+    if (EFI_ERROR (Status) ||
+        EFI_ERROR (Cpu->GetTimerValue (Cpu, 0, &Start, &TimerPeriod))) {
+      Cpu = NULL;
+    }
+  }
+
+  DEBUG ((EFI_D_INFO, "Reading %a ...", Name));
+  QemuFwCfgSelectItem (Item);
+  QemuFwCfgReadBytes (Size, Buffer);
+
+  if (Cpu != NULL &&
+      !EFI_ERROR (Cpu->GetTimerValue (Cpu, 0, &End, &TimerPeriod))) {
+    //
+    // TimerPeriod is in femtoseconds; report microseconds.
+    //
+    DEBUG ((EFI_D_INFO, " [done] %Lu bytes in %Lu us\n", (UINT64)Size,
+      DivU64x32 (MultU64x64 (End - Start, TimerPeriod), 1000000000)));
+  } else {
+    DEBUG ((EFI_D_INFO, " [done]\n"));
+  }
+}
+
+
 EFI_STATUS
 TryRunningQemuKernel (
   VOID
@@ -70,10 +124,8 @@ TryRunningQemuKernel (
   }
 
   DEBUG ((EFI_D_INFO, "Setup size: 0x%x\n", (UINT32) SetupSize));
-  DEBUG ((EFI_D_INFO, "Reading kernel setup image ..."));
-  QemuFwCfgSelectItem (QemuFwCfgItemKernelSetupData);
-  QemuFwCfgReadBytes (SetupSize, SetupBuf);
-  DEBUG ((EFI_D_INFO, " [done]\n"));
+  QemuKernelReadItem ("kernel setup image", QemuFwCfgItemKernelSetupData,
+    SetupSize, SetupBuf);
 
   Status = LoadLinuxCheckKernelSetup (SetupBuf, SetupSize);
   if (EFI_ERROR (Status)) {
@@ -101,10 +153,8 @@ TryRunningQemuKernel (
   }
 
   DEBUG ((EFI_D_INFO, "Kernel size: 0x%x\n", (UINT32) KernelSize));
-  DEBUG ((EFI_D_INFO, "Reading kernel image ..."));
-  QemuFwCfgSelectItem (QemuFwCfgItemKernelData);
-  QemuFwCfgReadBytes (KernelSize, KernelBuf);
-  DEBUG ((EFI_D_INFO, " [done]\n"));
+  QemuKernelReadItem ("kernel image", QemuFwCfgItemKernelData, KernelSize,
+    KernelBuf);
 
   QemuFwCfgSelectItem (QemuFwCfgItemCommandLineSize);
   CommandLineSize = (UINTN) QemuFwCfgRead64 ();
@@ -112,8 +162,8 @@ TryRunningQemuKernel (
   if (CommandLineSize > 0) {
     CommandLine = LoadLinuxAllocateCommandLinePages (
                     EFI_SIZE_TO_PAGES (CommandLineSize));
-    QemuFwCfgSelectItem (QemuFwCfgItemCommandLineData);
-    QemuFwCfgReadBytes (CommandLineSize, CommandLine);
+    QemuKernelReadItem ("command line", QemuFwCfgItemCommandLineData,
+      CommandLineSize, CommandLine);
   } else {
     CommandLine = NULL;
   }
@@ -132,10 +182,8 @@ TryRunningQemuKernel (
                    EFI_SIZE_TO_PAGES (InitrdSize)
                    );
     DEBUG ((EFI_D_INFO, "Initrd size: 0x%x\n", (UINT32) InitrdSize));
-    DEBUG ((EFI_D_INFO, "Reading initrd image ..."));
-    QemuFwCfgSelectItem (QemuFwCfgItemInitrdData);
-    QemuFwCfgReadBytes (InitrdSize, InitrdData);
-    DEBUG ((EFI_D_INFO, " [done]\n"));
+    QemuKernelReadItem ("initrd image", QemuFwCfgItemInitrdData, InitrdSize,
+      InitrdData);
   } else {
     InitrdData = NULL;
   }
@@ -45,6 +45,39 @@ QemuFwCfgSelectItem (
   IoWrite16 (FW_CFG_IO_SELECTOR, (UINT16)(UINTN) QemuFwCfgItem);
 }
 
+/**
+  Transfer an array of bytes, or skip a number of bytes, using the DMA
+  interface, in chunks of at most FW_CFG_DMA_MAX_CHUNK bytes.
+
+  @param[in]     Size     Size in bytes to transfer or skip.
+
+  @param[in,out] Buffer   Buffer to read data into or write data from. Ignored,
+                          and may be NULL, if Size is zero, or Control is
+                          FW_CFG_DMA_CTL_SKIP.
+
+  @param[in]     Control  FW_CFG_DMA_CTL_WRITE, FW_CFG_DMA_CTL_READ or
+                          FW_CFG_DMA_CTL_SKIP.
+**/
+STATIC
+VOID
+InternalQemuFwCfgDmaChunks (
+  IN     UINTN    Size,
+  IN OUT VOID     *Buffer OPTIONAL,
+  IN     UINT32   Control
+  )
+{
+  UINT32 ChunkSize;
+
+  while (Size > 0) {
+    ChunkSize = (UINT32)MIN (Size, FW_CFG_DMA_MAX_CHUNK);
+    InternalQemuFwCfgDmaBytes (ChunkSize, Buffer, Control);
+    if (Control != FW_CFG_DMA_CTL_SKIP) {
+      Buffer = (UINT8 *)Buffer + ChunkSize;
+    }
+    Size -= ChunkSize;
+  }
+}
+
 /**
   Reads firmware configuration bytes into a buffer
 
@@ -59,8 +92,8 @@ InternalQemuFwCfgReadBytes (
   IN VOID                   *Buffer  OPTIONAL
   )
 {
-  if (InternalQemuFwCfgDmaIsAvailable () && Size <= MAX_UINT32) {
-    InternalQemuFwCfgDmaBytes ((UINT32)Size, Buffer, FW_CFG_DMA_CTL_READ);
+  if (InternalQemuFwCfgDmaIsAvailable ()) {
+    InternalQemuFwCfgDmaChunks (Size, Buffer, FW_CFG_DMA_CTL_READ);
     return;
   }
   IoReadFifo8 (FW_CFG_IO_DATA, Size, Buffer);
@@ -111,8 +144,8 @@ QemuFwCfgWriteBytes (
   )
 {
   if (InternalQemuFwCfgIsAvailable ()) {
-    if (InternalQemuFwCfgDmaIsAvailable () && Size <= MAX_UINT32) {
-      InternalQemuFwCfgDmaBytes ((UINT32)Size, Buffer, FW_CFG_DMA_CTL_WRITE);
+    if (InternalQemuFwCfgDmaIsAvailable ()) {
+      InternalQemuFwCfgDmaChunks (Size, Buffer, FW_CFG_DMA_CTL_WRITE);
       return;
     }
     IoWriteFifo8 (FW_CFG_IO_DATA, Size, Buffer);
@@ -142,8 +175,8 @@ QemuFwCfgSkipBytes (
     return;
   }
 
-  if (InternalQemuFwCfgDmaIsAvailable () && Size <= MAX_UINT32) {
-    InternalQemuFwCfgDmaBytes ((UINT32)Size, NULL, FW_CFG_DMA_CTL_SKIP);
+  if (InternalQemuFwCfgDmaIsAvailable ()) {
+    InternalQemuFwCfgDmaChunks (Size, NULL, FW_CFG_DMA_CTL_SKIP);
     return;
   }
 
@@ -17,6 +17,13 @@
 #ifndef __QEMU_FW_CFG_LIB_INTERNAL_H__
 #define __QEMU_FW_CFG_LIB_INTERNAL_H__
 
+//
+// The largest number of bytes moved by a single DMA transfer. Longer reads,
+// writes and skips are split up; this also bounds the size of the bounce
+// buffer that IoMmu->Map() may have to allocate for SEV guests.
+//
+#define FW_CFG_DMA_MAX_CHUNK SIZE_16MB
+
 /**
   Returns a boolean indicating if the firmware configuration interface is
   available for library-internal purposes.
@@ -1,14 +1,19 @@
 /** @file
 
-  This driver produces Block I/O Protocol instances for virtio-blk devices.
+  This driver produces Block I/O and Block I/O 2 Protocol instances for
+  virtio-blk devices.
 
   The implementation is basic:
 
   - No attach/detach (ie. removable media).
 
-  - Although the non-blocking interfaces of EFI_BLOCK_IO2_PROTOCOL could be a
-    good match for multiple in-flight virtio-blk requests, we stick to
-    synchronous requests and EFI_BLOCK_IO_PROTOCOL for now.
+  - Only the first virtqueue ("requestq") is used, even if the device offers
+    more. Boot services run on a single processor, so additional queues would
+    not add parallelism.
+
+  Requests from both protocols are placed in a fixed set of request slots,
+  which allows multiple requests to be in flight on the virtqueue. The used
+  ring is polled by a timer event while any request is outstanding.
 
   Copyright (C) 2012, Red Hat, Inc.
   Copyright (c) 2012 - 2018, Intel Corporation. All rights reserved.<BR>
@@ -24,7 +29,7 @@
 
 **/
 
-#include <IndustryStandard/VirtioBlk.h>
+#include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/MemoryAllocationLib.h>
@@ -184,93 +189,127 @@ VerifyReadWriteRequest (
 
 /**
 
-  Format a read / write / flush request as three consecutive virtio
-  descriptors, push them to the host, and poll for the response.
+  Pop a free request slot, or report that all slots are in use.
 
-  This is the main workhorse function. Two use cases are supported, read/write
-  and flush. The function may only be called after the request parameters have
-  been verified by
-  - specific checks in ReadBlocks() / WriteBlocks() / FlushBlocks(), and
-  - VerifyReadWriteRequest() (for read/write only).
+  Must be called at TPL_NOTIFY.
 
-  Parameters handled commonly:
+  @param[in out] Dev      The virtio-blk device.
 
-    @param[in] Dev             The virtio-blk device the request is targeted
-                               at.
+  @param[out]    SlotIdx  The index of the slot taken.
 
-  Flush request:
+  @retval TRUE   A slot has been taken.
 
-    @param[in] Lba             Must be zero.
+  @retval FALSE  All slots are in flight.
 
-    @param[in] BufferSize      Must be zero.
+**/
 
-    @param[in out] Buffer      Ignored by the function.
+STATIC
+BOOLEAN
+VirtioBlkTakeSlot (
+  IN OUT VBLK_DEV *Dev,
+  OUT    UINT16   *SlotIdx
+  )
+{
+  if (Dev->FreeSlotCount == 0) {
+    return FALSE;
+  }
+  *SlotIdx = Dev->FreeSlot[--Dev->FreeSlotCount];
+  return TRUE;
+}
 
-    @param[in] RequestIsWrite  Must be TRUE.
 
-  Read/Write request:
+/**
 
-    @param[in] Lba             Logical Block Address: number of logical blocks
-                               to skip from the beginning of the device.
+  Finish a request that has left the virtqueue (or never made it there), and
+  report its outcome to the requester.
 
-    @param[in] BufferSize      Size of buffer to transfer, in bytes. The caller
-                               is responsible to ensure this parameter is
-                               positive.
+  Blocking requests are only marked as done; SynchronousRequest() is polling
+  for that. For non-blocking requests, the token is signaled, and the tracking
+  structure is released.
 
-    @param[in out] Buffer      The guest side area to read data from the device
-                               into, or write data to the device from.
+  Must be called at TPL_NOTIFY.
 
-    @param[in] RequestIsWrite  TRUE iff data transfer goes from guest to
-                               device.
+  @param[in out] Request  The request to complete.
 
-  Return values are common to both use cases, and are appropriate to be
-  forwarded by the EFI_BLOCK_IO_PROTOCOL functions (ReadBlocks(),
-  WriteBlocks(), FlushBlocks()).
+  @param[in] Status       The outcome of the request.
 
+**/
 
-  @retval EFI_SUCCESS          Transfer complete.
+STATIC
+VOID
+VirtioBlkCompleteRequest (
+  IN OUT VBLK_REQUEST *Request,
+  IN     EFI_STATUS   Status
+  )
+{
+  EFI_BLOCK_IO2_TOKEN *Token;
 
-  @retval EFI_DEVICE_ERROR     Failed to notify host side via VirtIo write, or
-                               unable to parse host response, or host response
-                               is not VIRTIO_BLK_S_OK or failed to map Buffer
-                               for a bus master operation.
+  Token = Request->Token;
+  if (Token == NULL) {
+    Request->Status = Status;
+    Request->Done   = TRUE;
+    return;
+  }
+
+  Token->TransactionStatus = Status;
+  FreePool (Request);
+  gBS->SignalEvent (Token->Event);
+}
+
+
+/**
+
+  Format a read / write / flush request as a chain of virtio descriptors in the
+  specified request slot, and place the head of the chain on the available
+  ring. The available ring index is not published to the host here, so that
+  VirtioBlkDispatch() can notify the host once for a batch of requests.
+
+  The descriptors are either two or three consecutive entries in the
+  descriptor table, starting at SlotIdx * 3, or -- if indirect descriptors have
+  been negotiated -- an indirect table in the slot's shared area, referenced by
+  the single descriptor table entry at SlotIdx. Either way the head descriptor
+  identifies the slot, when the host returns it on the used ring.
+
+  Must be called at TPL_NOTIFY.
+
+  @param[in out] Dev       The virtio-blk device.
+
+  @param[in out] Request   The request to submit. The parameters have been
+                           verified by the caller.
+
+  @param[in] SlotIdx       The request slot reserved for the request.
+
+  @param[in out] AvailIdx  The next available ring index to fill in. Advanced
+                           on success.
+
+  @retval EFI_SUCCESS       The request has been placed on the available ring.
+
+  @retval EFI_DEVICE_ERROR  Failed to map the data buffer for a bus master
+                            operation.
 
 **/
 
 STATIC
 EFI_STATUS
-EFIAPI
-SynchronousRequest (
-  IN              VBLK_DEV *Dev,
-  IN              EFI_LBA  Lba,
-  IN              UINTN    BufferSize,
-  IN OUT volatile VOID     *Buffer,
-  IN              BOOLEAN  RequestIsWrite
+VirtioBlkSubmit (
+  IN OUT VBLK_DEV     *Dev,
+  IN OUT VBLK_REQUEST *Request,
+  IN     UINT16       SlotIdx,
+  IN OUT UINT16       *AvailIdx
   )
 {
-  UINT32                  BlockSize;
-  volatile VIRTIO_BLK_REQ Request;
-  volatile UINT8          *HostStatus;
-  VOID                    *HostStatusBuffer;
-  DESC_INDICES            Indices;
-  VOID                    *RequestMapping;
-  VOID                    *StatusMapping;
-  VOID                    *BufferMapping;
-  EFI_PHYSICAL_ADDRESS    BufferDeviceAddress;
-  EFI_PHYSICAL_ADDRESS    HostStatusDeviceAddress;
-  EFI_PHYSICAL_ADDRESS    RequestDeviceAddress;
-  EFI_STATUS              Status;
-  EFI_STATUS              UnmapStatus;
+  VBLK_SHARED_SLOT     *Shared;
+  EFI_PHYSICAL_ADDRESS SharedDeviceAddress;
+  EFI_PHYSICAL_ADDRESS BufferDeviceAddress;
+  volatile VRING_DESC  *Desc;
+  UINT16               DescBase;
+  UINT16               HeadDescIdx;
+  UINT16               NumDesc;
+  UINT32               BlockSize;
+  EFI_STATUS           Status;
 
   BlockSize = Dev->BlockIoMedia.BlockSize;
 
-  //
-  // Set BufferMapping and BufferDeviceAddress to suppress incorrect
-  // compiler/analyzer warnings.
-  //
-  BufferMapping       = NULL;
-  BufferDeviceAddress = 0;
-
   //
   // ensured by VirtioBlkInit()
   //
@@ -278,186 +317,455 @@ SynchronousRequest (
   ASSERT (BlockSize % 512 == 0);
 
   //
-  // ensured by contract above, plus VerifyReadWriteRequest()
-  //
-  ASSERT (BufferSize % BlockSize == 0);
-
-  //
-  // Prepare virtio-blk request header, setting zero size for flush.
-  // IO Priority is homogeneously 0.
+  // ensured by VerifyReadWriteRequest(); see also virtio-0.9.5, 2.3.2
+  // Descriptor Table: "no descriptor chain may be more than 2^32 bytes long in
+  // total". The predicate also implies that converting BufferSize to UINT32
+  // will not truncate it.
   //
-  Request.Type   = RequestIsWrite ?
-                   (BufferSize == 0 ? VIRTIO_BLK_T_FLUSH : VIRTIO_BLK_T_OUT) :
-                   VIRTIO_BLK_T_IN;
-  Request.IoPrio = 0;
-  Request.Sector = MultU64x32(Lba, BlockSize / 512);
+  ASSERT (Request->BufferSize % BlockSize == 0);
+  ASSERT (Request->BufferSize <= SIZE_1GB);
 
-  //
-  // Host status is bi-directional (we preset with a value and expect the
-  // device to update it). Allocate a host status buffer which can be mapped
-  // to access equally by both processor and the device.
-  //
-  Status = Dev->VirtIo->AllocateSharedPages (
-                          Dev->VirtIo,
-                          EFI_SIZE_TO_PAGES (sizeof *HostStatus),
-                          &HostStatusBuffer
-                          );
-  if (EFI_ERROR (Status)) {
-    return EFI_DEVICE_ERROR;
-  }
-
-  HostStatus = HostStatusBuffer;
-
-  //
-  // Map virtio-blk request header (must be done after request header is
-  // populated)
-  //
-  Status = VirtioMapAllBytesInSharedBuffer (
-             Dev->VirtIo,
-             VirtioOperationBusMasterRead,
-             (VOID *) &Request,
-             sizeof Request,
-             &RequestDeviceAddress,
-             &RequestMapping
-             );
-  if (EFI_ERROR (Status)) {
-    Status = EFI_DEVICE_ERROR;
-    goto FreeHostStatusBuffer;
-  }
+  Shared              = &Dev->Shared[SlotIdx];
+  SharedDeviceAddress = Dev->SharedDeviceAddress +
+                        SlotIdx * sizeof (VBLK_SHARED_SLOT);
 
   //
   // Map data buffer
   //
-  if (BufferSize > 0) {
+  Request->BufferMapping = NULL;
+  BufferDeviceAddress    = 0;
+  if (Request->BufferSize > 0) {
     Status = VirtioMapAllBytesInSharedBuffer (
                Dev->VirtIo,
-               (RequestIsWrite ?
+               (Request->RequestIsWrite ?
                 VirtioOperationBusMasterRead :
                 VirtioOperationBusMasterWrite),
-               (VOID *) Buffer,
-               BufferSize,
+               Request->Buffer,
+               Request->BufferSize,
                &BufferDeviceAddress,
-               &BufferMapping
+               &Request->BufferMapping
                );
     if (EFI_ERROR (Status)) {
-      Status = EFI_DEVICE_ERROR;
-      goto UnmapRequestBuffer;
+      return EFI_DEVICE_ERROR;
     }
   }
 
   //
-  // preset a host status for ourselves that we do not accept as success
-  //
-  *HostStatus = VIRTIO_BLK_S_IOERR;
+  // Prepare virtio-blk request header, setting zero size for flush.
+  // IO Priority is homogeneously 0. Preset a host status that we do not
+  // accept as success.
+  //
+  Shared->Request.Type   = Request->RequestIsWrite ?
+                           (Request->BufferSize == 0 ?
+                            VIRTIO_BLK_T_FLUSH :
+                            VIRTIO_BLK_T_OUT) :
+                           VIRTIO_BLK_T_IN;
+  Shared->Request.IoPrio = 0;
+  Shared->Request.Sector = MultU64x32 (Request->Lba, BlockSize / 512);
+  Shared->HostStatus     = VIRTIO_BLK_S_IOERR;
+
+  if (Dev->Indirect) {
+    Desc        = Shared->Indirect;
+    DescBase    = 0;
+    HeadDescIdx = SlotIdx;
+  } else {
+    DescBase    = (UINT16) (SlotIdx * 3);
+    Desc        = &Dev->Ring.Desc[DescBase];
+    HeadDescIdx = DescBase;
+  }
 
   //
-  // Map the Status Buffer with VirtioOperationBusMasterCommonBuffer so that
-  // both processor and device can access it.
+  // virtio-blk header in first desc
   //
-  Status = VirtioMapAllBytesInSharedBuffer (
-             Dev->VirtIo,
-             VirtioOperationBusMasterCommonBuffer,
-             HostStatusBuffer,
-             sizeof *HostStatus,
-             &HostStatusDeviceAddress,
-             &StatusMapping
-             );
-  if (EFI_ERROR (Status)) {
-    Status = EFI_DEVICE_ERROR;
-    goto UnmapDataBuffer;
+  NumDesc = 0;
+  Desc[NumDesc].Addr  = SharedDeviceAddress +
+                        OFFSET_OF (VBLK_SHARED_SLOT, Request);
+  Desc[NumDesc].Len   = sizeof Shared->Request;
+  Desc[NumDesc].Flags = VRING_DESC_F_NEXT;
+  Desc[NumDesc].Next  = (UINT16) (DescBase + NumDesc + 1);
+  NumDesc++;
+
+  //
+  // data buffer for read/write in second desc; VRING_DESC_F_WRITE is
+  // interpreted from the host's point of view.
+  //
+  if (Request->BufferSize > 0) {
+    Desc[NumDesc].Addr  = BufferDeviceAddress;
+    Desc[NumDesc].Len   = (UINT32) Request->BufferSize;
+    Desc[NumDesc].Flags = VRING_DESC_F_NEXT |
+                          (Request->RequestIsWrite ? 0 : VRING_DESC_F_WRITE);
+    Desc[NumDesc].Next  = (UINT16) (DescBase + NumDesc + 1);
+    NumDesc++;
   }
 
-  VirtioPrepare (&Dev->Ring, &Indices);
-
   //
-  // ensured by VirtioBlkInit() -- this predicate, in combination with the
-  // lock-step progress, ensures we don't have to track free descriptors.
+  // host status in last (second or third) desc
   //
-  ASSERT (Dev->Ring.QueueSize >= 3);
+  Desc[NumDesc].Addr  = SharedDeviceAddress +
+                        OFFSET_OF (VBLK_SHARED_SLOT, HostStatus);
+  Desc[NumDesc].Len   = sizeof Shared->HostStatus;
+  Desc[NumDesc].Flags = VRING_DESC_F_WRITE;
+  Desc[NumDesc].Next  = 0;
+  NumDesc++;
+
+  if (Dev->Indirect) {
+    Desc        = &Dev->Ring.Desc[HeadDescIdx];
+    Desc->Addr  = SharedDeviceAddress + OFFSET_OF (VBLK_SHARED_SLOT, Indirect);
+    Desc->Len   = (UINT32) (NumDesc * sizeof (VRING_DESC));
+    Desc->Flags = VRING_DESC_F_INDIRECT;
+    Desc->Next  = 0;
+  }
 
   //
-  // virtio-blk header in first desc
+  // virtio-0.9.5, 2.4.1.2 Updating the Available Ring. The number of
+  // requests in flight never exceeds the number of slots, which never exceeds
+  // the queue size, hence the available ring cannot overflow.
   //
-  VirtioAppendDesc (
-    &Dev->Ring,
-    RequestDeviceAddress,
-    sizeof Request,
-    VRING_DESC_F_NEXT,
-    &Indices
-    );
-
-  //
-  // data buffer for read/write in second desc
-  //
-  if (BufferSize > 0) {
-    //
-    // From virtio-0.9.5, 2.3.2 Descriptor Table:
-    // "no descriptor chain may be more than 2^32 bytes long in total".
-    //
-    // The predicate is ensured by the call contract above (for flush), or
-    // VerifyReadWriteRequest() (for read/write). It also implies that
-    // converting BufferSize to UINT32 will not truncate it.
-    //
-    ASSERT (BufferSize <= SIZE_1GB);
-
-    //
-    // VRING_DESC_F_WRITE is interpreted from the host's point of view.
-    //
-    VirtioAppendDesc (
-      &Dev->Ring,
-      BufferDeviceAddress,
-      (UINT32) BufferSize,
-      VRING_DESC_F_NEXT | (RequestIsWrite ? 0 : VRING_DESC_F_WRITE),
-      &Indices
-      );
+  Dev->Slot[SlotIdx] = Request;
+  Dev->Ring.Avail.Ring[(*AvailIdx)++ % Dev->Ring.QueueSize] = HeadDescIdx;
+  return EFI_SUCCESS;
+}
+
+
+/**
+
+  Move as many requests from the pending list to the virtqueue as there are
+  free slots, and notify the host once about all of them.
+
+  Requests are submitted in FIFO order. A flush request is submitted only when
+  no other request is in flight (holding back the requests queued behind it);
+  this way a flush covers all writes queued before it.
+
+  Must be called at TPL_NOTIFY.
+
+  @param[in out] Dev  The virtio-blk device.
+
+**/
+
+STATIC
+VOID
+VirtioBlkDispatch (
+  IN OUT VBLK_DEV *Dev
+  )
+{
+  VBLK_REQUEST *Request;
+  UINT16       SlotIdx;
+  UINT16       AvailIdx;
+  UINT16       NumSubmitted;
+  EFI_STATUS   Status;
+
+  AvailIdx     = *Dev->Ring.Avail.Idx;
+  NumSubmitted = 0;
+
+  while (!IsListEmpty (&Dev->PendingList)) {
+    Request = VBLK_REQUEST_FROM_LINK (GetFirstNode (&Dev->PendingList));
+
+    if (Request->RequestIsWrite && Request->BufferSize == 0 &&
+        Dev->FreeSlotCount < Dev->SlotCount) {
+      break;
+    }
+    if (!VirtioBlkTakeSlot (Dev, &SlotIdx)) {
+      break;
+    }
+    RemoveEntryList (&Request->Link);
+
+    Status = VirtioBlkSubmit (Dev, Request, SlotIdx, &AvailIdx);
+    if (EFI_ERROR (Status)) {
+      Dev->FreeSlot[Dev->FreeSlotCount++] = SlotIdx;
+      VirtioBlkCompleteRequest (Request, Status);
+      continue;
+    }
+    NumSubmitted++;
+  }
+
+  if (NumSubmitted == 0) {
+    return;
   }
 
   //
-  // host status in last (second or third) desc
+  // virtio-0.9.5, 2.4.1.3 Updating the Index Field
   //
-  VirtioAppendDesc (
-    &Dev->Ring,
-    HostStatusDeviceAddress,
-    sizeof *HostStatus,
-    VRING_DESC_F_WRITE,
-    &Indices
-    );
+  MemoryFence ();
+  *Dev->Ring.Avail.Idx = AvailIdx;
 
   //
-  // virtio-blk's only virtqueue is #0, called "requestq" (see Appendix D).
+  // virtio-0.9.5, 2.4.1.4 Notifying the Device -- gratuitous notifications are
+  // OK. virtio-blk's only virtqueue is #0, called "requestq" (see Appendix D).
   //
-  if (VirtioFlush (Dev->VirtIo, 0, &Dev->Ring, &Indices,
-        NULL) == EFI_SUCCESS &&
-      *HostStatus == VIRTIO_BLK_S_OK) {
-    Status = EFI_SUCCESS;
-  } else {
-    Status = EFI_DEVICE_ERROR;
+  MemoryFence ();
+  Status = Dev->VirtIo->SetQueueNotify (Dev->VirtIo, 0);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: SetQueueNotify(): %r\n", __FUNCTION__, Status));
   }
+}
+
+
+/**
+
+  Collect the requests that the host has completed since the last call from
+  the used ring, release their slots, and report their outcomes. Then submit
+  pending requests to the freed slots, and stop the poll timer if nothing is
+  left in flight.
+
+  Must be called at TPL_NOTIFY.
+
+  @param[in out] Dev  The virtio-blk device.
+
+**/
+
+STATIC
+VOID
+VirtioBlkReap (
+  IN OUT VBLK_DEV *Dev
+  )
+{
+  volatile CONST VRING_USED_ELEM *UsedElem;
+  VBLK_REQUEST                   *Request;
+  UINT32                         HeadDescIdx;
+  UINT16                         SlotIdx;
+  EFI_STATUS                     Status;
+  EFI_STATUS                     UnmapStatus;
+
+  //
+  // virtio-0.9.5, 2.4.2 Receiving Used Buffers From the Device
+  //
+  MemoryFence ();
+  while (Dev->LastUsedIdx != *Dev->Ring.Used.Idx) {
+    MemoryFence ();
+    UsedElem = &Dev->Ring.Used.UsedElem[Dev->LastUsedIdx++ %
+                                        Dev->Ring.QueueSize];
+    HeadDescIdx = UsedElem->Id;
+    SlotIdx = (UINT16) (Dev->Indirect ? HeadDescIdx : HeadDescIdx / 3);
+    ASSERT (SlotIdx < Dev->SlotCount);
+
+    Request = Dev->Slot[SlotIdx];
+    ASSERT (Request != NULL);
+    Dev->Slot[SlotIdx] = NULL;
+
+    Status = (Dev->Shared[SlotIdx].HostStatus == VIRTIO_BLK_S_OK) ?
+             EFI_SUCCESS :
+             EFI_DEVICE_ERROR;
+    Dev->FreeSlot[Dev->FreeSlotCount++] = SlotIdx;
+
+    if (Request->BufferSize > 0) {
+      UnmapStatus = Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo,
+                                   Request->BufferMapping);
+      if (EFI_ERROR (UnmapStatus) && !Request->RequestIsWrite) {
+        //
+        // Data from the bus master may not reach the caller; fail the
+        // request.
+        //
+        Status = EFI_DEVICE_ERROR;
+      }
+    }
+
+    VirtioBlkCompleteRequest (Request, Status);
+    MemoryFence ();
+  }
+
+  VirtioBlkDispatch (Dev);
+
+  if (Dev->FreeSlotCount == Dev->SlotCount && IsListEmpty (&Dev->PendingList)) {
+    gBS->SetTimer (Dev->PollTimer, TimerCancel, 0);
+  }
+}
+
+
+/**
+
+  Timer event notification function that polls the used ring while requests
+  are in flight.
+
+  @param[in] Event    Event whose notification function is being invoked.
+
+  @param[in] Context  Pointer to the VBLK_DEV structure.
+
+**/
+
+STATIC
+VOID
+EFIAPI
+VirtioBlkPollTimer (
+  IN  EFI_EVENT Event,
+  IN  VOID      *Context
+  )
+{
+  VirtioBlkReap (Context);
+}
+
+
+/**
+
+  Queue a verified request for submission to the host, and submit it
+  immediately if possible.
+
+  @param[in out] Dev      The virtio-blk device.
+
+  @param[in out] Request  The request to queue.
+
+**/
+
+STATIC
+VOID
+VirtioBlkQueueRequest (
+  IN OUT VBLK_DEV     *Dev,
+  IN OUT VBLK_REQUEST *Request
+  )
+{
+  EFI_TPL OldTpl;
+
+  Request->Signature = VBLK_REQ_SIG;
+  Request->Done      = FALSE;
+
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  InsertTailList (&Dev->PendingList, &Request->Link);
+  VirtioBlkDispatch (Dev);
+  if (Dev->FreeSlotCount < Dev->SlotCount ||
+      !IsListEmpty (&Dev->PendingList)) {
+    gBS->SetTimer (Dev->PollTimer, TimerPeriodic, VBLK_POLL_PERIOD);
+  }
+  gBS->RestoreTPL (OldTpl);
+}
+
+
+/**
+
+  Wait until all requests queued on the device have completed.
+
+  @param[in out] Dev  The virtio-blk device.
+
+**/
+
+STATIC
+VOID
+VirtioBlkDrain (
+  IN OUT VBLK_DEV *Dev
+  )
+{
+  EFI_TPL OldTpl;
+  BOOLEAN Idle;
+  UINTN   PollPeriodUsecs;
+
+  PollPeriodUsecs = 1;
+  for (;;) {
+    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+    VirtioBlkReap (Dev);
+    Idle = (BOOLEAN) (Dev->FreeSlotCount == Dev->SlotCount &&
+                      IsListEmpty (&Dev->PendingList));
+    gBS->RestoreTPL (OldTpl);
+
+    if (Idle) {
+      return;
+    }
+
+    gBS->Stall (PollPeriodUsecs);
+    if (PollPeriodUsecs < 1024) {
+      PollPeriodUsecs *= 2;
+    }
+  }
+}
+
+
+/**
+
+  Format a read / write / flush request, queue it to the host, and poll for
+  the response.
+
+  This is the blocking wrapper around the request queue. Two use cases are
+  supported, read/write and flush. The function may only be called after the
+  request parameters have been verified by
+  - specific checks in ReadBlocks() / WriteBlocks() / FlushBlocks(), and
+  - VerifyReadWriteRequest() (for read/write only).
+
+  Parameters handled commonly:
+
+    @param[in] Dev             The virtio-blk device the request is targeted
+                               at.
+
+  Flush request:
+
+    @param[in] Lba             Must be zero.
+
+    @param[in] BufferSize      Must be zero.
+
+    @param[in out] Buffer      Ignored by the function.
+
+    @param[in] RequestIsWrite  Must be TRUE.
+
+  Read/Write request:
+
+    @param[in] Lba             Logical Block Address: number of logical blocks
+                               to skip from the beginning of the device.
+
+    @param[in] BufferSize      Size of buffer to transfer, in bytes. The caller
+                               is responsible to ensure this parameter is
+                               positive.
+
+    @param[in out] Buffer      The guest side area to read data from the device
+                               into, or write data to the device from.
+
+    @param[in] RequestIsWrite  TRUE iff data transfer goes from guest to
+                               device.
+
+  Return values are common to both use cases, and are appropriate to be
+  forwarded by the EFI_BLOCK_IO_PROTOCOL functions (ReadBlocks(),
+  WriteBlocks(), FlushBlocks()).
+
+
+  @retval EFI_SUCCESS          Transfer complete.
+
+  @retval EFI_DEVICE_ERROR     Unable to parse host response, or host response
+                               is not VIRTIO_BLK_S_OK or failed to map Buffer
+                               for a bus master operation.
+
+**/
+
+STATIC
+EFI_STATUS
+EFIAPI
+SynchronousRequest (
+  IN              VBLK_DEV *Dev,
+  IN              EFI_LBA  Lba,
+  IN              UINTN    BufferSize,
+  IN OUT volatile VOID     *Buffer,
+  IN              BOOLEAN  RequestIsWrite
+  )
+{
+  VBLK_REQUEST Request;
+  EFI_TPL      OldTpl;
+  BOOLEAN      Done;
+  UINTN        PollPeriodUsecs;
+
+  Request.Token          = NULL;
+  Request.Lba            = Lba;
+  Request.BufferSize     = BufferSize;
+  Request.Buffer         = (VOID *) Buffer;
+  Request.RequestIsWrite = RequestIsWrite;
+  VirtioBlkQueueRequest (Dev, &Request);
+
+  //
+  // Keep slowing down until we reach a poll period of slightly above 1 ms.
+  // The poll timer may complete the request too, if our caller runs below
+  // TPL_NOTIFY.
+  //
+  PollPeriodUsecs = 1;
+  for (;;) {
+    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+    if (!Request.Done) {
+      VirtioBlkReap (Dev);
+    }
+    Done = Request.Done;
+    gBS->RestoreTPL (OldTpl);
 
-  Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, StatusMapping);
+    if (Done) {
+      return Request.Status;
+    }
 
-UnmapDataBuffer:
-  if (BufferSize > 0) {
-    UnmapStatus = Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, BufferMapping);
-    if (EFI_ERROR (UnmapStatus) && !RequestIsWrite && !EFI_ERROR (Status)) {
-      //
-      // Data from the bus master may not reach the caller; fail the request.
-      //
-      Status = EFI_DEVICE_ERROR;
+    gBS->Stall (PollPeriodUsecs); // calls AcpiTimerLib::MicroSecondDelay
+    if (PollPeriodUsecs < 1024) {
+      PollPeriodUsecs *= 2;
     }
   }
-
-UnmapRequestBuffer:
-  Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, RequestMapping);
-
-FreeHostStatusBuffer:
-  Dev->VirtIo->FreeSharedPages (
-                 Dev->VirtIo,
-                 EFI_SIZE_TO_PAGES (sizeof *HostStatus),
-                 HostStatusBuffer
-                 );
-
-  return Status;
 }
 
 
@@ -610,6 +918,256 @@ VirtioBlkFlushBlocks (
 }
 
 
+//
+// UEFI Spec 2.7, 13.10 Block I/O 2 Protocol
+//
+EFI_STATUS
+EFIAPI
+VirtioBlkResetEx (
+  IN EFI_BLOCK_IO2_PROTOCOL *This,
+  IN BOOLEAN                ExtendedVerification
+  )
+{
+  //
+  // The device is working correctly (see VirtioBlkReset()); we only let the
+  // requests in flight finish.
+  //
+  VirtioBlkDrain (VIRTIO_BLK_FROM_BLOCK_IO2 (This));
+  return EFI_SUCCESS;
+}
+
+
+/**
+
+  Submit a read / write / flush request in blocking or non-blocking mode, as
+  selected by Token.
+
+  The parameters are verified by the caller, like for SynchronousRequest().
+
+  @param[in] Dev             The virtio-blk device the request is targeted at.
+
+  @param[in] Lba             See SynchronousRequest().
+
+  @param[in out] Token       If NULL, or Token->Event is NULL, the request is
+                             executed with SynchronousRequest(). Otherwise
+                             Token->Event is signaled upon completion, with
+                             Token->TransactionStatus set.
+
+  @param[in] BufferSize      See SynchronousRequest().
+
+  @param[in out] Buffer      See SynchronousRequest().
+
+  @param[in] RequestIsWrite  See SynchronousRequest().
+
+
+  @retval EFI_SUCCESS           The non-blocking request has been queued.
+
+  @retval EFI_OUT_OF_RESOURCES  Memory allocation failed.
+
+  @return                       Return values from SynchronousRequest(), in
+                                blocking mode.
+
+**/
+
+STATIC
+EFI_STATUS
+AsynchronousRequest (
+  IN     VBLK_DEV            *Dev,
+  IN     EFI_LBA             Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN *Token,
+  IN     UINTN               BufferSize,
+  IN OUT VOID                *Buffer,
+  IN     BOOLEAN             RequestIsWrite
+  )
+{
+  VBLK_REQUEST *Request;
+
+  if (Token == NULL || Token->Event == NULL) {
+    return SynchronousRequest (Dev, Lba, BufferSize, Buffer, RequestIsWrite);
+  }
+
+  Request = AllocatePool (sizeof *Request);
+  if (Request == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Request->Token          = Token;
+  Request->Lba            = Lba;
+  Request->BufferSize     = BufferSize;
+  Request->Buffer         = Buffer;
+  Request->RequestIsWrite = RequestIsWrite;
+  VirtioBlkQueueRequest (Dev, Request);
+  return EFI_SUCCESS;
+}
+
+
+/**
+
+  Complete a non-blocking request successfully without involving the host.
+
+  @param[in out] Token  The token of the request, or NULL for blocking
+                        requests.
+
+**/
+
+STATIC
+VOID
+VirtioBlkSignalSuccess (
+  IN OUT EFI_BLOCK_IO2_TOKEN *Token
+  )
+{
+  if (Token != NULL && Token->Event != NULL) {
+    Token->TransactionStatus = EFI_SUCCESS;
+    gBS->SignalEvent (Token->Event);
+  }
+}
+
+
+/**
+
+  ReadBlocksEx() operation for virtio-blk.
+
+  See UEFI Spec 2.7, 13.10 Block I/O 2 Protocol,
+  EFI_BLOCK_IO2_PROTOCOL.ReadBlocksEx().
+
+  If Token is NULL, or Token->Event is NULL, the request is executed in
+  blocking mode, like ReadBlocks(). Otherwise the request is queued to the
+  virtqueue, and Token->Event is signaled when the host completes it.
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioBlkReadBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  OUT    VOID                   *Buffer
+  )
+{
+  VBLK_DEV   *Dev;
+  EFI_STATUS Status;
+
+  if (BufferSize == 0) {
+    VirtioBlkSignalSuccess (Token);
+    return EFI_SUCCESS;
+  }
+
+  Dev = VIRTIO_BLK_FROM_BLOCK_IO2 (This);
+  Status = VerifyReadWriteRequest (
+             &Dev->BlockIoMedia,
+             Lba,
+             BufferSize,
+             FALSE               // RequestIsWrite
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return AsynchronousRequest (
+           Dev,
+           Lba,
+           Token,
+           BufferSize,
+           Buffer,
+           FALSE       // RequestIsWrite
+           );
+}
+
+
+/**
+
+  WriteBlocksEx() operation for virtio-blk.
+
+  See UEFI Spec 2.7, 13.10 Block I/O 2 Protocol,
+  EFI_BLOCK_IO2_PROTOCOL.WriteBlocksEx().
+
+  Blocking and non-blocking modes are selected as in VirtioBlkReadBlocksEx().
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioBlkWriteBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  IN     VOID                   *Buffer
+  )
+{
+  VBLK_DEV   *Dev;
+  EFI_STATUS Status;
+
+  if (BufferSize == 0) {
+    VirtioBlkSignalSuccess (Token);
+    return EFI_SUCCESS;
+  }
+
+  Dev = VIRTIO_BLK_FROM_BLOCK_IO2 (This);
+  Status = VerifyReadWriteRequest (
+             &Dev->BlockIoMedia,
+             Lba,
+             BufferSize,
+             TRUE                // RequestIsWrite
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return AsynchronousRequest (
+           Dev,
+           Lba,
+           Token,
+           BufferSize,
+           Buffer,
+           TRUE        // RequestIsWrite
+           );
+}
+
+
+/**
+
+  FlushBlocksEx() operation for virtio-blk.
+
+  See UEFI Spec 2.7, 13.10 Block I/O 2 Protocol,
+  EFI_BLOCK_IO2_PROTOCOL.FlushBlocksEx().
+
+  The flush request is submitted to the host only after all requests queued
+  before it have completed. Without write-caching, we do nothing, successfully,
+  as in VirtioBlkFlushBlocks().
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioBlkFlushBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token
+  )
+{
+  VBLK_DEV *Dev;
+
+  Dev = VIRTIO_BLK_FROM_BLOCK_IO2 (This);
+  if (!Dev->BlockIoMedia.WriteCaching) {
+    VirtioBlkSignalSuccess (Token);
+    return EFI_SUCCESS;
+  }
+
+  return AsynchronousRequest (
+           Dev,
+           0,     // Lba
+           Token,
+           0,     // BufferSize
+           NULL,  // Buffer
+           TRUE   // RequestIsWrite
+           );
+}
+
+
 /**
 
   Device probe function for this driver.
@@ -691,6 +1249,144 @@ VirtioBlkDriverBindingSupported (
 }
 
 
+/**
+
+  Allocate and map the request slots of the device, and set up the tracking
+  structures for the requests in flight.
+
+  The number of slots is derived from the queue size: each request consumes
+  three descriptors, or one if indirect descriptors have been negotiated.
+
+  @param[in out] Dev  The virtio-blk device. Dev->Ring and Dev->Indirect must
+                      be set.
+
+  @retval EFI_SUCCESS           Slots set up.
+
+  @retval EFI_OUT_OF_RESOURCES  Memory allocation failed.
+
+  @return                       Error codes from
+                                VirtIo->AllocateSharedPages() or
+                                VirtioMapAllBytesInSharedBuffer().
+
+**/
+
+STATIC
+EFI_STATUS
+VirtioBlkInitSlots (
+  IN OUT VBLK_DEV *Dev
+  )
+{
+  UINTN      SharedPages;
+  UINT16     SlotIdx;
+  EFI_STATUS Status;
+
+  Dev->SlotCount = (UINT16) (Dev->Indirect ?
+                              Dev->Ring.QueueSize :
+                              Dev->Ring.QueueSize / 3);
+  if (Dev->SlotCount > VBLK_MAX_SLOTS) {
+    Dev->SlotCount = VBLK_MAX_SLOTS;
+  }
+  ASSERT (Dev->SlotCount > 0);
+
+  SharedPages = EFI_SIZE_TO_PAGES (Dev->SlotCount * sizeof *Dev->Shared);
+  Status = Dev->VirtIo->AllocateSharedPages (
+                          Dev->VirtIo,
+                          SharedPages,
+                          (VOID **)&Dev->Shared
+                          );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+  ZeroMem (Dev->Shared, EFI_PAGES_TO_SIZE (SharedPages));
+
+  //
+  // Map the request headers, indirect descriptor tables and status bytes with
+  // VirtioOperationBusMasterCommonBuffer so that both processor and device
+  // can access them.
+  //
+  Status = VirtioMapAllBytesInSharedBuffer (
+             Dev->VirtIo,
+             VirtioOperationBusMasterCommonBuffer,
+             Dev->Shared,
+             EFI_PAGES_TO_SIZE (SharedPages),
+             &Dev->SharedDeviceAddress,
+             &Dev->SharedMap
+             );
+  if (EFI_ERROR (Status)) {
+    goto FreeShared;
+  }
+
+  Dev->Slot = AllocateZeroPool (Dev->SlotCount * sizeof *Dev->Slot);
+  if (Dev->Slot == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto UnmapShared;
+  }
+
+  Dev->FreeSlot = AllocatePool (Dev->SlotCount * sizeof *Dev->FreeSlot);
+  if (Dev->FreeSlot == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto FreeSlot;
+  }
+
+  //
+  // Hand out the lowest slots first.
+  //
+  for (SlotIdx = 0; SlotIdx < Dev->SlotCount; SlotIdx++) {
+    Dev->FreeSlot[SlotIdx] = (UINT16) (Dev->SlotCount - 1 - SlotIdx);
+  }
+  Dev->FreeSlotCount = Dev->SlotCount;
+  Dev->LastUsedIdx   = 0;
+  InitializeListHead (&Dev->PendingList);
+
+  //
+  // We're going to poll the used ring, the host should not send an
+  // interrupt.
+  //
+  *Dev->Ring.Avail.Flags = (UINT16) VRING_AVAIL_F_NO_INTERRUPT;
+  return EFI_SUCCESS;
+
+FreeSlot:
+  FreePool (Dev->Slot);
+
+UnmapShared:
+  Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Dev->SharedMap);
+
+FreeShared:
+  Dev->VirtIo->FreeSharedPages (Dev->VirtIo, SharedPages, Dev->Shared);
+
+  return Status;
+}
+
+
+/**
+
+  Release the request slots set up with VirtioBlkInitSlots(). No request may
+  be in flight.
+
+  @param[in out] Dev  The virtio-blk device.
+
+**/
+
+STATIC
+VOID
+VirtioBlkUninitSlots (
+  IN OUT VBLK_DEV *Dev
+  )
+{
+  ASSERT (Dev->FreeSlotCount == Dev->SlotCount);
+  ASSERT (IsListEmpty (&Dev->PendingList));
+
+  FreePool (Dev->FreeSlot);
+  FreePool (Dev->Slot);
+  Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Dev->SharedMap);
+  Dev->VirtIo->FreeSharedPages (
+                 Dev->VirtIo,
+                 EFI_SIZE_TO_PAGES (Dev->SlotCount * sizeof *Dev->Shared),
+                 Dev->Shared
+                 );
+}
+
+
 /**
 
   Set up all BlockIo and virtio-blk aspects of this driver for the specified
@@ -707,7 +1403,7 @@ VirtioBlkDriverBindingSupported (
 
   @return                  Error codes from VirtioRingInit() or
                            VIRTIO_CFG_READ() / VIRTIO_CFG_WRITE or
-                           VirtioRingMap().
+                           VirtioRingMap() or VirtioBlkInitSlots().
 
 **/
 
@@ -822,8 +1518,9 @@ VirtioBlkInit (
   }
 
   Features &= VIRTIO_BLK_F_BLK_SIZE | VIRTIO_BLK_F_TOPOLOGY | VIRTIO_BLK_F_RO |
-              VIRTIO_BLK_F_FLUSH | VIRTIO_F_VERSION_1 |
-              VIRTIO_F_IOMMU_PLATFORM;
+              VIRTIO_BLK_F_FLUSH | VIRTIO_F_RING_INDIRECT_DESC |
+              VIRTIO_F_VERSION_1 | VIRTIO_F_IOMMU_PLATFORM;
+  Dev->Indirect = (BOOLEAN) ((Features & VIRTIO_F_RING_INDIRECT_DESC) != 0);
 
   //
   // In virtio-1.0, feature negotiation is expected to complete before queue
@@ -847,7 +1544,7 @@ VirtioBlkInit (
   if (EFI_ERROR (Status)) {
     goto Failed;
   }
-  if (QueueSize < 3) { // SynchronousRequest() uses at most three descriptors
+  if (QueueSize < 3) { // VirtioBlkSubmit() uses at most three descriptors
     Status = EFI_UNSUPPORTED;
     goto Failed;
   }
@@ -896,6 +1593,15 @@ VirtioBlkInit (
     goto UnmapQueue;
   }
 
+  //
+  // Set up the request slots. If anything fails from here on, we must release
+  // them.
+  //
+  Status = VirtioBlkInitSlots (Dev);
+  if (EFI_ERROR (Status)) {
+    goto UnmapQueue;
+  }
+
 
   //
   // step 5 -- Report understood features.
@@ -904,7 +1610,7 @@ VirtioBlkInit (
     Features &= ~(UINT64)(VIRTIO_F_VERSION_1 | VIRTIO_F_IOMMU_PLATFORM);
     Status = Dev->VirtIo->SetGuestFeatures (Dev->VirtIo, Features);
     if (EFI_ERROR (Status)) {
-      goto UnmapQueue;
+      goto UninitSlots;
     }
   }
 
@@ -914,7 +1620,7 @@ VirtioBlkInit (
   NextDevStat |= VSTAT_DRIVER_OK;
   Status = Dev->VirtIo->SetDeviceStatus (Dev->VirtIo, NextDevStat);
   if (EFI_ERROR (Status)) {
-    goto UnmapQueue;
+    goto UninitSlots;
   }
 
   //
@@ -938,9 +1644,17 @@ VirtioBlkInit (
   Dev->BlockIoMedia.LastBlock        = DivU64x32 (NumSectors,
                                          BlockSize / 512) - 1;
 
+  Dev->BlockIo2.Media                = &Dev->BlockIoMedia;
+  Dev->BlockIo2.Reset                = &VirtioBlkResetEx;
+  Dev->BlockIo2.ReadBlocksEx         = &VirtioBlkReadBlocksEx;
+  Dev->BlockIo2.WriteBlocksEx        = &VirtioBlkWriteBlocksEx;
+  Dev->BlockIo2.FlushBlocksEx        = &VirtioBlkFlushBlocksEx;
+
   DEBUG ((DEBUG_INFO, "%a: LbaSize=0x%x[B] NumBlocks=0x%Lx[Lba]\n",
     __FUNCTION__, Dev->BlockIoMedia.BlockSize,
     Dev->BlockIoMedia.LastBlock + 1));
+  DEBUG ((DEBUG_INFO, "%a: QueueSize=%d Slots=%d Indirect=%d\n",
+    __FUNCTION__, Dev->Ring.QueueSize, Dev->SlotCount, Dev->Indirect));
 
   if (Features & VIRTIO_BLK_F_TOPOLOGY) {
     Dev->BlockIo.Revision = EFI_BLOCK_IO_PROTOCOL_REVISION3;
@@ -957,6 +1671,9 @@ VirtioBlkInit (
   }
   return EFI_SUCCESS;
 
+UninitSlots:
+  VirtioBlkUninitSlots (Dev);
+
 UnmapQueue:
   Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Dev->RingMap);
 
@@ -998,10 +1715,12 @@ VirtioBlkUninit (
   //
   Dev->VirtIo->SetDeviceStatus (Dev->VirtIo, 0);
 
+  VirtioBlkUninitSlots (Dev);
   Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Dev->RingMap);
   VirtioRingUninit (Dev->VirtIo, &Dev->Ring);
 
   SetMem (&Dev->BlockIo,      sizeof Dev->BlockIo,      0x00);
+  SetMem (&Dev->BlockIo2,     sizeof Dev->BlockIo2,     0x00);
   SetMem (&Dev->BlockIoMedia, sizeof Dev->BlockIoMedia, 0x00);
 }
 
@@ -1057,13 +1776,15 @@ VirtioBlkExitBoot (
 
   @retval EFI_SUCCESS           Driver instance has been created and
                                 initialized  for the virtio-blk device, it
-                                is now accessible via EFI_BLOCK_IO_PROTOCOL.
+                                is now accessible via EFI_BLOCK_IO_PROTOCOL
+                                and EFI_BLOCK_IO2_PROTOCOL.
 
   @retval EFI_OUT_OF_RESOURCES  Memory allocation failed.
 
   @return                       Error codes from the OpenProtocol() boot
                                 service, the VirtIo protocol, VirtioBlkInit(),
-                                or the InstallProtocolInterface() boot service.
+                                or the InstallMultipleProtocolInterfaces() boot
+                                service.
 
 **/
 
@@ -1104,19 +1825,30 @@ VirtioBlkDriverBindingStart (
     goto UninitDev;
   }
 
+  Status = gBS->CreateEvent (EVT_TIMER | EVT_NOTIFY_SIGNAL, TPL_NOTIFY,
+                  &VirtioBlkPollTimer, Dev, &Dev->PollTimer);
+  if (EFI_ERROR (Status)) {
+    goto CloseExitBoot;
+  }
+
   //
-  // Setup complete, attempt to export the driver instance's BlockIo interface.
+  // Setup complete, attempt to export the driver instance's BlockIo and
+  // BlockIo2 interfaces.
   //
   Dev->Signature = VBLK_SIG;
-  Status = gBS->InstallProtocolInterface (&DeviceHandle,
-                  &gEfiBlockIoProtocolGuid, EFI_NATIVE_INTERFACE,
-                  &Dev->BlockIo);
+  Status = gBS->InstallMultipleProtocolInterfaces (&DeviceHandle,
+                  &gEfiBlockIoProtocolGuid, &Dev->BlockIo,
+                  &gEfiBlockIo2ProtocolGuid, &Dev->BlockIo2,
+                  NULL);
   if (EFI_ERROR (Status)) {
-    goto CloseExitBoot;
+    goto ClosePollTimer;
   }
 
   return EFI_SUCCESS;
 
+ClosePollTimer:
+  gBS->CloseEvent (Dev->PollTimer);
+
 CloseExitBoot:
   gBS->CloseEvent (Dev->ExitBoot);
 
@@ -1187,12 +1919,20 @@ VirtioBlkDriverBindingStop (
   //
   // Handle Stop() requests for in-use driver instances gracefully.
   //
-  Status = gBS->UninstallProtocolInterface (DeviceHandle,
-                  &gEfiBlockIoProtocolGuid, &Dev->BlockIo);
+  Status = gBS->UninstallMultipleProtocolInterfaces (DeviceHandle,
+                  &gEfiBlockIoProtocolGuid, &Dev->BlockIo,
+                  &gEfiBlockIo2ProtocolGuid, &Dev->BlockIo2,
+                  NULL);
   if (EFI_ERROR (Status)) {
     return Status;
   }
 
+  //
+  // Let the non-blocking requests still in flight complete.
+  //
+  VirtioBlkDrain (Dev);
+  gBS->CloseEvent (Dev->PollTimer);
+
   gBS->CloseEvent (Dev->ExitBoot);
 
   VirtioBlkUninit (Dev);
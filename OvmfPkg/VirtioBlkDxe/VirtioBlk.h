@@ -1,7 +1,7 @@
 /** @file
 
   Internal definitions for the virtio-blk driver, which produces Block I/O
-  Protocol instances for virtio-blk devices.
+  and Block I/O 2 Protocol instances for virtio-blk devices.
 
   Copyright (C) 2012, Red Hat, Inc.
 
@@ -19,14 +19,65 @@
 #define _VIRTIO_BLK_DXE_H_
 
 #include <Protocol/BlockIo.h>
+#include <Protocol/BlockIo2.h>
 #include <Protocol/ComponentName.h>
 #include <Protocol/DriverBinding.h>
 
-#include <IndustryStandard/Virtio.h>
+#include <IndustryStandard/VirtioBlk.h>
 
 
 #define VBLK_SIG SIGNATURE_32 ('V', 'B', 'L', 'K')
 
+//
+// Upper limit on the number of requests we keep in flight on the virtqueue.
+//
+#define VBLK_MAX_SLOTS 256
+
+//
+// Polling period of the used ring while requests are in flight, in 100ns
+// units.
+//
+#define VBLK_POLL_PERIOD EFI_TIMER_PERIOD_MILLISECONDS (1)
+
+//
+// The parts of an in-flight request that the host accesses, apart from the
+// data buffer. One such structure exists per request slot; all of them are
+// allocated and mapped together, as a common buffer, when the device is
+// initialized. The indirect descriptor table is used only if
+// VIRTIO_F_RING_INDIRECT_DESC has been negotiated.
+//
+typedef struct {
+  VRING_DESC     Indirect[3];
+  VIRTIO_BLK_REQ Request;
+  UINT8          HostStatus;
+  UINT8          Reserved[15];
+} VBLK_SHARED_SLOT;
+
+//
+// Tracks a single read / write / flush request from submission to completion.
+// Token is NULL for blocking requests, which live on the stack of
+// SynchronousRequest(); non-blocking requests are allocated from pool and
+// freed upon completion.
+//
+#define VBLK_REQ_SIG SIGNATURE_32 ('V', 'B', 'R', 'Q')
+
+typedef struct {
+  UINT32               Signature;
+  LIST_ENTRY           Link;           // on VBLK_DEV.PendingList until a
+                                       // slot is assigned
+  EFI_BLOCK_IO2_TOKEN  *Token;
+  EFI_LBA              Lba;
+  UINTN                BufferSize;
+  VOID                 *Buffer;
+  BOOLEAN              RequestIsWrite;
+  VOID                 *BufferMapping;
+  BOOLEAN              Done;
+  EFI_STATUS           Status;
+} VBLK_REQUEST;
+
+#define VBLK_REQUEST_FROM_LINK(LinkPointer) \
+        CR (LinkPointer, VBLK_REQUEST, Link, VBLK_REQ_SIG)
+
 typedef struct {
   //
   // Parts of this structure are initialized / torn down in various functions
@@ -42,11 +93,26 @@ typedef struct {
   EFI_BLOCK_IO_PROTOCOL  BlockIo;              // VirtioBlkInit       1
   EFI_BLOCK_IO_MEDIA     BlockIoMedia;         // VirtioBlkInit       1
   VOID                   *RingMap;             // VirtioRingMap       2
+  EFI_BLOCK_IO2_PROTOCOL BlockIo2;             // VirtioBlkInit       1
+  BOOLEAN                Indirect;             // VirtioBlkInit       1
+  UINT16                 SlotCount;            // VirtioBlkInitSlots  2
+  VBLK_SHARED_SLOT       *Shared;              // VirtioBlkInitSlots  2
+  EFI_PHYSICAL_ADDRESS   SharedDeviceAddress;  // VirtioBlkInitSlots  2
+  VOID                   *SharedMap;           // VirtioBlkInitSlots  2
+  VBLK_REQUEST           **Slot;               // VirtioBlkInitSlots  2
+  UINT16                 *FreeSlot;            // VirtioBlkInitSlots  2
+  UINT16                 FreeSlotCount;        // VirtioBlkInitSlots  2
+  UINT16                 LastUsedIdx;          // VirtioBlkInitSlots  2
+  LIST_ENTRY             PendingList;          // VirtioBlkInitSlots  2
+  EFI_EVENT              PollTimer;            // DriverBindingStart  0
 } VBLK_DEV;
 
 #define VIRTIO_BLK_FROM_BLOCK_IO(BlockIoPointer) \
         CR (BlockIoPointer, VBLK_DEV, BlockIo, VBLK_SIG)
 
+#define VIRTIO_BLK_FROM_BLOCK_IO2(BlockIo2Pointer) \
+        CR (BlockIo2Pointer, VBLK_DEV, BlockIo2, VBLK_SIG)
+
 
 /**
 
@@ -259,6 +325,86 @@ VirtioBlkFlushBlocks (
   );
 
 
+//
+// UEFI Spec 2.7, 13.10 Block I/O 2 Protocol
+//
+EFI_STATUS
+EFIAPI
+VirtioBlkResetEx (
+  IN EFI_BLOCK_IO2_PROTOCOL *This,
+  IN BOOLEAN                ExtendedVerification
+  );
+
+
+/**
+
+  ReadBlocksEx() operation for virtio-blk.
+
+  See UEFI Spec 2.7, 13.10 Block I/O 2 Protocol,
+  EFI_BLOCK_IO2_PROTOCOL.ReadBlocksEx().
+
+  If Token is NULL, or Token->Event is NULL, the request is executed in
+  blocking mode, like ReadBlocks(). Otherwise the request is queued to the
+  virtqueue, and Token->Event is signaled when the host completes it.
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioBlkReadBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  OUT    VOID                   *Buffer
+  );
+
+
+/**
+
+  WriteBlocksEx() operation for virtio-blk.
+
+  See UEFI Spec 2.7, 13.10 Block I/O 2 Protocol,
+  EFI_BLOCK_IO2_PROTOCOL.WriteBlocksEx().
+
+  Blocking and non-blocking modes are selected as in VirtioBlkReadBlocksEx().
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioBlkWriteBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  IN     VOID                   *Buffer
+  );
+
+
+/**
+
+  FlushBlocksEx() operation for virtio-blk.
+
+  See UEFI Spec 2.7, 13.10 Block I/O 2 Protocol,
+  EFI_BLOCK_IO2_PROTOCOL.FlushBlocksEx().
+
+  The flush request is submitted to the host only after all requests queued
+  before it have completed. Without write-caching, we do nothing, successfully,
+  as in VirtioBlkFlushBlocks().
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioBlkFlushBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token
+  );
+
+
 //
 // The purpose of the following scaffolding (EFI_COMPONENT_NAME_PROTOCOL and
 // EFI_COMPONENT_NAME2_PROTOCOL implementation) is to format the driver's name
@@ -86,9 +86,12 @@ VirtioNetGetStatus (
   }
 
   //
-  // update link status
+  // Update link status. Reading the device configuration is expensive under
+  // virtualization; skip it when the caller only recycles transmit buffers,
+  // such as the network stack does in a loop, buffer by buffer.
   //
-  if (Dev->Snm.MediaPresentSupported) {
+  if (Dev->Snm.MediaPresentSupported &&
+      (InterruptStatus != NULL || TxBuf == NULL)) {
     UINT16 LinkStatus;
 
     Status = VIRTIO_CFG_READ (Dev, LinkStatus, &LinkStatus);
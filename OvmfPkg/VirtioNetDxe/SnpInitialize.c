@@ -218,9 +218,10 @@ VirtioNetInitTx (
 
   //
   // In VirtIo 1.0, the NumBuffers field is mandatory. In 0.9.5, it depends on
-  // VIRTIO_NET_F_MRG_RXBUF, which we never negotiate.
+  // VIRTIO_NET_F_MRG_RXBUF.
   //
-  TxSharedReqSize = (Dev->VirtIo->Revision < VIRTIO_SPEC_REVISION (1, 0, 0)) ?
+  TxSharedReqSize = (Dev->VirtIo->Revision < VIRTIO_SPEC_REVISION (1, 0, 0) &&
+                     !Dev->RxMergeable) ?
                     sizeof (Dev->TxSharedReq->V0_9_5) :
                     sizeof *Dev->TxSharedReq;
 
@@ -299,7 +300,8 @@ FreeTxFreeStack:
     packet data into,
   - select polling over RX interrupt,
   - fully populate the RX queue with a static pattern of virtio descriptor
-    chains.
+    chains (two descriptors per packet), or, with VIRTIO_NET_F_MRG_RXBUF, of
+    single descriptors that receive both the header and the packet data.
 
   @param[in,out] Dev       The VNET_DEV driver instance about to enter the
                            EfiSimpleNetworkInitialized state.
@@ -330,26 +332,35 @@ VirtioNetInitRx (
 
   //
   // In VirtIo 1.0, the NumBuffers field is mandatory. In 0.9.5, it depends on
-  // VIRTIO_NET_F_MRG_RXBUF, which we never negotiate.
+  // VIRTIO_NET_F_MRG_RXBUF.
   //
-  VirtioNetReqSize = (Dev->VirtIo->Revision < VIRTIO_SPEC_REVISION (1, 0, 0)) ?
+  VirtioNetReqSize = (Dev->VirtIo->Revision < VIRTIO_SPEC_REVISION (1, 0, 0) &&
+                      !Dev->RxMergeable) ?
                      sizeof (VIRTIO_NET_REQ) :
                      sizeof (VIRTIO_1_0_NET_REQ);
 
   //
-  // For each incoming packet we must supply two descriptors:
-  // - the recipient for the virtio-net request header, plus
-  // - the recipient for the network data (which consists of Ethernet header
-  //   and Ethernet payload).
+  // For each incoming packet we must supply room for:
+  // - the virtio-net request header, plus
+  // - the network data (which consists of Ethernet header and Ethernet
+  //   payload).
+  //
+  // Without VIRTIO_NET_F_MRG_RXBUF, these are two separate descriptors. With
+  // VIRTIO_NET_F_MRG_RXBUF, the header is placed at the start of the buffer,
+  // hence a single descriptor suffices. The buffer is large enough for any
+  // packet, but VirtioNetReceive() still accepts packets that the host merges
+  // from multiple buffers.
   //
   RxBufSize = VirtioNetReqSize +
               (Dev->Snm.MediaHeaderSize + Dev->Snm.MaxPacketSize);
 
   //
-  // Limit the number of pending RX packets if the queue is big. The division
-  // by two is due to the above "two descriptors per packet" trait.
+  // Limit the number of pending RX packets if the queue is big.
   //
-  RxAlwaysPending = (UINT16) MIN (Dev->RxRing.QueueSize / 2, VNET_MAX_PENDING);
+  RxAlwaysPending = (UINT16) MIN (
+                      Dev->RxRing.QueueSize / (Dev->RxMergeable ? 1 : 2),
+                      VNET_MAX_PENDING
+                      );
 
   //
   // The RxBuf is shared between guest and hypervisor, use
@@ -399,8 +410,9 @@ VirtioNetInitRx (
   *Dev->RxRing.Avail.Flags = (UINT16) VRING_AVAIL_F_NO_INTERRUPT;
 
   //
-  // now set up a separate, two-part descriptor chain for each RX packet, and
-  // link each chain into (from) the available ring as well
+  // now set up a separate, two-part descriptor chain (or a single descriptor,
+  // for mergeable buffers) for each RX packet, and link each chain into (from)
+  // the available ring as well
   //
   DescIdx = 0;
   RxBufDeviceAddress = Dev->RxBufDeviceBase;
@@ -414,6 +426,14 @@ VirtioNetInitRx (
     //
     // virtio-0.9.5, 2.4.1.1 Placing Buffers into the Descriptor Table
     //
+    if (Dev->RxMergeable) {
+      Dev->RxRing.Desc[DescIdx].Addr  = RxBufDeviceAddress;
+      Dev->RxRing.Desc[DescIdx].Len   = (UINT32) RxBufSize;
+      Dev->RxRing.Desc[DescIdx].Flags = VRING_DESC_F_WRITE;
+      RxBufDeviceAddress += Dev->RxRing.Desc[DescIdx++].Len;
+      continue;
+    }
+
     Dev->RxRing.Desc[DescIdx].Addr  = RxBufDeviceAddress;
     Dev->RxRing.Desc[DescIdx].Len   = (UINT32) VirtioNetReqSize;
     Dev->RxRing.Desc[DescIdx].Flags = VRING_DESC_F_WRITE | VRING_DESC_F_NEXT;
@@ -562,8 +582,15 @@ VirtioNetInitialize (
   ASSERT (Dev->Snm.MediaPresentSupported ==
     !!(Features & VIRTIO_NET_F_STATUS));
 
-  Features &= VIRTIO_NET_F_MAC | VIRTIO_NET_F_STATUS | VIRTIO_F_VERSION_1 |
-              VIRTIO_F_IOMMU_PLATFORM;
+  //
+  // VIRTIO_NET_F_CSUM and VIRTIO_NET_F_GUEST_CSUM are not negotiated: the
+  // Simple Network Protocol has no means to tell the network stack to skip
+  // checksum calculation or verification, so offloading would only move
+  // checksum work from the host into this driver.
+  //
+  Features &= VIRTIO_NET_F_MAC | VIRTIO_NET_F_STATUS | VIRTIO_NET_F_MRG_RXBUF |
+              VIRTIO_F_VERSION_1 | VIRTIO_F_IOMMU_PLATFORM;
+  Dev->RxMergeable = (BOOLEAN) ((Features & VIRTIO_NET_F_MRG_RXBUF) != 0);
 
   //
   // In virtio-1.0, feature negotiation is expected to complete before queue
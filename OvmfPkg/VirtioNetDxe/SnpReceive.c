@@ -21,6 +21,69 @@
 
 #include "VirtioNet.h"
 
+/**
+  Locate the packet data that the host has placed in one receive buffer.
+
+  @param[in]  Dev      The VNET_DEV driver instance.
+  @param[in]  UsedIdx  The free-running Used Ring index of the buffer.
+  @param[in]  IsFirst  Whether the buffer starts the packet. With mergeable
+                       receive buffers, only the first buffer of a packet
+                       carries the virtio-net request header.
+  @param[out] DescIdx  The index of the head descriptor of the buffer.
+  @param[out] Data     The packet data in the buffer.
+  @param[out] DataLen  The number of packet data bytes in the buffer.
+**/
+
+STATIC
+VOID
+VirtioNetRxFragment (
+  IN  VNET_DEV *Dev,
+  IN  UINT16   UsedIdx,
+  IN  BOOLEAN  IsFirst,
+  OUT UINT16   *DescIdx,
+  OUT UINT8    **Data,
+  OUT UINT32   *DataLen
+  )
+{
+  UINT16               UsedElemIdx;
+  UINT32               RxLen;
+  EFI_PHYSICAL_ADDRESS DataAddress;
+
+  UsedElemIdx = UsedIdx % Dev->RxRing.QueueSize;
+  *DescIdx = (UINT16) Dev->RxRing.Used.UsedElem[UsedElemIdx].Id;
+  RxLen    = Dev->RxRing.Used.UsedElem[UsedElemIdx].Len;
+
+  if (Dev->RxMergeable) {
+    //
+    // the host must not have filled in more data than requested
+    //
+    ASSERT (RxLen <= Dev->RxRing.Desc[*DescIdx].Len);
+    DataAddress = Dev->RxRing.Desc[*DescIdx].Addr;
+    if (IsFirst) {
+      //
+      // the virtio-net request header must be complete; we skip it
+      //
+      ASSERT (RxLen >= sizeof (VIRTIO_1_0_NET_REQ));
+      RxLen       -= sizeof (VIRTIO_1_0_NET_REQ);
+      DataAddress += sizeof (VIRTIO_1_0_NET_REQ);
+    }
+  } else {
+    //
+    // the virtio-net request header must be complete; we skip it
+    //
+    ASSERT (RxLen >= Dev->RxRing.Desc[*DescIdx].Len);
+    RxLen -= Dev->RxRing.Desc[*DescIdx].Len;
+    //
+    // the host must not have filled in more data than requested
+    //
+    ASSERT (RxLen <= Dev->RxRing.Desc[*DescIdx + 1].Len);
+    DataAddress = Dev->RxRing.Desc[*DescIdx + 1].Addr;
+  }
+
+  *Data    = Dev->RxBuf + (UINTN)(DataAddress - Dev->RxBufDeviceBase);
+  *DataLen = RxLen;
+}
+
 /**
   Receives a packet from a network interface.
 
@@ -71,18 +134,21 @@ VirtioNetReceive (
   OUT UINT16                     *Protocol   OPTIONAL
   )
 {
-  VNET_DEV   *Dev;
-  EFI_TPL    OldTpl;
-  EFI_STATUS Status;
-  UINT16     RxCurUsed;
-  UINT16     UsedElemIdx;
-  UINT32     DescIdx;
-  UINT32     RxLen;
-  UINTN      OrigBufferSize;
-  UINT8      *RxPtr;
-  UINT16     AvailIdx;
-  EFI_STATUS NotifyStatus;
-  UINTN      RxBufOffset;
+  VNET_DEV           *Dev;
+  EFI_TPL            OldTpl;
+  EFI_STATUS         Status;
+  UINT16             RxCurUsed;
+  UINT16             UsedElemIdx;
+  UINT16             DescIdx;
+  UINT16             NumBuffers;
+  VIRTIO_1_0_NET_REQ *RxHdr;
+  UINT16             BufIdx;
+  UINT32             FragLen;
+  UINT32             RxLen;
+  UINTN              OrigBufferSize;
+  UINT8              *RxPtr;
+  UINT16             AvailIdx;
+  EFI_STATUS         NotifyStatus;
 
   if (This == NULL || BufferSize == NULL || Buffer == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -113,19 +179,33 @@ VirtioNetReceive (
     goto Exit;
   }
 
-  UsedElemIdx = Dev->RxLastUsed % Dev->RxRing.QueueSize;
-  DescIdx = Dev->RxRing.Used.UsedElem[UsedElemIdx].Id;
-  RxLen   = Dev->RxRing.Used.UsedElem[UsedElemIdx].Len;
-
   //
-  // the virtio-net request header must be complete; we skip it
+  // With mergeable receive buffers, the packet may span several buffers, as
+  // reported in the request header of the first one. All of them must have
+  // arrived.
   //
-  ASSERT (RxLen >= Dev->RxRing.Desc[DescIdx].Len);
-  RxLen -= Dev->RxRing.Desc[DescIdx].Len;
-  //
-  // the host must not have filled in more data than requested
-  //
-  ASSERT (RxLen <= Dev->RxRing.Desc[DescIdx + 1].Len);
+  NumBuffers = 1;
+  if (Dev->RxMergeable) {
+    VirtioNetRxFragment (Dev, Dev->RxLastUsed, TRUE, &DescIdx, &RxPtr,
+      &FragLen);
+    RxHdr = (VIRTIO_1_0_NET_REQ *) (RxPtr - sizeof *RxHdr);
+    NumBuffers = RxHdr->NumBuffers;
+    ASSERT (NumBuffers > 0);
+    if (NumBuffers == 0) {
+      NumBuffers = 1; // recycle the bogus buffer below
+    }
+    if ((UINT16) (RxCurUsed - Dev->RxLastUsed) < NumBuffers) {
+      Status = EFI_NOT_READY;
+      goto Exit;
+    }
+  }
+
+  RxLen = 0;
+  for (BufIdx = 0; BufIdx < NumBuffers; ++BufIdx) {
+    VirtioNetRxFragment (Dev, (UINT16) (Dev->RxLastUsed + BufIdx), BufIdx == 0,
+      &DescIdx, &RxPtr, &FragLen);
+    RxLen += FragLen;
+  }
 
   OrigBufferSize = *BufferSize;
   *BufferSize = RxLen;
@@ -144,11 +224,15 @@ VirtioNetReceive (
     *HeaderSize = Dev->Snm.MediaHeaderSize;
   }
 
-  RxBufOffset = (UINTN)(Dev->RxRing.Desc[DescIdx + 1].Addr -
-                        Dev->RxBufDeviceBase);
-  RxPtr = Dev->RxBuf + RxBufOffset;
-  CopyMem (Buffer, RxPtr, RxLen);
+  RxLen = 0;
+  for (BufIdx = 0; BufIdx < NumBuffers; ++BufIdx) {
+    VirtioNetRxFragment (Dev, (UINT16) (Dev->RxLastUsed + BufIdx), BufIdx == 0,
+      &DescIdx, &RxPtr, &FragLen);
+    CopyMem ((UINT8 *) Buffer + RxLen, RxPtr, FragLen);
+    RxLen += FragLen;
+  }
 
+  RxPtr = Buffer;
   if (DestAddr != NULL) {
     CopyMem (DestAddr, RxPtr, SIZE_OF_VNET (Mac));
   }
@@ -167,22 +251,31 @@ VirtioNetReceive (
   Status = EFI_SUCCESS;
 
 RecycleDesc:
-  ++Dev->RxLastUsed;
-
   //
   // virtio-0.9.5, 2.4.1 Supplying Buffers to The Device
   //
   AvailIdx = *Dev->RxRing.Avail.Idx;
-  Dev->RxRing.Avail.Ring[AvailIdx++ % Dev->RxRing.QueueSize] =
-    (UINT16) DescIdx;
+  for (BufIdx = 0; BufIdx < NumBuffers; ++BufIdx) {
+    UsedElemIdx = Dev->RxLastUsed++ % Dev->RxRing.QueueSize;
+    DescIdx = (UINT16) Dev->RxRing.Used.UsedElem[UsedElemIdx].Id;
+    Dev->RxRing.Avail.Ring[AvailIdx++ % Dev->RxRing.QueueSize] = DescIdx;
+  }
 
   MemoryFence ();
   *Dev->RxRing.Avail.Idx = AvailIdx;
 
+  //
+  // virtio-0.9.5, 2.4.1.4 Notifying the Device -- the host sets
+  // VRING_USED_F_NO_NOTIFY while it does not need the notification (for
+  // example because it still has receive buffers), which saves us an exit to
+  // the hypervisor per packet.
+  //
   MemoryFence ();
-  NotifyStatus = Dev->VirtIo->SetQueueNotify (Dev->VirtIo, VIRTIO_NET_Q_RX);
-  if (!EFI_ERROR (Status)) { // earlier error takes precedence
-    Status = NotifyStatus;
+  if ((*Dev->RxRing.Used.Flags & VRING_USED_F_NO_NOTIFY) == 0) {
+    NotifyStatus = Dev->VirtIo->SetQueueNotify (Dev->VirtIo, VIRTIO_NET_Q_RX);
+    if (!EFI_ERROR (Status)) { // earlier error takes precedence
+      Status = NotifyStatus;
+    }
   }
 
 Exit:
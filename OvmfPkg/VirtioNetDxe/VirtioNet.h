@@ -86,6 +86,7 @@ typedef struct {
   VRING                       RxRing;            // VirtioNetInitRing
   VOID                        *RxRingMap;        // VirtioRingMap and
                                                  // VirtioNetInitRing
+  BOOLEAN                     RxMergeable;       // VirtioNetInitialize
   UINT8                       *RxBuf;            // VirtioNetInitRx
   UINT16                      RxLastUsed;        // VirtioNetInitRx
   UINTN                       RxBufNrPages;      // VirtioNetInitRx
@@ -0,0 +1,401 @@
+/** @file
+  Image verification benchmark application.
+
+  Measures the time LoadImage() takes to verify the image of this application
+  with the current forbidden database (dbx), then with a dbx extended by a
+  synthetic list of SHA-256 signatures, so that the cost of the dbx size on
+  image verification can be compared between DxeImageVerificationLib versions.
+
+  The synthetic signatures are appended to dbx without authentication, which
+  the variable driver only accepts in Setup Mode or in Custom Mode with a
+  physically present user. Secure Boot must be enabled for the images to be
+  verified. The original dbx is written back before the application exits.
+
+  Copyright (c) 2018, Intel Corporation. All rights reserved.<BR>
+  This program and the accompanying materials
+  are licensed and made available under the terms and conditions of the BSD License
+  which accompanies this distribution.  The full text of the license may be found at
+  http://opensource.org/licenses/bsd-license.php
+
+  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#include <PiDxe.h>
+#include <Guid/GlobalVariable.h>
+#include <Guid/ImageAuthentication.h>
+#include <Protocol/LoadedImage.h>
+#include <Protocol/ShellParameters.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DevicePathLib.h>
+#include <Library/DxeServicesLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/PrintLib.h>
+#include <Library/TimerLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiRuntimeServicesTableLib.h>
+#include <Library/UefiLib.h>
+#include <Library/UefiApplicationEntryPoint.h>
+
+//
+// Number of synthetic dbx signatures when none is given on the command line.
+//
+#define IMAGE_BENCH_DEFAULT_COUNT   1000
+
+//
+// Minimum time spent loading the image after the first load, in nanoseconds.
+//
+#define IMAGE_BENCH_MIN_TIME        1000000000ULL
+
+#define IMAGE_BENCH_SHA256_SIZE     32
+
+#define IMAGE_BENCH_DBX_ATTRIBUTES  (EFI_VARIABLE_NON_VOLATILE | \
+                                     EFI_VARIABLE_BOOTSERVICE_ACCESS | \
+                                     EFI_VARIABLE_RUNTIME_ACCESS | \
+                                     EFI_VARIABLE_TIME_BASED_AUTHENTICATED_WRITE_ACCESS)
+
+/**
+  Return the time elapsed between two performance counter values.
+
+  @param[in]  Start  The performance counter value at the start.
+  @param[in]  End    The performance counter value at the end.
+
+  @return The elapsed time in nanoseconds.
+
+**/
+UINT64
+GetElapsedTime (
+  IN UINT64  Start,
+  IN UINT64  End
+  )
+{
+  UINT64  CounterStart;
+  UINT64  CounterEnd;
+  UINT64  Ticks;
+
+  GetPerformanceCounterProperties (&CounterStart, &CounterEnd);
+  if (CounterEnd < CounterStart) {
+    //
+    // Counter counts down, swap the roles of Start and End.
+    //
+    Ticks = (Start >= End) ? (Start - End) : (Start + (CounterStart - End) + 1 - CounterEnd);
+  } else {
+    Ticks = (End >= Start) ? (End - Start) : (End + (CounterEnd - Start) + 1 - CounterStart);
+  }
+  return GetTimeInNanoSecond (Ticks);
+}
+
+/**
+  Write dbx with an EFI_VARIABLE_AUTHENTICATION_2 descriptor which has no
+  certificate data, as accepted in Setup Mode and in Custom Mode.
+
+  @param[in]  Attributes   EFI_VARIABLE_APPEND_WRITE or 0.
+  @param[in]  Data         The signature lists to write. Optional.
+  @param[in]  DataSize     The size of Data in bytes, 0 to delete dbx.
+
+  @retval EFI_SUCCESS           dbx was written.
+  @retval EFI_OUT_OF_RESOURCES  The payload could not be allocated.
+  @retval Others                GetTime() or SetVariable() failed.
+
+**/
+EFI_STATUS
+WriteDbx (
+  IN UINT32  Attributes,
+  IN VOID    *Data     OPTIONAL,
+  IN UINTN   DataSize
+  )
+{
+  EFI_STATUS                     Status;
+  EFI_VARIABLE_AUTHENTICATION_2  *Descriptor;
+  UINTN                          DescriptorSize;
+  EFI_TIME                       Time;
+
+  DescriptorSize = OFFSET_OF (EFI_VARIABLE_AUTHENTICATION_2, AuthInfo) + OFFSET_OF (WIN_CERTIFICATE_UEFI_GUID, CertData);
+  Descriptor     = AllocateZeroPool (DescriptorSize + DataSize);
+  if (Descriptor == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  ZeroMem (&Time, sizeof (EFI_TIME));
+  Status = gRT->GetTime (&Time, NULL);
+  if (EFI_ERROR (Status)) {
+    FreePool (Descriptor);
+    return Status;
+  }
+  Time.Pad1       = 0;
+  Time.Nanosecond = 0;
+  Time.TimeZone   = 0;
+  Time.Daylight   = 0;
+  Time.Pad2       = 0;
+  CopyMem (&Descriptor->TimeStamp, &Time, sizeof (EFI_TIME));
+
+  Descriptor->AuthInfo.Hdr.dwLength         = OFFSET_OF (WIN_CERTIFICATE_UEFI_GUID, CertData);
+  Descriptor->AuthInfo.Hdr.wRevision        = 0x0200;
+  Descriptor->AuthInfo.Hdr.wCertificateType = WIN_CERT_TYPE_EFI_GUID;
+  CopyGuid (&Descriptor->AuthInfo.CertType, &gEfiCertPkcs7Guid);
+  if (DataSize != 0) {
+    CopyMem ((UINT8 *) Descriptor + DescriptorSize, Data, DataSize);
+  }
+
+  Status = gRT->SetVariable (
+                  EFI_IMAGE_SECURITY_DATABASE1,
+                  &gEfiImageSecurityDatabaseGuid,
+                  IMAGE_BENCH_DBX_ATTRIBUTES | Attributes,
+                  DescriptorSize + DataSize,
+                  Descriptor
+                  );
+  FreePool (Descriptor);
+  return Status;
+}
+
+/**
+  Create a signature list of pseudo-random SHA-256 hashes. None of them is
+  the hash of a real image.
+
+  @param[in]   Count      The number of signatures.
+  @param[out]  ListSize   The size of the signature list in bytes.
+
+  @return The signature list, or NULL on failure.
+
+**/
+EFI_SIGNATURE_LIST *
+CreateSyntheticSignatureList (
+  IN  UINTN  Count,
+  OUT UINTN  *ListSize
+  )
+{
+  EFI_SIGNATURE_LIST  *List;
+  EFI_SIGNATURE_DATA  *Signature;
+  UINTN               SignatureSize;
+  UINTN               Index;
+  UINTN               Byte;
+  UINT32              Seed;
+
+  SignatureSize = OFFSET_OF (EFI_SIGNATURE_DATA, SignatureData) + IMAGE_BENCH_SHA256_SIZE;
+  if (Count > (MAX_UINT32 - sizeof (EFI_SIGNATURE_LIST)) / SignatureSize) {
+    return NULL;
+  }
+
+  *ListSize = sizeof (EFI_SIGNATURE_LIST) + Count * SignatureSize;
+  List      = AllocateZeroPool (*ListSize);
+  if (List == NULL) {
+    return NULL;
+  }
+
+  CopyGuid (&List->SignatureType, &gEfiCertSha256Guid);
+  List->SignatureListSize   = (UINT32) *ListSize;
+  List->SignatureHeaderSize = 0;
+  List->SignatureSize       = (UINT32) SignatureSize;
+
+  Seed      = 0x12345678;
+  Signature = (EFI_SIGNATURE_DATA *) (List + 1);
+  for (Index = 0; Index < Count; Index++) {
+    CopyGuid (&Signature->SignatureOwner, &gEfiCallerIdGuid);
+    for (Byte = 0; Byte < IMAGE_BENCH_SHA256_SIZE; Byte++) {
+      //
+      // xorshift32
+      //
+      Seed ^= Seed << 13;
+      Seed ^= Seed >> 17;
+      Seed ^= Seed << 5;
+      Signature->SignatureData[Byte] = (UINT8) Seed;
+    }
+    Signature = (EFI_SIGNATURE_DATA *) ((UINT8 *) Signature + SignatureSize);
+  }
+
+  return List;
+}
+
+/**
+  Load the image from memory repeatedly and print the time of the first load
+  and the average time of the following ones.
+
+  @param[in]  Label       The description of the dbx in use.
+  @param[in]  FilePath    The device path of the image file.
+  @param[in]  Image       The content of the image file.
+  @param[in]  ImageSize   The size of Image in bytes.
+
+  @retval EFI_SUCCESS   The image was loaded and unloaded.
+  @retval Others        LoadImage() failed.
+
+**/
+EFI_STATUS
+MeasureLoadImage (
+  IN CHAR16                    *Label,
+  IN EFI_DEVICE_PATH_PROTOCOL  *FilePath,
+  IN VOID                      *Image,
+  IN UINTN                     ImageSize
+  )
+{
+  EFI_STATUS  Status;
+  EFI_HANDLE  Handle;
+  UINT64      Start;
+  UINT64      Elapsed;
+  UINT64      First;
+  UINT64      Loads;
+
+  First   = 0;
+  Loads   = 0;
+  Elapsed = 0;
+  Start   = GetPerformanceCounter ();
+  do {
+    Handle = NULL;
+    Status = gBS->LoadImage (FALSE, gImageHandle, FilePath, Image, ImageSize, &Handle);
+    if (Handle != NULL) {
+      gBS->UnloadImage (Handle);
+    }
+    if (EFI_ERROR (Status)) {
+      Print (L"%-28s  LoadImage failed - %r\n", Label, Status);
+      return Status;
+    }
+
+    if (Loads == 0) {
+      //
+      // The first load after dbx has been written includes reading and indexing it.
+      //
+      First = GetElapsedTime (Start, GetPerformanceCounter ());
+      Start = GetPerformanceCounter ();
+    } else {
+      Elapsed = GetElapsedTime (Start, GetPerformanceCounter ());
+    }
+    Loads++;
+  } while (Elapsed < IMAGE_BENCH_MIN_TIME);
+
+  Print (
+    L"%-28s  first %8Lu us, then %8Lu us per image\n",
+    Label,
+    DivU64x32 (First, 1000),
+    DivU64x64Remainder (Elapsed, MultU64x32 (Loads - 1, 1000), NULL)
+    );
+  return EFI_SUCCESS;
+}
+
+/**
+  The user Entry Point for Application. The user code starts with this function
+  as the real entry point for the application.
+
+  The only argument is the number of synthetic dbx signatures.
+
+  @param[in] ImageHandle    The firmware allocated handle for the EFI image.
+  @param[in] SystemTable    A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS             The entry point is executed successfully.
+  @retval EFI_UNSUPPORTED         No performance counter is available, or
+                                  Secure Boot is not enabled.
+  @retval EFI_OUT_OF_RESOURCES    The buffers could not be allocated.
+  @retval Others                  dbx could not be written, or the image could
+                                  not be loaded.
+
+**/
+EFI_STATUS
+EFIAPI
+UefiMain (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS                     Status;
+  EFI_STATUS                     RestoreStatus;
+  EFI_LOADED_IMAGE_PROTOCOL      *LoadedImage;
+  EFI_SHELL_PARAMETERS_PROTOCOL  *ShellParameters;
+  EFI_DEVICE_PATH_PROTOCOL       *FilePath;
+  UINT8                          *SecureBoot;
+  VOID                           *Image;
+  UINTN                          ImageSize;
+  UINT32                         AuthenticationStatus;
+  VOID                           *Dbx;
+  UINTN                          DbxSize;
+  EFI_SIGNATURE_LIST             *List;
+  UINTN                          ListSize;
+  UINTN                          Count;
+  CHAR16                         Label[32];
+
+  if (GetPerformanceCounterProperties (NULL, NULL) == 0) {
+    Print (L"ImageVerificationBench: no performance counter is available.\n");
+    return EFI_UNSUPPORTED;
+  }
+
+  GetEfiGlobalVariable2 (EFI_SECURE_BOOT_MODE_NAME, (VOID **) &SecureBoot, NULL);
+  if ((SecureBoot == NULL) || (*SecureBoot != SECURE_BOOT_MODE_ENABLE)) {
+    Print (L"ImageVerificationBench: Secure Boot is not enabled, images are not verified.\n");
+    if (SecureBoot != NULL) {
+      FreePool (SecureBoot);
+    }
+    return EFI_UNSUPPORTED;
+  }
+  FreePool (SecureBoot);
+
+  Count  = IMAGE_BENCH_DEFAULT_COUNT;
+  Status = gBS->HandleProtocol (ImageHandle, &gEfiShellParametersProtocolGuid, (VOID **) &ShellParameters);
+  if (!EFI_ERROR (Status) && (ShellParameters->Argc > 1)) {
+    Count = StrDecimalToUintn (ShellParameters->Argv[1]);
+  }
+
+  //
+  // Load this application again from a copy of its file, so that the same
+  // image goes through the same verification on each load.
+  //
+  Status = gBS->HandleProtocol (ImageHandle, &gEfiLoadedImageProtocolGuid, (VOID **) &LoadedImage);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+  FilePath = AppendDevicePath (DevicePathFromHandle (LoadedImage->DeviceHandle), LoadedImage->FilePath);
+  if (FilePath == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  Image = GetFileBufferByFilePath (FALSE, FilePath, &ImageSize, &AuthenticationStatus);
+  if (Image == NULL) {
+    Print (L"ImageVerificationBench: cannot read the image file.\n");
+    FreePool (FilePath);
+    return EFI_NOT_FOUND;
+  }
+
+  Dbx = NULL;
+  GetVariable2 (EFI_IMAGE_SECURITY_DATABASE1, &gEfiImageSecurityDatabaseGuid, &Dbx, &DbxSize);
+  if (Dbx == NULL) {
+    DbxSize = 0;
+  }
+
+  Print (L"ImageVerificationBench: %u byte image, %u byte dbx\n", ImageSize, DbxSize);
+  Status = MeasureLoadImage (L"current dbx", FilePath, Image, ImageSize);
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  List = CreateSyntheticSignatureList (Count, &ListSize);
+  if (List == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Done;
+  }
+  Status = WriteDbx (EFI_VARIABLE_APPEND_WRITE, List, ListSize);
+  FreePool (List);
+  if (EFI_ERROR (Status)) {
+    Print (L"ImageVerificationBench: cannot append to dbx - %r.\n", Status);
+    Print (L"Use Custom Mode, and a PcdMaxAuthVariableSize that fits the synthetic signatures.\n");
+    goto Done;
+  }
+
+  UnicodeSPrint (Label, sizeof (Label), L"dbx + %u SHA-256", Count);
+  Status = MeasureLoadImage (Label, FilePath, Image, ImageSize);
+
+  //
+  // Put the original dbx back.
+  //
+  RestoreStatus = WriteDbx (0, Dbx, DbxSize);
+  if (EFI_ERROR (RestoreStatus)) {
+    Print (L"ImageVerificationBench: cannot restore dbx - %r.\n", RestoreStatus);
+    if (!EFI_ERROR (Status)) {
+      Status = RestoreStatus;
+    }
+  }
+
+Done:
+  if (Dbx != NULL) {
+    FreePool (Dbx);
+  }
+  FreePool (Image);
+  FreePool (FilePath);
+  return Status;
+}
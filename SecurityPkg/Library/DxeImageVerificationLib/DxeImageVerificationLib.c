@@ -42,6 +42,13 @@ UINT8                               *mImageBase       = NULL;
 UINT8                               mImageDigest[MAX_DIGEST_SIZE];
 UINTN                               mImageDigestSize;
 
+//
+// Digests of current PE/COFF image which have been calculated, indexed by hash
+// algorithm type. Bit N of mImageDigestCacheMask is set if mImageDigestCache[N] is valid.
+//
+UINT8                               mImageDigestCache[HASHALG_MAX][MAX_DIGEST_SIZE];
+UINT32                              mImageDigestCacheMask;
+
 //
 // Notify string for authorization UI.
 //
@@ -72,6 +79,15 @@ HASH_TABLE mHash[] = {
   { L"SHA512", 64, &mHashOidValue[32], 9, Sha512GetContextSize, Sha512Init, Sha512Update, Sha512Final}
 };
 
+//
+// Signature types of X.509 certificate hashes and their hash algorithms
+//
+CERT_HASH_TYPE mCertHashType[] = {
+  { &gEfiCertX509Sha256Guid, HASHALG_SHA256 },
+  { &gEfiCertX509Sha384Guid, HASHALG_SHA384 },
+  { &gEfiCertX509Sha512Guid, HASHALG_SHA512 }
+};
+
 EFI_STRING mHashTypeStr;
 
 /**
@@ -272,9 +288,44 @@ GetImageType (
   return IMAGE_UNKNOWN;
 }
 
+/**
+  Feed a part of the image to the hash contexts of all the hash algorithms
+  which are being calculated.
+
+  @param[in]  HashCtx     Hash contexts indexed by hash algorithm type. NULL for
+                          the hash algorithms which are not calculated.
+  @param[in]  HashBase    Pointer to the data to be hashed.
+  @param[in]  HashSize    Size of the data in bytes.
+
+  @retval TRUE            All hash contexts were updated.
+  @retval FALSE           Fail to update a hash context.
+
+**/
+BOOLEAN
+HashPeImageUpdate (
+  IN VOID                   **HashCtx,
+  IN UINT8                  *HashBase,
+  IN UINTN                  HashSize
+  )
+{
+  UINT32                    HashAlg;
+
+  for (HashAlg = 0; HashAlg < HASHALG_MAX; HashAlg++) {
+    if (HashCtx[HashAlg] == NULL) {
+      continue;
+    }
+    if (!mHash[HashAlg].HashUpdate (HashCtx[HashAlg], HashBase, HashSize)) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
 /**
   Calculate hash of Pe/Coff image based on the authenticode image hashing in
-  PE/COFF Specification 8.0 Appendix A
+  PE/COFF Specification 8.0 Appendix A, for several hash algorithms in a single
+  pass over the image. The digests are saved in the digest cache of the current image.
 
   Caution: This function may receive untrusted input.
   PE/COFF image is external input, so this function will validate its data structure
@@ -283,21 +334,22 @@ GetImageType (
   Notes: PE/COFF image has been checked by BasePeCoffLib PeCoffLoaderGetImageInfo() in
   its caller function DxeImageVerificationHandler().
 
-  @param[in]    HashAlg   Hash algorithm type.
+  @param[in]    HashAlgMask   Bit mask of the hash algorithm types, bit N stands
+                              for hash algorithm type N.
 
-  @retval TRUE            Successfully hash image.
-  @retval FALSE           Fail in hash image.
+  @retval TRUE                Successfully hash image.
+  @retval FALSE               Fail in hash image.
 
 **/
 BOOLEAN
-HashPeImage (
-  IN  UINT32              HashAlg
+HashPeImageMultiple (
+  IN  UINT32              HashAlgMask
   )
 {
   BOOLEAN                   Status;
   EFI_IMAGE_SECTION_HEADER  *Section;
-  VOID                      *HashCtx;
-  UINTN                     CtxSize;
+  VOID                      *HashCtx[HASHALG_MAX];
+  UINT32                    HashAlg;
   UINT8                     *HashBase;
   UINTN                     HashSize;
   UINTN                     SumOfBytesHashed;
@@ -307,59 +359,35 @@ HashPeImage (
   UINT32                    CertSize;
   UINT32                    NumberOfRvaAndSizes;
 
-  HashCtx       = NULL;
   SectionHeader = NULL;
   Status        = FALSE;
+  ZeroMem (HashCtx, sizeof (HashCtx));
 
-  if ((HashAlg >= HASHALG_MAX)) {
-    return FALSE;
-  }
-
-  //
-  // Initialize context of hash.
-  //
-  ZeroMem (mImageDigest, MAX_DIGEST_SIZE);
-
-  switch (HashAlg) {
-  case HASHALG_SHA1:
-    mImageDigestSize = SHA1_DIGEST_SIZE;
-    mCertType        = gEfiCertSha1Guid;
-    break;
-
-  case HASHALG_SHA256:
-    mImageDigestSize = SHA256_DIGEST_SIZE;
-    mCertType        = gEfiCertSha256Guid;
-    break;
-
-  case HASHALG_SHA384:
-    mImageDigestSize = SHA384_DIGEST_SIZE;
-    mCertType        = gEfiCertSha384Guid;
-    break;
-
-  case HASHALG_SHA512:
-    mImageDigestSize = SHA512_DIGEST_SIZE;
-    mCertType        = gEfiCertSha512Guid;
-    break;
-
-  default:
+  if ((HashAlgMask == 0) || (HashAlgMask >= (1 << HASHALG_MAX))) {
     return FALSE;
   }
 
-  mHashTypeStr = mHash[HashAlg].Name;
-  CtxSize   = mHash[HashAlg].GetContextSize();
-
-  HashCtx = AllocatePool (CtxSize);
-  if (HashCtx == NULL) {
-    return FALSE;
-  }
+  PERF_INMODULE_BEGIN ("HashPeImage");
 
   // 1.  Load the image header into memory.
 
-  // 2.  Initialize a SHA hash context.
-  Status = mHash[HashAlg].HashInit(HashCtx);
-
-  if (!Status) {
-    goto Done;
+  // 2.  Initialize a SHA hash context for every requested hash algorithm.
+  for (HashAlg = 0; HashAlg < HASHALG_MAX; HashAlg++) {
+    if ((HashAlgMask & (1 << HashAlg)) == 0) {
+      continue;
+    }
+    Status = FALSE;
+    if (mHash[HashAlg].GetContextSize == NULL) {
+      goto Done;
+    }
+    HashCtx[HashAlg] = AllocatePool (mHash[HashAlg].GetContextSize ());
+    if (HashCtx[HashAlg] == NULL) {
+      goto Done;
+    }
+    Status = mHash[HashAlg].HashInit (HashCtx[HashAlg]);
+    if (!Status) {
+      goto Done;
+    }
   }
 
   //
@@ -392,7 +420,7 @@ HashPeImage (
     goto Done;
   }
 
-  Status  = mHash[HashAlg].HashUpdate(HashCtx, HashBase, HashSize);
+  Status  = HashPeImageUpdate (HashCtx, HashBase, HashSize);
   if (!Status) {
     goto Done;
   }
@@ -420,7 +448,7 @@ HashPeImage (
     }
 
     if (HashSize != 0) {
-      Status  = mHash[HashAlg].HashUpdate(HashCtx, HashBase, HashSize);
+      Status  = HashPeImageUpdate (HashCtx, HashBase, HashSize);
       if (!Status) {
         goto Done;
       }
@@ -444,7 +472,7 @@ HashPeImage (
     }
 
     if (HashSize != 0) {
-      Status  = mHash[HashAlg].HashUpdate(HashCtx, HashBase, HashSize);
+      Status  = HashPeImageUpdate (HashCtx, HashBase, HashSize);
       if (!Status) {
         goto Done;
       }
@@ -469,7 +497,7 @@ HashPeImage (
     }
 
     if (HashSize != 0) {
-      Status  = mHash[HashAlg].HashUpdate(HashCtx, HashBase, HashSize);
+      Status  = HashPeImageUpdate (HashCtx, HashBase, HashSize);
       if (!Status) {
         goto Done;
       }
@@ -542,7 +570,7 @@ HashPeImage (
     HashBase  = mImageBase + Section->PointerToRawData;
     HashSize  = (UINTN) Section->SizeOfRawData;
 
-    Status  = mHash[HashAlg].HashUpdate(HashCtx, HashBase, HashSize);
+    Status  = HashPeImageUpdate (HashCtx, HashBase, HashSize);
     if (!Status) {
       goto Done;
     }
@@ -578,7 +606,7 @@ HashPeImage (
     if (mImageSize > CertSize + SumOfBytesHashed) {
       HashSize = (UINTN) (mImageSize - CertSize - SumOfBytesHashed);
 
-      Status  = mHash[HashAlg].HashUpdate(HashCtx, HashBase, HashSize);
+      Status  = HashPeImageUpdate (HashCtx, HashBase, HashSize);
       if (!Status) {
         goto Done;
       }
@@ -588,11 +616,24 @@ HashPeImage (
     }
   }
 
-  Status  = mHash[HashAlg].HashFinal(HashCtx, mImageDigest);
+  for (HashAlg = 0; HashAlg < HASHALG_MAX; HashAlg++) {
+    if (HashCtx[HashAlg] == NULL) {
+      continue;
+    }
+    Status = mHash[HashAlg].HashFinal (HashCtx[HashAlg], mImageDigestCache[HashAlg]);
+    if (!Status) {
+      goto Done;
+    }
+    mImageDigestCacheMask |= (1 << HashAlg);
+  }
 
 Done:
-  if (HashCtx != NULL) {
-    FreePool (HashCtx);
+  PERF_INMODULE_END ("HashPeImage");
+
+  for (HashAlg = 0; HashAlg < HASHALG_MAX; HashAlg++) {
+    if (HashCtx[HashAlg] != NULL) {
+      FreePool (HashCtx[HashAlg]);
+    }
   }
   if (SectionHeader != NULL) {
     FreePool (SectionHeader);
@@ -601,9 +642,78 @@ Done:
 }
 
 /**
-  Recognize the Hash algorithm in PE/COFF Authenticode and calculate hash of
-  Pe/Coff image based on the authenticode image hashing in PE/COFF Specification
-  8.0 Appendix A
+  Calculate hash of Pe/Coff image based on the authenticode image hashing in
+  PE/COFF Specification 8.0 Appendix A
+
+  The image is only hashed if the digest of this hash algorithm is not in the
+  digest cache of the current image yet.
+
+  Caution: This function may receive untrusted input.
+  PE/COFF image is external input, so this function will validate its data structure
+  within this image buffer before use.
+
+  Notes: PE/COFF image has been checked by BasePeCoffLib PeCoffLoaderGetImageInfo() in
+  its caller function DxeImageVerificationHandler().
+
+  @param[in]    HashAlg   Hash algorithm type.
+
+  @retval TRUE            Successfully hash image.
+  @retval FALSE           Fail in hash image.
+
+**/
+BOOLEAN
+HashPeImage (
+  IN  UINT32              HashAlg
+  )
+{
+  if ((HashAlg >= HASHALG_MAX)) {
+    return FALSE;
+  }
+
+  //
+  // Initialize context of hash.
+  //
+  ZeroMem (mImageDigest, MAX_DIGEST_SIZE);
+
+  switch (HashAlg) {
+  case HASHALG_SHA1:
+    mImageDigestSize = SHA1_DIGEST_SIZE;
+    mCertType        = gEfiCertSha1Guid;
+    break;
+
+  case HASHALG_SHA256:
+    mImageDigestSize = SHA256_DIGEST_SIZE;
+    mCertType        = gEfiCertSha256Guid;
+    break;
+
+  case HASHALG_SHA384:
+    mImageDigestSize = SHA384_DIGEST_SIZE;
+    mCertType        = gEfiCertSha384Guid;
+    break;
+
+  case HASHALG_SHA512:
+    mImageDigestSize = SHA512_DIGEST_SIZE;
+    mCertType        = gEfiCertSha512Guid;
+    break;
+
+  default:
+    return FALSE;
+  }
+
+  mHashTypeStr = mHash[HashAlg].Name;
+
+  if ((mImageDigestCacheMask & (1 << HashAlg)) == 0) {
+    if (!HashPeImageMultiple (1 << HashAlg)) {
+      return FALSE;
+    }
+  }
+
+  CopyMem (mImageDigest, mImageDigestCache[HashAlg], mImageDigestSize);
+  return TRUE;
+}
+
+/**
+  Recognize the Hash algorithm in PE/COFF Authenticode.
 
   Caution: This function may receive untrusted input.
   PE/COFF image is external input, so this function will validate its data structure
@@ -612,17 +722,16 @@ Done:
   @param[in]  AuthData            Pointer to the Authenticode Signature retrieved from signed image.
   @param[in]  AuthDataSize        Size of the Authenticode Signature in bytes.
 
-  @retval EFI_UNSUPPORTED             Hash algorithm is not supported.
-  @retval EFI_SUCCESS                 Hash successfully.
+  @return The hash algorithm type, or HASHALG_MAX if the hash algorithm is not supported.
 
 **/
-EFI_STATUS
-HashPeImageByType (
+UINT32
+GetAuthenticodeHashAlg (
   IN UINT8              *AuthData,
   IN UINTN              AuthDataSize
   )
 {
-  UINT8                     Index;
+  UINT32                    Index;
 
   for (Index = 0; Index < HASHALG_MAX; Index++) {
     //
@@ -645,7 +754,7 @@ HashPeImageByType (
     }
 
     if (AuthDataSize < 32 + mHash[Index].OidLength) {
-      return EFI_UNSUPPORTED;
+      return HASHALG_MAX;
     }
 
     if (CompareMem (AuthData + 32, mHash[Index].OidValue, mHash[Index].OidLength) == 0) {
@@ -653,6 +762,34 @@ HashPeImageByType (
     }
   }
 
+  return Index;
+}
+
+/**
+  Recognize the Hash algorithm in PE/COFF Authenticode and calculate hash of
+  Pe/Coff image based on the authenticode image hashing in PE/COFF Specification
+  8.0 Appendix A
+
+  Caution: This function may receive untrusted input.
+  PE/COFF image is external input, so this function will validate its data structure
+  within this image buffer before use.
+
+  @param[in]  AuthData            Pointer to the Authenticode Signature retrieved from signed image.
+  @param[in]  AuthDataSize        Size of the Authenticode Signature in bytes.
+
+  @retval EFI_UNSUPPORTED             Hash algorithm is not supported.
+  @retval EFI_SUCCESS                 Hash successfully.
+
+**/
+EFI_STATUS
+HashPeImageByType (
+  IN UINT8              *AuthData,
+  IN UINTN              AuthDataSize
+  )
+{
+  UINT32                    Index;
+
+  Index = GetAuthenticodeHashAlg (AuthData, AuthDataSize);
   if (Index == HASHALG_MAX) {
     return EFI_UNSUPPORTED;
   }
@@ -824,8 +961,7 @@ AddImageExeInfo (
 
   @param[in]  Certificate       Pointer to X.509 Certificate that is searched for.
   @param[in]  CertSize          Size of X.509 Certificate.
-  @param[in]  SignatureList     Pointer to the Signature List in forbidden database.
-  @param[in]  SignatureListSize Size of Signature List.
+  @param[in]  Database          Pointer to the cached forbidden database.
   @param[out] RevocationTime    Return the time that the certificate was revoked.
 
   @return TRUE   The certificate hash is found in the forbidden database.
@@ -836,33 +972,28 @@ BOOLEAN
 IsCertHashFoundInDatabase (
   IN  UINT8               *Certificate,
   IN  UINTN               CertSize,
-  IN  EFI_SIGNATURE_LIST  *SignatureList,
-  IN  UINTN               SignatureListSize,
+  IN  SIGNATURE_DATABASE  *Database,
   OUT EFI_TIME            *RevocationTime
   )
 {
   BOOLEAN             IsFound;
   BOOLEAN             Status;
-  EFI_SIGNATURE_LIST  *DbxList;
-  UINTN               DbxSize;
   EFI_SIGNATURE_DATA  *CertHash;
-  UINTN               CertHashCount;
+  EFI_SIGNATURE_DATA  *FoundCertHash;
+  UINTN               FoundDigestLength;
   UINTN               Index;
   UINT32              HashAlg;
   VOID                *HashCtx;
   UINT8               CertDigest[MAX_DIGEST_SIZE];
-  UINT8               *DbxCertHash;
-  UINTN               SiglistHeaderSize;
   UINT8               *TBSCert;
   UINTN               TBSCertSize;
 
-  IsFound  = FALSE;
-  DbxList  = SignatureList;
-  DbxSize  = SignatureListSize;
-  HashCtx  = NULL;
-  HashAlg  = HASHALG_MAX;
+  IsFound           = FALSE;
+  HashCtx           = NULL;
+  FoundCertHash     = NULL;
+  FoundDigestLength = 0;
 
-  if ((RevocationTime == NULL) || (DbxList == NULL)) {
+  if ((RevocationTime == NULL) || (Database == NULL) || (Database->IndexCount == 0)) {
     return FALSE;
   }
 
@@ -873,19 +1004,13 @@ IsCertHashFoundInDatabase (
     return FALSE;
   }
 
-  while ((DbxSize > 0) && (SignatureListSize >= DbxList->SignatureListSize)) {
+  for (Index = 0; Index < ARRAY_SIZE (mCertHashType); Index++) {
+    HashAlg = mCertHashType[Index].HashAlg;
+
     //
-    // Determine Hash Algorithm of Certificate in the forbidden database.
+    // Skip the hash algorithms which no certificate hash in the database uses.
     //
-    if (CompareGuid (&DbxList->SignatureType, &gEfiCertX509Sha256Guid)) {
-      HashAlg = HASHALG_SHA256;
-    } else if (CompareGuid (&DbxList->SignatureType, &gEfiCertX509Sha384Guid)) {
-      HashAlg = HASHALG_SHA384;
-    } else if (CompareGuid (&DbxList->SignatureType, &gEfiCertX509Sha512Guid)) {
-      HashAlg = HASHALG_SHA512;
-    } else {
-      DbxSize -= DbxList->SignatureListSize;
-      DbxList  = (EFI_SIGNATURE_LIST *) ((UINT8 *) DbxList + DbxList->SignatureListSize);
+    if (!IsSignatureTypeIndexed (Database, mCertHashType[Index].SignatureType)) {
       continue;
     }
 
@@ -912,32 +1037,35 @@ IsCertHashFoundInDatabase (
     if (!Status) {
       goto Done;
     }
+    FreePool (HashCtx);
+    HashCtx = NULL;
 
-    SiglistHeaderSize = sizeof (EFI_SIGNATURE_LIST) + DbxList->SignatureHeaderSize;
-    CertHash          = (EFI_SIGNATURE_DATA *) ((UINT8 *) DbxList + SiglistHeaderSize);
-    CertHashCount     = (DbxList->SignatureListSize - SiglistHeaderSize) / DbxList->SignatureSize;
-    for (Index = 0; Index < CertHashCount; Index++) {
-      //
-      // Iterate each Signature Data Node within this CertList for verify.
-      //
-      DbxCertHash = CertHash->SignatureData;
-      if (CompareMem (DbxCertHash, CertDigest, mHash[HashAlg].DigestLength) == 0) {
-        //
-        // Hash of Certificate is found in forbidden database.
-        //
-        IsFound = TRUE;
-
-        //
-        // Return the revocation time.
-        //
-        CopyMem (RevocationTime, (EFI_TIME *)(DbxCertHash + mHash[HashAlg].DigestLength), sizeof (EFI_TIME));
-        goto Done;
-      }
-      CertHash = (EFI_SIGNATURE_DATA *) ((UINT8 *) CertHash + DbxList->SignatureSize);
+    //
+    // Keep the match which comes first in the forbidden database.
+    //
+    CertHash = LookupSignatureDatabase (
+                 Database,
+                 mCertHashType[Index].SignatureType,
+                 CertDigest,
+                 mHash[HashAlg].DigestLength,
+                 NULL
+                 );
+    if ((CertHash != NULL) && ((FoundCertHash == NULL) || ((UINTN) CertHash < (UINTN) FoundCertHash))) {
+      FoundCertHash     = CertHash;
+      FoundDigestLength = mHash[HashAlg].DigestLength;
     }
+  }
 
-    DbxSize -= DbxList->SignatureListSize;
-    DbxList  = (EFI_SIGNATURE_LIST *) ((UINT8 *) DbxList + DbxList->SignatureListSize);
+  if (FoundCertHash != NULL) {
+    //
+    // Hash of Certificate is found in forbidden database.
+    //
+    IsFound = TRUE;
+
+    //
+    // Return the revocation time.
+    //
+    CopyMem (RevocationTime, (EFI_TIME *)(FoundCertHash->SignatureData + FoundDigestLength), sizeof (EFI_TIME));
   }
 
 Done:
@@ -951,7 +1079,7 @@ Done:
 /**
   Check whether signature is in specified database.
 
-  @param[in]  VariableName        Name of database variable that is searched in.
+  @param[in]  Database            Pointer to the cached database that is searched in.
   @param[in]  Signature           Pointer to signature that is searched for.
   @param[in]  CertType            Pointer to hash algrithom.
   @param[in]  SignatureSize       Size of Signature.
@@ -962,82 +1090,31 @@ Done:
 **/
 BOOLEAN
 IsSignatureFoundInDatabase (
-  IN CHAR16             *VariableName,
+  IN SIGNATURE_DATABASE *Database,
   IN UINT8              *Signature,
   IN EFI_GUID           *CertType,
   IN UINTN              SignatureSize
   )
 {
-  EFI_STATUS          Status;
   EFI_SIGNATURE_LIST  *CertList;
   EFI_SIGNATURE_DATA  *Cert;
-  UINTN               DataSize;
-  UINT8               *Data;
-  UINTN               Index;
-  UINTN               CertCount;
-  BOOLEAN             IsFound;
 
   //
-  // Read signature database variable.
+  // Look up the executable's signature in the index of the signature database.
   //
-  IsFound   = FALSE;
-  Data      = NULL;
-  DataSize  = 0;
-  Status    = gRT->GetVariable (VariableName, &gEfiImageSecurityDatabaseGuid, NULL, &DataSize, NULL);
-  if (Status != EFI_BUFFER_TOO_SMALL) {
-    return FALSE;
-  }
-
-  Data = (UINT8 *) AllocateZeroPool (DataSize);
-  if (Data == NULL) {
+  Cert = LookupSignatureDatabase (Database, CertType, Signature, SignatureSize, &CertList);
+  if (Cert == NULL) {
     return FALSE;
   }
 
-  Status = gRT->GetVariable (VariableName, &gEfiImageSecurityDatabaseGuid, NULL, &DataSize, Data);
-  if (EFI_ERROR (Status)) {
-    goto Done;
-  }
   //
-  // Enumerate all signature data in SigDB to check if executable's signature exists.
+  // Entries in UEFI_IMAGE_SECURITY_DATABASE that are used to validate image should be measured
   //
-  CertList = (EFI_SIGNATURE_LIST *) Data;
-  while ((DataSize > 0) && (DataSize >= CertList->SignatureListSize)) {
-    CertCount = (CertList->SignatureListSize - sizeof (EFI_SIGNATURE_LIST) - CertList->SignatureHeaderSize) / CertList->SignatureSize;
-    Cert      = (EFI_SIGNATURE_DATA *) ((UINT8 *) CertList + sizeof (EFI_SIGNATURE_LIST) + CertList->SignatureHeaderSize);
-    if ((CertList->SignatureSize == sizeof(EFI_SIGNATURE_DATA) - 1 + SignatureSize) && (CompareGuid(&CertList->SignatureType, CertType))) {
-      for (Index = 0; Index < CertCount; Index++) {
-        if (CompareMem (Cert->SignatureData, Signature, SignatureSize) == 0) {
-          //
-          // Find the signature in database.
-          //
-          IsFound = TRUE;
-          //
-          // Entries in UEFI_IMAGE_SECURITY_DATABASE that are used to validate image should be measured
-          //
-          if (StrCmp(VariableName, EFI_IMAGE_SECURITY_DATABASE) == 0) {
-            SecureBootHook (VariableName, &gEfiImageSecurityDatabaseGuid, CertList->SignatureSize, Cert);
-          }
-          break;
-        }
-
-        Cert = (EFI_SIGNATURE_DATA *) ((UINT8 *) Cert + CertList->SignatureSize);
-      }
-
-      if (IsFound) {
-        break;
-      }
-    }
-
-    DataSize -= CertList->SignatureListSize;
-    CertList = (EFI_SIGNATURE_LIST *) ((UINT8 *) CertList + CertList->SignatureListSize);
+  if (StrCmp (Database->VariableName, EFI_IMAGE_SECURITY_DATABASE) == 0) {
+    SecureBootHook (Database->VariableName, &gEfiImageSecurityDatabaseGuid, CertList->SignatureSize, Cert);
   }
 
-Done:
-  if (Data != NULL) {
-    FreePool (Data);
-  }
-
-  return IsFound;
+  return TRUE;
 }
 
 /**
@@ -1216,10 +1293,7 @@ IsForbiddenByDbx (
   IN UINTN                  AuthDataSize
   )
 {
-  EFI_STATUS                Status;
   BOOLEAN                   IsForbidden;
-  UINT8                     *Data;
-  UINTN                     DataSize;
   EFI_SIGNATURE_LIST        *CertList;
   UINTN                     CertListSize;
   EFI_SIGNATURE_DATA        *CertData;
@@ -1240,7 +1314,6 @@ IsForbiddenByDbx (
   // Variable Initialization
   //
   IsForbidden       = FALSE;
-  Data              = NULL;
   CertList          = NULL;
   CertData          = NULL;
   RootCert          = NULL;
@@ -1254,18 +1327,7 @@ IsForbiddenByDbx (
   //
   // The image will not be forbidden if dbx can't be got.
   //
-  DataSize = 0;
-  Status   = gRT->GetVariable (EFI_IMAGE_SECURITY_DATABASE1, &gEfiImageSecurityDatabaseGuid, NULL, &DataSize, NULL);
-  if (Status != EFI_BUFFER_TOO_SMALL) {
-    return IsForbidden;
-  }
-  Data = (UINT8 *) AllocateZeroPool (DataSize);
-  if (Data == NULL) {
-    return IsForbidden;
-  }
-
-  Status = gRT->GetVariable (EFI_IMAGE_SECURITY_DATABASE1, &gEfiImageSecurityDatabaseGuid, NULL, &DataSize, (VOID *) Data);
-  if (EFI_ERROR (Status)) {
+  if (mSignatureDbx.Data == NULL) {
     return IsForbidden;
   }
 
@@ -1273,8 +1335,8 @@ IsForbiddenByDbx (
   // Verify image signature with RAW X509 certificates in DBX database.
   // If passed, the image will be forbidden.
   //
-  CertList     = (EFI_SIGNATURE_LIST *) Data;
-  CertListSize = DataSize;
+  CertList     = (EFI_SIGNATURE_LIST *) mSignatureDbx.Data;
+  CertListSize = mSignatureDbx.DataSize;
   while ((CertListSize > 0) && (CertListSize >= CertList->SignatureListSize)) {
     if (CompareGuid (&CertList->SignatureType, &gEfiCertX509Guid)) {
       CertData  = (EFI_SIGNATURE_DATA *) ((UINT8 *) CertList + sizeof (EFI_SIGNATURE_LIST) + CertList->SignatureHeaderSize);
@@ -1346,7 +1408,7 @@ IsForbiddenByDbx (
     //
     CertPtr = CertPtr + sizeof (UINT32) + CertSize;
 
-    if (IsCertHashFoundInDatabase (Cert, CertSize, (EFI_SIGNATURE_LIST *)Data, DataSize, &RevocationTime)) {
+    if (IsCertHashFoundInDatabase (Cert, CertSize, &mSignatureDbx, &RevocationTime)) {
       //
       // Check the timestamp signature and signing time to determine if the image can be trusted.
       //
@@ -1365,10 +1427,6 @@ IsForbiddenByDbx (
   }
 
 Done:
-  if (Data != NULL) {
-    FreePool (Data);
-  }
-
   Pkcs7FreeSigners (CertBuffer);
   Pkcs7FreeSigners (TrustedCert);
 
@@ -1392,45 +1450,28 @@ IsAllowedByDb (
   IN UINTN              AuthDataSize
   )
 {
-  EFI_STATUS                Status;
   BOOLEAN                   VerifyStatus;
   EFI_SIGNATURE_LIST        *CertList;
   EFI_SIGNATURE_DATA        *CertData;
   UINTN                     DataSize;
-  UINT8                     *Data;
   UINT8                     *RootCert;
   UINTN                     RootCertSize;
   UINTN                     Index;
   UINTN                     CertCount;
-  UINTN                     DbxDataSize;
-  UINT8                     *DbxData;
   EFI_TIME                  RevocationTime;
 
-  Data              = NULL;
   CertList          = NULL;
   CertData          = NULL;
   RootCert          = NULL;
-  DbxData           = NULL;
   RootCertSize      = 0;
   VerifyStatus      = FALSE;
 
-  DataSize = 0;
-  Status   = gRT->GetVariable (EFI_IMAGE_SECURITY_DATABASE, &gEfiImageSecurityDatabaseGuid, NULL, &DataSize, NULL);
-  if (Status == EFI_BUFFER_TOO_SMALL) {
-    Data = (UINT8 *) AllocateZeroPool (DataSize);
-    if (Data == NULL) {
-      return VerifyStatus;
-    }
-
-    Status = gRT->GetVariable (EFI_IMAGE_SECURITY_DATABASE, &gEfiImageSecurityDatabaseGuid, NULL, &DataSize, (VOID *) Data);
-    if (EFI_ERROR (Status)) {
-      goto Done;
-    }
-
+  if (mSignatureDb.Data != NULL) {
     //
     // Find X509 certificate in Signature List to verify the signature in pkcs7 signed data.
     //
-    CertList = (EFI_SIGNATURE_LIST *) Data;
+    DataSize = mSignatureDb.DataSize;
+    CertList = (EFI_SIGNATURE_LIST *) mSignatureDb.Data;
     while ((DataSize > 0) && (DataSize >= CertList->SignatureListSize)) {
       if (CompareGuid (&CertList->SignatureType, &gEfiCertX509Guid)) {
         CertData  = (EFI_SIGNATURE_DATA *) ((UINT8 *) CertList + sizeof (EFI_SIGNATURE_LIST) + CertList->SignatureHeaderSize);
@@ -1458,21 +1499,7 @@ IsAllowedByDb (
             //
             // Here We still need to check if this RootCert's Hash is revoked
             //
-            Status   = gRT->GetVariable (EFI_IMAGE_SECURITY_DATABASE1, &gEfiImageSecurityDatabaseGuid, NULL, &DbxDataSize, NULL);
-            if (Status == EFI_BUFFER_TOO_SMALL) {
-              goto Done;
-            }
-            DbxData = (UINT8 *) AllocateZeroPool (DbxDataSize);
-            if (DbxData == NULL) {
-              goto Done;
-            }
-
-            Status = gRT->GetVariable (EFI_IMAGE_SECURITY_DATABASE1, &gEfiImageSecurityDatabaseGuid, NULL, &DbxDataSize, (VOID *) DbxData);
-            if (EFI_ERROR (Status)) {
-              goto Done;
-            }
-
-            if (IsCertHashFoundInDatabase (RootCert, RootCertSize, (EFI_SIGNATURE_LIST *)DbxData, DbxDataSize, &RevocationTime)) {
+            if (IsCertHashFoundInDatabase (RootCert, RootCertSize, &mSignatureDbx, &RevocationTime)) {
               //
               // Check the timestamp signature and signing time to determine if the RootCert can be trusted.
               //
@@ -1500,14 +1527,80 @@ Done:
     SecureBootHook (EFI_IMAGE_SECURITY_DATABASE, &gEfiImageSecurityDatabaseGuid, CertList->SignatureSize, CertData);
   }
 
-  if (Data != NULL) {
-    FreePool (Data);
-  }
-  if (DbxData != NULL) {
-    FreePool (DbxData);
+  return VerifyStatus;
+}
+
+/**
+  Get the hash algorithms used by the Authenticode signatures of the current image,
+  so that the image can be hashed for all of them in a single pass.
+
+  Caution: This function may receive untrusted input.
+  PE/COFF image is external input, so this function will validate its data structure
+  within this image buffer before use.
+
+  @param[in]  SecDataDir    Pointer to the security data directory of the image.
+
+  @return Bit mask of the supported hash algorithm types, bit N stands for hash
+          algorithm type N.
+
+**/
+UINT32
+GetImageSignatureHashAlgs (
+  IN EFI_IMAGE_DATA_DIRECTORY  *SecDataDir
+  )
+{
+  WIN_CERTIFICATE              *WinCertificate;
+  WIN_CERTIFICATE_EFI_PKCS     *PkcsCertData;
+  WIN_CERTIFICATE_UEFI_GUID    *WinCertUefiGuid;
+  UINT8                        *AuthData;
+  UINTN                        AuthDataSize;
+  UINT32                       OffSet;
+  UINT32                       HashAlg;
+  UINT32                       HashAlgMask;
+
+  HashAlgMask    = 0;
+  WinCertificate = NULL;
+
+  for (OffSet = SecDataDir->VirtualAddress;
+       OffSet < (SecDataDir->VirtualAddress + SecDataDir->Size);
+       OffSet += (WinCertificate->dwLength + ALIGN_SIZE (WinCertificate->dwLength))) {
+    WinCertificate = (WIN_CERTIFICATE *) (mImageBase + OffSet);
+    if ((SecDataDir->VirtualAddress + SecDataDir->Size - OffSet) <= sizeof (WIN_CERTIFICATE) ||
+        (SecDataDir->VirtualAddress + SecDataDir->Size - OffSet) < WinCertificate->dwLength) {
+      break;
+    }
+
+    if (WinCertificate->wCertificateType == WIN_CERT_TYPE_PKCS_SIGNED_DATA) {
+      PkcsCertData = (WIN_CERTIFICATE_EFI_PKCS *) WinCertificate;
+      if (PkcsCertData->Hdr.dwLength <= sizeof (PkcsCertData->Hdr)) {
+        break;
+      }
+      AuthData     = PkcsCertData->CertData;
+      AuthDataSize = PkcsCertData->Hdr.dwLength - sizeof(PkcsCertData->Hdr);
+    } else if (WinCertificate->wCertificateType == WIN_CERT_TYPE_EFI_GUID) {
+      WinCertUefiGuid = (WIN_CERTIFICATE_UEFI_GUID *) WinCertificate;
+      if (WinCertUefiGuid->Hdr.dwLength <= OFFSET_OF(WIN_CERTIFICATE_UEFI_GUID, CertData)) {
+        break;
+      }
+      if (!CompareGuid (&WinCertUefiGuid->CertType, &gEfiCertPkcs7Guid)) {
+        continue;
+      }
+      AuthData     = WinCertUefiGuid->CertData;
+      AuthDataSize = WinCertUefiGuid->Hdr.dwLength - OFFSET_OF(WIN_CERTIFICATE_UEFI_GUID, CertData);
+    } else {
+      if (WinCertificate->dwLength < sizeof (WIN_CERTIFICATE)) {
+        break;
+      }
+      continue;
+    }
+
+    HashAlg = GetAuthenticodeHashAlg (AuthData, AuthDataSize);
+    if ((HashAlg < HASHALG_MAX) && (mHash[HashAlg].GetContextSize != NULL)) {
+      HashAlgMask |= (1 << HashAlg);
+    }
   }
 
-  return VerifyStatus;
+  return HashAlgMask;
 }
 
 /**
@@ -1585,6 +1678,7 @@ DxeImageVerificationHandler (
   UINTN                                AuthDataSize;
   EFI_IMAGE_DATA_DIRECTORY             *SecDataDir;
   UINT32                               OffSet;
+  UINT32                               HashAlgMask;
   CHAR16                               *NameStr;
 
   SignatureList     = NULL;
@@ -1666,6 +1760,7 @@ DxeImageVerificationHandler (
 
   mImageBase  = (UINT8 *) FileBuffer;
   mImageSize  = FileSize;
+  mImageDigestCacheMask = 0;
 
   ZeroMem (&ImageContext, sizeof (ImageContext));
   ImageContext.Handle    = (VOID *) FileBuffer;
@@ -1725,6 +1820,17 @@ DxeImageVerificationHandler (
     }
   }
 
+  //
+  // Bring the cached db and dbx up to date before they are searched for this image.
+  // The image can't be trusted if the forbidden database can't be checked.
+  //
+  if (EFI_ERROR (RefreshSignatureDatabase (&mSignatureDbx)) ||
+      EFI_ERROR (RefreshSignatureDatabase (&mSignatureDb))) {
+    DEBUG ((DEBUG_INFO, "DxeImageVerificationLib: Failed to read the signature databases.\n"));
+    Status = EFI_ACCESS_DENIED;
+    goto Done;
+  }
+
   //
   // Start Image Validation.
   //
@@ -1738,7 +1844,7 @@ DxeImageVerificationHandler (
       goto Done;
     }
 
-    if (IsSignatureFoundInDatabase (EFI_IMAGE_SECURITY_DATABASE1, mImageDigest, &mCertType, mImageDigestSize)) {
+    if (IsSignatureFoundInDatabase (&mSignatureDbx, mImageDigest, &mCertType, mImageDigestSize)) {
       //
       // Image Hash is in forbidden database (DBX).
       //
@@ -1746,7 +1852,7 @@ DxeImageVerificationHandler (
       goto Done;
     }
 
-    if (IsSignatureFoundInDatabase (EFI_IMAGE_SECURITY_DATABASE, mImageDigest, &mCertType, mImageDigestSize)) {
+    if (IsSignatureFoundInDatabase (&mSignatureDb, mImageDigest, &mCertType, mImageDigestSize)) {
       //
       // Image Hash is in allowed database (DB).
       //
@@ -1760,6 +1866,15 @@ DxeImageVerificationHandler (
     goto Done;
   }
 
+  //
+  // Hash the image once for all the hash algorithms used by its signatures. The digests
+  // are cached, so a failure here is reported by HashPeImageByType() for each signature.
+  //
+  HashAlgMask = GetImageSignatureHashAlgs (SecDataDir);
+  if (HashAlgMask != 0) {
+    HashPeImageMultiple (HashAlgMask);
+  }
+
   //
   // Verify the signature of the image, multiple signatures are allowed as per PE/COFF Section 4.7
   // "Attribute Certificate Table".
@@ -1834,13 +1949,13 @@ DxeImageVerificationHandler (
     //
     // Check the image's hash value.
     //
-    if (IsSignatureFoundInDatabase (EFI_IMAGE_SECURITY_DATABASE1, mImageDigest, &mCertType, mImageDigestSize)) {
+    if (IsSignatureFoundInDatabase (&mSignatureDbx, mImageDigest, &mCertType, mImageDigestSize)) {
       Action = EFI_IMAGE_EXECUTION_AUTH_SIG_FOUND;
       DEBUG ((DEBUG_INFO, "DxeImageVerificationLib: Image is signed but %s hash of image is found in DBX.\n", mHashTypeStr));
       VerifyStatus = EFI_ACCESS_DENIED;
       break;
     } else if (EFI_ERROR (VerifyStatus)) {
-      if (IsSignatureFoundInDatabase (EFI_IMAGE_SECURITY_DATABASE, mImageDigest, &mCertType, mImageDigestSize)) {
+      if (IsSignatureFoundInDatabase (&mSignatureDb, mImageDigest, &mCertType, mImageDigestSize)) {
         VerifyStatus = EFI_SUCCESS;
       } else {
         DEBUG ((DEBUG_INFO, "DxeImageVerificationLib: Image is signed but signature is not allowed by DB and %s hash of image is not found in DB/DBX.\n", mHashTypeStr));
@@ -1961,6 +2076,18 @@ DxeImageVerificationLibConstructor (
     &Event
     );
 
+  //
+  // Register the event to read db and dbx again after they have been written.
+  //
+  gBS->CreateEventEx (
+         EVT_NOTIFY_SIGNAL,
+         TPL_CALLBACK,
+         OnSignatureDatabaseChanged,
+         NULL,
+         &gEdkiiImageSecurityDatabaseChangedGuid,
+         &Event
+         );
+
   return RegisterSecurity2Handler (
           DxeImageVerificationHandler,
           EFI_AUTH_OPERATION_VERIFY_IMAGE | EFI_AUTH_OPERATION_IMAGE_REQUIRED
@@ -2,7 +2,7 @@
   The internal header file includes the common header files, defines
   internal structure and functions used by ImageVerificationLib.
 
-Copyright (c) 2009 - 2014, Intel Corporation. All rights reserved.<BR>
+Copyright (c) 2009 - 2018, Intel Corporation. All rights reserved.<BR>
 This program and the accompanying materials
 are licensed and made available under the terms and conditions of the BSD License
 which accompanies this distribution.  The full text of the license may be found at
@@ -29,6 +29,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Library/DevicePathLib.h>
 #include <Library/SecurityManagementLib.h>
 #include <Library/PeCoffLib.h>
+#include <Library/PerformanceLib.h>
 #include <Protocol/FirmwareVolume2.h>
 #include <Protocol/DevicePath.h>
 #include <Protocol/BlockIo.h>
@@ -36,6 +37,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Protocol/VariableWrite.h>
 #include <Guid/ImageAuthentication.h>
 #include <Guid/AuthenticatedVariableFormat.h>
+#include <Guid/ImageSecurityDatabaseChanged.h>
 #include <IndustryStandard/PeImage.h>
 
 #define EFI_CERT_TYPE_RSA2048_SHA256_SIZE 256
@@ -204,4 +206,129 @@ typedef struct {
   HASH_FINAL               HashFinal;
 } HASH_TABLE;
 
+//
+// Signature type of X.509 certificate hash and its hash algorithm
+//
+typedef struct {
+  EFI_GUID                 *SignatureType;
+  UINT32                   HashAlg;
+} CERT_HASH_TYPE;
+
+//
+// Index entry referring to one signature in a cached signature database.
+//
+typedef struct {
+  //
+  // Signature list which contains the signature
+  //
+  EFI_SIGNATURE_LIST       *SignatureList;
+  //
+  // Signature data node within the signature list
+  //
+  EFI_SIGNATURE_DATA       *Signature;
+  //
+  // Number of leading bytes of SignatureData used as the lookup key
+  //
+  UINTN                    KeySize;
+} SIGNATURE_INDEX_ENTRY;
+
+//
+// In-memory copy of a signature database variable (db/dbx) and the sorted
+// index of the hash signatures it contains.
+//
+typedef struct {
+  //
+  // Name of the signature database variable
+  //
+  CHAR16                   *VariableName;
+  //
+  // Cached variable data, NULL if the variable does not exist
+  //
+  UINT8                    *Data;
+  UINTN                    DataSize;
+  //
+  // Sorted index of the signatures in Data
+  //
+  SIGNATURE_INDEX_ENTRY    *Index;
+  UINTN                    IndexCount;
+  //
+  // TRUE if Data and Index match the variable, cleared when the variable is written
+  //
+  BOOLEAN                  Valid;
+} SIGNATURE_DATABASE;
+
+extern SIGNATURE_DATABASE  mSignatureDb;
+extern SIGNATURE_DATABASE  mSignatureDbx;
+
+/**
+  Notification function of the image security database changed event group.
+  The cached db and dbx are read again before the next image is verified.
+
+  @param[in]  Event     Event whose notification function is being invoked.
+  @param[in]  Context   Pointer to the notification function's context.
+
+**/
+VOID
+EFIAPI
+OnSignatureDatabaseChanged (
+  IN EFI_EVENT                   Event,
+  IN VOID                        *Context
+  );
+
+/**
+  Read a signature database variable and build its signature index, unless the
+  cached copy is still valid.
+
+  @param[in, out]  Database       Pointer to the signature database cache.
+
+  @retval EFI_SUCCESS             The cache is up to date. Database->Data is NULL
+                                  if the variable does not exist.
+  @retval EFI_OUT_OF_RESOURCES    Fail to allocate memory. The cache is emptied.
+
+**/
+EFI_STATUS
+RefreshSignatureDatabase (
+  IN OUT SIGNATURE_DATABASE      *Database
+  );
+
+/**
+  Look up a signature in the index of a cached signature database.
+
+  @param[in]   Database           Pointer to the signature database cache.
+  @param[in]   SignatureType      Type of the signature list to search.
+  @param[in]   Key                Leading bytes of the signature data to search for.
+  @param[in]   KeySize            Size of Key in bytes.
+  @param[out]  SignatureList      Return the signature list which contains the match.
+                                  Optional.
+
+  @return Pointer to the first matching signature data node in database order,
+          or NULL if there is no match.
+
+**/
+EFI_SIGNATURE_DATA *
+LookupSignatureDatabase (
+  IN  SIGNATURE_DATABASE         *Database,
+  IN  EFI_GUID                   *SignatureType,
+  IN  UINT8                      *Key,
+  IN  UINTN                      KeySize,
+  OUT EFI_SIGNATURE_LIST         **SignatureList OPTIONAL
+  );
+
+/**
+  Check whether the index of a cached signature database has any signature of
+  a given type.
+
+  @param[in]   Database           Pointer to the signature database cache.
+  @param[in]   SignatureType      Type of the signature list to search.
+
+  @retval TRUE    The index has at least one signature of SignatureType.
+  @retval FALSE   The index has no signature of SignatureType.
+
+**/
+BOOLEAN
+IsSignatureTypeIndexed (
+  IN  SIGNATURE_DATABASE         *Database,
+  IN  EFI_GUID                   *SignatureType
+  );
+
 #endif
@@ -0,0 +1,463 @@
+/** @file
+  Cache of the image signature databases (db/dbx) with a sorted signature index.
+
+  The content of the signature database variables is kept in memory and the hash
+  signatures it contains are indexed by (signature type, signature data), so the
+  image hash and certificate hash checks done for every image are binary searches
+  instead of repeated variable reads and linear scans of every signature list.
+  The variables are read once and read again only after the variable driver has
+  signaled that db, dbx or dbt has been written.
+
+  Caution: This file requires additional review when modified.
+  This library will have external input - signature database variables.
+  The signature lists must be validated before use.
+
+Copyright (c) 2018, Intel Corporation. All rights reserved.<BR>
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#include "DxeImageVerificationLib.h"
+
+SIGNATURE_DATABASE  mSignatureDb  = { EFI_IMAGE_SECURITY_DATABASE,  NULL, 0, NULL, 0, FALSE };
+SIGNATURE_DATABASE  mSignatureDbx = { EFI_IMAGE_SECURITY_DATABASE1, NULL, 0, NULL, 0, FALSE };
+
+/**
+  Compare a lookup key with the key of a signature index entry.
+
+  @param[in]  SignatureType   Type of the signature list of the lookup key.
+  @param[in]  Key             Lookup key.
+  @param[in]  KeySize         Size of Key in bytes.
+  @param[in]  Entry           Signature index entry to compare with.
+
+  @retval 0      The lookup key matches the entry.
+  @retval <0     The lookup key sorts before the entry.
+  @retval >0     The lookup key sorts after the entry.
+
+**/
+INTN
+CompareSignatureIndexKey (
+  IN EFI_GUID               *SignatureType,
+  IN UINT8                  *Key,
+  IN UINTN                  KeySize,
+  IN SIGNATURE_INDEX_ENTRY  *Entry
+  )
+{
+  INTN                      Result;
+
+  Result = CompareMem (SignatureType, &Entry->SignatureList->SignatureType, sizeof (EFI_GUID));
+  if (Result != 0) {
+    return Result;
+  }
+
+  if (KeySize != Entry->KeySize) {
+    return (KeySize < Entry->KeySize) ? -1 : 1;
+  }
+
+  return CompareMem (Key, Entry->Signature->SignatureData, KeySize);
+}
+
+/**
+  Compare two signature index entries. Entries with the same key are ordered by
+  their position in the database so that lookups return the first match.
+
+  @param[in]  Entry1   First signature index entry.
+  @param[in]  Entry2   Second signature index entry.
+
+  @retval 0      The entries are the same.
+  @retval <0     Entry1 sorts before Entry2.
+  @retval >0     Entry1 sorts after Entry2.
+
+**/
+INTN
+CompareSignatureIndexEntry (
+  IN SIGNATURE_INDEX_ENTRY  *Entry1,
+  IN SIGNATURE_INDEX_ENTRY  *Entry2
+  )
+{
+  INTN                      Result;
+
+  Result = CompareSignatureIndexKey (
+             &Entry1->SignatureList->SignatureType,
+             Entry1->Signature->SignatureData,
+             Entry1->KeySize,
+             Entry2
+             );
+  if (Result != 0) {
+    return Result;
+  }
+
+  if (Entry1->Signature == Entry2->Signature) {
+    return 0;
+  }
+  return ((UINTN) Entry1->Signature < (UINTN) Entry2->Signature) ? -1 : 1;
+}
+
+/**
+  Restore the heap property of the sub-tree rooted at Root.
+
+  @param[in, out]  Index    Signature index array.
+  @param[in]       Root     Root of the sub-tree.
+  @param[in]       Count    Number of entries in the heap.
+
+**/
+VOID
+SiftDownSignatureIndex (
+  IN OUT SIGNATURE_INDEX_ENTRY  *Index,
+  IN     UINTN                  Root,
+  IN     UINTN                  Count
+  )
+{
+  UINTN                         Child;
+  SIGNATURE_INDEX_ENTRY         Entry;
+
+  while ((Child = 2 * Root + 1) < Count) {
+    if ((Child + 1 < Count) && (CompareSignatureIndexEntry (&Index[Child], &Index[Child + 1]) < 0)) {
+      Child++;
+    }
+    if (CompareSignatureIndexEntry (&Index[Root], &Index[Child]) >= 0) {
+      break;
+    }
+    CopyMem (&Entry, &Index[Root], sizeof (Entry));
+    CopyMem (&Index[Root], &Index[Child], sizeof (Entry));
+    CopyMem (&Index[Child], &Entry, sizeof (Entry));
+    Root = Child;
+  }
+}
+
+/**
+  Sort the signature index with heap sort, which needs no extra memory and has
+  a bounded run time whatever the content of the database is.
+
+  @param[in, out]  Index    Signature index array.
+  @param[in]       Count    Number of entries in Index.
+
+**/
+VOID
+SortSignatureIndex (
+  IN OUT SIGNATURE_INDEX_ENTRY  *Index,
+  IN     UINTN                  Count
+  )
+{
+  UINTN                         Root;
+  UINTN                         Last;
+  SIGNATURE_INDEX_ENTRY         Entry;
+
+  if (Count < 2) {
+    return;
+  }
+
+  for (Root = Count / 2; Root > 0; Root--) {
+    SiftDownSignatureIndex (Index, Root - 1, Count);
+  }
+
+  for (Last = Count - 1; Last > 0; Last--) {
+    CopyMem (&Entry, &Index[0], sizeof (Entry));
+    CopyMem (&Index[0], &Index[Last], sizeof (Entry));
+    CopyMem (&Index[Last], &Entry, sizeof (Entry));
+    SiftDownSignatureIndex (Index, 0, Last);
+  }
+}
+
+/**
+  Get the size of the lookup key of the signatures in a signature list.
+
+  The raw X.509 certificates are not indexed since they are verified one by one.
+  The key of an X.509 certificate hash is the digest without the revocation time,
+  the key of any other signature is the whole signature data.
+
+  @param[in]  SignatureList   Pointer to the signature list.
+
+  @return Size of the lookup key in bytes, or 0 if the list is not indexed.
+
+**/
+UINTN
+GetSignatureKeySize (
+  IN EFI_SIGNATURE_LIST     *SignatureList
+  )
+{
+  UINTN                     KeySize;
+
+  if (CompareGuid (&SignatureList->SignatureType, &gEfiCertX509Guid) ||
+      (SignatureList->SignatureSize <= sizeof (EFI_GUID))) {
+    return 0;
+  }
+
+  KeySize = SignatureList->SignatureSize - sizeof (EFI_GUID);
+  if (CompareGuid (&SignatureList->SignatureType, &gEfiCertX509Sha256Guid) ||
+      CompareGuid (&SignatureList->SignatureType, &gEfiCertX509Sha384Guid) ||
+      CompareGuid (&SignatureList->SignatureType, &gEfiCertX509Sha512Guid)) {
+    if (KeySize <= sizeof (EFI_TIME)) {
+      return 0;
+    }
+    KeySize -= sizeof (EFI_TIME);
+  }
+
+  return KeySize;
+}
+
+/**
+  Walk the signature lists of a cached database, optionally filling the index.
+
+  @param[in]       Database     Pointer to the signature database cache.
+  @param[out]      Index        Signature index array to fill. Optional.
+
+  @return Number of signatures which are indexed.
+
+**/
+UINTN
+EnumerateSignatureDatabase (
+  IN  SIGNATURE_DATABASE     *Database,
+  OUT SIGNATURE_INDEX_ENTRY  *Index OPTIONAL
+  )
+{
+  EFI_SIGNATURE_LIST         *CertList;
+  EFI_SIGNATURE_DATA         *Cert;
+  UINTN                      DataSize;
+  UINTN                      CertCount;
+  UINTN                      KeySize;
+  UINTN                      Count;
+  UINTN                      Loop;
+
+  Count    = 0;
+  DataSize = Database->DataSize;
+  CertList = (EFI_SIGNATURE_LIST *) Database->Data;
+  while ((DataSize >= sizeof (EFI_SIGNATURE_LIST)) && (DataSize >= CertList->SignatureListSize)) {
+    if ((CertList->SignatureSize == 0) ||
+        (CertList->SignatureListSize < sizeof (EFI_SIGNATURE_LIST) + CertList->SignatureHeaderSize)) {
+      //
+      // Malformed signature list, stop here like the other walkers do.
+      //
+      break;
+    }
+
+    KeySize = GetSignatureKeySize (CertList);
+    if (KeySize != 0) {
+      CertCount = (CertList->SignatureListSize - sizeof (EFI_SIGNATURE_LIST) - CertList->SignatureHeaderSize) / CertList->SignatureSize;
+      Cert      = (EFI_SIGNATURE_DATA *) ((UINT8 *) CertList + sizeof (EFI_SIGNATURE_LIST) + CertList->SignatureHeaderSize);
+      for (Loop = 0; Loop < CertCount; Loop++) {
+        if (Index != NULL) {
+          Index[Count].SignatureList = CertList;
+          Index[Count].Signature     = Cert;
+          Index[Count].KeySize       = KeySize;
+        }
+        Count++;
+        Cert = (EFI_SIGNATURE_DATA *) ((UINT8 *) Cert + CertList->SignatureSize);
+      }
+    }
+
+    DataSize -= CertList->SignatureListSize;
+    CertList  = (EFI_SIGNATURE_LIST *) ((UINT8 *) CertList + CertList->SignatureListSize);
+  }
+
+  return Count;
+}
+
+/**
+  Release the cached data and index of a signature database.
+
+  @param[in, out]  Database       Pointer to the signature database cache.
+
+**/
+VOID
+FreeSignatureDatabase (
+  IN OUT SIGNATURE_DATABASE      *Database
+  )
+{
+  if (Database->Data != NULL) {
+    FreePool (Database->Data);
+  }
+  if (Database->Index != NULL) {
+    FreePool (Database->Index);
+  }
+  Database->Data       = NULL;
+  Database->DataSize   = 0;
+  Database->Index      = NULL;
+  Database->IndexCount = 0;
+  Database->Valid      = FALSE;
+}
+
+/**
+  Notification function of the image security database changed event group.
+  The cached db and dbx are read again before the next image is verified.
+
+  @param[in]  Event     Event whose notification function is being invoked.
+  @param[in]  Context   Pointer to the notification function's context.
+
+**/
+VOID
+EFIAPI
+OnSignatureDatabaseChanged (
+  IN EFI_EVENT                   Event,
+  IN VOID                        *Context
+  )
+{
+  mSignatureDb.Valid  = FALSE;
+  mSignatureDbx.Valid = FALSE;
+}
+
+/**
+  Read a signature database variable and build its signature index, unless the
+  cached copy is still valid.
+
+  @param[in, out]  Database       Pointer to the signature database cache.
+
+  @retval EFI_SUCCESS             The cache is up to date. Database->Data is NULL
+                                  if the variable does not exist.
+  @retval EFI_OUT_OF_RESOURCES    Fail to allocate memory. The cache is emptied.
+
+**/
+EFI_STATUS
+RefreshSignatureDatabase (
+  IN OUT SIGNATURE_DATABASE      *Database
+  )
+{
+  EFI_STATUS                     Status;
+  UINT8                          *Data;
+  UINTN                          DataSize;
+  UINTN                          Count;
+
+  if (Database->Valid) {
+    return EFI_SUCCESS;
+  }
+
+  FreeSignatureDatabase (Database);
+
+  DataSize = 0;
+  Status   = gRT->GetVariable (Database->VariableName, &gEfiImageSecurityDatabaseGuid, NULL, &DataSize, NULL);
+  if (Status != EFI_BUFFER_TOO_SMALL) {
+    //
+    // The variable does not exist until it is written. Any other error, such as
+    // the variable services not being available yet, is retried next time.
+    //
+    Database->Valid = (BOOLEAN) (Status == EFI_NOT_FOUND);
+    return EFI_SUCCESS;
+  }
+
+  Data = (UINT8 *) AllocateZeroPool (DataSize);
+  if (Data == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = gRT->GetVariable (Database->VariableName, &gEfiImageSecurityDatabaseGuid, NULL, &DataSize, Data);
+  if (EFI_ERROR (Status)) {
+    FreePool (Data);
+    return EFI_SUCCESS;
+  }
+
+  Database->Data     = Data;
+  Database->DataSize = DataSize;
+
+  Count = EnumerateSignatureDatabase (Database, NULL);
+  if (Count != 0) {
+    Database->Index = AllocatePool (Count * sizeof (SIGNATURE_INDEX_ENTRY));
+    if (Database->Index == NULL) {
+      FreeSignatureDatabase (Database);
+      return EFI_OUT_OF_RESOURCES;
+    }
+    EnumerateSignatureDatabase (Database, Database->Index);
+    SortSignatureIndex (Database->Index, Count);
+  }
+  Database->IndexCount = Count;
+  Database->Valid      = TRUE;
+
+  DEBUG ((DEBUG_INFO, "DxeImageVerificationLib: Indexed %d signatures in %s.\n", Count, Database->VariableName));
+  return EFI_SUCCESS;
+}
+
+/**
+  Look up a signature in the index of a cached signature database.
+
+  @param[in]   Database           Pointer to the signature database cache.
+  @param[in]   SignatureType      Type of the signature list to search.
+  @param[in]   Key                Leading bytes of the signature data to search for.
+  @param[in]   KeySize            Size of Key in bytes.
+  @param[out]  SignatureList      Return the signature list which contains the match.
+                                  Optional.
+
+  @return Pointer to the first matching signature data node in database order,
+          or NULL if there is no match.
+
+**/
+EFI_SIGNATURE_DATA *
+LookupSignatureDatabase (
+  IN  SIGNATURE_DATABASE         *Database,
+  IN  EFI_GUID                   *SignatureType,
+  IN  UINT8                      *Key,
+  IN  UINTN                      KeySize,
+  OUT EFI_SIGNATURE_LIST         **SignatureList OPTIONAL
+  )
+{
+  UINTN                          Low;
+  UINTN                          High;
+  UINTN                          Middle;
+
+  //
+  // Find the lowest entry which does not sort before the key.
+  //
+  Low  = 0;
+  High = Database->IndexCount;
+  while (Low < High) {
+    Middle = Low + (High - Low) / 2;
+    if (CompareSignatureIndexKey (SignatureType, Key, KeySize, &Database->Index[Middle]) > 0) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+
+  if ((Low == Database->IndexCount) ||
+      (CompareSignatureIndexKey (SignatureType, Key, KeySize, &Database->Index[Low]) != 0)) {
+    return NULL;
+  }
+
+  if (SignatureList != NULL) {
+    *SignatureList = Database->Index[Low].SignatureList;
+  }
+  return Database->Index[Low].Signature;
+}
+
+/**
+  Check whether the index of a cached signature database has any signature of
+  a given type.
+
+  @param[in]   Database           Pointer to the signature database cache.
+  @param[in]   SignatureType      Type of the signature list to search.
+
+  @retval TRUE    The index has at least one signature of SignatureType.
+  @retval FALSE   The index has no signature of SignatureType.
+
+**/
+BOOLEAN
+IsSignatureTypeIndexed (
+  IN  SIGNATURE_DATABASE         *Database,
+  IN  EFI_GUID                   *SignatureType
+  )
+{
+  UINTN                          Low;
+  UINTN                          High;
+  UINTN                          Middle;
+
+  //
+  // The index is sorted by signature type first, find the lowest entry of the type.
+  //
+  Low  = 0;
+  High = Database->IndexCount;
+  while (Low < High) {
+    Middle = Low + (High - Low) / 2;
+    if (CompareMem (SignatureType, &Database->Index[Middle].SignatureList->SignatureType, sizeof (EFI_GUID)) > 0) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+
+  return (BOOLEAN) ((Low < Database->IndexCount) &&
+                    CompareGuid (SignatureType, &Database->Index[Low].SignatureList->SignatureType));
+}
@@ -583,6 +583,8 @@ ApWakeupFunction (
   CPU_INFO_IN_HOB            *CpuInfoInHob;
   UINT64                     ApTopOfStack;
   UINTN                      CurrentApicMode;
+  BOOLEAN                    TakeTurn;
+  UINTN                      NextNumber;
 
   //
   // AP finished assembly code and begin to execute C code
@@ -657,6 +659,17 @@ ApWakeupFunction (
         Procedure = (EFI_AP_PROCEDURE)CpuMpData->CpuData[ProcessorNumber].ApFunction;
         Parameter = (VOID *) CpuMpData->CpuData[ProcessorNumber].ApFunctionArgument;
         if (Procedure != NULL) {
+          TakeTurn = (BOOLEAN) (CpuMpData->SingleThread &&
+                                CpuMpData->CpuData[ProcessorNumber].Waiting);
+          if (TakeTurn) {
+            //
+            // Single-threaded StartupAllAPs(): wait until the previous AP
+            // hands over.
+            //
+            while (CpuMpData->SingleThreadTurn != ProcessorNumber) {
+              CpuPause ();
+            }
+          }
           SetApState (&CpuMpData->CpuData[ProcessorNumber], CpuStateBusy);
           //
           // Enable source debugging on AP function
@@ -695,6 +708,19 @@ ApWakeupFunction (
               }
             }
           }
+          if (TakeTurn) {
+            //
+            // Hand over to the next waiting AP. This must happen before the
+            // state becomes CpuStateFinished: once the last AP finishes, the
+            // BSP may start a new StartupAllAPs() and reset the turn.
+            //
+            for (NextNumber = ProcessorNumber + 1; NextNumber < CpuMpData->CpuCount; NextNumber++) {
+              if (CpuMpData->CpuData[NextNumber].Waiting) {
+                break;
+              }
+            }
+            CpuMpData->SingleThreadTurn = NextNumber;
+          }
         }
         SetApState (&CpuMpData->CpuData[ProcessorNumber], CpuStateFinished);
       }
@@ -1282,6 +1308,34 @@ TimedWaitForApFinish (
   }
 }
 
+/**
+  Get the number of microseconds elapsed since a performance counter value.
+
+  @param[in] StartTime        A value returned by GetPerformanceCounter().
+
+  @return The elapsed time in microseconds.
+**/
+STATIC
+UINT64
+GetElapsedMicroseconds (
+  IN UINT64                    StartTime
+  )
+{
+  UINT64  TotalTime;
+
+  //
+  // With an infinite timeout, CheckTimeout() only accumulates the elapsed
+  // ticks, taking care of performance counter roll-over.
+  //
+  TotalTime = 0;
+  CheckTimeout (&StartTime, &TotalTime, MAX_UINT64);
+  return DivU64x64Remainder (
+           MultU64x32 (TotalTime, 1000000),
+           GetPerformanceCounterProperties (NULL, NULL),
+           NULL
+           );
+}
+
 /**
   Reset an AP to Idle state.
 
@@ -1309,37 +1363,6 @@ ResetProcessorToIdleState (
   SetApState (&CpuMpData->CpuData[ProcessorNumber], CpuStateIdle);
 }
 
-/**
-  Searches for the next waiting AP.
-
-  Search for the next AP that is put in waiting state by single-threaded StartupAllAPs().
-
-  @param[out]  NextProcessorNumber  Pointer to the processor number of the next waiting AP.
-
-  @retval EFI_SUCCESS          The next waiting AP has been found.
-  @retval EFI_NOT_FOUND        No waiting AP exists.
-
-**/
-EFI_STATUS
-GetNextWaitingProcessorNumber (
-  OUT UINTN                    *NextProcessorNumber
-  )
-{
-  UINTN           ProcessorNumber;
-  CPU_MP_DATA     *CpuMpData;
-
-  CpuMpData = GetCpuMpData ();
-
-  for (ProcessorNumber = 0; ProcessorNumber < CpuMpData->CpuCount; ProcessorNumber++) {
-    if (CpuMpData->CpuData[ProcessorNumber].Waiting) {
-      *NextProcessorNumber = ProcessorNumber;
-      return EFI_SUCCESS;
-    }
-  }
-
-  return EFI_NOT_FOUND;
-}
-
 /** Checks status of specified AP.
 
   This function checks whether the specified AP has finished the task assigned
@@ -1411,16 +1434,12 @@ CheckAllAPs (
   )
 {
   UINTN           ProcessorNumber;
-  UINTN           NextProcessorNumber;
   UINTN           ListIndex;
-  EFI_STATUS      Status;
   CPU_MP_DATA     *CpuMpData;
   CPU_AP_DATA     *CpuData;
 
   CpuMpData = GetCpuMpData ();
 
-  NextProcessorNumber = 0;
-
   //
   // Go through all APs that are responsible for the StartupAllAPs().
   //
@@ -1439,24 +1458,6 @@ CheckAllAPs (
       CpuMpData->RunningCount --;
       CpuMpData->CpuData[ProcessorNumber].Waiting = FALSE;
       SetApState(CpuData, CpuStateIdle);
-
-      //
-      // If in Single Thread mode, then search for the next waiting AP for execution.
-      //
-      if (CpuMpData->SingleThread) {
-        Status = GetNextWaitingProcessorNumber (&NextProcessorNumber);
-
-        if (!EFI_ERROR (Status)) {
-          WakeUpAP (
-            CpuMpData,
-            FALSE,
-            (UINT32) NextProcessorNumber,
-            CpuMpData->Procedure,
-            CpuMpData->ProcArguments,
-            TRUE
-            );
-         }
-      }
     }
   }
 
@@ -2173,6 +2174,9 @@ StartupAllAPsWorker (
   CPU_AP_DATA             *CpuData;
   BOOLEAN                 HasEnabledAp;
   CPU_STATE               ApState;
+  UINT64                  StartTime;
+  UINT64                  WakeUpTime;
+  UINT32                  ApCount;
 
   CpuMpData = GetCpuMpData ();
 
@@ -2230,7 +2234,8 @@ StartupAllAPsWorker (
     return EFI_NOT_STARTED;
   }
 
-  CpuMpData->RunningCount = 0;
+  CpuMpData->RunningCount     = 0;
+  CpuMpData->SingleThreadTurn = ProcessorCount;
   for (ProcessorNumber = 0; ProcessorNumber < ProcessorCount; ProcessorNumber++) {
     CpuData = &CpuMpData->CpuData[ProcessorNumber];
     CpuData->Waiting = FALSE;
@@ -2241,9 +2246,13 @@ StartupAllAPsWorker (
         //
         CpuData->Waiting = TRUE;
         CpuMpData->RunningCount++;
+        if (CpuMpData->SingleThreadTurn == ProcessorCount) {
+          CpuMpData->SingleThreadTurn = ProcessorNumber;
+        }
       }
     }
   }
+  ApCount = CpuMpData->RunningCount;
 
   CpuMpData->Procedure     = Procedure;
   CpuMpData->ProcArguments = ProcedureArgument;
@@ -2257,25 +2266,30 @@ StartupAllAPsWorker (
   CpuMpData->TotalTime     = 0;
   CpuMpData->WaitEvent     = WaitEvent;
 
-  if (!SingleThread) {
-    WakeUpAP (CpuMpData, TRUE, 0, Procedure, ProcedureArgument, FALSE);
-  } else {
-    for (ProcessorNumber = 0; ProcessorNumber < ProcessorCount; ProcessorNumber++) {
-      if (ProcessorNumber == CallerNumber) {
-        continue;
-      }
-      if (CpuMpData->CpuData[ProcessorNumber].Waiting) {
-        WakeUpAP (CpuMpData, FALSE, ProcessorNumber, Procedure, ProcedureArgument, TRUE);
-        break;
-      }
-    }
-  }
+  //
+  // Wake up all APs with one broadcast, also in single-threaded mode. There
+  // the APs take turns by themselves (see SingleThreadTurn), instead of the
+  // BSP waking up, and in HLT loop mode sending INIT-SIPI-SIPI to, one AP
+  // after another.
+  //
+  StartTime = GetPerformanceCounter ();
+  WakeUpAP (CpuMpData, TRUE, 0, Procedure, ProcedureArgument, FALSE);
+  WakeUpTime = GetElapsedMicroseconds (StartTime);
 
   Status = EFI_SUCCESS;
   if (WaitEvent == NULL) {
     do {
       Status = CheckAllAPs ();
     } while (Status == EFI_NOT_READY);
+
+    DEBUG ((
+      DEBUG_VERBOSE,
+      "%a: %u APs woken up in %Lu microseconds, finished in %Lu microseconds\n",
+      __FUNCTION__,
+      ApCount,
+      WakeUpTime,
+      GetElapsedMicroseconds (StartTime)
+      ));
   }
 
   return Status;
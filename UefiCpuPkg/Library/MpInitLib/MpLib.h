@@ -219,6 +219,13 @@ struct _CPU_MP_DATA {
   volatile UINT32                FinishedCount;
   UINT32                         RunningCount;
   BOOLEAN                        SingleThread;
+  //
+  // Single-threaded StartupAllAPs() wakes all APs at once; they then run the
+  // procedure one after another, in the order of their processor numbers.
+  // This is the processor number of the AP whose turn it is, or CpuCount
+  // after the last one.
+  //
+  volatile UINTN                 SingleThreadTurn;
   EFI_AP_PROCEDURE               Procedure;
   VOID                           *ProcArguments;
   BOOLEAN                        *Finished;
@@ -47,12 +47,11 @@ typedef struct {
   UINT64                 Address;
   UINT64                 Alignment;
   UINT64                 Length;
-  MTRR_MEMORY_CACHE_TYPE Type : 7;
+  MTRR_MEMORY_CACHE_TYPE Type;
 
   //
   // Temprary use for calculating the best MTRR settings.
   //
-  BOOLEAN                Visited : 1;
   UINT8                  Weight;
   UINT16                 Previous;
 } MTRR_LIB_ADDRESS;
@@ -1143,6 +1142,12 @@ MtrrLibGetNumberOfTypes (
   the Previous of all vertices from Start to Stop is updated to reflect
   how the memory range is covered by MTRR.
 
+  Every edge goes from a lower vertex to a higher one, so the graph is
+  acyclic and the vertices are already in topological order. A single
+  forward pass relaxing the outgoing edges of each vertex finds the least
+  weight paths. Only the vertices within the alignment of a vertex can be
+  covered by one MTRR starting from it, so the edges beyond are not visited.
+
   @param VertexCount     The count of vertices in the graph.
   @param Vertices        Array holding all vertices.
   @param Weight          2-dimention array holding weights between vertices.
@@ -1160,58 +1165,38 @@ MtrrLibCalculateLeastMtrrs (
   IN BOOLEAN                     IncludeOptional
   )
 {
-  UINT16                         Index;
-  UINT8                          MinWeight;
-  UINT16                         MinI;
+  UINT16                         From;
+  UINT16                         To;
   UINT8                          Mandatory;
   UINT8                          Optional;
+  UINTN                          NewWeight;
 
-  for (Index = Start; Index <= Stop; Index++) {
-    Vertices[Index].Visited = FALSE;
-    Mandatory = Weight[M(Start,Index)];
-    Vertices[Index].Weight = Mandatory;
-    if (Mandatory != MAX_WEIGHT) {
-      Optional = IncludeOptional ? Weight[O(Start, Index)] : 0;
-      Vertices[Index].Weight += Optional;
-      ASSERT (Vertices[Index].Weight >= Optional);
-    }
+  for (To = Start; To <= Stop; To++) {
+    Vertices[To].Weight = MAX_WEIGHT;
   }
+  Vertices[Start].Weight = 0;
 
-  MinI = Start;
-  MinWeight = 0;
-  while (!Vertices[Stop].Visited) {
+  for (From = Start; From < Stop; From++) {
     //
-    // Update the weight from the shortest vertex to other unvisited vertices
+    // The adjacent edge always exists, so every vertex is reachable from Start.
     //
-    for (Index = Start + 1; Index <= Stop; Index++) {
-      if (!Vertices[Index].Visited) {
-        Mandatory = Weight[M(MinI, Index)];
-        if (Mandatory != MAX_WEIGHT) {
-          Optional = IncludeOptional ? Weight[O(MinI, Index)] : 0;
-          if (MinWeight + Mandatory + Optional <= Vertices[Index].Weight) {
-            Vertices[Index].Weight   = MinWeight + Mandatory + Optional;
-            Vertices[Index].Previous = MinI; // Previous is Start based.
-          }
-        }
+    ASSERT (Vertices[From].Weight != MAX_WEIGHT);
+    for (To = From + 1; To <= Stop; To++) {
+      if (Vertices[To].Address - Vertices[From].Address > Vertices[From].Alignment) {
+        break;
       }
-    }
-
-    //
-    // Find the shortest vertex from Start
-    //
-    MinI      = VertexCount;
-    MinWeight = MAX_WEIGHT;
-    for (Index = Start + 1; Index <= Stop; Index++) {
-      if (!Vertices[Index].Visited && MinWeight > Vertices[Index].Weight) {
-        MinI      = Index;
-        MinWeight = Vertices[Index].Weight;
+      Mandatory = Weight[M(From, To)];
+      if (Mandatory == MAX_WEIGHT) {
+        continue;
+      }
+      Optional  = IncludeOptional ? Weight[O(From, To)] : 0;
+      NewWeight = (UINTN)Vertices[From].Weight + Mandatory + Optional;
+      ASSERT (NewWeight < MAX_WEIGHT);
+      if (NewWeight <= Vertices[To].Weight) {
+        Vertices[To].Weight   = (UINT8)NewWeight;
+        Vertices[To].Previous = From; // Previous is Start based.
       }
     }
-
-    //
-    // Mark the shortest vertex from Start as visited
-    //
-    Vertices[MinI].Visited = TRUE;
   }
 }
 
@@ -25,6 +25,7 @@ SMM_DISPATCHER_MP_SYNC_DATA                 *mSmmMpSyncData = NULL;
 UINTN                                       mSmmMpSyncDataSize;
 SMM_CPU_SEMAPHORES                          mSmmCpuSemaphores;
 UINTN                                       mSemaphoreSize;
+UINTN                                       mSmmCpuPackageCount;
 SPIN_LOCK                                   *mPFLock = NULL;
 SMM_CPU_SYNC_MODE                           mCpuSmmSyncMode;
 BOOLEAN                                     mMachineCheckSupported = FALSE;
@@ -124,6 +125,35 @@ WaitForAllAPs (
   )
 {
   UINTN                             BspIndex;
+  UINTN                             Index;
+  volatile UINT32                   *Arrival;
+  UINT32                            Value;
+  UINT32                            Taken;
+
+  if (FeaturePcdGet (PcdCpuSmmHierarchicalSync)) {
+    //
+    // Collect the arrivals from the per-package counters. Each counter is
+    // drained with a single compare exchange, so the BSP pulls the cache line
+    // of a package once per round instead of once per AP.
+    //
+    while (NumberOfAPs > 0) {
+      for (Index = 0; Index < mSmmCpuPackageCount && NumberOfAPs > 0; Index++) {
+        Arrival = (UINT32 *)((UINTN)mSmmCpuSemaphores.SemaphorePackage.Arrival + mSemaphoreSize * Index);
+        Value   = *Arrival;
+        if (Value == 0) {
+          continue;
+        }
+        Taken = (UINT32)MIN (Value, NumberOfAPs);
+        if (InterlockedCompareExchange32 ((UINT32 *)Arrival, Value, Value - Taken) == Value) {
+          NumberOfAPs -= Taken;
+        }
+      }
+      if (NumberOfAPs > 0) {
+        CpuPause ();
+      }
+    }
+    return;
+  }
 
   BspIndex = mSmmMpSyncData->BspIndex;
   while (NumberOfAPs-- > 0) {
@@ -131,6 +161,31 @@ WaitForAllAPs (
   }
 }
 
+/**
+  Signal the BSP that an AP has reached a synchronization point.
+
+  With PcdCpuSmmHierarchicalSync, the AP increments the arrival counter of its
+  package, so only the processors of one package contend for a cache line.
+  Otherwise it releases the Run semaphore of the BSP.
+
+  @param   CpuIndex         AP processor Index
+  @param   BspIndex         BSP processor Index
+
+**/
+STATIC
+VOID
+ReleaseBsp (
+  IN      UINTN                     CpuIndex,
+  IN      UINTN                     BspIndex
+  )
+{
+  if (FeaturePcdGet (PcdCpuSmmHierarchicalSync)) {
+    ReleaseSemaphore (mSmmMpSyncData->CpuData[CpuIndex].Arrival);
+  } else {
+    ReleaseSemaphore (mSmmMpSyncData->CpuData[BspIndex].Run);
+  }
+}
+
 /**
   Performs an atomic compare exchange operation to release semaphore
   for each AP.
@@ -678,7 +733,7 @@ APHandler (
     //
     // Notify BSP of arrival at this point
     //
-    ReleaseSemaphore (mSmmMpSyncData->CpuData[BspIndex].Run);
+    ReleaseBsp (CpuIndex, BspIndex);
   }
 
   if (SmmCpuFeaturesNeedConfigureMtrrs()) {
@@ -695,7 +750,7 @@ APHandler (
     //
     // Signal BSP the completion of this AP
     //
-    ReleaseSemaphore (mSmmMpSyncData->CpuData[BspIndex].Run);
+    ReleaseBsp (CpuIndex, BspIndex);
 
     //
     // Wait for BSP's signal to program MTRRs
@@ -710,7 +765,7 @@ APHandler (
     //
     // Signal BSP the completion of this AP
     //
-    ReleaseSemaphore (mSmmMpSyncData->CpuData[BspIndex].Run);
+    ReleaseBsp (CpuIndex, BspIndex);
   }
 
   while (TRUE) {
@@ -750,7 +805,7 @@ APHandler (
     //
     // Notify BSP the readiness of this AP to program MTRRs
     //
-    ReleaseSemaphore (mSmmMpSyncData->CpuData[BspIndex].Run);
+    ReleaseBsp (CpuIndex, BspIndex);
 
     //
     // Wait for the signal from BSP to program MTRRs
@@ -767,7 +822,7 @@ APHandler (
   //
   // Notify BSP the readiness of this AP to Reset states/semaphore for this processor
   //
-  ReleaseSemaphore (mSmmMpSyncData->CpuData[BspIndex].Run);
+  ReleaseBsp (CpuIndex, BspIndex);
 
   //
   // Wait for the signal from BSP to Reset states/semaphore for this processor
@@ -782,7 +837,7 @@ APHandler (
   //
   // Notify BSP the readiness of this AP to exit SMM
   //
-  ReleaseSemaphore (mSmmMpSyncData->CpuData[BspIndex].Run);
+  ReleaseBsp (CpuIndex, BspIndex);
 
 }
 
@@ -1108,9 +1163,15 @@ SmiRendezvous (
   BOOLEAN                        BspInProgress;
   UINTN                          Index;
   UINTN                          Cr2;
+  UINT64                         EntryTimer;
 
   ASSERT(CpuIndex < mMaxNumberOfCpus);
 
+  EntryTimer = 0;
+  if (FeaturePcdGet (PcdCpuSmmProfileEnable)) {
+    EntryTimer = StartSyncTimer ();
+  }
+
   //
   // Save Cr2 because Page Fault exception in SMM may override its value
   //
@@ -1236,6 +1297,10 @@ SmiRendezvous (
         // BSP Handler is always called with a ValidSmi == TRUE
         //
         BSPHandler (CpuIndex, mSmmMpSyncData->EffectiveSyncMode);
+
+        if (FeaturePcdGet (PcdCpuSmmProfileEnable)) {
+          SmmProfileRecordSmiLatency (GetSyncTimerElapsed (EntryTimer));
+        }
       } else {
         APHandler (CpuIndex, ValidSmi, mSmmMpSyncData->EffectiveSyncMode);
       }
@@ -1272,16 +1337,31 @@ InitializeSmmCpuSemaphores (
   UINTN                      TotalSize;
   UINTN                      GlobalSemaphoresSize;
   UINTN                      CpuSemaphoresSize;
+  UINTN                      PackageSemaphoresSize;
   UINTN                      SemaphoreSize;
   UINTN                      Pages;
   UINTN                      *SemaphoreBlock;
   UINTN                      SemaphoreAddr;
+  UINTN                      Index;
+
+  //
+  // Package numbers are expected to be dense; fold any outliers so that the
+  // number of package counters never exceeds the number of processors.
+  //
+  ProcessorCount      = gSmmCpuPrivate->SmmCoreEntryContext.NumberOfCpus;
+  mSmmCpuPackageCount = 1;
+  for (Index = 0; Index < ProcessorCount; Index++) {
+    if (gSmmCpuPrivate->ProcessorInfo[Index].ProcessorId != INVALID_APIC_ID) {
+      mSmmCpuPackageCount = MAX (mSmmCpuPackageCount, (UINTN)gSmmCpuPrivate->ProcessorInfo[Index].Location.Package + 1);
+    }
+  }
+  mSmmCpuPackageCount = MIN (mSmmCpuPackageCount, ProcessorCount);
 
   SemaphoreSize   = GetSpinLockProperties ();
-  ProcessorCount = gSmmCpuPrivate->SmmCoreEntryContext.NumberOfCpus;
-  GlobalSemaphoresSize = (sizeof (SMM_CPU_SEMAPHORE_GLOBAL) / sizeof (VOID *)) * SemaphoreSize;
-  CpuSemaphoresSize    = (sizeof (SMM_CPU_SEMAPHORE_CPU) / sizeof (VOID *)) * ProcessorCount * SemaphoreSize;
-  TotalSize = GlobalSemaphoresSize + CpuSemaphoresSize;
+  GlobalSemaphoresSize  = (sizeof (SMM_CPU_SEMAPHORE_GLOBAL) / sizeof (VOID *)) * SemaphoreSize;
+  CpuSemaphoresSize     = (sizeof (SMM_CPU_SEMAPHORE_CPU) / sizeof (VOID *)) * ProcessorCount * SemaphoreSize;
+  PackageSemaphoresSize = (sizeof (SMM_CPU_SEMAPHORE_PACKAGE) / sizeof (VOID *)) * mSmmCpuPackageCount * SemaphoreSize;
+  TotalSize = GlobalSemaphoresSize + CpuSemaphoresSize + PackageSemaphoresSize;
   DEBUG((EFI_D_INFO, "One Semaphore Size    = 0x%x\n", SemaphoreSize));
   DEBUG((EFI_D_INFO, "Total Semaphores Size = 0x%x\n", TotalSize));
   Pages = EFI_SIZE_TO_PAGES (TotalSize);
@@ -1309,6 +1389,9 @@ InitializeSmmCpuSemaphores (
   SemaphoreAddr += ProcessorCount * SemaphoreSize;
   mSmmCpuSemaphores.SemaphoreCpu.Present = (BOOLEAN *)SemaphoreAddr;
 
+  SemaphoreAddr = (UINTN)SemaphoreBlock + GlobalSemaphoresSize + CpuSemaphoresSize;
+  mSmmCpuSemaphores.SemaphorePackage.Arrival = (UINT32 *)SemaphoreAddr;
+
   mPFLock                       = mSmmCpuSemaphores.SemaphoreGlobal.PFLock;
   mConfigSmmCodeAccessCheckLock = mSmmCpuSemaphores.SemaphoreGlobal.CodeAccessCheckLock;
 
@@ -1326,6 +1409,7 @@ InitializeMpSyncData (
   )
 {
   UINTN                      CpuIndex;
+  UINTN                      PackageIndex;
 
   if (mSmmMpSyncData != NULL) {
     //
@@ -1362,6 +1446,20 @@ InitializeMpSyncData (
       *(mSmmMpSyncData->CpuData[CpuIndex].Busy)    = 0;
       *(mSmmMpSyncData->CpuData[CpuIndex].Run)     = 0;
       *(mSmmMpSyncData->CpuData[CpuIndex].Present) = FALSE;
+
+      //
+      // Processors that are not present yet (hot plug) share the counter of
+      // package 0; that only costs some contention, not correctness.
+      //
+      PackageIndex = 0;
+      if (gSmmCpuPrivate->ProcessorInfo[CpuIndex].ProcessorId != INVALID_APIC_ID) {
+        PackageIndex = gSmmCpuPrivate->ProcessorInfo[CpuIndex].Location.Package % mSmmCpuPackageCount;
+      }
+      mSmmMpSyncData->CpuData[CpuIndex].Arrival =
+        (UINT32 *)((UINTN)mSmmCpuSemaphores.SemaphorePackage.Arrival + mSemaphoreSize * PackageIndex);
+    }
+    for (PackageIndex = 0; PackageIndex < mSmmCpuPackageCount; PackageIndex++) {
+      *(UINT32 *)((UINTN)mSmmCpuSemaphores.SemaphorePackage.Arrival + mSemaphoreSize * PackageIndex) = 0;
     }
   }
 }
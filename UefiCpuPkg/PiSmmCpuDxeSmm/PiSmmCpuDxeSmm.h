@@ -324,6 +324,7 @@ typedef struct {
   volatile VOID                     *Parameter;
   volatile UINT32                   *Run;
   volatile BOOLEAN                  *Present;
+  volatile UINT32                   *Arrival;
 } SMM_CPU_DATA_BLOCK;
 
 typedef enum {
@@ -369,12 +370,20 @@ typedef struct {
   volatile BOOLEAN                  *Present;
 } SMM_CPU_SEMAPHORE_CPU;
 
+///
+/// All semaphores for each processor package
+///
+typedef struct {
+  volatile UINT32                   *Arrival;
+} SMM_CPU_SEMAPHORE_PACKAGE;
+
 ///
 /// All semaphores' information
 ///
 typedef struct {
   SMM_CPU_SEMAPHORE_GLOBAL          SemaphoreGlobal;
   SMM_CPU_SEMAPHORE_CPU             SemaphoreCpu;
+  SMM_CPU_SEMAPHORE_PACKAGE         SemaphorePackage;
 } SMM_CPU_SEMAPHORES;
 
 extern IA32_DESCRIPTOR                     gcSmiGdtr;
@@ -391,6 +400,7 @@ extern EFI_SMM_CPU_SERVICE_PROTOCOL        mSmmCpuService;
 extern IA32_DESCRIPTOR                     gcSmiInitGdtr;
 extern SMM_CPU_SEMAPHORES                  mSmmCpuSemaphores;
 extern UINTN                               mSemaphoreSize;
+extern UINTN                               mSmmCpuPackageCount;
 extern SPIN_LOCK                           *mPFLock;
 extern SPIN_LOCK                           *mConfigSmmCodeAccessCheckLock;
 extern EFI_SMRAM_DESCRIPTOR                *mSmmCpuSmramRanges;
@@ -459,6 +469,20 @@ IsSyncTimerTimeout (
   IN      UINT64                    Timer
   );
 
+/**
+  Get the number of performance counter ticks elapsed since the timer started.
+
+  @param Timer  The start timer from the begin.
+
+  @return The elapsed ticks.
+
+**/
+UINT64
+EFIAPI
+GetSyncTimerElapsed (
+  IN      UINT64                    Timer
+  );
+
 /**
   Initialize IDT for SMM Stack Guard.
 
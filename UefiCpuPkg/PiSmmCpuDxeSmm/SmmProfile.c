@@ -864,6 +864,7 @@ InitSmmProfileInternal (
   mSmmProfileBase->TsegSize       = mCpuHotPlugData.SmrrSize;
   mSmmProfileBase->NumSmis        = 0;
   mSmmProfileBase->NumCpus        = gSmmCpuPrivate->SmmCoreEntryContext.NumberOfCpus;
+  ZeroMem (mSmmProfileBase->SmiLatency, sizeof (mSmmProfileBase->SmiLatency));
 
   if (mBtsSupported) {
     mMsrDsArea = (MSR_DS_AREA_STRUCT **)AllocateZeroPool (sizeof (MSR_DS_AREA_STRUCT *) * mMaxNumberOfCpus);
@@ -1057,6 +1058,36 @@ SmmProfileRecordSmiNum (
   }
 }
 
+/**
+  Record the time the BSP spent handling an SMI in the latency histogram.
+
+  @param  Ticks  Performance counter ticks elapsed from entering to leaving
+                 SMI rendezvous.
+
+**/
+VOID
+SmmProfileRecordSmiLatency (
+  IN UINT64  Ticks
+  )
+{
+  UINT64  Microseconds;
+  UINTN   Bucket;
+
+  if (!mSmmProfileStart) {
+    return;
+  }
+
+  Microseconds = DivU64x32 (GetTimeInNanoSecond (Ticks), 1000);
+  Bucket       = 0;
+  if (Microseconds != 0) {
+    Bucket = (UINTN)HighBitSet64 (Microseconds) + 1;
+  }
+  if (Bucket >= SMM_PROFILE_LATENCY_BUCKETS) {
+    Bucket = SMM_PROFILE_LATENCY_BUCKETS - 1;
+  }
+  mSmmProfileBase->SmiLatency[Bucket]++;
+}
+
 /**
   Initialize processor environment for SMM profile.
 
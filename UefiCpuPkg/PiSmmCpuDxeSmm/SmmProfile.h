@@ -52,6 +52,18 @@ SmmProfileRecordSmiNum (
   VOID
   );
 
+/**
+  Record the time the BSP spent handling an SMI in the latency histogram.
+
+  @param  Ticks  Performance counter ticks elapsed from entering to leaving
+                 SMI rendezvous.
+
+**/
+VOID
+SmmProfileRecordSmiLatency (
+  IN UINT64  Ticks
+  );
+
 /**
   The Page fault handler to save SMM profile data.
 
@@ -34,6 +34,13 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 #define MAX_PF_ENTRY_COUNT          10
 
+//
+// Number of buckets in the SMI latency histogram. Bucket 0 counts the SMIs
+// handled in less than 1 microsecond, bucket N counts those that took from
+// 2^(N-1) up to 2^N microseconds. The last bucket also counts longer SMIs.
+//
+#define SMM_PROFILE_LATENCY_BUCKETS 24
+
 //
 // This MACRO just enable unit test for the profile
 // Please disable it.
@@ -89,6 +96,7 @@ typedef struct {
   UINT64  TsegSize;
   UINT64  NumSmis;
   UINT64  NumCpus;
+  UINT64  SmiLatency[SMM_PROFILE_LATENCY_BUCKETS];
 } SMM_PROFILE_HEADER;
 
 typedef struct {
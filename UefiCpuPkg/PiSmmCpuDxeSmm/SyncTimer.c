@@ -66,14 +66,16 @@ StartSyncTimer (
 
 
 /**
-  Check if the SMM AP Sync timer is timeout.
+  Get the number of performance counter ticks elapsed since the timer started.
 
   @param Timer  The start timer from the begin.
 
+  @return The elapsed ticks.
+
 **/
-BOOLEAN
+UINT64
 EFIAPI
-IsSyncTimerTimeout (
+GetSyncTimerElapsed (
   IN      UINT64                    Timer
   )
 {
@@ -112,5 +114,20 @@ IsSyncTimerTimeout (
     }
   }
 
-  return (BOOLEAN) (Delta >= mTimeoutTicker);
+  return Delta;
+}
+
+/**
+  Check if the SMM AP Sync timer is timeout.
+
+  @param Timer  The start timer from the begin.
+
+**/
+BOOLEAN
+EFIAPI
+IsSyncTimerTimeout (
+  IN      UINT64                    Timer
+  )
+{
+  return (BOOLEAN) (GetSyncTimerElapsed (Timer) >= mTimeoutTicker);
 }